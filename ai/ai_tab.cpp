@@ -283,20 +283,18 @@ void AITab::insert(const std::string &code)
 	// Insert the code into the file content
 	editor_state.fileContent.insert(editor_state.cursor_index, code);
 
-	ImVec4 ghost_color = ImVec4(0.5f, 0.5f, 0.5f, 0.5f);
+	HighlightClass ghost_color = HighlightClass::Ghost;
 
 	// Ensure fileColors is properly sized and matches fileContent
 	size_t new_size = editor_state.fileContent.size();
-	if (editor_state.fileColors.size() != new_size)
+	if (!editor_state.large_file && editor_state.fileColors.size() != new_size)
 	{
-		editor_state.fileColors.resize(new_size, ImVec4(1.0f, 1.0f, 1.0f, 1.0f));
+		std::lock_guard<std::mutex> lock(editor_state.colorsMutex);
+		editor_state.fileColors.resize(new_size, HighlightClass::Text);
 	}
 
 	// Insert ghost colors at the cursor position
-	editor_state.fileColors.insert(editor_state.fileColors.begin() +
-									   editor_state.cursor_index,
-								   code.size(),
-								   ghost_color);
+	editor_state.insertColors(editor_state.cursor_index, code.size(), ghost_color);
 
 	editor_state.ghost_text_changed = true;
 	gEditor.updateLineStarts();
@@ -311,7 +309,7 @@ void AITab::accept_completion()
 	{
 		if (i < editor_state.fileColors.size())
 		{
-			editor_state.fileColors[i] = ImVec4(1.0f, 1.0f, 1.0f, 1.0f);
+			editor_state.fileColors[i] = HighlightClass::Text;
 		}
 	}
 
@@ -335,8 +333,7 @@ void AITab::dismiss_completion()
 
 	// Validate indices before accessing
 	if (ghost_text_start < 0 || ghost_text_end > editor_state.fileContent.size() ||
-		ghost_text_start >= editor_state.fileColors.size() ||
-		ghost_text_end > editor_state.fileColors.size())
+		ghost_text_start > ghost_text_end)
 	{
 		has_ghost_text = false;
 		ghost_text.clear();
@@ -346,8 +343,7 @@ void AITab::dismiss_completion()
 	}
 
 	editor_state.fileContent.erase(ghost_text_start, ghost_text_end - ghost_text_start);
-	editor_state.fileColors.erase(editor_state.fileColors.begin() + ghost_text_start,
-								  editor_state.fileColors.begin() + ghost_text_end);
+	editor_state.eraseColors(ghost_text_start, ghost_text_end - ghost_text_start);
 
 	has_ghost_text = false;
 	ghost_text.clear();
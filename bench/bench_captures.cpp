@@ -0,0 +1,155 @@
+/*
+	File: bench_captures.cpp
+	Description: Rate at which highlight query captures are turned into
+	classes, on the C++ sample of the corpus.
+
+	Usage: ned_bench_captures [corpus dir] [queries dir]
+
+	The file is parsed once, then the cpp.scm highlight query is run over
+	the whole tree the way TreeSitter::highlightRange does. Resolved looks
+	the class up by capture id in a table built when the query is loaded,
+	which is what the editor does; by name resolves the capture name on
+	every capture, which is what it did before. Both must give the same
+	classes.
+*/
+
+#include "bench_common.h"
+
+#include "../editor/editor_highlight_class.h"
+
+#include <cstdint>
+#include <string>
+#include <tree_sitter/api.h>
+#include <vector>
+
+#ifndef NED_BENCH_QUERIES
+#define NED_BENCH_QUERIES "editor/queries"
+#endif
+
+extern "C" TSLanguage *tree_sitter_cpp();
+
+namespace {
+
+constexpr size_t CORPUS_BYTES = 1024 * 1024;
+constexpr int RUNS = 5;
+
+struct Pass
+{
+	size_t captures = 0;
+	uint64_t checksum = 0;
+};
+
+// Runs query over the whole tree and colors every capture, classOf giving
+// the class of a capture id
+template <typename ClassOf>
+Pass colorCaptures(TSQueryCursor *cursor,
+				   const TSQuery *query,
+				   TSNode root,
+				   std::vector<HighlightClass> &colors,
+				   ClassOf &&classOf)
+{
+	Pass pass;
+	ts_query_cursor_exec(cursor, query, root);
+	TSQueryMatch match;
+	while (ts_query_cursor_next_match(cursor, &match))
+	{
+		for (uint32_t i = 0; i < match.capture_count; ++i)
+		{
+			TSNode node = match.captures[i].node;
+			HighlightClass cls = classOf(match.captures[i].index);
+			uint32_t start = ts_node_start_byte(node);
+			uint32_t end = std::min<uint32_t>(ts_node_end_byte(node), colors.size());
+			for (uint32_t pos = start; pos < end; ++pos)
+			{
+				colors[pos] = cls;
+			}
+			pass.checksum = pass.checksum * 31 + static_cast<uint8_t>(cls);
+			++pass.captures;
+		}
+	}
+	return pass;
+}
+
+void report(const char *name, const Pass &pass, double seconds)
+{
+	std::printf("%-10s %9zu captures %7.2f M/s %7.1f ns/capture   classes %016llx\n",
+				name,
+				pass.captures,
+				pass.captures / seconds / 1e6,
+				seconds * 1e9 / pass.captures,
+				static_cast<unsigned long long>(pass.checksum));
+}
+
+} // namespace
+
+int main(int argc, char **argv)
+{
+	std::string corpus = Bench::corpusDir(argc, argv);
+	std::string queries = argc > 2 ? argv[2] : NED_BENCH_QUERIES;
+	std::string code = Bench::loadCorpus(corpus + "/sample.cpp", CORPUS_BYTES);
+	std::string source = Bench::readFile(queries + "/cpp.scm");
+
+	TSParser *parser = ts_parser_new();
+	ts_parser_set_language(parser, tree_sitter_cpp());
+	TSTree *tree = ts_parser_parse_string(
+		parser, nullptr, code.data(), static_cast<uint32_t>(code.size()));
+
+	uint32_t error_offset = 0;
+	TSQueryError error_type = TSQueryErrorNone;
+	TSQuery *query = ts_query_new(tree_sitter_cpp(),
+								  source.data(),
+								  static_cast<uint32_t>(source.size()),
+								  &error_offset,
+								  &error_type);
+	if (!query)
+	{
+		std::fprintf(
+			stderr, "cpp.scm: query error %d at offset %u\n", error_type, error_offset);
+		return 1;
+	}
+
+	std::vector<HighlightClass> capture_classes;
+	for (uint32_t id = 0; id < ts_query_capture_count(query); ++id)
+	{
+		uint32_t length;
+		const char *name = ts_query_capture_name_for_id(query, id, &length);
+		capture_classes.push_back(highlightClassForCapture(std::string_view(name, length)));
+	}
+
+	TSQueryCursor *cursor = ts_query_cursor_new();
+	TSNode root = ts_tree_root_node(tree);
+	std::vector<HighlightClass> colors(code.size(), HighlightClass::Text);
+	std::printf("Highlight captures, best of %d runs on %zu bytes of C++\n",
+				RUNS,
+				code.size());
+
+	Pass resolved;
+	double resolved_seconds = Bench::bestOf(RUNS, [&]() {
+		resolved = colorCaptures(cursor, query, root, colors, [&](uint32_t id) {
+			return capture_classes[id];
+		});
+	});
+	report("resolved", resolved, resolved_seconds);
+
+	Pass by_name;
+	double by_name_seconds = Bench::bestOf(RUNS, [&]() {
+		by_name = colorCaptures(cursor, query, root, colors, [&](uint32_t id) {
+			uint32_t length;
+			const char *name = ts_query_capture_name_for_id(query, id, &length);
+			return highlightClassForCapture(std::string(name, length));
+		});
+	});
+	report("by name", by_name, by_name_seconds);
+
+	ts_query_cursor_delete(cursor);
+	ts_query_delete(query);
+	ts_tree_delete(tree);
+	ts_parser_delete(parser);
+
+	if (resolved.checksum != by_name.checksum)
+	{
+		std::fprintf(stderr, "Resolved and by name classes differ\n");
+		return 1;
+	}
+	return 0;
+}
@@ -0,0 +1,82 @@
+/*
+	File: bench_common.h
+	Description: Corpus loading and timing shared by the benchmarks.
+
+	The corpus in bench/corpus is small on purpose: a benchmark repeats a
+	file up to a fixed size, so every language and every run is timed on the
+	same amount of text and the numbers compare across machines and commits.
+*/
+
+#pragma once
+#include <algorithm>
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <fstream>
+#include <iterator>
+#include <limits>
+#include <string>
+
+#ifndef NED_BENCH_CORPUS
+#define NED_BENCH_CORPUS "bench/corpus"
+#endif
+
+namespace Bench {
+
+// Directory of the corpus, NED_BENCH_CORPUS unless the first argument names
+// another one
+inline std::string corpusDir(int argc, char **argv)
+{
+	return argc > 1 ? argv[1] : NED_BENCH_CORPUS;
+}
+
+inline std::string readFile(const std::string &path)
+{
+	std::ifstream file(path, std::ios::binary);
+	if (!file)
+	{
+		std::fprintf(stderr, "Cannot read %s\n", path.c_str());
+		std::exit(1);
+	}
+	return std::string(std::istreambuf_iterator<char>(file),
+					   std::istreambuf_iterator<char>());
+}
+
+// The file repeated, whole copies only, until it holds at least min_bytes
+inline std::string loadCorpus(const std::string &path, size_t min_bytes)
+{
+	std::string sample = readFile(path);
+	if (sample.empty())
+	{
+		return sample;
+	}
+	if (sample.back() != '\n')
+	{
+		sample.push_back('\n');
+	}
+	std::string text;
+	text.reserve(min_bytes + sample.size());
+	while (text.size() < min_bytes)
+	{
+		text += sample;
+	}
+	return text;
+}
+
+// Seconds of the fastest of runs calls to fn, after one warm-up call. The
+// fastest run is the one least disturbed by the rest of the machine.
+template <typename Fn> double bestOf(int runs, Fn &&fn)
+{
+	fn();
+	double best = std::numeric_limits<double>::max();
+	for (int run = 0; run < runs; ++run)
+	{
+		auto start = std::chrono::steady_clock::now();
+		fn();
+		std::chrono::duration<double> elapsed = std::chrono::steady_clock::now() - start;
+		best = std::min(best, elapsed.count());
+	}
+	return best;
+}
+
+} // namespace Bench
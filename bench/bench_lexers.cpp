@@ -0,0 +1,85 @@
+/*
+	File: bench_lexers.cpp
+	Description: Throughput of the custom lexers on the checked-in corpus.
+
+	Usage: ned_bench_lexers [corpus dir]
+
+	Prints MB/s per lexer along with a checksum of the classes it produced,
+	so a change to a lexer shows both its speed and whether its colors moved.
+*/
+
+#include "bench_common.h"
+
+#include "../lexers/cpp.h"
+#include "../lexers/csharp.h"
+#include "../lexers/css.h"
+#include "../lexers/html.h"
+#include "../lexers/java.h"
+#include "../lexers/jsx.h"
+#include "../lexers/python.h"
+#include "../lexers/tsx.h"
+
+#include <cstdint>
+#include <iostream>
+#include <sstream>
+#include <vector>
+
+namespace {
+
+// Every language is lexed as one document of this size
+constexpr size_t CORPUS_BYTES = 4 * 1024 * 1024;
+constexpr int RUNS = 5;
+
+uint64_t checksum(const std::vector<HighlightClass> &colors)
+{
+	// FNV-1a over the classes
+	uint64_t hash = 14695981039346656037ull;
+	for (HighlightClass cls : colors)
+	{
+		hash = (hash ^ static_cast<uint8_t>(cls)) * 1099511628211ull;
+	}
+	return hash;
+}
+
+template <typename Lexer>
+void run(const char *name, const std::string &corpus, const std::string &file)
+{
+	std::string code = Bench::loadCorpus(corpus + "/" + file, CORPUS_BYTES);
+	std::vector<HighlightClass> colors(code.size(), HighlightClass::Text);
+	Lexer lexer;
+
+	// Some lexers log every call, which is not what is being timed
+	std::ostringstream discarded;
+	std::streambuf *out = std::cout.rdbuf(discarded.rdbuf());
+	double seconds = Bench::bestOf(RUNS, [&]() {
+		discarded.str("");
+		lexer.applyHighlighting(code, colors, 0);
+	});
+	std::cout.rdbuf(out);
+
+	std::printf("%-8s %10zu bytes %9.1f MB/s   classes %016llx\n",
+				name,
+				code.size(),
+				code.size() / seconds / 1e6,
+				static_cast<unsigned long long>(checksum(colors)));
+}
+
+} // namespace
+
+int main(int argc, char **argv)
+{
+	std::string corpus = Bench::corpusDir(argc, argv);
+	std::printf("Lexers, best of %d runs on %zu MB per language\n",
+				RUNS,
+				CORPUS_BYTES / (1024 * 1024));
+
+	run<CppLexer::Lexer>("cpp", corpus, "sample.cpp");
+	run<PythonLexer::Lexer>("python", corpus, "sample.py");
+	run<JsxLexer::Lexer>("jsx", corpus, "sample.js");
+	run<TsxLexer::Lexer>("tsx", corpus, "sample.tsx");
+	run<JavaLexer::Lexer>("java", corpus, "sample.java");
+	run<CSharpLexer::Lexer>("csharp", corpus, "sample.cs");
+	run<CssLexer::Lexer>("css", corpus, "sample.css");
+	run<HtmlLexer::Lexer>("html", corpus, "sample.html");
+	return 0;
+}
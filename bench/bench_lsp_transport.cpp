@@ -0,0 +1,233 @@
+/*
+	File: bench_lsp_transport.cpp
+	Description: Round trip throughput of LSPTransport against an echo
+	server, checking every message that comes back.
+
+	Usage: ned_bench_lsp_transport
+
+	The executable is its own server: started with --echo it sends back each
+	message it reads. It writes the frames in awkward pieces, a header a
+	byte at a time, a body split in two, several frames in one write and
+	header names in other cases, so the reader's incremental header parsing
+	sees every way a frame can arrive. Receives use a timeout, which on
+	Windows is the PeekNamedPipe wait.
+
+	Exits non-zero when a message is lost, altered or out of order, so it
+	also runs as a test.
+*/
+
+#include "../lsp/lsp_transport.h"
+#include "bench_common.h"
+
+#include <cctype>
+#include <cstdint>
+#include <cstdio>
+#include <string>
+#include <thread>
+#include <vector>
+
+#ifdef _WIN32
+#include <fcntl.h>
+#include <io.h>
+#else
+#include <csignal>
+#endif
+
+namespace {
+
+// Sizes cycled through by the client; the largest makes the ring grow
+const size_t MESSAGE_SIZES[] = {64, 700, 16 * 1024, 3, 200 * 1024, 0, 2 * 1024 * 1024};
+constexpr int MESSAGES = 700;
+constexpr int RECEIVE_TIMEOUT_MS = 10000;
+
+void writeAll(const char *data, size_t length)
+{
+	std::fwrite(data, 1, length, stdout);
+	std::fflush(stdout);
+}
+
+// Reads header lines up to the blank one; -1 at the end of input
+long long readHeader()
+{
+	long long length = -1;
+	std::string line;
+	int c;
+	while ((c = std::getchar()) != EOF)
+	{
+		if (c != '\n')
+		{
+			line.push_back(char(c));
+			continue;
+		}
+		if (!line.empty() && line.back() == '\r')
+		{
+			line.pop_back();
+		}
+		if (line.empty())
+		{
+			return length;
+		}
+		const std::string name = "content-length:";
+		if (line.size() > name.size())
+		{
+			std::string lower = line.substr(0, name.size());
+			for (char &ch : lower)
+			{
+				ch = char(std::tolower(static_cast<unsigned char>(ch)));
+			}
+			if (lower == name)
+			{
+				length = std::stoll(line.substr(name.size()));
+			}
+		}
+		line.clear();
+	}
+	return -1;
+}
+
+int runEchoServer()
+{
+#ifdef _WIN32
+	_setmode(_fileno(stdin), _O_BINARY);
+	_setmode(_fileno(stdout), _O_BINARY);
+#endif
+	std::string pending; // frames held back to go out in one write
+	for (int index = 0;; ++index)
+	{
+		long long length = readHeader();
+		if (length < 0)
+		{
+			break;
+		}
+		std::string body(size_t(length), '\0');
+		if (length > 0 && std::fread(body.data(), 1, body.size(), stdin) != body.size())
+		{
+			break;
+		}
+
+		const char *names[] = {"Content-Length", "content-length", "CONTENT-LENGTH"};
+		std::string header = std::string(names[index % 3]) + ": " +
+							 std::to_string(body.size()) + "\r\n";
+		if (index % 4 == 1)
+		{
+			header += "Content-Type: application/vscode-jsonrpc; charset=utf-8\r\n";
+		}
+		header += "\r\n";
+
+		switch (index % 4)
+		{
+		case 0: // header a byte at a time
+			for (char c : header)
+			{
+				writeAll(&c, 1);
+			}
+			writeAll(body.data(), body.size());
+			break;
+		case 1: // split inside the body
+			writeAll(header.data(), header.size());
+			writeAll(body.data(), body.size() / 2);
+			writeAll(body.data() + body.size() / 2, body.size() - body.size() / 2);
+			break;
+		case 2: // held back, goes out together with the next frame
+			pending = header + body;
+			break;
+		default:
+			pending += header + body;
+			writeAll(pending.data(), pending.size());
+			pending.clear();
+			break;
+		}
+	}
+	writeAll(pending.data(), pending.size());
+	return 0;
+}
+
+std::string makeBody(int index)
+{
+	size_t size = MESSAGE_SIZES[index % (sizeof(MESSAGE_SIZES) / sizeof(MESSAGE_SIZES[0]))];
+	std::string body(size, '\0');
+	uint32_t state = 2166136261u ^ uint32_t(index);
+	for (char &c : body)
+	{
+		state = state * 1664525u + 1013904223u;
+		c = char(' ' + (state >> 24) % 95);
+	}
+	return body;
+}
+
+} // namespace
+
+int main(int argc, char **argv)
+{
+	if (argc > 1 && std::string(argv[1]) == "--echo")
+	{
+		return runEchoServer();
+	}
+
+#ifndef _WIN32
+	// As in main(), see lsp_transport.h
+	signal(SIGPIPE, SIG_IGN);
+#endif
+
+	LSPTransport transport;
+	if (!transport.start({argv[0], "--echo"}))
+	{
+		std::fprintf(stderr, "Cannot start the echo server\n");
+		return 1;
+	}
+
+	// Nothing was sent yet, so this has to time out
+	if (!transport.receive(50).empty())
+	{
+		std::fprintf(stderr, "Message before any was sent\n");
+		return 1;
+	}
+
+	std::vector<std::string> bodies;
+	size_t bytes = 0;
+	for (int index = 0; index < MESSAGES; ++index)
+	{
+		bodies.push_back(makeBody(index));
+		bytes += bodies.back().size();
+	}
+
+	// Sent from another thread, as the pipes do not hold all of it
+	auto start = std::chrono::steady_clock::now();
+	std::thread writer([&transport, &bodies]() {
+		for (const std::string &body : bodies)
+		{
+			if (!transport.send(body))
+			{
+				return;
+			}
+		}
+	});
+
+	for (int index = 0; index < MESSAGES; ++index)
+	{
+		std::string body = transport.receive(RECEIVE_TIMEOUT_MS);
+		if (body != bodies[index])
+		{
+			std::fprintf(stderr,
+						 "Message %d: expected %zu bytes, got %zu%s\n",
+						 index,
+						 bodies[index].size(),
+						 body.size(),
+						 body.empty() ? " (timeout or closed)" : " that differ");
+			// The writer may be blocked on a pipe nothing drains any more
+			std::fflush(stderr);
+			std::_Exit(1);
+		}
+	}
+	writer.join();
+	std::chrono::duration<double> elapsed = std::chrono::steady_clock::now() - start;
+	transport.stop();
+
+	std::printf("%d messages, %.1f MB each way in %.3f s: %.1f MB/s, %.0f messages/s\n",
+				MESSAGES,
+				bytes / 1e6,
+				elapsed.count(),
+				bytes / elapsed.count() / 1e6,
+				MESSAGES / elapsed.count());
+	return 0;
+}
@@ -0,0 +1,120 @@
+// Sample C++ source for the lexer and highlighting benchmarks. The text is
+// repeated up to the benchmark size, so it covers the constructs the lexers
+// handle rather than being large itself.
+#include <algorithm>
+#include <map>
+#include <memory>
+#include <string>
+#include <vector>
+
+#define BENCH_MAX_ITEMS 1024
+#define BENCH_SQUARE(x) ((x) * (x))
+
+namespace bench {
+
+/* A block comment spanning
+   more than one line, with "quotes" and 'chars' inside. */
+enum class Shape : uint8_t
+{
+	Circle,
+	Square,
+	Triangle
+};
+
+template <typename T, size_t N = 16> class RingBuffer
+{
+  public:
+	explicit RingBuffer(size_t capacity = N) : items(capacity), head(0), count(0) {}
+
+	bool push(const T &value)
+	{
+		if (count == items.size())
+		{
+			return false;
+		}
+		items[(head + count++) % items.size()] = value;
+		return true;
+	}
+
+	std::optional<T> pop() noexcept
+	{
+		if (count == 0)
+		{
+			return std::nullopt;
+		}
+		T value = std::move(items[head]);
+		head = (head + 1) % items.size();
+		--count;
+		return value;
+	}
+
+	[[nodiscard]] size_t size() const { return count; }
+
+  private:
+	std::vector<T> items;
+	size_t head;
+	size_t count;
+};
+
+struct Point
+{
+	double x = 0.0;
+	double y = -1.5e3;
+	constexpr Point operator+(const Point &other) const
+	{
+		return {x + other.x, y + other.y};
+	}
+};
+
+static const char *shapeName(Shape shape)
+{
+	switch (shape)
+	{
+	case Shape::Circle:
+		return "circle";
+	case Shape::Square:
+		return "square\tsquare";
+	default:
+		return "triangle \"quoted\"";
+	}
+}
+
+int countWords(const std::string &text, std::map<std::string, int> &words)
+{
+	int total = 0;
+	std::string word;
+	for (char c : text)
+	{
+		if (std::isalnum(static_cast<unsigned char>(c)) || c == '_')
+		{
+			word.push_back(c);
+		} else if (!word.empty())
+		{
+			++words[word];
+			++total;
+			word.clear();
+		}
+	}
+	auto raw = R"(raw string with \n no escapes)";
+	unsigned long mask = 0xFF00FF00ul | 0b1010;
+	float ratio = total > 0 ? 1.0f / total : 0.5f;
+	(void)raw;
+	(void)mask;
+	(void)ratio;
+	return total;
+}
+
+class Renderer : public std::enable_shared_from_this<Renderer>
+{
+  public:
+	virtual ~Renderer() = default;
+	virtual void draw(const Point &at, Shape shape) = 0;
+	void drawAll(const std::vector<std::pair<Point, Shape>> &shapes)
+	{
+		std::for_each(shapes.begin(), shapes.end(), [this](const auto &entry) {
+			draw(entry.first, entry.second);
+		});
+	}
+};
+
+} // namespace bench
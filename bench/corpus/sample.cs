@@ -0,0 +1,83 @@
+// Sample C# source for the lexer and highlighting benchmarks. The text is
+// repeated up to the benchmark size.
+using System;
+using System.Collections.Generic;
+using System.Linq;
+using System.Threading.Tasks;
+
+namespace Bench.Sample
+{
+    /// <summary>Keeps items by name and answers simple queries.</summary>
+    public sealed class Inventory<T> where T : class, INamed
+    {
+        private const int MaxItems = 1024;
+        private readonly Dictionary<string, T> _byName = new(MaxItems);
+        private readonly List<T> _ordered = new();
+
+        public event EventHandler<T>? ItemAdded;
+
+        public int Count => _ordered.Count;
+
+        public bool Add(T item)
+        {
+            if (item is null || _byName.ContainsKey(item.Name))
+            {
+                return false;
+            }
+            _byName[item.Name] = item;
+            _ordered.Add(item);
+            ItemAdded?.Invoke(this, item);
+            return true;
+        }
+
+        public T? Find(string name) => _byName.TryGetValue(name, out var item) ? item : null;
+
+        public IEnumerable<T> Heaviest(int limit = 10)
+        {
+            return _ordered.OrderByDescending(i => i.Weight).ThenBy(i => i.Name).Take(limit);
+        }
+
+        public async Task<int> LoadAsync(IAsyncEnumerable<T> source)
+        {
+            var added = 0;
+            await foreach (var item in source)
+            {
+                if (Add(item)) added++;
+            }
+            return added;
+        }
+
+        public override string ToString()
+        {
+            /* Block comment with "quotes" and 'c' chars */
+            var verbatim = @"C:\items\list.txt";
+            var interpolated = $"Inventory of {Count} items from {verbatim}";
+            return interpolated + '\n' + 0x1F.ToString() + 1.5e3m;
+        }
+    }
+
+    public interface INamed
+    {
+        string Name { get; }
+        int Weight { get; }
+    }
+
+    public record Item(string Name, int Weight = 1) : INamed;
+
+    public static class Program
+    {
+        public static void Main(string[] args)
+        {
+            var inventory = new Inventory<Item>();
+            inventory.ItemAdded += (_, item) => Console.WriteLine($"added {item.Name}");
+            for (int i = 0; i < 10; ++i)
+            {
+                inventory.Add(new Item($"item-{i}", i * 2));
+            }
+            foreach (var item in inventory.Heaviest(3))
+            {
+                Console.WriteLine(item);
+            }
+        }
+    }
+}
@@ -0,0 +1,86 @@
+// Sample Java source for the lexer and highlighting benchmarks. The text is
+// repeated up to the benchmark size.
+package bench.sample;
+
+import java.util.ArrayList;
+import java.util.HashMap;
+import java.util.List;
+import java.util.Map;
+import java.util.Optional;
+import java.util.function.Predicate;
+
+/**
+ * Keeps items by name and answers simple queries over them.
+ *
+ * @param <T> the item type
+ */
+public final class Inventory<T extends Inventory.Named> implements Iterable<T> {
+    public interface Named {
+        String name();
+
+        default int weight() {
+            return 1;
+        }
+    }
+
+    private static final int MAX_ITEMS = 1024;
+    private static final double LOAD_FACTOR = 0.75d;
+
+    private final Map<String, T> byName = new HashMap<>(MAX_ITEMS, (float) LOAD_FACTOR);
+    private final List<T> ordered = new ArrayList<>();
+    private volatile long version = 0L;
+
+    public synchronized boolean add(T item) {
+        if (item == null || byName.containsKey(item.name())) {
+            return false;
+        }
+        byName.put(item.name(), item);
+        ordered.add(item);
+        version++;
+        return true;
+    }
+
+    public Optional<T> find(String name) {
+        return Optional.ofNullable(byName.get(name));
+    }
+
+    public List<T> filter(Predicate<? super T> predicate) {
+        List<T> result = new ArrayList<>();
+        for (T item : ordered) {
+            if (predicate.test(item)) {
+                result.add(item);
+            }
+        }
+        return result;
+    }
+
+    public int totalWeight() {
+        int total = 0;
+        for (int i = 0; i < ordered.size(); i++) {
+            total += ordered.get(i).weight();
+        }
+        return total;
+    }
+
+    @Override
+    public java.util.Iterator<T> iterator() {
+        return ordered.iterator();
+    }
+
+    @Override
+    public String toString() {
+        /* Block comment with "quotes" and 'c' chars */
+        StringBuilder builder = new StringBuilder("Inventory[");
+        builder.append(ordered.size()).append(" items, v").append(version).append(']');
+        return builder.toString();
+    }
+
+    public static void main(String[] args) throws Exception {
+        Inventory<Named> inventory = new Inventory<>();
+        for (int i = 0; i < 10; ++i) {
+            final String name = "item-" + i + "\t";
+            inventory.add(() -> name);
+        }
+        System.out.println(inventory + " weighs " + inventory.totalWeight() + 0x1F);
+    }
+}
@@ -0,0 +1,83 @@
+// Sample JavaScript source for the lexer and highlighting benchmarks. The
+// text is repeated up to the benchmark size.
+import React, { useEffect, useState } from 'react';
+import { fetchItems } from './api';
+
+const MAX_ITEMS = 1024;
+const pattern = /^[a-z_][a-z0-9_]*$/i;
+
+/* Block comment with "quotes" and `backticks` */
+export class Store {
+	constructor(name, capacity = 16) {
+		this.name = name;
+		this.capacity = capacity;
+		this.items = new Map();
+	}
+
+	add(key, value) {
+		if (this.items.size >= this.capacity) {
+			throw new Error(`store ${this.name} is full`);
+		}
+		this.items.set(key, value);
+		return this;
+	}
+
+	*entries() {
+		for (const [key, value] of this.items) {
+			yield { key, value };
+		}
+	}
+
+	static fromObject(name, object) {
+		const store = new Store(name, Object.keys(object).length);
+		Object.entries(object).forEach(([key, value]) => store.add(key, value));
+		return store;
+	}
+}
+
+export function ItemList({ filter, onSelect }) {
+	const [items, setItems] = useState([]);
+	const [loading, setLoading] = useState(true);
+
+	useEffect(() => {
+		let cancelled = false;
+		fetchItems({ limit: MAX_ITEMS })
+			.then((result) => {
+				if (!cancelled) {
+					setItems(result.filter((item) => pattern.test(item.name)));
+				}
+			})
+			.catch((error) => console.error('fetch failed', error))
+			.finally(() => setLoading(false));
+		return () => {
+			cancelled = true;
+		};
+	}, [filter]);
+
+	if (loading) {
+		return <div className="spinner">Loading...</div>;
+	}
+
+	return (
+		<ul className="item-list" data-count={items.length}>
+			{items.map((item) => (
+				<li key={item.id} onClick={() => onSelect?.(item)}>
+					<span className="name">{item.name}</span>
+					<span className="size">{(item.size / 1024).toFixed(1)} KB</span>
+				</li>
+			))}
+		</ul>
+	);
+}
+
+export default async function load(url, retries = 3) {
+	for (let attempt = 0; attempt < retries; attempt++) {
+		try {
+			const response = await fetch(url, { method: 'GET' });
+			return await response.json();
+		} catch (e) {
+			if (attempt === retries - 1) throw e;
+		}
+	}
+	return null;
+}
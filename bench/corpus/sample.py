@@ -0,0 +1,82 @@
+"""Sample Python source for the lexer and highlighting benchmarks.
+
+The text is repeated up to the benchmark size.
+"""
+
+import json
+import os
+from dataclasses import dataclass, field
+from typing import Dict, List, Optional
+
+MAX_ITEMS = 1024
+RATIO = 0.75
+MASK = 0xFF00
+
+
+@dataclass
+class Entry:
+    name: str
+    size: int = 0
+    tags: List[str] = field(default_factory=list)
+
+    def describe(self) -> str:
+        return f"{self.name} ({self.size} bytes, {len(self.tags)} tags)"
+
+
+class Index:
+    """Keeps entries by name and by tag."""
+
+    def __init__(self, root: str) -> None:
+        self.root = root
+        self.entries: Dict[str, Entry] = {}
+        self._by_tag: Dict[str, List[Entry]] = {}
+
+    def add(self, entry: Entry) -> None:
+        if entry.name in self.entries:
+            raise KeyError(f"duplicate entry {entry.name!r}")
+        self.entries[entry.name] = entry
+        for tag in entry.tags:
+            self._by_tag.setdefault(tag, []).append(entry)
+
+    def find(self, tag: str) -> List[Entry]:
+        return sorted(self._by_tag.get(tag, []), key=lambda e: (-e.size, e.name))
+
+    def scan(self) -> int:
+        count = 0
+        for directory, _, files in os.walk(self.root):
+            for name in files:
+                path = os.path.join(directory, name)
+                try:
+                    size = os.path.getsize(path)
+                except OSError:
+                    continue
+                tags = [part for part in name.split(".")[1:] if part]
+                self.add(Entry(path, size, tags))
+                count += 1
+        return count
+
+    def to_json(self, indent: Optional[int] = 2) -> str:
+        data = {name: {"size": e.size, "tags": e.tags} for name, e in self.entries.items()}
+        return json.dumps(data, indent=indent)
+
+
+def largest(index: Index, limit: int = 10) -> List[Entry]:
+    # Single line comment with 'quotes' and "more quotes"
+    result = list(index.entries.values())
+    result.sort(key=lambda e: e.size, reverse=True)
+    return result[:limit] if limit > 0 else []
+
+
+async def fetch_all(urls, session):
+    results = []
+    for url in urls:
+        async with session.get(url) as response:
+            results.append(await response.text())
+    return results
+
+
+if __name__ == "__main__":
+    idx = Index(".")
+    print("scanned", idx.scan(), "files", r"raw\string", b"bytes", 1e-3, 42j)
+    for item in largest(idx):
+        print(item.describe())
@@ -0,0 +1,90 @@
+// Sample TypeScript/TSX source for the lexer and highlighting benchmarks. The
+// text is repeated up to the benchmark size.
+import React, { useCallback, useMemo, useState } from 'react';
+
+export interface Item {
+	id: number;
+	name: string;
+	size?: number;
+	tags: readonly string[];
+}
+
+type SortKey = keyof Pick<Item, 'name' | 'size'>;
+
+enum Direction {
+	Ascending = 1,
+	Descending = -1,
+}
+
+const MAX_ITEMS: number = 1_024;
+
+/* Block comment with "quotes" and `backticks` */
+export abstract class Repository<T extends { id: number }> {
+	protected readonly items = new Map<number, T>();
+
+	constructor(private readonly name: string) {}
+
+	abstract validate(item: T): boolean;
+
+	save(item: T): void {
+		if (!this.validate(item)) {
+			throw new Error(`invalid item ${item.id} in ${this.name}`);
+		}
+		this.items.set(item.id, item);
+	}
+
+	find(predicate: (item: T) => boolean): T | undefined {
+		for (const item of this.items.values()) {
+			if (predicate(item)) return item;
+		}
+		return undefined;
+	}
+}
+
+function compare<K extends SortKey>(key: K, direction: Direction) {
+	return (a: Item, b: Item): number => {
+		const left = a[key] ?? 0;
+		const right = b[key] ?? 0;
+		return left < right ? -direction : left > right ? direction : 0;
+	};
+}
+
+export const ItemTable: React.FC<{ items: Item[]; onOpen?: (item: Item) => void }> = ({
+	items,
+	onOpen,
+}) => {
+	const [sortKey, setSortKey] = useState<SortKey>('name');
+	const [direction, setDirection] = useState(Direction.Ascending);
+
+	const sorted = useMemo(
+		() => [...items].sort(compare(sortKey, direction)).slice(0, MAX_ITEMS),
+		[items, sortKey, direction]
+	);
+
+	const toggle = useCallback(
+		(key: SortKey) => {
+			setDirection(key === sortKey ? -direction : Direction.Ascending);
+			setSortKey(key);
+		},
+		[sortKey, direction]
+	);
+
+	return (
+		<table className="items">
+			<thead>
+				<tr>
+					<th onClick={() => toggle('name')}>Name</th>
+					<th onClick={() => toggle('size')}>Size</th>
+				</tr>
+			</thead>
+			<tbody>
+				{sorted.map((item) => (
+					<tr key={item.id} onDoubleClick={() => onOpen?.(item)}>
+						<td>{item.name}</td>
+						<td>{item.size !== undefined ? `${item.size} B` : '-'}</td>
+					</tr>
+				))}
+			</tbody>
+		</table>
+	);
+};
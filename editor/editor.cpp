@@ -27,6 +27,7 @@
 #include "editor_render.h"
 #include "editor_selection.h"
 #include "editor_utils.h"
+#include "editor_wrap.h"
 
 #include "../ai/ai_tab.h"
 #include "../files/file_finder.h"
@@ -44,8 +45,11 @@ EditorState editor_state;
 
 void Editor::textEditor()
 {
-	// process auto complete before edtior input....
-	gLSPAutocomplete.renderCompletions();
+	// Responses from the language server run their handlers here
+	gLSPManager.processMessages();
+
+	// The popup takes its keys before the editor input...
+	gLSPAutocomplete.processInput();
 
 	if (gLSPAutocomplete.showCompletions) {
 		std::cout << "[DEBUG] Popup visible with "
@@ -62,6 +66,9 @@ void Editor::textEditor()
 
 	processEditorInput();
 
+	// ...and is drawn after it, with the list the keystroke filtered
+	gLSPAutocomplete.renderCompletions();
+
 	ImGui::Separator();
 	if (gLSPManager.isInitialized()) {
 		ImGui::TextUnformatted("LSP: connected");
@@ -84,13 +91,21 @@ void Editor::setupEditorDisplay()
 	editor_state.line_numbers_pos = gEditorLineNumbers.createLineNumbersPanel();
 
 	updateLineStarts();
-	editor_state.total_height =
-		editor_state.line_height * editor_state.editor_content_lines.size();
 
 	float remaining_width = editor_state.size.x - editor_state.line_number_width;
 	float content_width = calculateTextWidth() + ImGui::GetFontSize() * 10.0f;
-	float content_height =
-		editor_state.editor_content_lines.size() * editor_state.line_height;
+
+	// Wrapped text fits the width, leaving room for the vertical scrollbar
+	float wrap_width = remaining_width - editor_state.text_left_margin -
+					   ImGui::GetFontSize() - WRAP_SCROLLBAR_ROOM;
+	gEditorWrap.update(wrap_width);
+	if (gEditorWrap.enabled())
+	{
+		content_width = remaining_width - WRAP_SCROLLBAR_ROOM;
+	}
+
+	editor_state.total_height = editor_state.line_height * gEditorWrap.totalRows();
+	float content_height = editor_state.total_height;
 
 	gEditorRender.beginTextEditorChild(
 		"##editor", remaining_width, content_width, content_height);
@@ -114,79 +129,108 @@ void Editor::processEditorInput()
 
 void Editor::updateLineStarts()
 {
-	if (editor_state.fileContent == editor_state.cached_text)
+	LineIndex::Change change =
+		editor_state.editor_content_lines.update(editor_state.fileContent);
+	if (change.removed_lines == 0 && change.inserted_lines == 0)
 	{
 		return;
 	}
 
-	editor_state.cached_text = editor_state.fileContent;
-	editor_state.editor_content_lines.clear();
-	editor_state.line_widths.clear();
-
-	editor_state.editor_content_lines.reserve(
-		editor_state.fileContent.size() /
-		40); // Heuristic: assume average line length of 40 chars
-	editor_state.editor_content_lines.push_back(0);
-
-	size_t pos = 0;
-	while ((pos = editor_state.fileContent.find('\n', pos)) != std::string::npos)
-	{
-		editor_state.editor_content_lines.push_back(
-			pos + 1); // Position after the newline character
-		++pos;
-	}
-
-	for (size_t i = 0; i < editor_state.editor_content_lines.size(); ++i)
-	{
-		int start = editor_state.editor_content_lines[i];
-		int end = (i + 1 < editor_state.editor_content_lines.size())
-					  ? editor_state.editor_content_lines[i + 1] - 1
-					  : editor_state.fileContent.size();
-		float width = ImGui::CalcTextSize(editor_state.fileContent.c_str() + start,
-										  editor_state.fileContent.c_str() + end)
-						  .x;
-		editor_state.line_widths.push_back(width);
-	}
+	// Widths and wraps of the replaced lines are measured again on the next frame
+	editor_state.line_widths.splice(change.first_line,
+									change.rebuilt ? editor_state.line_widths.size()
+												   : change.removed_lines,
+									change.inserted_lines);
+	editor_state.line_wraps.splice(change.first_line,
+								   change.rebuilt ? editor_state.line_wraps.size()
+												  : change.removed_lines,
+								   change.inserted_lines);
 }
 
 int Editor::getLineFromPos(int pos)
 {
-	auto it = std::upper_bound(editor_state.editor_content_lines.begin(),
-							   editor_state.editor_content_lines.end(),
-							   pos);
-	return std::distance(editor_state.editor_content_lines.begin(), it) - 1;
+	return EditorUtils::GetLineFromPosition(editor_state.editor_content_lines, pos);
 }
 
 float Editor::calculateTextWidth()
 {
-	float max_width = 0.0f;
 	ImFont *font = ImGui::GetFont();
+	auto advanceOf = [font](const char *text) {
+		return font->CalcTextSizeA(font->LegacySize, FLT_MAX, 0.0f, text).x;
+	};
 
-	for (size_t i = 0; i < editor_state.editor_content_lines.size(); ++i)
+	// Re-measure everything only when the font changes. Monospace widths are
+	// stored in columns, so they survive a size change of the same font.
+	if (font != editor_state.line_widths_font)
 	{
-		size_t start = editor_state.editor_content_lines[i];
-		size_t end = (i + 1 < editor_state.editor_content_lines.size())
-						 ? editor_state.editor_content_lines[i + 1]
-						 : editor_state.fileContent.size();
-
-		if (end > start)
+		float advance = advanceOf("M");
+		editor_state.line_widths_monospace =
+			advance > 0.0f && advanceOf("i") == advance && advanceOf("W") == advance &&
+			advanceOf(".") == advance && advanceOf(" ") == advance;
+		editor_state.line_widths_font = font;
+		editor_state.line_widths_font_size = 0.0f;
+		editor_state.line_widths.invalidateAll();
+	}
+	if (font->LegacySize != editor_state.line_widths_font_size)
+	{
+		editor_state.line_widths_advance = advanceOf("M");
+		editor_state.line_widths_tab_columns =
+			editor_state.line_widths_advance > 0.0f
+				? advanceOf("\t") / editor_state.line_widths_advance
+				: 4.0f;
+		editor_state.line_widths_font_size = font->LegacySize;
+		if (!editor_state.line_widths_monospace)
 		{
-			std::string line = editor_state.fileContent.substr(start, end - start);
-			float width =
-				font->CalcTextSizeA(font->LegacySize, FLT_MAX, 0.0f, line.c_str()).x;
+			editor_state.line_widths.invalidateAll();
+		}
+	}
 
-			// Apply compensation based on line length and font size
-			float compensation = (line.length() * 0.1f) * (24.0f / font->LegacySize) * 10;
-			width += compensation;
+	// Extra room per char, scaled with the font size
+	const float compensation = 24.0f / font->LegacySize;
 
-			// Add extra safety margin
-			width *= 1.01f; // 1% extra
+	editor_state.line_widths.measurePending([&](size_t line) {
+		const LineIndex &lines = editor_state.editor_content_lines;
+		if (!lines.complete() && line + 1 == lines.size())
+		{
+			return 0.0f; // unscanned rest of a large file, measured once indexed
+		}
+		size_t start = lines[line];
+		size_t length = lines.lineLength(line);
 
-			if (width > max_width)
-				max_width = width;
+		if (editor_state.line_widths_monospace)
+		{
+			// Count columns straight from the buffer: one per UTF-8 char,
+			// tabs as wide as the font draws them
+			float columns = 0.0f;
+			const float tab_columns = editor_state.line_widths_tab_columns;
+			auto countColumns = [&columns, tab_columns](std::string_view chunk) {
+				for (char c : chunk)
+				{
+					if (c == '\t')
+						columns += tab_columns;
+					else if (c != '\n' && (static_cast<unsigned char>(c) & 0xC0) != 0x80)
+						columns += 1.0f;
+				}
+				return true;
+			};
+			editor_state.fileContent.forEachChunk(start, length, countColumns);
+			return columns;
 		}
+
+		std::string text = editor_state.fileContent.substr(start, length);
+		return font->CalcTextSizeA(font->LegacySize, FLT_MAX, 0.0f, text.c_str()).x +
+			   text.length() * compensation;
+	});
+
+	float max_width = editor_state.line_widths.max();
+	if (editor_state.line_widths_monospace)
+	{
+		max_width *= editor_state.line_widths_advance + compensation;
 	}
 
+	// Add extra safety margin
+	max_width *= 1.01f; // 1% extra
+
 	// Add generous padding (15% or 150px, whichever is larger)
 	float padding = std::max(150.0f, max_width * 0.15f);
 	return max_width + padding;
@@ -16,6 +16,7 @@
 #include "editor_render.h"
 #include "editor_scroll.h"
 #include "editor_types.h"
+#include "editor_wrap.h"
 
 #include <string>
 #include <vector>
@@ -41,4 +42,8 @@ class Editor
 	float calculateTextWidth();
 
 	void renderEditor(ImFont *font, float editorWidth);
+
+  private:
+	// Scrollbar size EditorRender::beginTextEditorChild sets for the editor
+	static constexpr float WRAP_SCROLLBAR_ROOM = 12.0f;
 };
@@ -0,0 +1,686 @@
+/*
+	File: editor_buffer.cpp
+	Description: Piece table document buffer used for EditorState::fileContent.
+*/
+
+#include "editor_buffer.h"
+#include "editor_file_mapping.h"
+
+#include <algorithm>
+#include <atomic>
+#include <cstring>
+
+static std::atomic<uint64_t> next_document_id{1};
+
+static size_t countNewlines(const char *data, size_t length)
+{
+	return static_cast<size_t>(std::count(data, data + length, '\n'));
+}
+
+void TextBuffer::const_iterator::load() const
+{
+	size_t node_start = 0;
+	const Node *node = buffer->findNode(pos, node_start);
+	if (!node)
+	{
+		static const char terminator = '\0';
+		chunk = &terminator;
+		chunk_start = pos;
+		chunk_end = pos + 1;
+		return;
+	}
+	chunk = node->data;
+	chunk_start = node_start;
+	chunk_end = node_start + node->length;
+}
+
+TextBuffer::TextBuffer() = default;
+
+TextBuffer::TextBuffer(std::string text) { assign(std::move(text)); }
+
+TextBuffer::TextBuffer(const TextSnapshot &snapshot)
+	: root(snapshot.buffer->root), storage(std::make_shared<Storage>()),
+	  document_id(next_document_id++)
+{
+	// Edits of the fork go to its own add blocks; the snapshot's text stays
+	// reachable through base
+	storage->base = snapshot.buffer->storage;
+	newlines_pending = true;
+	edit_log_version = modification_version;
+}
+
+TextBuffer::~TextBuffer() = default;
+
+TextBuffer::TextBuffer(TextBuffer &&other) noexcept = default;
+
+TextBuffer &TextBuffer::operator=(TextBuffer &&other) noexcept = default;
+
+void TextBuffer::update(Node *node)
+{
+	node->subtree_bytes = bytesOf(node->left) + node->length + bytesOf(node->right);
+	node->subtree_newlines =
+		newlinesOf(node->left) + node->newlines + newlinesOf(node->right);
+}
+
+TextBuffer::NodePtr TextBuffer::makeNode(const char *data,
+										size_t length,
+										bool count_newlines)
+{
+	// xorshift32, only needs to be cheap and well spread for treap balance
+	rng_state ^= rng_state << 13;
+	rng_state ^= rng_state >> 17;
+	rng_state ^= rng_state << 5;
+
+	NodePtr node = std::make_shared<Node>();
+	node->data = data;
+	node->length = length;
+	node->newlines = count_newlines ? countNewlines(data, length) : 0;
+	node->newlines_counted = count_newlines;
+	node->priority = rng_state;
+	update(node.get());
+	return node;
+}
+
+TextBuffer::Node *TextBuffer::own(NodePtr &node)
+{
+	// A node reachable from a snapshot (or another buffer) is copied before
+	// it is changed. Its children are shared by both copies afterwards, so the
+	// copying continues down exactly the path the edit touches.
+	if (node.use_count() > 1)
+	{
+		node = std::make_shared<Node>(*node);
+	}
+	return node.get();
+}
+
+TextBuffer::NodePtr TextBuffer::merge(NodePtr a, NodePtr b)
+{
+	if (!a)
+		return b;
+	if (!b)
+		return a;
+
+	if (a->priority > b->priority)
+	{
+		Node *node = own(a);
+		node->right = merge(std::move(node->right), std::move(b));
+		update(node);
+		return a;
+	}
+	Node *node = own(b);
+	node->left = merge(std::move(a), std::move(node->left));
+	update(node);
+	return b;
+}
+
+std::pair<TextBuffer::NodePtr, TextBuffer::NodePtr> TextBuffer::split(NodePtr node,
+																	   size_t pos)
+{
+	if (!node)
+	{
+		return {nullptr, nullptr};
+	}
+
+	Node *owned = own(node);
+	size_t left_bytes = bytesOf(owned->left);
+	if (pos <= left_bytes)
+	{
+		auto [a, b] = split(std::move(owned->left), pos);
+		owned->left = std::move(b);
+		update(owned);
+		return {std::move(a), std::move(node)};
+	}
+	if (pos >= left_bytes + owned->length)
+	{
+		auto [a, b] = split(std::move(owned->right), pos - left_bytes - owned->length);
+		owned->right = std::move(a);
+		update(owned);
+		return {std::move(node), std::move(b)};
+	}
+
+	// The split point falls inside this piece: cut it in two. The tail keeps
+	// the node's priority and takes over its right subtree, so both halves
+	// remain valid treaps.
+	size_t offset = pos - left_bytes;
+	size_t head_newlines =
+		owned->newlines_counted ? countNewlines(owned->data, offset) : 0;
+
+	NodePtr tail = std::make_shared<Node>();
+	tail->data = owned->data + offset;
+	tail->length = owned->length - offset;
+	tail->newlines = owned->newlines_counted ? owned->newlines - head_newlines : 0;
+	tail->newlines_counted = owned->newlines_counted;
+	tail->priority = owned->priority;
+	tail->right = std::move(owned->right);
+	update(tail.get());
+
+	owned->length = offset;
+	owned->newlines = head_newlines;
+	update(owned);
+	return {std::move(node), std::move(tail)};
+}
+
+bool TextBuffer::extendPieceEndingAt(size_t pos, const char *data, size_t length)
+{
+	if (pos == 0)
+	{
+		return false;
+	}
+	size_t node_start = 0;
+	const Node *piece = findNode(pos - 1, node_start);
+	if (!piece || node_start + piece->length != pos ||
+		piece->data + piece->length != data || piece->length + length > MAX_PIECE_BYTES)
+	{
+		return false;
+	}
+	growPiece(root, pos, data, length);
+	return true;
+}
+
+void TextBuffer::growPiece(NodePtr &node, size_t pos, const char *data, size_t length)
+{
+	Node *owned = own(node);
+	size_t left_bytes = bytesOf(owned->left);
+	if (pos <= left_bytes)
+	{
+		growPiece(owned->left, pos, data, length);
+	} else if (pos == left_bytes + owned->length)
+	{
+		owned->length += length;
+		owned->newlines += countNewlines(data, length);
+	} else
+	{
+		growPiece(owned->right, pos - left_bytes - owned->length, data, length);
+	}
+	update(owned);
+}
+
+const TextBuffer::Node *TextBuffer::findNode(size_t pos, size_t &node_start) const
+{
+	const Node *node = root.get();
+	size_t base = 0;
+	while (node)
+	{
+		size_t left_bytes = bytesOf(node->left);
+		if (pos < left_bytes)
+		{
+			node = node->left.get();
+		} else if (pos < left_bytes + node->length)
+		{
+			node_start = base + left_bytes;
+			return node;
+		} else
+		{
+			base += left_bytes + node->length;
+			pos -= left_bytes + node->length;
+			node = node->right.get();
+		}
+	}
+	return nullptr;
+}
+
+const char *TextBuffer::appendToAddBuffer(std::string_view text)
+{
+	// Snapshots only see bytes below add_block_used, so appending past it
+	// never changes text they can reach
+	if (!storage || !add_block || add_block_used + text.size() > add_block_capacity)
+	{
+		if (!storage)
+		{
+			storage = std::make_shared<Storage>();
+		}
+		add_block_capacity = std::max(ADD_BLOCK_BYTES, text.size());
+		storage->add_blocks.push_back(std::make_unique<char[]>(add_block_capacity));
+		add_block = storage->add_blocks.back().get();
+		add_block_used = 0;
+	}
+	char *dest = add_block + add_block_used;
+	std::memcpy(dest, text.data(), text.size());
+	add_block_used += text.size();
+	return dest;
+}
+
+TextBuffer::NodePtr TextBuffer::buildPieces(const char *data, size_t length)
+{
+	// Newlines are only counted once somebody asks for lines, so loading
+	// does not have to read the text, which matters for mapped files.
+	NodePtr result;
+	for (size_t offset = 0; offset < length; offset += MAX_PIECE_BYTES)
+	{
+		size_t piece_length = std::min(MAX_PIECE_BYTES, length - offset);
+		result = merge(std::move(result), makeNode(data + offset, piece_length, false));
+	}
+	newlines_pending = length > 0;
+	return result;
+}
+
+void TextBuffer::assign(std::string text)
+{
+	auto fresh = std::make_shared<Storage>();
+	fresh->original = std::move(text);
+	resetPieces(std::move(fresh));
+}
+
+void TextBuffer::assign(std::unique_ptr<FileMapping> file)
+{
+	auto fresh = std::make_shared<Storage>();
+	fresh->mapping = std::move(file);
+	resetPieces(std::move(fresh));
+}
+
+void TextBuffer::resetPieces(std::shared_ptr<Storage> fresh)
+{
+	// The old storage stays alive for as long as snapshots refer to it
+	root.reset();
+	storage = std::move(fresh);
+	add_block = nullptr;
+	add_block_used = 0;
+	add_block_capacity = 0;
+	if (storage->mapping)
+	{
+		root = buildPieces(storage->mapping->data(), storage->mapping->size());
+	} else
+	{
+		root = buildPieces(storage->original.data(), storage->original.size());
+	}
+	document_id = next_document_id++;
+	++modification_version;
+	edit_log.clear();
+	edit_log_version = modification_version;
+}
+
+bool TextBuffer::mapsFile() const
+{
+	for (const Storage *s = storage.get(); s; s = s->base.get())
+	{
+		if (s->mapping)
+		{
+			return true;
+		}
+	}
+	return false;
+}
+
+bool TextBuffer::mappedFileShrunk() const
+{
+	for (const Storage *s = storage.get(); s; s = s->base.get())
+	{
+		if (s->mapping && s->mapping->shrunk())
+		{
+			return true;
+		}
+	}
+	return false;
+}
+
+TextSnapshot TextBuffer::snapshot() const
+{
+	auto copy = std::make_shared<TextBuffer>();
+	copy->root = root;
+	copy->storage = storage;
+	copy->document_id = document_id;
+	copy->modification_version = modification_version;
+	copy->newlines_pending = newlines_pending;
+	return TextSnapshot(std::move(copy));
+}
+
+void TextBuffer::recordEdit(size_t position,
+							size_t removed_length,
+							size_t inserted_length)
+{
+	++modification_version;
+	edit_log.push_back({position, removed_length, inserted_length});
+	if (edit_log.size() > MAX_EDIT_LOG)
+	{
+		edit_log.pop_front();
+		++edit_log_version;
+	}
+}
+
+bool TextBuffer::editsSince(uint64_t version, std::vector<TextEdit> &edits) const
+{
+	edits.clear();
+	if (version < edit_log_version || version > modification_version)
+	{
+		return false;
+	}
+	edits.assign(edit_log.begin() + (version - edit_log_version), edit_log.end());
+	return true;
+}
+
+size_t TextBuffer::size() const { return bytesOf(root); }
+
+char TextBuffer::at(size_t pos) const
+{
+	size_t node_start = 0;
+	const Node *node = findNode(pos, node_start);
+	return node ? node->data[pos - node_start] : '\0';
+}
+
+void TextBuffer::insert(size_t pos, std::string_view text)
+{
+	if (text.empty())
+	{
+		return;
+	}
+	pos = std::min(pos, size());
+	recordEdit(pos, 0, text.size());
+
+	// Long pastes go in as several pieces so no piece exceeds the cap.
+	while (!text.empty())
+	{
+		std::string_view part = text.substr(0, MAX_PIECE_BYTES);
+		const char *data = appendToAddBuffer(part);
+
+		// Typing appends to the add buffer right after the previous insert,
+		// so the piece that ends at the caret can simply grow in place.
+		if (!extendPieceEndingAt(pos, data, part.size()))
+		{
+			auto [left, right] = split(std::move(root), pos);
+			root = merge(merge(std::move(left), makeNode(data, part.size())),
+						 std::move(right));
+		}
+		pos += part.size();
+		text.remove_prefix(part.size());
+	}
+}
+
+void TextBuffer::erase(size_t pos, size_t len)
+{
+	size_t total = size();
+	if (pos >= total || len == 0)
+	{
+		return;
+	}
+	len = std::min(len, total - pos);
+	recordEdit(pos, len, 0);
+
+	auto [left, rest] = split(std::move(root), pos);
+	auto [removed, right] = split(std::move(rest), len);
+	root = merge(std::move(left), std::move(right));
+}
+
+void TextBuffer::replace(size_t pos, size_t len, std::string_view text)
+{
+	erase(pos, len);
+	insert(pos, text);
+}
+
+std::string TextBuffer::substr(size_t pos, size_t len) const
+{
+	std::string result;
+	if (pos >= size())
+	{
+		return result;
+	}
+	result.reserve(std::min(len, size() - pos));
+	forEachChunk(pos, len, [&result](std::string_view chunk) {
+		result.append(chunk);
+		return true;
+	});
+	return result;
+}
+
+std::string_view TextBuffer::chunkAt(size_t pos) const
+{
+	size_t node_start = 0;
+	const Node *node = findNode(pos, node_start);
+	if (!node)
+	{
+		return {};
+	}
+	size_t offset = pos - node_start;
+	return std::string_view(node->data + offset, node->length - offset);
+}
+
+size_t TextBuffer::find(char c, size_t pos) const
+{
+	size_t result = npos;
+	size_t chunk_pos = pos;
+	forEachChunk(pos, npos, [&](std::string_view chunk) {
+		const void *hit = std::memchr(chunk.data(), c, chunk.size());
+		if (hit)
+		{
+			result = chunk_pos + (static_cast<const char *>(hit) - chunk.data());
+			return false;
+		}
+		chunk_pos += chunk.size();
+		return true;
+	});
+	return result;
+}
+
+size_t TextBuffer::find(std::string_view needle, size_t pos) const
+{
+	size_t total = size();
+	if (needle.empty())
+	{
+		return pos <= total ? pos : npos;
+	}
+	while (pos + needle.size() <= total)
+	{
+		pos = find(needle[0], pos);
+		if (pos == npos || pos + needle.size() > total)
+		{
+			return npos;
+		}
+
+		size_t matched = 0;
+		forEachChunk(pos, needle.size(), [&](std::string_view chunk) {
+			if (needle.compare(matched, chunk.size(), chunk) != 0)
+			{
+				return false;
+			}
+			matched += chunk.size();
+			return true;
+		});
+		if (matched == needle.size())
+		{
+			return pos;
+		}
+		++pos;
+	}
+	return npos;
+}
+
+size_t TextBuffer::rfind(char c, size_t pos) const
+{
+	size_t total = size();
+	if (total == 0)
+	{
+		return npos;
+	}
+	pos = std::min(pos, total - 1);
+
+	while (true)
+	{
+		size_t node_start = 0;
+		const Node *node = findNode(pos, node_start);
+		if (!node)
+		{
+			return npos;
+		}
+		for (size_t i = pos - node_start + 1; i-- > 0;)
+		{
+			if (node->data[i] == c)
+			{
+				return node_start + i;
+			}
+		}
+		if (node_start == 0)
+		{
+			return npos;
+		}
+		pos = node_start - 1;
+	}
+}
+
+size_t TextBuffer::rfind(std::string_view needle, size_t pos) const
+{
+	size_t total = size();
+	if (needle.size() > total)
+	{
+		return npos;
+	}
+	pos = std::min(pos, total - needle.size());
+	if (needle.empty())
+	{
+		return pos;
+	}
+
+	while (true)
+	{
+		pos = rfind(needle[0], pos);
+		if (pos == npos)
+		{
+			return npos;
+		}
+
+		size_t matched = 0;
+		forEachChunk(pos, needle.size(), [&](std::string_view chunk) {
+			if (needle.compare(matched, chunk.size(), chunk) != 0)
+			{
+				return false;
+			}
+			matched += chunk.size();
+			return true;
+		});
+		if (matched == needle.size())
+		{
+			return pos;
+		}
+		if (pos == 0)
+		{
+			return npos;
+		}
+		--pos;
+	}
+}
+
+bool TextBuffer::equals(std::string_view text) const
+{
+	if (text.size() != size())
+	{
+		return false;
+	}
+	size_t offset = 0;
+	bool equal = true;
+	forEachChunk(0, npos, [&](std::string_view chunk) {
+		equal = text.compare(offset, chunk.size(), chunk) == 0;
+		offset += chunk.size();
+		return equal;
+	});
+	return equal;
+}
+
+void TextBuffer::countNewlinesIn(Node *node)
+{
+	if (!node)
+	{
+		return;
+	}
+	countNewlinesIn(node->left.get());
+	countNewlinesIn(node->right.get());
+	if (!node->newlines_counted)
+	{
+		node->newlines = countNewlines(node->data, node->length);
+		node->newlines_counted = true;
+	}
+	// Only the newline fields change, and only in nodes that were not counted
+	// yet. Snapshots read them only when taken fully counted, so counting is
+	// safe while they are in use on other threads.
+	size_t subtree_newlines =
+		newlinesOf(node->left) + node->newlines + newlinesOf(node->right);
+	if (node->subtree_newlines != subtree_newlines)
+	{
+		node->subtree_newlines = subtree_newlines;
+	}
+}
+
+void TextBuffer::countPendingNewlines() const
+{
+	if (newlines_pending)
+	{
+		countNewlinesIn(root.get());
+		newlines_pending = false;
+	}
+}
+
+size_t TextBuffer::lineCount() const
+{
+	countPendingNewlines();
+	return newlinesOf(root) + 1;
+}
+
+size_t TextBuffer::lineStart(size_t line) const
+{
+	countPendingNewlines();
+	if (line == 0)
+	{
+		return 0;
+	}
+	if (line > newlinesOf(root))
+	{
+		return size();
+	}
+
+	// Find the line-th newline; the line starts right after it.
+	const Node *node = root.get();
+	size_t base = 0;
+	size_t remaining = line;
+	while (node)
+	{
+		size_t left_newlines = newlinesOf(node->left);
+		if (remaining <= left_newlines)
+		{
+			node = node->left.get();
+			continue;
+		}
+		remaining -= left_newlines;
+		size_t piece_start = base + bytesOf(node->left);
+		if (remaining <= node->newlines)
+		{
+			const char *p = node->data;
+			const char *end = node->data + node->length;
+			while (p < end)
+			{
+				p = static_cast<const char *>(std::memchr(p, '\n', end - p));
+				if (--remaining == 0)
+				{
+					return piece_start + (p - node->data) + 1;
+				}
+				++p;
+			}
+			break;
+		}
+		remaining -= node->newlines;
+		base = piece_start + node->length;
+		node = node->right.get();
+	}
+	return size();
+}
+
+size_t TextBuffer::lineFromOffset(size_t pos) const
+{
+	countPendingNewlines();
+	const Node *node = root.get();
+	size_t line = 0;
+	while (node)
+	{
+		size_t left_bytes = bytesOf(node->left);
+		if (pos <= left_bytes)
+		{
+			node = node->left.get();
+		} else if (pos <= left_bytes + node->length)
+		{
+			return line + newlinesOf(node->left) +
+				   countNewlines(node->data, pos - left_bytes);
+		} else
+		{
+			line += newlinesOf(node->left) + node->newlines;
+			pos -= left_bytes + node->length;
+			node = node->right.get();
+		}
+	}
+	return line;
+}
@@ -0,0 +1,435 @@
+/*
+	File: editor_buffer.h
+	Description: Piece table document buffer used for EditorState::fileContent.
+
+	The document is a sequence of pieces, each pointing either into the text
+	the file was loaded with (a string, or a FileMapping for large files) or
+	into an append-only add buffer. Pieces live in
+	a treap ordered by document position and every node caches the byte and
+	newline count of its subtree, so insert, erase, offset lookup and line
+	lookup are O(log n) instead of moving the whole file on every keystroke.
+
+	Nodes are never changed while something else refers to them: an edit
+	copies the O(log n) nodes on its path instead, which makes snapshot() a
+	constant time, thread safe copy for background readers.
+
+	The interface mirrors the parts of std::string the editor relies on.
+	Readers that need contiguous memory should walk the buffer with
+	forEachChunk() or copy a bounded range with substr(); str() flattens the
+	whole document and is meant for consumers that really need all of it.
+*/
+
+#pragma once
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <deque>
+#include <iterator>
+#include <memory>
+#include <string>
+#include <string_view>
+#include <utility>
+#include <vector>
+
+class FileMapping;
+class TextSnapshot;
+
+// One modification of the document: removed_length bytes at position were
+// replaced by inserted_length bytes. Positions are in the coordinates of the
+// document right before the edit was applied.
+struct TextEdit
+{
+	size_t position;
+	size_t removed_length;
+	size_t inserted_length;
+};
+
+class TextBuffer
+{
+  public:
+	static constexpr size_t npos = std::string::npos;
+
+	// Random access iterator over the bytes of the document. It remembers the
+	// piece it last read from so sequential walks are O(1) per step.
+	class const_iterator
+	{
+	  public:
+		using iterator_category = std::random_access_iterator_tag;
+		using value_type = char;
+		using difference_type = std::ptrdiff_t;
+		using pointer = const char *;
+		using reference = char;
+
+		const_iterator() = default;
+		const_iterator(const TextBuffer *buffer, size_t pos) : buffer(buffer), pos(pos) {}
+
+		char operator*() const
+		{
+			if (pos < chunk_start || pos >= chunk_end)
+			{
+				load();
+			}
+			return chunk[pos - chunk_start];
+		}
+		char operator[](difference_type n) const { return *(*this + n); }
+
+		const_iterator &operator++()
+		{
+			++pos;
+			return *this;
+		}
+		const_iterator operator++(int)
+		{
+			const_iterator tmp = *this;
+			++pos;
+			return tmp;
+		}
+		const_iterator &operator--()
+		{
+			--pos;
+			return *this;
+		}
+		const_iterator operator--(int)
+		{
+			const_iterator tmp = *this;
+			--pos;
+			return tmp;
+		}
+		const_iterator &operator+=(difference_type n)
+		{
+			pos += n;
+			return *this;
+		}
+		const_iterator &operator-=(difference_type n)
+		{
+			pos -= n;
+			return *this;
+		}
+		friend const_iterator operator+(const_iterator it, difference_type n)
+		{
+			return it += n;
+		}
+		friend const_iterator operator+(difference_type n, const_iterator it)
+		{
+			return it += n;
+		}
+		friend const_iterator operator-(const_iterator it, difference_type n)
+		{
+			return it -= n;
+		}
+		friend difference_type operator-(const const_iterator &a, const const_iterator &b)
+		{
+			return static_cast<difference_type>(a.pos) -
+				   static_cast<difference_type>(b.pos);
+		}
+		friend bool operator==(const const_iterator &a, const const_iterator &b)
+		{
+			return a.pos == b.pos;
+		}
+		friend bool operator!=(const const_iterator &a, const const_iterator &b)
+		{
+			return a.pos != b.pos;
+		}
+		friend bool operator<(const const_iterator &a, const const_iterator &b)
+		{
+			return a.pos < b.pos;
+		}
+		friend bool operator>(const const_iterator &a, const const_iterator &b)
+		{
+			return a.pos > b.pos;
+		}
+		friend bool operator<=(const const_iterator &a, const const_iterator &b)
+		{
+			return a.pos <= b.pos;
+		}
+		friend bool operator>=(const const_iterator &a, const const_iterator &b)
+		{
+			return a.pos >= b.pos;
+		}
+
+		size_t index() const { return pos; }
+
+	  private:
+		void load() const;
+
+		const TextBuffer *buffer = nullptr;
+		size_t pos = 0;
+		mutable const char *chunk = nullptr;
+		mutable size_t chunk_start = 0;
+		mutable size_t chunk_end = 0;
+	};
+
+	TextBuffer();
+	TextBuffer(std::string text);
+	// Starts an editable copy of a snapshot. It shares all pieces with it, so
+	// this is O(1); it is a new document with its own edit log.
+	explicit TextBuffer(const TextSnapshot &snapshot);
+	~TextBuffer();
+	TextBuffer(const TextBuffer &) = delete;
+	TextBuffer &operator=(const TextBuffer &) = delete;
+	TextBuffer(TextBuffer &&other) noexcept;
+	TextBuffer &operator=(TextBuffer &&other) noexcept;
+
+	// Replaces the whole document. The string becomes the original buffer of
+	// the piece table, so loading a file does not copy it again.
+	void assign(std::string text);
+	TextBuffer &operator=(std::string text)
+	{
+		assign(std::move(text));
+		return *this;
+	}
+	TextBuffer &operator=(const char *text)
+	{
+		assign(std::string(text));
+		return *this;
+	}
+	void clear() { assign(std::string()); }
+
+	// Replaces the whole document with the contents of a mapped file. Only
+	// the piece tree is built here, so this costs O(size / piece size) and
+	// reads none of the text; edits land in the add buffer on top of it.
+	void assign(std::unique_ptr<FileMapping> mapping);
+
+	// True when the original text is a mapping of a file on disk, which then
+	// must not be overwritten in place while this buffer refers to it.
+	bool mapsFile() const;
+	// True when that file was truncated on disk and reads went past its new
+	// end, see FileMapping::shrunk()
+	bool mappedFileShrunk() const;
+
+	// Immutable copy of the current text for readers on other threads, O(1).
+	TextSnapshot snapshot() const;
+
+	size_t size() const;
+	size_t length() const { return size(); }
+	bool empty() const { return size() == 0; }
+
+	char at(size_t pos) const;
+	char operator[](size_t pos) const { return at(pos); }
+
+	void insert(size_t pos, std::string_view text);
+	void insert(size_t pos, size_t count, char c) { insert(pos, std::string(count, c)); }
+	void erase(size_t pos, size_t len = npos);
+	void replace(size_t pos, size_t len, std::string_view text);
+
+	std::string substr(size_t pos, size_t len = npos) const;
+	std::string str() const { return substr(0); }
+
+	size_t find(char c, size_t pos = 0) const;
+	size_t find(std::string_view needle, size_t pos = 0) const;
+	size_t rfind(char c, size_t pos = npos) const;
+	size_t rfind(std::string_view needle, size_t pos = npos) const;
+
+	bool equals(std::string_view text) const;
+	bool operator==(std::string_view text) const { return equals(text); }
+	bool operator!=(std::string_view text) const { return !equals(text); }
+
+	// Contiguous run of bytes starting at pos and ending at the end of the
+	// piece that contains pos. Empty when pos is past the end.
+	std::string_view chunkAt(size_t pos) const;
+
+	// Calls fn(std::string_view) for each contiguous run covering
+	// [pos, pos + len). Stops early when fn returns false.
+	template <typename Fn> void forEachChunk(size_t pos, size_t len, Fn &&fn) const
+	{
+		size_t end = (len == npos || pos + len > size()) ? size() : pos + len;
+		while (pos < end)
+		{
+			std::string_view chunk = chunkAt(pos);
+			if (chunk.size() > end - pos)
+			{
+				chunk = chunk.substr(0, end - pos);
+			}
+			if (chunk.empty() || !fn(chunk))
+			{
+				return;
+			}
+			pos += chunk.size();
+		}
+	}
+
+	// Line queries answered from the cached newline counts. Pieces of a newly
+	// assigned document are counted on the first of these calls.
+	size_t lineCount() const;
+	size_t lineStart(size_t line) const;
+	size_t lineFromOffset(size_t pos) const;
+
+	// Incremented on every modification so callers can cheaply detect changes.
+	// Safe to call from other threads while the owner edits, see matches().
+	uint64_t version() const { return modification_version; }
+
+	// Copies the edits made after version into edits, oldest first, so callers
+	// can update derived state incrementally. Returns false when the log does
+	// not reach back that far or the document was replaced by assign(); the
+	// caller has to rebuild from scratch then.
+	bool editsSince(uint64_t version, std::vector<TextEdit> &edits) const;
+
+	// Unique per assign(), so state derived from one document is never
+	// mistaken for another that happens to share the same version number.
+	uint64_t documentId() const { return document_id; }
+
+	const_iterator begin() const { return const_iterator(this, 0); }
+	const_iterator end() const { return const_iterator(this, size()); }
+
+  private:
+	struct Node
+	{
+		const char *data = nullptr;
+		size_t length = 0;
+		size_t newlines = 0;
+		bool newlines_counted = true;
+		uint32_t priority = 0;
+		size_t subtree_bytes = 0;
+		size_t subtree_newlines = 0;
+		std::shared_ptr<Node> left;
+		std::shared_ptr<Node> right;
+	};
+	// Nodes are shared with snapshots and copied on write, see own()
+	using NodePtr = std::shared_ptr<Node>;
+
+	// Owns the bytes pieces point into. Snapshots keep it alive after the
+	// buffer moved on to another document; forks chain to their origin.
+	struct Storage
+	{
+		std::string original;
+		std::unique_ptr<FileMapping> mapping;
+		std::vector<std::unique_ptr<char[]>> add_blocks;
+		std::shared_ptr<const Storage> base;
+	};
+
+	// Pieces are capped so line lookups never scan more than this inside a
+	// single piece, and so the original file is not one giant piece.
+	static constexpr size_t MAX_PIECE_BYTES = 16 * 1024;
+	static constexpr size_t ADD_BLOCK_BYTES = 64 * 1024;
+	static constexpr size_t MAX_EDIT_LOG = 4096;
+
+	static size_t bytesOf(const NodePtr &node) { return node ? node->subtree_bytes : 0; }
+	static size_t newlinesOf(const NodePtr &node)
+	{
+		return node ? node->subtree_newlines : 0;
+	}
+	static void update(Node *node);
+	static Node *own(NodePtr &node);
+
+	NodePtr makeNode(const char *data, size_t length, bool count_newlines = true);
+	NodePtr merge(NodePtr a, NodePtr b);
+	std::pair<NodePtr, NodePtr> split(NodePtr node, size_t pos);
+	bool extendPieceEndingAt(size_t pos, const char *data, size_t length);
+	void growPiece(NodePtr &node, size_t pos, const char *data, size_t length);
+	const Node *findNode(size_t pos, size_t &node_start) const;
+	const char *appendToAddBuffer(std::string_view text);
+	NodePtr buildPieces(const char *data, size_t length);
+	void resetPieces(std::shared_ptr<Storage> fresh);
+	void countPendingNewlines() const;
+	static void countNewlinesIn(Node *node);
+	void recordEdit(size_t position, size_t removed_length, size_t inserted_length);
+
+	NodePtr root;
+	// Heap allocated so piece pointers survive moving the buffer even when the
+	// string is short enough to live inline, and shared with snapshots.
+	std::shared_ptr<Storage> storage;
+	char *add_block = nullptr; // block new text is appended to
+	size_t add_block_used = 0;
+	size_t add_block_capacity = 0;
+	uint32_t rng_state = 0x9E3779B9u;
+	// Set while some pieces still have no newline count, see buildPieces().
+	mutable bool newlines_pending = false;
+	// Counter that highlight workers read through TextSnapshot::matches()
+	// while the UI thread edits the buffer. Moving the buffer copies it.
+	struct SharedCounter
+	{
+		std::atomic<uint64_t> value{0};
+
+		SharedCounter() = default;
+		SharedCounter(uint64_t v) : value(v) {}
+		SharedCounter(const SharedCounter &other) : value(other.value.load()) {}
+		SharedCounter &operator=(const SharedCounter &other)
+		{
+			value.store(other.value.load());
+			return *this;
+		}
+		SharedCounter &operator=(uint64_t v)
+		{
+			value.store(v);
+			return *this;
+		}
+		SharedCounter &operator++()
+		{
+			++value;
+			return *this;
+		}
+		operator uint64_t() const { return value.load(); }
+	};
+	// The id is stored before the version, which matches() reads in the
+	// other order, so a reader never pairs an old id with a new version
+	SharedCounter document_id;
+	SharedCounter modification_version;
+	// Every version bump logs exactly one edit, so the version before the
+	// oldest entry is modification_version - edit_log.size().
+	std::deque<TextEdit> edit_log;
+	uint64_t edit_log_version = 0;
+
+	friend class const_iterator;
+	friend class TextSnapshot;
+};
+
+// Immutable view of a TextBuffer at one version. It shares the piece tree with
+// the buffer, and later edits copy the nodes they touch instead of changing
+// them, so handing a version to a worker thread costs one allocation and no
+// lock is held while the worker reads it. The buffer counts newlines lazily
+// inside the shared nodes, so line queries only work on a snapshot taken
+// after lineCount() or another line query on the buffer.
+class TextSnapshot
+{
+  public:
+	TextSnapshot() : buffer(std::make_shared<TextBuffer>()) {}
+
+	size_t size() const { return buffer->size(); }
+	size_t length() const { return size(); }
+	bool empty() const { return size() == 0; }
+	char at(size_t pos) const { return buffer->at(pos); }
+	char operator[](size_t pos) const { return at(pos); }
+
+	std::string substr(size_t pos, size_t len = TextBuffer::npos) const
+	{
+		return buffer->substr(pos, len);
+	}
+	std::string str() const { return buffer->str(); }
+	std::string_view chunkAt(size_t pos) const { return buffer->chunkAt(pos); }
+	template <typename Fn> void forEachChunk(size_t pos, size_t len, Fn &&fn) const
+	{
+		buffer->forEachChunk(pos, len, std::forward<Fn>(fn));
+	}
+
+	bool equals(std::string_view text) const { return buffer->equals(text); }
+	bool operator==(std::string_view text) const { return equals(text); }
+	bool operator!=(std::string_view text) const { return !equals(text); }
+
+	// Whether newlines were counted when the snapshot was taken. Only then
+	// may lineStart() and lineFromOffset() be called.
+	bool linesCounted() const { return !buffer->newlines_pending; }
+	size_t lineStart(size_t line) const { return buffer->lineStart(line); }
+	size_t lineFromOffset(size_t pos) const { return buffer->lineFromOffset(pos); }
+
+	uint64_t version() const { return buffer->version(); }
+	uint64_t documentId() const { return buffer->documentId(); }
+
+	// True while the buffer has not changed since this snapshot was taken.
+	// Workers call this while the UI thread edits current; see document_id.
+	bool matches(const TextBuffer &current) const
+	{
+		return version() == current.version() && documentId() == current.documentId();
+	}
+
+	TextBuffer::const_iterator begin() const { return buffer->begin(); }
+	TextBuffer::const_iterator end() const { return buffer->end(); }
+
+  private:
+	friend class TextBuffer;
+	explicit TextSnapshot(std::shared_ptr<const TextBuffer> buffer)
+		: buffer(std::move(buffer))
+	{
+	}
+
+	std::shared_ptr<const TextBuffer> buffer;
+};
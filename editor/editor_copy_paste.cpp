@@ -53,7 +53,7 @@ int EditorCopyPaste::getSelectionEnd() const
 	return std::max(editor_state.selection_start, editor_state.selection_end);
 }
 
-void EditorCopyPaste::copySelectedText(const std::string &text)
+void EditorCopyPaste::copySelectedText(const TextBuffer &text)
 {
 	if (editor_state.selection_start != editor_state.selection_end)
 	{
@@ -68,19 +68,12 @@ void EditorCopyPaste::cutSelectedText()
 {
 	if (editor_state.selection_start != editor_state.selection_end)
 	{
-		// Save the state before making any changes
-		std::string beforeContent = editor_state.fileContent;
-		int beforeCursor = editor_state.cursor_index;
-		int cutStart = getSelectionStart();
-		int cutEnd = getSelectionEnd();
-
 		int start = getSelectionStart();
 		int end = getSelectionEnd();
 		std::string selected_text = editor_state.fileContent.substr(start, end - start);
 		ImGui::SetClipboardText(selected_text.c_str());
 		editor_state.fileContent.erase(start, end - start);
-		editor_state.fileColors.erase(editor_state.fileColors.begin() + start,
-									  editor_state.fileColors.begin() + end);
+		editor_state.eraseColors(start, end - start);
 		editor_state.cursor_index = start;
 		editor_state.selection_start = editor_state.selection_end = start;
 		editor_state.text_changed = true;
@@ -95,10 +88,6 @@ void EditorCopyPaste::cutWholeLine()
 	gAITab.cancel_request();
 	gAITab.dismiss_completion();
 	gFileExplorer.addUndoState();
-	// Save the state before making any changes
-	std::string beforeContent = editor_state.fileContent;
-	int beforeCursor = editor_state.cursor_index;
-
 	int line = EditorUtils::GetLineFromPosition(editor_state.editor_content_lines,
 												editor_state.cursor_index);
 	int line_start = editor_state.editor_content_lines[line];
@@ -111,8 +100,7 @@ void EditorCopyPaste::cutWholeLine()
 	ImGui::SetClipboardText(line_text.c_str());
 
 	editor_state.fileContent.erase(line_start, line_end - line_start);
-	editor_state.fileColors.erase(editor_state.fileColors.begin() + line_start,
-								  editor_state.fileColors.begin() + line_end);
+	editor_state.eraseColors(line_start, line_end - line_start);
 
 	editor_state.cursor_index = line > 0 ? editor_state.editor_content_lines[line] : 0;
 	editor_state.text_changed = true;
@@ -125,10 +113,6 @@ void EditorCopyPaste::pasteText()
 	gAITab.cancel_request();
 	gAITab.dismiss_completion();
 
-	// Save the state before making any changes
-	std::string beforeContent = editor_state.fileContent;
-	int beforeCursor = editor_state.cursor_index;
-
 	const char *clipboard_text = ImGui::GetClipboardText();
 	if (clipboard_text != nullptr)
 	{
@@ -147,9 +131,7 @@ void EditorCopyPaste::pasteText()
 				paste_content = convertTabsToSpaces(paste_content);
 			}
 
-			// Get the proper default text color from the theme
-			TreeSitter::updateThemeColors();
-			ImVec4 defaultColor = TreeSitter::cachedColors.text;
+			HighlightClass defaultColor = HighlightClass::Text;
 
 			int paste_start = editor_state.cursor_index;
 			int paste_end = paste_start + paste_content.size();
@@ -158,20 +140,15 @@ void EditorCopyPaste::pasteText()
 				int start = getSelectionStart();
 				int end = getSelectionEnd();
 				editor_state.fileContent.replace(start, end - start, paste_content);
-				editor_state.fileColors.erase(editor_state.fileColors.begin() + start,
-											  editor_state.fileColors.begin() + end);
-				editor_state.fileColors.insert(editor_state.fileColors.begin() + start,
-											   paste_content.size(),
-											   defaultColor);
+				editor_state.eraseColors(start, end - start);
+				editor_state.insertColors(start, paste_content.size(), defaultColor);
 				paste_start = start;
 				paste_end = start + paste_content.size();
 			} else
 			{
 				editor_state.fileContent.insert(editor_state.cursor_index, paste_content);
-				editor_state.fileColors.insert(editor_state.fileColors.begin() +
-												   editor_state.cursor_index,
-											   paste_content.size(),
-											   defaultColor);
+				editor_state.insertColors(
+					editor_state.cursor_index, paste_content.size(), defaultColor);
 			}
 			editor_state.cursor_index = paste_end;
 			editor_state.selection_start = editor_state.selection_end =
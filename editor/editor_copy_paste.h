@@ -16,7 +16,7 @@ class EditorCopyPaste
 	~EditorCopyPaste() = default;
 
 	// Copy operation
-	void copySelectedText(const std::string &text);
+	void copySelectedText(const TextBuffer &text);
 
 	// Cut operations
 	void cutSelectedText();
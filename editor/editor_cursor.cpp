@@ -16,6 +16,7 @@
 #include "../util/settings.h"
 #include "editor.h"
 #include "editor/utf8_utils.h"
+#include "editor_glyphs.h"
 #include "editor_utils.h"
 #include <algorithm>
 #include <cctype>
@@ -116,14 +117,14 @@ void EditorCursor::renderCursor()
 	// (ImGui::IsWindowFocused(ImGuiFocusedFlags_RootAndChildWindows))
 	{
 		// Main cursor calculations
-		int main_cursor_line = gEditor.getLineFromPos(editor_state.cursor_index);
+		size_t main_cursor_row = gEditorWrap.rowOfPosition(editor_state.cursor_index);
 		float main_cursor_x = getCursorXPosition(editor_state.text_pos,
 												 editor_state.fileContent,
 												 editor_state.cursor_index);
 
 		ImVec2 main_cursor_start = editor_state.text_pos;
 		main_cursor_start.x = main_cursor_x;
-		main_cursor_start.y += main_cursor_line * editor_state.line_height;
+		main_cursor_start.y += main_cursor_row * editor_state.line_height;
 		ImVec2 main_cursor_end(main_cursor_start.x,
 							   main_cursor_start.y + editor_state.line_height - 1);
 
@@ -151,14 +152,14 @@ void EditorCursor::renderCursor()
 		// Render multi-cursors
 		for (int cursor_idx : editor_state.multi_cursor_indices)
 		{
-			int cursor_line = gEditor.getLineFromPos(cursor_idx);
+			size_t cursor_row = gEditorWrap.rowOfPosition(cursor_idx);
 			float cursor_x = getCursorXPosition(editor_state.text_pos,
 												editor_state.fileContent,
 												cursor_idx);
 
 			ImVec2 cursor_start = editor_state.text_pos;
 			cursor_start.x = cursor_x;
-			cursor_start.y += cursor_line * editor_state.line_height;
+			cursor_start.y += cursor_row * editor_state.line_height;
 			ImVec2 cursor_end(cursor_start.x,
 							  cursor_start.y + editor_state.line_height - 1);
 
@@ -178,9 +179,9 @@ void EditorCursor::calculateVisualColumn()
 {
 	const int TAB_WIDTH = 4; // Tab width in spaces
 	int visual_column = 0;
-	int current_line = EditorUtils::GetLineFromPosition(editor_state.editor_content_lines,
-														editor_state.cursor_index);
-	int line_start = editor_state.editor_content_lines[current_line];
+	// Columns count from the start of the visual row when lines wrap
+	int line_start =
+		static_cast<int>(gEditorWrap.rowStartOfPosition(editor_state.cursor_index));
 
 	for (int i = line_start;
 		 i < editor_state.cursor_index && i < editor_state.fileContent.length();
@@ -294,20 +295,19 @@ void EditorCursor::cursorRight()
 void EditorCursor::cursorUp()
 {
 	// --- Main Cursor ---
-	int main_current_line_num =
-		EditorUtils::GetLineFromPosition(editor_state.editor_content_lines,
-										 editor_state.cursor_index);
-	if (main_current_line_num > 0)
+	// Moves by visual rows, which are just the lines unless word wrap is on
+	size_t main_current_row = gEditorWrap.rowOfPosition(editor_state.cursor_index);
+	if (main_current_row > 0)
 	{
+		int row_start =
+			static_cast<int>(gEditorWrap.rowStartOfPosition(editor_state.cursor_index));
 		if (editor_state.cursor_column_prefered == 0 &&
-			editor_state.cursor_index !=
-				editor_state.editor_content_lines[main_current_line_num])
+			editor_state.cursor_index != row_start)
 		{
 			calculateVisualColumn();
 		}
-		int target_line_idx = main_current_line_num - 1;
-		int new_line_start = editor_state.editor_content_lines[target_line_idx];
-		int new_line_end = editor_state.editor_content_lines[main_current_line_num] - 1;
+		size_t new_line_start, new_line_end;
+		gEditorWrap.rowBounds(main_current_row - 1, new_line_start, new_line_end);
 		findPositionFromVisualColumn(new_line_start, new_line_end);
 
 		ImVec2 currentPos = gEditorScroll.getScrollPosition();
@@ -326,28 +326,22 @@ void EditorCursor::cursorUp()
 			editor_state.multi_cursor_prefered_columns[i]; // Use this multi-cursor's
 														   // own preferred column
 
-		int multi_current_line_num =
-			EditorUtils::GetLineFromPosition(editor_state.editor_content_lines,
-											 current_multi_idx);
-		if (multi_current_line_num > 0)
+		size_t multi_current_row = gEditorWrap.rowOfPosition(current_multi_idx);
+		if (multi_current_row > 0)
 		{
-			if (multi_cursor_pref_col == 0 &&
-				current_multi_idx !=
-					editor_state.editor_content_lines[multi_current_line_num])
+			int multi_row_start =
+				static_cast<int>(gEditorWrap.rowStartOfPosition(current_multi_idx));
+			if (multi_cursor_pref_col == 0 && current_multi_idx != multi_row_start)
 			{
 				// Using simple char offset for this "on-the-fly" calculation to
 				// match mouse click
-				multi_cursor_pref_col =
-					current_multi_idx -
-					editor_state.editor_content_lines[multi_current_line_num];
+				multi_cursor_pref_col = current_multi_idx - multi_row_start;
 				editor_state.multi_cursor_prefered_columns[i] =
 					multi_cursor_pref_col; // Store it
 			}
 
-			int target_line_idx = multi_current_line_num - 1;
-			int new_line_start = editor_state.editor_content_lines[target_line_idx];
-			int new_line_end =
-				editor_state.editor_content_lines[multi_current_line_num] - 1;
+			size_t new_line_start, new_line_end;
+			gEditorWrap.rowBounds(multi_current_row - 1, new_line_start, new_line_end);
 
 			// Temporarily set global state for findPositionFromVisualColumn to
 			// work for this multi-cursor
@@ -386,23 +380,19 @@ void EditorCursor::cursorUp()
 void EditorCursor::cursorDown()
 {
 	// --- Main Cursor ---
-	int main_current_line_num =
-		EditorUtils::GetLineFromPosition(editor_state.editor_content_lines,
-										 editor_state.cursor_index);
-	if (main_current_line_num < editor_state.editor_content_lines.size() - 1)
+	// Moves by visual rows, which are just the lines unless word wrap is on
+	size_t main_current_row = gEditorWrap.rowOfPosition(editor_state.cursor_index);
+	if (main_current_row + 1 < gEditorWrap.totalRows())
 	{
+		int row_start =
+			static_cast<int>(gEditorWrap.rowStartOfPosition(editor_state.cursor_index));
 		if (editor_state.cursor_column_prefered == 0 &&
-			editor_state.cursor_index !=
-				editor_state.editor_content_lines[main_current_line_num])
+			editor_state.cursor_index != row_start)
 		{
 			calculateVisualColumn();
 		}
-		int target_line_idx = main_current_line_num + 1;
-		int new_line_start = editor_state.editor_content_lines[target_line_idx];
-		int new_line_end =
-			(target_line_idx + 1 < editor_state.editor_content_lines.size())
-				? editor_state.editor_content_lines[target_line_idx + 1] - 1
-				: editor_state.fileContent.size();
+		size_t new_line_start, new_line_end;
+		gEditorWrap.rowBounds(main_current_row + 1, new_line_start, new_line_end);
 		findPositionFromVisualColumn(new_line_start, new_line_end);
 
 		ImVec2 currentPos = gEditorScroll.getScrollPosition();
@@ -419,27 +409,19 @@ void EditorCursor::cursorDown()
 		int current_multi_idx = editor_state.multi_cursor_indices[i];
 		int multi_cursor_pref_col = editor_state.multi_cursor_prefered_columns[i];
 
-		int multi_current_line_num =
-			EditorUtils::GetLineFromPosition(editor_state.editor_content_lines,
-											 current_multi_idx);
-		if (multi_current_line_num < editor_state.editor_content_lines.size() - 1)
+		size_t multi_current_row = gEditorWrap.rowOfPosition(current_multi_idx);
+		if (multi_current_row + 1 < gEditorWrap.totalRows())
 		{
-			if (multi_cursor_pref_col == 0 &&
-				current_multi_idx !=
-					editor_state.editor_content_lines[multi_current_line_num])
+			int multi_row_start =
+				static_cast<int>(gEditorWrap.rowStartOfPosition(current_multi_idx));
+			if (multi_cursor_pref_col == 0 && current_multi_idx != multi_row_start)
 			{
-				multi_cursor_pref_col =
-					current_multi_idx -
-					editor_state.editor_content_lines[multi_current_line_num];
+				multi_cursor_pref_col = current_multi_idx - multi_row_start;
 				editor_state.multi_cursor_prefered_columns[i] = multi_cursor_pref_col;
 			}
 
-			int target_line_idx = multi_current_line_num + 1;
-			int new_line_start = editor_state.editor_content_lines[target_line_idx];
-			int new_line_end =
-				(target_line_idx + 1 < editor_state.editor_content_lines.size())
-					? editor_state.editor_content_lines[target_line_idx + 1] - 1
-					: editor_state.fileContent.size();
+			size_t new_line_start, new_line_end;
+			gEditorWrap.rowBounds(multi_current_row + 1, new_line_start, new_line_end);
 
 			editor_state.cursor_index = current_multi_idx;
 			editor_state.cursor_column_prefered = multi_cursor_pref_col;
@@ -467,7 +449,7 @@ void EditorCursor::cursorDown()
 	}
 }
 
-void EditorCursor::moveCursorVertically(std::string &text, int line_delta)
+void EditorCursor::moveCursorVertically(TextBuffer &text, int line_delta)
 {
 	int main_current_line_num =
 		EditorUtils::GetLineFromPosition(editor_state.editor_content_lines,
@@ -555,7 +537,7 @@ void EditorCursor::moveCursorVertically(std::string &text, int line_delta)
 	editor_state.cursor_column_prefered = original_main_cursor_pref_col;
 }
 
-void EditorCursor::moveWordForward(const std::string &text)
+void EditorCursor::moveWordForward(const TextBuffer &text)
 {
 	const size_t len = text.length();
 
@@ -642,7 +624,7 @@ void EditorCursor::moveWordForward(const std::string &text)
 	}
 }
 
-void EditorCursor::moveWordBackward(const std::string &text)
+void EditorCursor::moveWordBackward(const TextBuffer &text)
 {
 	// --- Main Cursor ---
 	size_t current_main_idx = editor_state.cursor_index;
@@ -715,76 +697,45 @@ void EditorCursor::moveWordBackward(const std::string &text)
 
 float EditorCursor::getCursorYPosition(float line_height)
 {
-	int cursor_line = EditorUtils::GetLineFromPosition(editor_state.editor_content_lines,
-													   editor_state.cursor_index);
-	return cursor_line * line_height;
+	return gEditorWrap.rowOfPosition(editor_state.cursor_index) * line_height;
 }
 
 float EditorCursor::getCursorXPosition(const ImVec2 &text_pos,
-									   const std::string &text,
+									   const TextBuffer &text,
 									   int cursor_pos)
 {
+	// Only the cursor's own line contributes to x, so measure just that line,
+	// or just its visual row when lines wrap
+	size_t line_start;
+	if (gEditorWrap.enabled())
+	{
+		line_start = gEditorWrap.rowStartOfPosition(cursor_pos);
+	} else
+	{
+		line_start = cursor_pos > 0 ? text.rfind('\n', cursor_pos - 1) : TextBuffer::npos;
+		line_start = (line_start == TextBuffer::npos) ? 0 : line_start + 1;
+	}
+	std::string line = text.substr(line_start, cursor_pos - line_start);
+
+	// Same advances and tab stops as EditorRender::renderLine
 	float x = text_pos.x;
-	for (int i = 0; i < cursor_pos;)
+	const char *line_end = line.data() + line.size();
+	for (const char *p = line.data(); p < line_end;)
 	{
-		if (text[i] == '\n')
+		size_t length = 1;
+		if (*p == '\t')
 		{
-			x = text_pos.x;
-			i++;
-		} else if (text[i] == '\t')
-		{
-			// Handle tab characters specially to match rendering logic
-			float space_width = ImGui::CalcTextSize(" ").x;
-			const int TAB_SIZE = 4;
-			float current_column_pixels = x - text_pos.x;
-			int current_column = static_cast<int>(current_column_pixels / space_width);
-			int next_tab_stop = ((current_column / TAB_SIZE) + 1) * TAB_SIZE;
-			float tab_width = (next_tab_stop - current_column) * space_width;
-			x += tab_width;
-			i++;
+			x += gEditorGlyphs.tabWidth(x - text_pos.x);
 		} else
 		{
-			// Skip continuation bytes of multi-byte characters (same logic as rendering)
-			if ((text[i] & 0xC0) == 0x80)
-			{
-				i++;
-				continue;
-			}
-
-			// Handle UTF-8 characters properly (same logic as renderCharacterAndSelection)
-			const char *char_start = &text[i];
-			const char *char_end = (i + 1 < text.size()) ? &text[i + 1] : nullptr;
-
-			// For multi-byte characters, find the end
-			if (char_end && (*char_start & 0x80))
-			{
-				while (char_end < &text[text.size()] && (*char_end & 0xC0) == 0x80)
-				{
-					char_end++;
-				}
-			}
-
-			x += ImGui::CalcTextSize(char_start, char_end).x;
-
-			// Advance by the character length (same logic as rendering loop)
-			if ((*char_start & 0x80) == 0)
-			{
-				i++; // Single byte character
-			} else
-			{
-				// Multi-byte character, find the end
-				while (i < text.size() && (text[i] & 0xC0) == 0x80)
-				{
-					i++;
-				}
-				i++; // Move past the last byte of the character
-			}
+			x += gEditorGlyphs.charAdvance(p, line_end, length);
 		}
+		p += length;
 	}
 	return x;
 }
 
-void EditorCursor::handleCursorMovement(const std::string &text,
+void EditorCursor::handleCursorMovement(const TextBuffer &text,
 										const ImVec2 &text_pos,
 										float line_height,
 										float window_height,
@@ -893,8 +844,7 @@ void EditorCursor::swapLines(int direction)
 
 		// Delete original line
 		editor_state.fileContent.erase(line_start, line_end - line_start);
-		editor_state.fileColors.erase(editor_state.fileColors.begin() + line_start,
-									  editor_state.fileColors.begin() + line_end);
+		editor_state.eraseColors(line_start, line_end - line_start);
 
 		// Adjust insertion position for the deleted content
 		if (insert_pos > line_start)
@@ -902,9 +852,7 @@ void EditorCursor::swapLines(int direction)
 
 		// Insert below next line
 		editor_state.fileContent.insert(insert_pos, line_content);
-		editor_state.fileColors.insert(editor_state.fileColors.begin() + insert_pos,
-									   line_content.size(),
-									   ImVec4(1.0f, 1.0f, 1.0f, 1.0f));
+		editor_state.insertColors(insert_pos, line_content.size());
 
 		// Update line structure and cursor
 		gEditor.updateLineStarts();
@@ -944,15 +892,12 @@ void EditorCursor::swapLines(int direction)
 
 		// Delete original line
 		editor_state.fileContent.erase(line_start, line_end - line_start);
-		editor_state.fileColors.erase(editor_state.fileColors.begin() + line_start,
-									  editor_state.fileColors.begin() + line_end);
+		editor_state.eraseColors(line_start, line_end - line_start);
 
 		// Insert above target line
 		const size_t insert_pos = editor_state.editor_content_lines[target_line];
 		editor_state.fileContent.insert(insert_pos, line_content);
-		editor_state.fileColors.insert(editor_state.fileColors.begin() + insert_pos,
-									   line_content.size(),
-									   ImVec4(1.0f, 1.0f, 1.0f, 1.0f));
+		editor_state.insertColors(insert_pos, line_content.size());
 
 		// Update line structure and cursor
 		gEditor.updateLineStarts();
@@ -972,7 +917,7 @@ void EditorCursor::swapLines(int direction)
 	editor_state.ensure_cursor_visible = {true, true};
 }
 
-void EditorCursor::processCursorJump(std::string &text,
+void EditorCursor::processCursorJump(TextBuffer &text,
 									 CursorVisibility &ensure_cursor_visible)
 {
 	if (ImGui::IsKeyPressed(ImGuiKey_LeftArrow))
@@ -1132,7 +1077,7 @@ void EditorCursor::processCursorJump(std::string &text,
 		ensure_cursor_visible.horizontal = true;
 	}
 }
-void EditorCursor::processWordMovement(std::string &text,
+void EditorCursor::processWordMovement(TextBuffer &text,
 									   CursorVisibility &ensure_cursor_visible)
 {
 	if (ImGui::IsKeyPressed(ImGuiKey_LeftArrow))
@@ -1147,8 +1092,8 @@ void EditorCursor::processWordMovement(std::string &text,
 	ensure_cursor_visible.vertical = true;
 }
 int EditorCursor::CalculateVisualColumnForPosition(int position,
-												   const std::string &content,
-												   const std::vector<int> &content_lines)
+												   const TextBuffer &content,
+												   const LineIndex &content_lines)
 {
 	const int TAB_WIDTH = 4;
 	int visual_column = 0;
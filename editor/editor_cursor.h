@@ -34,17 +34,17 @@ class EditorCursor
 
 	void cursorDown();
 
-	void moveCursorVertically(std::string &text, int line_delta);
+	void moveCursorVertically(TextBuffer &text, int line_delta);
 
-	void moveWordForward(const std::string &text);
+	void moveWordForward(const TextBuffer &text);
 
-	void moveWordBackward(const std::string &text);
+	void moveWordBackward(const TextBuffer &text);
 
-	void processWordMovement(std::string &text, CursorVisibility &ensure_cursor_visible);
+	void processWordMovement(TextBuffer &text, CursorVisibility &ensure_cursor_visible);
 
-	void processCursorJump(std::string &text, CursorVisibility &ensure_cursor_visible);
+	void processCursorJump(TextBuffer &text, CursorVisibility &ensure_cursor_visible);
 
-	void handleCursorMovement(const std::string &text,
+	void handleCursorMovement(const TextBuffer &text,
 							  const ImVec2 &text_pos,
 							  float line_height,
 							  float window_height,
@@ -53,7 +53,7 @@ class EditorCursor
 	float getCursorYPosition(float line_height);
 
 	float
-	getCursorXPosition(const ImVec2 &text_pos, const std::string &text, int cursor_pos);
+	getCursorXPosition(const ImVec2 &text_pos, const TextBuffer &text, int cursor_pos);
 
 	void updateBlinkTime();
 
@@ -62,8 +62,8 @@ class EditorCursor
 	void spawnCursorBelow();
 	void spawnCursorAbove();
 	static int CalculateVisualColumnForPosition(int position,
-												const std::string &content,
-												const std::vector<int> &content_lines);
+												const TextBuffer &content,
+												const LineIndex &content_lines);
 	void calculateVisualColumn();
 
   private:
@@ -0,0 +1,413 @@
+/*
+	File: editor_fast_highlight.cpp
+	Description: Vectorized scanner that colors the lines of large JSON, log
+	and plain text files.
+*/
+
+#include "editor_fast_highlight.h"
+#include "../lexers/lexer_tables.h"
+#include "editor_lexer_lines.h"
+#include "editor_tree_sitter.h"
+
+#include <algorithm>
+#include <bit>
+#include <cstddef>
+#include <cstdint>
+#include <unordered_map>
+
+#if defined(__AVX2__)
+#include <immintrin.h>
+#define FAST_HIGHLIGHT_AVX2
+#elif defined(__SSE2__) || defined(_M_X64)
+#include <emmintrin.h>
+#define FAST_HIGHLIGHT_SSE2
+#endif
+
+namespace {
+
+// A block of bytes in one SIMD register and the few operations the byte
+// sets below are made of. Each lane of a result is 0xFF or 0.
+#if defined(FAST_HIGHLIGHT_AVX2)
+using Block = __m256i;
+constexpr size_t BLOCK_BYTES = 32;
+
+inline Block load(const char *p)
+{
+	return _mm256_loadu_si256(reinterpret_cast<const __m256i *>(p));
+}
+inline Block equal(Block b, char c) { return _mm256_cmpeq_epi8(b, _mm256_set1_epi8(c)); }
+inline Block either(Block a, Block b) { return _mm256_or_si256(a, b); }
+inline Block between(Block b, char low, char high)
+{
+	// Clamping b to [low, high] leaves exactly the bytes in range unchanged
+	Block clamped = _mm256_min_epu8(_mm256_max_epu8(b, _mm256_set1_epi8(low)),
+									_mm256_set1_epi8(high));
+	return _mm256_cmpeq_epi8(clamped, b);
+}
+inline uint32_t bits(Block b) { return static_cast<uint32_t>(_mm256_movemask_epi8(b)); }
+#elif defined(FAST_HIGHLIGHT_SSE2)
+using Block = __m128i;
+constexpr size_t BLOCK_BYTES = 16;
+
+inline Block load(const char *p)
+{
+	return _mm_loadu_si128(reinterpret_cast<const __m128i *>(p));
+}
+inline Block equal(Block b, char c) { return _mm_cmpeq_epi8(b, _mm_set1_epi8(c)); }
+inline Block either(Block a, Block b) { return _mm_or_si128(a, b); }
+inline Block between(Block b, char low, char high)
+{
+	Block clamped =
+		_mm_min_epu8(_mm_max_epu8(b, _mm_set1_epi8(low)), _mm_set1_epi8(high));
+	return _mm_cmpeq_epi8(clamped, b);
+}
+inline uint32_t bits(Block b) { return static_cast<uint32_t>(_mm_movemask_epi8(b)); }
+#endif
+
+#if defined(FAST_HIGHLIGHT_AVX2) || defined(FAST_HIGHLIGHT_SSE2)
+#define FAST_HIGHLIGHT_SIMD
+constexpr uint32_t ALL_BITS =
+	BLOCK_BYTES == 32 ? 0xFFFFFFFFu : (1u << BLOCK_BYTES) - 1;
+#endif
+
+// Byte sets, each tested a byte or a block at a time
+struct JsonSpace
+{
+	static bool test(char c) { return c == ' ' || c == '\t' || c == '\r' || c == '\n'; }
+#if defined(FAST_HIGHLIGHT_SIMD)
+	static Block test(Block b)
+	{
+		return either(either(equal(b, ' '), equal(b, '\t')),
+					  either(equal(b, '\r'), equal(b, '\n')));
+	}
+#endif
+};
+
+struct JsonStringEnd
+{
+	static bool test(char c) { return c == '"' || c == '\\'; }
+#if defined(FAST_HIGHLIGHT_SIMD)
+	static Block test(Block b) { return either(equal(b, '"'), equal(b, '\\')); }
+#endif
+};
+
+// Where a log token can start: quotes, brackets, digits and capitals
+struct LogTokenStart
+{
+	static bool test(char c)
+	{
+		return c == '"' || c == '[' || c == ']' || LexerTables::isDigit(c) ||
+			   (c >= 'A' && c <= 'Z');
+	}
+#if defined(FAST_HIGHLIGHT_SIMD)
+	static Block test(Block b)
+	{
+		// 'A'..'[' covers the capitals and the opening bracket
+		return either(either(equal(b, '"'), equal(b, ']')),
+					  either(between(b, '0', '9'), between(b, 'A', '[')));
+	}
+#endif
+};
+
+struct LogStringEnd
+{
+	static bool test(char c) { return c == '"' || c == '\n'; }
+#if defined(FAST_HIGHLIGHT_SIMD)
+	static Block test(Block b) { return either(equal(b, '"'), equal(b, '\n')); }
+#endif
+};
+
+// First position from start whose byte is in Set when Member is true, or
+// is not when it is false; text.size() when there is none
+template <class Set, bool Member> size_t scan(std::string_view text, size_t start)
+{
+	const char *data = text.data();
+	size_t i = start;
+#if defined(FAST_HIGHLIGHT_SIMD)
+	for (; i + BLOCK_BYTES <= text.size(); i += BLOCK_BYTES)
+	{
+		uint32_t mask = bits(Set::test(load(data + i)));
+		if constexpr (!Member)
+		{
+			mask = ~mask & ALL_BITS;
+		}
+		if (mask != 0)
+		{
+			return i + std::countr_zero(mask);
+		}
+	}
+#endif
+	for (; i < text.size(); ++i)
+	{
+		if (Set::test(data[i]) == Member)
+		{
+			break;
+		}
+	}
+	return i;
+}
+
+template <class Set> size_t next(std::string_view text, size_t start)
+{
+	return scan<Set, true>(text, start);
+}
+
+template <class Set> size_t skip(std::string_view text, size_t start)
+{
+	return scan<Set, false>(text, start);
+}
+
+void fill(HighlightClass *classes, size_t start, size_t end, HighlightClass cls)
+{
+	std::fill(classes + start, classes + end, cls);
+}
+
+// Length of a date, time or both at pos, such as 2024-05-01T12:30:45.123Z,
+// 2024/05/01 or 12:30:45,123; 0 when there is none
+size_t timestampLength(std::string_view text, size_t pos)
+{
+	auto at = [&text](size_t i) { return i < text.size() ? text[i] : '\0'; };
+	auto digits = [&at](size_t i, size_t count) {
+		for (size_t k = 0; k < count; ++k)
+		{
+			if (!LexerTables::isDigit(at(i + k)))
+			{
+				return false;
+			}
+		}
+		return true;
+	};
+	auto time = [&](size_t i) {
+		return digits(i, 2) && at(i + 2) == ':' && digits(i + 3, 2) && at(i + 5) == ':' &&
+			   digits(i + 6, 2);
+	};
+
+	size_t end = pos;
+	char separator = at(pos + 4);
+	if (digits(pos, 4) && (separator == '-' || separator == '/') && digits(pos + 5, 2) &&
+		at(pos + 7) == separator && digits(pos + 8, 2))
+	{
+		end = pos + 10;
+		if ((at(end) != 'T' && at(end) != ' ') || !time(end + 1))
+		{
+			return end - pos;
+		}
+		++end;
+	} else if (!time(pos))
+	{
+		return 0;
+	}
+	end += 8;
+
+	if ((at(end) == '.' || at(end) == ',') && digits(end + 1, 1))
+	{
+		for (end += 2; digits(end, 1); ++end)
+		{
+		}
+	}
+	if (at(end) == 'Z')
+	{
+		++end;
+	} else if ((at(end) == '+' || at(end) == '-') && digits(end + 1, 2))
+	{
+		end += 3;
+		if (at(end) == ':' && digits(end + 1, 2))
+		{
+			end += 3;
+		} else if (digits(end, 2))
+		{
+			end += 2;
+		}
+	}
+	return end - pos;
+}
+
+HighlightClass logLevelClass(std::string_view word)
+{
+	struct Level
+	{
+		std::string_view name;
+		HighlightClass cls;
+	};
+	static constexpr Level levels[] = {{"ERROR", HighlightClass::Keyword},
+									   {"ERR", HighlightClass::Keyword},
+									   {"FATAL", HighlightClass::Keyword},
+									   {"CRITICAL", HighlightClass::Keyword},
+									   {"CRIT", HighlightClass::Keyword},
+									   {"PANIC", HighlightClass::Keyword},
+									   {"SEVERE", HighlightClass::Keyword},
+									   {"WARN", HighlightClass::Type},
+									   {"WARNING", HighlightClass::Type},
+									   {"INFO", HighlightClass::Function},
+									   {"NOTICE", HighlightClass::Function},
+									   {"DEBUG", HighlightClass::DimmedText},
+									   {"TRACE", HighlightClass::DimmedText},
+									   {"VERBOSE", HighlightClass::DimmedText}};
+	for (const Level &level : levels)
+	{
+		if (level.name == word)
+		{
+			return level.cls;
+		}
+	}
+	return HighlightClass::Text;
+}
+
+} // namespace
+
+FastHighlight::Format FastHighlight::formatFor(const std::string &extension)
+{
+	static const std::unordered_map<std::string, Format> formats = {
+		{".json", Format::Json},
+		{".jsonl", Format::Json},
+		{".ndjson", Format::Json},
+		{".geojson", Format::Json},
+		{".log", Format::Log},
+		{".txt", Format::Log},
+		{".out", Format::Log}};
+
+	auto found = formats.find(extension);
+	if (found != formats.end())
+	{
+		return found->second;
+	}
+	if (LexerSyntax::forExtension(extension) || TreeSitter::hasLanguage(extension))
+	{
+		return Format::None;
+	}
+	// Anything else this large is most likely machine output
+	return Format::Log;
+}
+
+void FastHighlight::classify(Format format,
+							 std::string_view text,
+							 HighlightClass *classes)
+{
+	switch (format)
+	{
+	case Format::Json:
+		classifyJson(text, classes);
+		break;
+	case Format::Log:
+		classifyLog(text, classes);
+		break;
+	case Format::None:
+		fill(classes, 0, text.size(), HighlightClass::Text);
+		break;
+	}
+}
+
+void FastHighlight::classifyJson(std::string_view text, HighlightClass *classes)
+{
+	const size_t size = text.size();
+	fill(classes, 0, size, HighlightClass::Text);
+
+	for (size_t i = skip<JsonSpace>(text, 0); i < size;)
+	{
+		char c = text[i];
+		size_t end = i + 1;
+		HighlightClass cls = HighlightClass::Text;
+		if (c == '"')
+		{
+			end = next<JsonStringEnd>(text, end);
+			while (end < size && text[end] == '\\')
+			{
+				end = next<JsonStringEnd>(text, std::min(end + 2, size));
+			}
+			end = std::min(end + 1, size);
+			// Keys are the strings followed by a colon
+			size_t after = skip<JsonSpace>(text, end);
+			cls = after < size && text[after] == ':' ? HighlightClass::Variable
+													 : HighlightClass::String;
+		} else if (c == '-' || LexerTables::isDigit(c))
+		{
+			// Exponents included; anything else running on is not valid JSON
+			while (end < size &&
+				   (LexerTables::isAlphaNumeric(text[end]) || text[end] == '.' ||
+					text[end] == '+' || text[end] == '-'))
+			{
+				++end;
+			}
+			cls = HighlightClass::Number;
+		} else if (LexerTables::isAlpha(c))
+		{
+			while (end < size && LexerTables::isAlpha(text[end]))
+			{
+				++end;
+			}
+			std::string_view word = text.substr(i, end - i);
+			if (word == "true" || word == "false" || word == "null")
+			{
+				cls = HighlightClass::Keyword;
+			}
+		} else if (c == '/' && end < size && (text[end] == '/' || text[end] == '*'))
+		{
+			// Comments of JSONC files
+			bool block = text[end] == '*';
+			size_t close = block ? text.find("*/", end + 1) : text.find('\n', end);
+			end = close == std::string_view::npos ? size : close + (block ? 2 : 0);
+			cls = HighlightClass::Comment;
+		} else if (c == '{' || c == '}' || c == '[' || c == ']' || c == ',' || c == ':')
+		{
+			cls = HighlightClass::DimmedText;
+		}
+		fill(classes, i, end, cls);
+		i = skip<JsonSpace>(text, end);
+	}
+}
+
+void FastHighlight::classifyLog(std::string_view text, HighlightClass *classes)
+{
+	const size_t size = text.size();
+	fill(classes, 0, size, HighlightClass::Text);
+
+	for (size_t i = next<LogTokenStart>(text, 0); i < size;
+		 i = next<LogTokenStart>(text, i))
+	{
+		char c = text[i];
+		size_t end = i + 1;
+		HighlightClass cls = HighlightClass::Text;
+		if (c == '"')
+		{
+			end = next<LogStringEnd>(text, end);
+			end = end < size && text[end] == '"' ? end + 1 : end;
+			cls = HighlightClass::String;
+		} else if (c == '[' || c == ']')
+		{
+			cls = HighlightClass::DimmedText;
+		} else if (i > 0 && LexerTables::isIdentPart(text[i - 1]))
+		{
+			// Inside a word like v2 or userId, which stays text
+			while (end < size && LexerTables::isIdentPart(text[end]))
+			{
+				++end;
+			}
+		} else if (LexerTables::isDigit(c))
+		{
+			size_t length = timestampLength(text, i);
+			if (length > 0)
+			{
+				end = i + length;
+				cls = HighlightClass::Comment;
+			} else
+			{
+				// With units and versions, as in 250ms or 1.2.3
+				while (end < size &&
+					   (LexerTables::isIdentPart(text[end]) || text[end] == '.'))
+				{
+					++end;
+				}
+				cls = HighlightClass::Number;
+			}
+		} else
+		{
+			while (end < size && LexerTables::isAlpha(text[end]))
+			{
+				++end;
+			}
+			cls = logLevelClass(text.substr(i, end - i));
+		}
+		fill(classes, i, end, cls);
+		i = end;
+	}
+}
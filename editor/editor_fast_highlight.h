@@ -0,0 +1,40 @@
+/*
+	File: editor_fast_highlight.h
+	Description: Vectorized scanner that colors the lines of large JSON, log
+	and plain text files, which keep no per-char classes and are not parsed.
+
+	The renderer classifies each line as it draws it, so the colors take no
+	memory and show as soon as the file is mapped. Every line is classified
+	on its own, which holds for JSON strings and log records alike. Runs of
+	bytes the scanner has nothing to do with, such as indentation, string
+	bodies and log messages, are skipped a SIMD block at a time: AVX2 when
+	the build targets it, SSE2 on other x86-64 builds and scalar elsewhere.
+*/
+
+#pragma once
+#include "editor_highlight_class.h"
+
+#include <string>
+#include <string_view>
+
+class FastHighlight
+{
+  public:
+	enum class Format
+	{
+		None, // drawn as plain text
+		Json,
+		Log, // also plain text and unknown extensions
+	};
+
+	// Format of a large file with extension. Languages with a lexer or a
+	// grammar get None: scanned line by line they would color wrongly.
+	static Format formatFor(const std::string &extension);
+
+	// Writes the class of each byte of text to classes.
+	static void classify(Format format, std::string_view text, HighlightClass *classes);
+
+  private:
+	static void classifyJson(std::string_view text, HighlightClass *classes);
+	static void classifyLog(std::string_view text, HighlightClass *classes);
+};
@@ -0,0 +1,242 @@
+/*
+	File: editor_file_mapping.cpp
+	Description: Read-only memory mapping of a file, used as the original
+	buffer of the piece table for large files.
+*/
+
+#include "editor_file_mapping.h"
+
+#ifdef PLATFORM_WINDOWS
+#include <windows.h>
+#else
+#include <atomic>
+#include <cerrno>
+#include <csignal>
+#include <cstdint>
+#include <cstring>
+#include <fcntl.h>
+#include <iostream>
+#include <mutex>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#endif
+
+#ifdef PLATFORM_WINDOWS
+
+std::unique_ptr<FileMapping> FileMapping::open(const std::string &path,
+											   std::string &error)
+{
+	HANDLE file = CreateFileA(path.c_str(),
+							  GENERIC_READ,
+							  FILE_SHARE_READ | FILE_SHARE_DELETE,
+							  nullptr,
+							  OPEN_EXISTING,
+							  FILE_ATTRIBUTE_NORMAL,
+							  nullptr);
+	if (file == INVALID_HANDLE_VALUE)
+	{
+		error = "cannot open file (error " + std::to_string(GetLastError()) + ")";
+		return nullptr;
+	}
+
+	LARGE_INTEGER file_size;
+	if (!GetFileSizeEx(file, &file_size))
+	{
+		error = "cannot get file size (error " + std::to_string(GetLastError()) + ")";
+		CloseHandle(file);
+		return nullptr;
+	}
+
+	std::unique_ptr<FileMapping> mapping(new FileMapping());
+	mapping->file_handle = file;
+	if (file_size.QuadPart == 0)
+	{
+		return mapping; // empty files cannot be mapped, nothing to read anyway
+	}
+
+	HANDLE section = CreateFileMappingA(file, nullptr, PAGE_READONLY, 0, 0, nullptr);
+	if (!section)
+	{
+		error = "cannot map file (error " + std::to_string(GetLastError()) + ")";
+		return nullptr;
+	}
+	mapping->mapping_handle = section;
+
+	void *view = MapViewOfFile(section, FILE_MAP_READ, 0, 0, 0);
+	if (!view)
+	{
+		error = "cannot map file (error " + std::to_string(GetLastError()) + ")";
+		return nullptr;
+	}
+	mapping->bytes = static_cast<const char *>(view);
+	mapping->length = static_cast<size_t>(file_size.QuadPart);
+	return mapping;
+}
+
+bool FileMapping::shrunk() const { return false; }
+
+FileMapping::~FileMapping()
+{
+	if (bytes)
+	{
+		UnmapViewOfFile(bytes);
+	}
+	if (mapping_handle)
+	{
+		CloseHandle(mapping_handle);
+	}
+	if (file_handle)
+	{
+		CloseHandle(file_handle);
+	}
+}
+
+#else
+
+namespace {
+
+// Address ranges of the live mappings, read by the SIGBUS handler, which
+// can take no locks. A slot is free while begin is 0.
+struct GuardedRange
+{
+	std::atomic<uintptr_t> begin{0};
+	std::atomic<uintptr_t> end{0};
+	std::atomic<bool> shrunk{false};
+};
+constexpr int GUARD_SLOTS = 64;
+GuardedRange guarded[GUARD_SLOTS];
+uintptr_t page_size = 4096;
+struct sigaction previous_sigbus;
+
+void onSigbus(int signal, siginfo_t *info, void *context)
+{
+	uintptr_t address = reinterpret_cast<uintptr_t>(info->si_addr);
+	for (GuardedRange &range : guarded)
+	{
+		if (address < range.begin.load() || address >= range.end.load())
+		{
+			continue;
+		}
+		// The file was truncated under the mapping: the page past its end
+		// becomes zeros and the read that faulted runs again
+		void *page = reinterpret_cast<void *>(address & ~(page_size - 1));
+		if (mmap(page,
+				 page_size,
+				 PROT_READ,
+				 MAP_PRIVATE | MAP_ANONYMOUS | MAP_FIXED,
+				 -1,
+				 0) != MAP_FAILED)
+		{
+			range.shrunk.store(true);
+			return;
+		}
+		break;
+	}
+
+	// Not a mapped file: whoever had the signal before gets it, else the
+	// default action ends the process as it would have without this handler
+	if (previous_sigbus.sa_flags & SA_SIGINFO)
+	{
+		previous_sigbus.sa_sigaction(signal, info, context);
+	} else if (previous_sigbus.sa_handler != SIG_DFL &&
+			   previous_sigbus.sa_handler != SIG_IGN)
+	{
+		previous_sigbus.sa_handler(signal);
+	} else
+	{
+		std::signal(signal, SIG_DFL);
+		std::raise(signal);
+	}
+}
+
+int guardRange(const char *bytes, size_t length)
+{
+	static std::once_flag installed;
+	std::call_once(installed, []() {
+		page_size = static_cast<uintptr_t>(sysconf(_SC_PAGESIZE));
+		struct sigaction action = {};
+		action.sa_sigaction = onSigbus;
+		action.sa_flags = SA_SIGINFO;
+		sigemptyset(&action.sa_mask);
+		sigaction(SIGBUS, &action, &previous_sigbus);
+	});
+
+	uintptr_t begin = reinterpret_cast<uintptr_t>(bytes);
+	for (int slot = 0; slot < GUARD_SLOTS; ++slot)
+	{
+		uintptr_t expected = 0;
+		if (guarded[slot].begin.compare_exchange_strong(expected, begin))
+		{
+			guarded[slot].shrunk.store(false);
+			guarded[slot].end.store(begin + length);
+			return slot;
+		}
+	}
+	std::cerr << "\033[31mFileMapping:\033[0m Too many mappings, a truncated file "
+				 "will crash the editor"
+			  << std::endl;
+	return -1;
+}
+
+} // namespace
+
+std::unique_ptr<FileMapping> FileMapping::open(const std::string &path,
+											   std::string &error)
+{
+	int fd = ::open(path.c_str(), O_RDONLY);
+	if (fd < 0)
+	{
+		error = std::string("cannot open file: ") + std::strerror(errno);
+		return nullptr;
+	}
+
+	struct stat info;
+	if (fstat(fd, &info) != 0)
+	{
+		error = std::string("cannot stat file: ") + std::strerror(errno);
+		::close(fd);
+		return nullptr;
+	}
+
+	std::unique_ptr<FileMapping> mapping(new FileMapping());
+	if (info.st_size > 0)
+	{
+		size_t size = static_cast<size_t>(info.st_size);
+		void *view = mmap(nullptr, size, PROT_READ, MAP_PRIVATE, fd, 0);
+		if (view == MAP_FAILED)
+		{
+			error = std::string("cannot map file: ") + std::strerror(errno);
+			::close(fd);
+			return nullptr;
+		}
+		mapping->bytes = static_cast<const char *>(view);
+		mapping->length = size;
+		mapping->guard_slot = guardRange(mapping->bytes, size);
+	}
+
+	// The mapping keeps the file referenced on its own
+	::close(fd);
+	return mapping;
+}
+
+bool FileMapping::shrunk() const
+{
+	return guard_slot >= 0 && guarded[guard_slot].shrunk.load();
+}
+
+FileMapping::~FileMapping()
+{
+	if (guard_slot >= 0)
+	{
+		// end first: with it 0 no address falls in the range any more
+		guarded[guard_slot].end.store(0);
+		guarded[guard_slot].begin.store(0);
+	}
+	if (bytes)
+	{
+		munmap(const_cast<char *>(bytes), length);
+	}
+}
+
+#endif
@@ -0,0 +1,56 @@
+/*
+	File: editor_file_mapping.h
+	Description: Read-only memory mapping of a file, used as the original
+	buffer of the piece table for large files.
+
+	Mapping instead of reading makes opening independent of the file size:
+	pages are only faulted in when something touches them, and they stay in
+	the page cache instead of the heap. The file must not be truncated while
+	it is mapped, which is why saving a mapped document writes a new file,
+	maps that one instead and then renames it over the old one.
+
+	Another process may still truncate it, log rotation with copytruncate
+	does. On POSIX a read past the new end raises SIGBUS; for addresses in a
+	live mapping the handler puts a page of zeros there instead, and the
+	mapping reports shrunk() so the document can be reloaded. Windows does
+	not let a mapped file be truncated at all.
+*/
+
+#pragma once
+#include <cstddef>
+#include <memory>
+#include <string>
+#include <string_view>
+
+class FileMapping
+{
+  public:
+	// Maps the whole file read-only. Returns nullptr and fills error when the
+	// file cannot be opened or mapped.
+	static std::unique_ptr<FileMapping> open(const std::string &path, std::string &error);
+
+	~FileMapping();
+	FileMapping(const FileMapping &) = delete;
+	FileMapping &operator=(const FileMapping &) = delete;
+
+	const char *data() const { return bytes; }
+	size_t size() const { return length; }
+	std::string_view view() const { return std::string_view(bytes, length); }
+
+	// True once a read went past the end of the file on disk, which had been
+	// truncated. Those bytes read as zeros.
+	bool shrunk() const;
+
+  private:
+	FileMapping() = default;
+
+	const char *bytes = nullptr;
+	size_t length = 0;
+#ifndef PLATFORM_WINDOWS
+	int guard_slot = -1; // in the SIGBUS guard, -1 when not guarded
+#endif
+#ifdef PLATFORM_WINDOWS
+	void *file_handle = nullptr;
+	void *mapping_handle = nullptr;
+#endif
+};
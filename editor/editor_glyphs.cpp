@@ -0,0 +1,85 @@
+/*
+	File: editor_glyphs.cpp
+	Description: Cached glyph advances used to lay out editor text.
+*/
+
+#include "editor_glyphs.h"
+
+EditorGlyphs gEditorGlyphs;
+
+void EditorGlyphs::sync()
+{
+	ImFont *current_font = ImGui::GetFont();
+	float current_size = ImGui::GetFontSize();
+	if (current_font == font && current_size == font_size)
+	{
+		return;
+	}
+	font = current_font;
+	font_size = current_size;
+	ascii.fill(-1.0f);
+	others.clear();
+}
+
+float EditorGlyphs::advance(uint32_t codepoint)
+{
+	sync();
+	if (codepoint < ascii.size())
+	{
+		float &cached = ascii[codepoint];
+		if (cached < 0.0f)
+		{
+			ImWchar c = static_cast<ImWchar>(codepoint);
+			cached = ImGui::GetFontBaked()->GetCharAdvance(c);
+		}
+		return cached;
+	}
+
+	auto it = others.find(codepoint);
+	if (it != others.end())
+	{
+		return it->second;
+	}
+	ImWchar c = codepoint <= IM_UNICODE_CODEPOINT_MAX
+					? static_cast<ImWchar>(codepoint)
+					: static_cast<ImWchar>(IM_UNICODE_CODEPOINT_INVALID);
+	float width = ImGui::GetFontBaked()->GetCharAdvance(c);
+	others.emplace(codepoint, width);
+	return width;
+}
+
+float EditorGlyphs::charAdvance(const char *text, const char *text_end, size_t &length)
+{
+	unsigned char lead = static_cast<unsigned char>(*text);
+	length = 1;
+	if (lead < 0x80)
+	{
+		return advance(lead);
+	}
+	if ((lead & 0xC0) == 0x80)
+	{
+		return 0.0f; // stray continuation byte, not drawn
+	}
+
+	// Lead byte plus its continuation bytes, same grouping the editor uses
+	// everywhere else for multi-byte chars
+	uint32_t codepoint = lead & (lead >= 0xF0 ? 0x07 : lead >= 0xE0 ? 0x0F : 0x1F);
+	while (text + length < text_end && (text[length] & 0xC0) == 0x80)
+	{
+		codepoint = (codepoint << 6) | (text[length] & 0x3F);
+		++length;
+	}
+	return advance(codepoint);
+}
+
+float EditorGlyphs::tabWidth(float x)
+{
+	float space_width = advance(' ');
+	if (space_width <= 0.0f)
+	{
+		return 0.0f;
+	}
+	int current_column = static_cast<int>(x / space_width);
+	int next_tab_stop = ((current_column / TAB_SIZE) + 1) * TAB_SIZE;
+	return (next_tab_stop - current_column) * space_width;
+}
@@ -0,0 +1,44 @@
+/*
+	File: editor_glyphs.h
+	Description: Cached glyph advances used to lay out editor text.
+
+	Rendering, caret placement and mouse hit testing all walk a line with
+	these advances, so text drawn in whole runs lines up with the caret.
+	The cache is keyed by codepoint and dropped whenever the font or its
+	size changes.
+*/
+
+#pragma once
+#include "imgui.h"
+
+#include <array>
+#include <cstddef>
+#include <cstdint>
+#include <unordered_map>
+
+// Forward declarations
+class EditorGlyphs;
+extern EditorGlyphs gEditorGlyphs;
+
+class EditorGlyphs
+{
+  public:
+	static constexpr int TAB_SIZE = 4;
+
+	float advance(uint32_t codepoint);
+
+	// Advance of the UTF-8 char at text; length receives its size in bytes.
+	// Stray continuation bytes are not drawn and have no advance.
+	float charAdvance(const char *text, const char *text_end, size_t &length);
+
+	// Width of a tab that starts x pixels into the line, up to the next stop.
+	float tabWidth(float x);
+
+  private:
+	void sync();
+
+	ImFont *font = nullptr;
+	float font_size = 0.0f;
+	std::array<float, 128> ascii{};
+	std::unordered_map<uint32_t, float> others;
+};
@@ -2,42 +2,85 @@
 #include "editor.h"
 #include "editor_tree_sitter.h"
 #include <algorithm>
+#include <chrono>
 #include <filesystem>
 #include <iostream>
+#include <memory>
 #include <tree_sitter/api.h>
 
 EditorHighlight gEditorHighlight;
 
-EditorHighlight::EditorHighlight()
-	: highlightingInProgress(false), cancelHighlightFlag(false)
-{
-}
+EditorHighlight::EditorHighlight() : highlightingInProgress(false) {}
 
 void EditorHighlight::cancelHighlighting()
 {
-	cancelHighlightFlag = true;
-	if (highlightFuture.valid())
+	// Nothing waits for the pass to end: its parse stops at the flag within
+	// a few hundred nodes, whatever the file size
+	if (passCancel)
 	{
-		highlightFuture.wait();
+		passCancel->store(1);
 	}
-	cancelHighlightFlag = false;
+	highlightingInProgress = false;
+
+	// Passes write colors only under colorsMutex after checking their flag,
+	// so once the lock was free none writes past this point
+	std::lock_guard<std::mutex> state_lock(editor_state.colorsMutex);
 }
 
-void EditorHighlight::forceColorUpdate()
+std::shared_ptr<TreeSitter::CancelFlag> EditorHighlight::beginPass()
 {
-	pythonLexer.forceColorUpdate();
-	cppLexer.forceColorUpdate();
-	htmlLexer.forceColorUpdate();
-	jsxLexer.forceColorUpdate();
-	tsxLexer.forceColorUpdate();
+	// Cancelled passes finish on their own, only collect the ones done
+	passes.erase(std::remove_if(passes.begin(),
+								passes.end(),
+								[](std::future<void> &pass) {
+									return pass.wait_for(std::chrono::seconds(0)) ==
+										   std::future_status::ready;
+								}),
+				 passes.end());
+	passCancel = std::make_shared<TreeSitter::CancelFlag>(0);
+	highlightingInProgress = true;
+	return passCancel;
+}
 
-	TreeSitter::refreshColors();
-	TreeSitter::clearQueryCache();
-	TreeSitter::colorsNeedUpdate = true;
-	if (!gFileExplorer.currentFile.empty())
+bool EditorHighlight::applyLexer(const std::string &extension,
+								 const std::string &code,
+								 std::vector<HighlightClass> &colors)
+{
+	if (extension == ".cpp" || extension == ".h" || extension == ".hpp")
+	{
+		cppLexer.applyHighlighting(code, colors, 0);
+	} else if (extension == ".py")
+	{
+		pythonLexer.applyHighlighting(code, colors, 0);
+	} else if (extension == ".html" || extension == ".cshtml")
+	{
+		htmlLexer.applyHighlighting(code, colors, 0);
+	} else if (extension == ".js" || extension == ".jsx")
+	{
+		jsxLexer.applyHighlighting(code, colors, 0);
+	} else if (extension == ".tsx" || extension == ".ts")
+	{
+		tsxLexer.applyHighlighting(code, colors, 0);
+	} else if (extension == ".java")
+	{
+		javaLexer.applyHighlighting(code, colors, 0);
+	} else if (extension == ".cs")
+	{
+		csharpLexer.applyHighlighting(code, colors, 0);
+	} else if (extension == ".css")
 	{
-		highlightContent();
+		cssLexer.applyHighlighting(code, colors, 0);
+	} else
+	{
+		return false;
 	}
+	return true;
+}
+
+void EditorHighlight::forceColorUpdate()
+{
+	// fileColors holds classes, so a theme change only rebuilds the palette
+	TreeSitter::refreshColors();
 }
 
 bool EditorHighlight::validateHighlightContentParams()
@@ -67,15 +110,12 @@ void EditorHighlight::highlightContent(bool fullRehighlight, bool sync)
 {
 	std::lock_guard<std::mutex> lock(highlight_mutex);
 
-	if (!sync)
-	{
-		cancelHighlighting();
-	}
+	// A sync pass replaces whatever a worker is doing too
+	cancelHighlighting();
 
 	TreeSitter::updateThemeColors();
 
-	std::string content_copy;
-	std::vector<ImVec4> colors_param_copy;
+	TextSnapshot snapshot;
 	std::string currentFile_copy;
 	std::string extension_copy;
 
@@ -89,13 +129,13 @@ void EditorHighlight::highlightContent(bool fullRehighlight, bool sync)
 			return;
 		}
 
-		// Handle large files quickly (bypasses async task)
-		const size_t LARGE_FILE_THRESHOLD = 1 * 1024 * 1024 * 100; // 100MB
-		if (editor_state.fileContent.size() > LARGE_FILE_THRESHOLD)
+		// Large files are not parsed at all: tree-sitter would need a copy of
+		// the whole file and one class per char. The renderer colors their
+		// JSON and log lines with FastHighlight instead.
+		if (editor_state.large_file)
 		{
-			editor_state.fileColors.assign(editor_state.fileContent.size(),
-										   TreeSitter::cachedColors.text);
-			highlightingInProgress = false; // Not strictly necessary here
+			editor_state.fileColors.clear();
+			highlightingInProgress = false;
 			return;
 		}
 
@@ -104,97 +144,264 @@ void EditorHighlight::highlightContent(bool fullRehighlight, bool sync)
 			return;
 		}
 
-		content_copy = editor_state.fileContent;
-		colors_param_copy =
-			editor_state.fileColors; // Copied while editor_state is locked
+		// Counted newlines let the parser place its edit by row and column
+		editor_state.fileContent.lineCount();
+		// O(1): the worker reads the text itself, without the lock
+		snapshot = editor_state.fileContent.snapshot();
 		currentFile_copy = gFileExplorer.currentFile;
 		extension_copy = fs::path(currentFile_copy).extension().string();
 	} // editor_state.colorsMutex is released
 
-	// Define the highlighting logic as a lambda that can be reused
-	auto performHighlighting = [this, content_copy, extension_copy, fullRehighlight](
-								   std::vector<ImVec4> &colors) {
-		try
-		{
-			colors.assign(content_copy.size(), TreeSitter::cachedColors.text);
+	if (gSettings.getTreesitterMode())
+	{
+		highlightWithTreeSitter(
+			snapshot, currentFile_copy, extension_copy, fullRehighlight, sync);
+		return;
+	}
+
+	highlightWithLexer(snapshot, extension_copy, fullRehighlight, sync);
+}
+
+void EditorHighlight::highlightWithLexer(const TextSnapshot &snapshot,
+										 const std::string &extension,
+										 bool fullRehighlight,
+										 bool sync)
+{
+	// Custom lexers or fallback for unsupported extensions
+	const LexerSyntax *syntax = LexerSyntax::forExtension(extension);
+	if (!syntax)
+	{
+		std::lock_guard<std::mutex> state_lock(editor_state.colorsMutex);
+		std::fill(editor_state.fileColors.begin(),
+				  editor_state.fileColors.end(),
+				  HighlightClass::Text);
+		highlightingInProgress = false;
+		return;
+	}
+
+	// Edits since the text of the last pass, which the line states are at
+	// once that pass ran. Only the UI thread edits the buffer, so these end
+	// at snapshot's version.
+	auto edits = std::make_shared<std::vector<TextEdit>>();
+	uint64_t base_version = lexedVersion;
+	if (fullRehighlight || lexedDocument != snapshot.documentId() ||
+		!editor_state.fileContent.editsSince(base_version, *edits))
+	{
+		edits.reset();
+	}
+	lexedDocument = snapshot.documentId();
+	lexedVersion = snapshot.version();
+
+	std::shared_ptr<TreeSitter::CancelFlag> cancel = beginPass();
+	// The UI thread may be editing meanwhile: the buffer's version is read
+	// atomically, and edits reshape fileColors only after the buffer, so a
+	// pass holding colorsMutex that still matches writes the right layout.
+	// Switching documents cancels the pass and changes the document id, so
+	// the file name needs no check of its own.
+	auto current = [snapshot, cancel]() {
+		return !cancel->load() && snapshot.matches(editor_state.fileContent);
+	};
 
-			if (gSettings.getTreesitterMode())
+	// Relexes from the first edited line until the lexer is back in the
+	// state it was in before, writing colors a chunk at a time
+	auto relex = [this, snapshot, extension, syntax, base_version, edits, current]() {
+		std::lock_guard<std::mutex> lexer_lock(lexerMutex);
+		// Cancelled passes still bring the states to their text, so the
+		// edits of the next pass apply on top
+		if (!lexerLines.update(snapshot, base_version, edits.get()) || !current())
+		{
+			return;
+		}
+		lexerLines.relex(*syntax, [&](size_t start, const std::string &code) {
+			std::vector<HighlightClass> colors(code.size(), HighlightClass::Text);
+			try
 			{
-				TreeSitter::parse(content_copy, colors, extension_copy, fullRehighlight);
-			} else // Custom lexers or fallback for unsupported extensions
+				applyLexer(extension, code, colors);
+			} catch (const std::exception &e)
 			{
-				if (extension_copy == ".cpp" || extension_copy == ".h" ||
-					extension_copy == ".hpp")
-				{
-					cppLexer.applyHighlighting(content_copy, colors, 0);
-				} else if (extension_copy == ".py")
-				{
-					pythonLexer.applyHighlighting(content_copy, colors, 0);
-				} else if (extension_copy == ".html" || extension_copy == ".cshtml")
-				{
-					htmlLexer.applyHighlighting(content_copy, colors, 0);
-				} else if (extension_copy == ".js" || extension_copy == ".jsx")
-				{
-					jsxLexer.applyHighlighting(content_copy, colors, 0);
-				} else if (extension_copy == ".tsx" || extension_copy == ".ts")
-				{
-					tsxLexer.applyHighlighting(content_copy, colors, 0);
-				} else if (extension_copy == ".java")
-				{
-					javaLexer.applyHighlighting(content_copy, colors, 0);
-				} else if (extension_copy == ".cs")
-				{
-					csharpLexer.applyHighlighting(content_copy, colors, 0);
-				} else if (extension_copy == ".css")
-				{
-					cssLexer.applyHighlighting(content_copy, colors, 0);
-				}
+				std::cerr << "Highlighting error: " << e.what() << std::endl;
+				std::fill(colors.begin(), colors.end(), HighlightClass::Text);
 			}
-		} catch (const std::exception &e)
-		{
-			std::cerr << "Highlighting error: " << e.what() << std::endl;
-			colors.assign(content_copy.size(), TreeSitter::cachedColors.text);
-		}
+
+			std::lock_guard<std::mutex> state_lock(editor_state.colorsMutex);
+			if (!current() || editor_state.fileColors.size() < start + colors.size())
+			{
+				return false;
+			}
+			std::copy(
+				colors.begin(), colors.end(), editor_state.fileColors.begin() + start);
+			return true;
+		});
 	};
 
 	if (sync)
 	{
 		// Synchronous highlighting - perform immediately
-		std::lock_guard<std::mutex> state_lock(editor_state.colorsMutex);
-		performHighlighting(editor_state.fileColors);
-	} else
+		relex();
+		highlightingInProgress = false;
+		return;
+	}
+	passes.push_back(std::async(std::launch::async, [this, relex, cancel]() {
+		relex();
+		if (!cancel->load())
+		{
+			highlightingInProgress = false;
+		}
+	}));
+}
+
+void EditorHighlight::highlightWithTreeSitter(const TextSnapshot &snapshot,
+											  const std::string &file,
+											  const std::string &extension,
+											  bool fullRehighlight,
+											  bool sync)
+{
+	// Edits since the last parse, so the parser can update its tree in place.
+	// Only the UI thread edits the buffer, so these end at snapshot's version.
+	std::shared_ptr<TreeSitter::SyntaxState> syntax = TreeSitter::activeSyntax();
+	auto delta = std::make_shared<TreeSitter::EditDelta>();
+	if (fullRehighlight ||
+		!TreeSitter::editsSinceLastParse(*syntax, editor_state.fileContent, *delta))
 	{
-		// Asynchronous highlighting - use existing async logic
-		highlightingInProgress = true;
+		delta.reset();
+	}
+	TreeSitter::ByteRange visible = visibleRange();
+	std::shared_ptr<TreeSitter::CancelFlag> cancel = beginPass();
 
-		highlightFuture = std::async(
-			std::launch::async,
-			[this,
-			 content_copy,
-			 colors_param_copy,
-			 currentFile_copy,
-			 performHighlighting]() mutable {
-				std::vector<ImVec4> current_colors = colors_param_copy;
+	// Parsing from scratch takes a while on a big file, until it is done the
+	// lines on screen get a quick lexer coloring
+	bool interim = !delta && colorVisibleWithLexer(extension, visible);
+
+	// See highlightWithLexer
+	auto current = [snapshot, cancel]() {
+		return !cancel->load() && snapshot.matches(editor_state.fileContent);
+	};
+
+	// Recolors what the parse left stale and the viewport; the rest of a
+	// document parsed from scratch is filled in afterwards. The parse runs
+	// without colorsMutex, as the UI keeps editing meanwhile.
+	auto parseAndRecolor = [syntax, snapshot, file, extension, fullRehighlight, delta,
+							visible, cancel, current]() {
+		std::vector<TreeSitter::ByteRange> stale;
+		TreeSitter::ParseResult result = TreeSitter::parse(*syntax,
+														   snapshot,
+														   file,
+														   extension,
+														   fullRehighlight,
+														   delta.get(),
+														   cancel.get(),
+														   stale);
+		if (result == TreeSitter::ParseResult::Cancelled)
+		{
+			return false; // the next pass picks up from here
+		}
+		std::lock_guard<std::mutex> state_lock(editor_state.colorsMutex);
+		if (!current())
+		{
+			return false;
+		}
+		stale.push_back(visible);
+		if (result == TreeSitter::ParseResult::NoParser ||
+			!TreeSitter::highlightRanges(
+				*syntax, snapshot, editor_state.fileColors, stale))
+		{
+			std::fill(editor_state.fileColors.begin(),
+					  editor_state.fileColors.end(),
+					  HighlightClass::Text);
+		}
+		return true;
+	};
+
+	// A sync pass is there to avoid a flash of plain text. The interim
+	// colors do that too, so then the parse goes to the worker as well.
+	bool parse_on_worker = !sync || interim;
+	if (!parse_on_worker && !parseAndRecolor())
+	{
+		highlightingInProgress = false;
+		return;
+	}
 
-				if (cancelHighlightFlag.load())
+	passes.push_back(std::async(
+		std::launch::async,
+		[this, syntax, snapshot, parse_on_worker, parseAndRecolor, current, cancel]() {
+			try
+			{
+				if (parse_on_worker && !parseAndRecolor())
 				{
-					highlightingInProgress = false;
 					return;
 				}
 
-				performHighlighting(current_colors);
-
-				std::lock_guard<std::mutex> state_lock(editor_state.colorsMutex);
-
-				if (!cancelHighlightFlag.load() &&
-					currentFile_copy == gFileExplorer.currentFile &&
-					content_copy == editor_state.fileContent)
+				// A slice at a time, so an edit waits for one slice at most
+				bool more = true;
+				while (more)
 				{
-					editor_state.fileColors = current_colors;
+					std::lock_guard<std::mutex> state_lock(editor_state.colorsMutex);
+					more = current() && TreeSitter::fillNextSlice(*syntax,
+																  snapshot,
+																  editor_state.fileColors,
+																  FILL_SLICE_BYTES);
 				}
+			} catch (const std::exception &e)
+			{
+				std::cerr << "Highlighting error: " << e.what() << std::endl;
+			}
+			if (!cancel->load())
+			{
 				highlightingInProgress = false;
-			});
+			}
+		}));
+}
+
+bool EditorHighlight::colorVisibleWithLexer(const std::string &extension,
+											TreeSitter::ByteRange visible)
+{
+	// Lexers are not thread safe; when a lexer pass is busy, skip this
+	std::unique_lock<std::mutex> lexer_lock(lexerMutex, std::try_to_lock);
+	if (!lexer_lock.owns_lock() || visible.end <= visible.start)
+	{
+		return false;
 	}
+
+	// Lexing starts at the top of the screen, so a comment or string opened
+	// above it may come out wrong until the tree is there
+	std::string text =
+		editor_state.fileContent.substr(visible.start, visible.end - visible.start);
+	std::vector<HighlightClass> colors(text.size(), HighlightClass::Text);
+	if (!applyLexer(extension, text, colors))
+	{
+		return false;
+	}
+
+	std::lock_guard<std::mutex> state_lock(editor_state.colorsMutex);
+	if (editor_state.fileColors.size() < visible.end)
+	{
+		return false;
+	}
+	std::copy(colors.begin(),
+			  colors.end(),
+			  editor_state.fileColors.begin() + visible.start);
+	return true;
+}
+
+TreeSitter::ByteRange EditorHighlight::visibleRange() const
+{
+	const LineIndex &lines = editor_state.editor_content_lines;
+	size_t content_size = editor_state.fileContent.size();
+	float line_height = editor_state.line_height;
+	if (lines.size() == 0 || line_height <= 0.0f)
+	{
+		// Not drawn yet, a new document shows its start
+		return {0, std::min(content_size, FILL_SLICE_BYTES)};
+	}
+
+	size_t first_row =
+		static_cast<size_t>(std::max(editor_state.current_scroll_y, 0.0f) / line_height);
+	size_t row_count = static_cast<size_t>(editor_state.size.y / line_height) + 2;
+	size_t first_line = gEditorWrap.lineAtRow(first_row);
+	size_t last_line = gEditorWrap.lineAtRow(first_row + row_count);
+	size_t start = lines[first_line];
+	size_t end = last_line + 1 < lines.size() ? lines[last_line + 1] : content_size;
+	return {std::min(start, content_size), std::min(end, content_size)};
 }
 
 void EditorHighlight::setTheme(const std::string &themeName) { loadTheme(themeName); }
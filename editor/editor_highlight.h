@@ -7,11 +7,15 @@
 #include "../lexers/jsx.h"
 #include "../lexers/python.h"
 #include "../lexers/tsx.h"
+#include "../util/settings.h"
+#include "editor_lexer_lines.h"
+#include "editor_tree_sitter.h"
 
 #include "imgui.h"
 #include <atomic>
 #include <filesystem>
 #include <future>
+#include <memory>
 #include <mutex>
 #include <string>
 #include <vector>
@@ -28,6 +32,8 @@ class EditorHighlight
 
 	void cancelHighlighting();
 
+	bool isHighlighting() const { return highlightingInProgress; }
+
 	void forceColorUpdate();
 
 	bool validateHighlightContentParams();
@@ -37,6 +43,33 @@ class EditorHighlight
 	void setTheme(const std::string &themeName);
 
   private:
+	// Bytes colored per step of the background fill, which holds
+	// colorsMutex for one step at a time
+	static constexpr size_t FILL_SLICE_BYTES = 64 * 1024;
+
+	// Cancels the newest pass in favor of a new one and returns its flag.
+	std::shared_ptr<TreeSitter::CancelFlag> beginPass();
+
+	// Highlights code with the lexer for extension, false if there is none.
+	// Call with lexerMutex held.
+	bool applyLexer(const std::string &extension,
+					const std::string &code,
+					std::vector<HighlightClass> &colors);
+	bool colorVisibleWithLexer(const std::string &extension,
+							   TreeSitter::ByteRange visible);
+
+	void highlightWithLexer(const TextSnapshot &snapshot,
+							const std::string &extension,
+							bool fullRehighlight,
+							bool sync);
+	void highlightWithTreeSitter(const TextSnapshot &snapshot,
+								 const std::string &file,
+								 const std::string &extension,
+								 bool fullRehighlight,
+								 bool sync);
+	// Bytes of the lines on screen
+	TreeSitter::ByteRange visibleRange() const;
+
 	// Lexer instances
 	PythonLexer::Lexer pythonLexer;
 	CppLexer::Lexer cppLexer;
@@ -49,12 +82,21 @@ class EditorHighlight
 
 	std::unordered_map<std::string, ImVec4> themeColors;
 
+	std::mutex lexerMutex;
+	// Line start states of the document the lexers last colored, under
+	// lexerMutex, and the text last handed to them, on the UI thread only
+	LexerLines lexerLines;
+	uint64_t lexedDocument = 0;
+	uint64_t lexedVersion = 0;
+
 	// Highlighting state management
 	std::mutex highlight_mutex;
-	std::future<void> highlightFuture;
+	// Running passes, newest last. Cancelled ones are not waited for; they
+	// stop at their flag and are collected when the next pass begins.
+	std::vector<std::future<void>> passes;
+	std::shared_ptr<TreeSitter::CancelFlag> passCancel; // of the newest pass
 	std::atomic<bool> highlightingInProgress{false};
 	std::mutex colorsMutex;
-	std::atomic<bool> cancelHighlightFlag{false};
 };
 
 // Global instance
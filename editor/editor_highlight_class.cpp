@@ -0,0 +1,41 @@
+/*
+	File: editor_highlight_class.cpp
+	Description: Maps tree-sitter capture names to highlight classes.
+*/
+
+#include "editor_highlight_class.h"
+#include <unordered_map>
+
+HighlightClass highlightClassForCapture(std::string_view name)
+{
+	static const std::unordered_map<std::string_view, HighlightClass> capture_classes = {
+		{"keyword", HighlightClass::Keyword},
+		{"string", HighlightClass::String},
+		{"number", HighlightClass::Number},
+		{"comment", HighlightClass::Comment},
+		{"type", HighlightClass::Type},
+		{"function", HighlightClass::Function},
+		{"variable", HighlightClass::Variable},
+		{"tag", HighlightClass::Type},			// Components
+		{"attribute", HighlightClass::Number},	// JSX attributes
+		{"property", HighlightClass::Variable}, // Object properties
+		{"hook", HighlightClass::Function},		// React hooks
+		{"variable.parameter", HighlightClass::Variable},
+		{"punctuation.special", HighlightClass::String}};
+
+	// Most specific name first, so keyword.control falls back to keyword
+	while (true)
+	{
+		auto class_it = capture_classes.find(name);
+		if (class_it != capture_classes.end())
+		{
+			return class_it->second;
+		}
+		size_t dot = name.rfind('.');
+		if (dot == std::string_view::npos)
+		{
+			return HighlightClass::Text; // Fallback to text
+		}
+		name = name.substr(0, dot);
+	}
+}
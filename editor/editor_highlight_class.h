@@ -0,0 +1,36 @@
+/*
+	File: editor_highlight_class.h
+	Description: One byte syntax class stored for every char of the document.
+
+	Highlighters write classes into EditorState::fileColors and the renderer
+	resolves them through TreeSitter's palette when drawing, so switching
+	themes never has to touch the per-char buffer.
+*/
+
+#pragma once
+#include <cstddef>
+#include <cstdint>
+#include <string_view>
+
+enum class HighlightClass : uint8_t
+{
+	Text,
+	Keyword,
+	String,
+	Number,
+	Comment,
+	Function,
+	Type,
+	Variable,
+	Operator,	 // theme "operator" when present, otherwise text
+	DimmedText,	 // text at 80% brightness, used for operators and punctuation
+	ReturnBlock, // JSX return block tint
+	Ghost,		 // translucent grey for AI ghost text and not yet highlighted text
+	Count
+};
+
+constexpr size_t HIGHLIGHT_CLASS_COUNT = static_cast<size_t>(HighlightClass::Count);
+
+// Class of a tree-sitter highlight capture name. Dotted names fall back to
+// their parents, most specific first, so keyword.control is a keyword.
+HighlightClass highlightClassForCapture(std::string_view name);
@@ -3,6 +3,7 @@
 #include "editor.h"
 #include "editor_highlight.h"
 #include "editor_indentation.h"
+#include "editor_multi_edit.h"
 
 #include "editor_tree_sitter.h"
 
@@ -121,85 +122,30 @@ void EditorIndentation::handleMultiLineIndentation()
 	}
 
 	// Update colors vector
-	auto &colors = editor_state.fileColors;
-	colors.erase(colors.begin() + firstLineStart, colors.begin() + lastLineEnd);
-
-	// Get the proper default text color from the theme
-	TreeSitter::updateThemeColors();
-	ImVec4 defaultColor = TreeSitter::cachedColors.text;
-
-	colors.insert(colors.begin() + firstLineStart,
-				  lastLineEnd - firstLineStart + totalTabsInserted,
-				  defaultColor);
+	editor_state.eraseColors(firstLineStart, lastLineEnd - firstLineStart);
+	editor_state.insertColors(firstLineStart,
+							  lastLineEnd - firstLineStart + totalTabsInserted);
 }
 
 void EditorIndentation::handleSingleLineIndentation()
 {
 	std::set<int> unique_cursor_positions;
-	editor_state.selection_active = false;
-	editor_state.selection_start = editor_state.cursor_index;
-	editor_state.selection_end = editor_state.cursor_index;
 	unique_cursor_positions.insert(editor_state.cursor_index); // Add primary
 	for (int mc_idx : editor_state.multi_cursor_indices)	   // Add multi-cursors
 	{
 		unique_cursor_positions.insert(mc_idx);
 	}
 
-	const char TAB_CHAR = '\t';
-	const size_t INSERT_LEN = 1;
-
-	int cumulative_offset = 0;
-	std::vector<int> new_final_cursor_positions;
-
+	std::vector<BatchEdit> edits;
+	edits.reserve(unique_cursor_positions.size());
 	for (int original_pos : unique_cursor_positions)
 	{
-		int actual_insert_pos = original_pos + cumulative_offset;
-
-		actual_insert_pos =
-			std::max(0,
-					 std::min(actual_insert_pos,
-							  static_cast<int>(editor_state.fileContent.length())));
-
-		editor_state.fileContent.insert(actual_insert_pos, 1, TAB_CHAR);
-
-		// Get the proper default text color from the theme
-		TreeSitter::updateThemeColors();
-		ImVec4 defaultColor = TreeSitter::cachedColors.text;
-
-		if (static_cast<size_t>(actual_insert_pos) <= editor_state.fileColors.size())
-		{
-			editor_state.fileColors.insert(editor_state.fileColors.begin() +
-											   actual_insert_pos,
-										   INSERT_LEN,
-										   defaultColor);
-		} else
-		{
-			editor_state.fileColors.push_back(defaultColor);
-		}
-
-		new_final_cursor_positions.push_back(actual_insert_pos + INSERT_LEN);
-
-		cumulative_offset += INSERT_LEN;
+		edits.push_back({original_pos, 0, "\t"});
 	}
 
-	if (!new_final_cursor_positions.empty())
-	{
-		// Assign the first new position to the primary cursor, the rest to
-		// multi-cursors
-		editor_state.cursor_index = new_final_cursor_positions[0];
-		editor_state.multi_cursor_indices.assign(new_final_cursor_positions.begin() + 1,
-												 new_final_cursor_positions.end());
-	}
-
-	editor_state.multi_selections.clear();
-	editor_state.selection_active = false;
-	editor_state.selection_start = editor_state.cursor_index;
-	editor_state.selection_end = editor_state.cursor_index;
-	// Reset preferred columns, as tab insertion explicitly changes horizontal
-	// (visual) position.
-	editor_state.cursor_column_prefered = 0;
-	editor_state.multi_cursor_prefered_columns.assign(
-		editor_state.multi_cursor_indices.size(), 0);
+	// Preferred columns are reset, as tab insertion explicitly changes
+	// horizontal (visual) position.
+	gEditorMultiEdit.placeCursors(gEditorMultiEdit.apply(edits));
 }
 
 void EditorIndentation::finishIndentationChange()
@@ -308,16 +254,9 @@ void EditorIndentation::removeIndentation()
 	}
 
 	// Update colors vector
-	auto &colors = editor_state.fileColors;
-	colors.erase(colors.begin() + firstLineStart, colors.begin() + lastLineEnd);
-
-	// Get the proper default text color from the theme
-	TreeSitter::updateThemeColors();
-	ImVec4 defaultColor = TreeSitter::cachedColors.text;
-
-	colors.insert(colors.begin() + firstLineStart,
-				  lastLineEnd - firstLineStart - totalSpacesRemoved,
-				  defaultColor);
+	editor_state.eraseColors(firstLineStart, lastLineEnd - firstLineStart);
+	editor_state.insertColors(firstLineStart,
+							  lastLineEnd - firstLineStart - totalSpacesRemoved);
 
 	// Update line starts
 	gEditor.updateLineStarts();
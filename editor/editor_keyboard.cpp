@@ -28,6 +28,7 @@
 #include "editor_indentation.h"
 #include "editor_line_jump.h"
 #include "editor_mouse.h"
+#include "editor_multi_edit.h"
 #include "editor_render.h"
 #include "editor_scroll.h"
 #include "editor_selection.h"
@@ -42,12 +43,12 @@
 // Global instance
 EditorKeyboard gEditorKeyboard;
 
-// Helper: Convert index to iterator and back for std::string
-static inline std::string::iterator str_iter_at(std::string &str, int idx)
+// Helper: Convert index to iterator and back for the document buffer
+static inline TextBuffer::const_iterator str_iter_at(const TextBuffer &str, int idx)
 {
 	return str.begin() + std::clamp(idx, 0, (int)str.size());
 }
-static inline int str_index_at(const std::string &str, std::string::const_iterator it)
+static inline int str_index_at(const TextBuffer &str, TextBuffer::const_iterator it)
 {
 	return (int)std::distance(str.begin(), it);
 }
@@ -115,8 +116,8 @@ void EditorKeyboard::handleBackspaceKey()
 			if (pos > 0)
 			{
 				// Use utfcpp to find the start of the previous UTF-8 character
-				std::string::iterator it = str_iter_at(editor_state.fileContent, pos);
-				std::string::iterator prev = it;
+				TextBuffer::const_iterator it = str_iter_at(editor_state.fileContent, pos);
+				TextBuffer::const_iterator prev = it;
 				if (prev != editor_state.fileContent.begin())
 				{
 					utf8::unchecked::prior(prev);
@@ -135,117 +136,26 @@ void EditorKeyboard::handleBackspaceKey()
 			}
 		}
 	}
-	std::sort(ranges_to_delete.begin(),
-			  ranges_to_delete.end(),
-			  [](const MultiSelectionRange &a, const MultiSelectionRange &b) {
-				  return a.start_index < b.start_index;
-			  });
-	std::vector<MultiSelectionRange> merged_ranges;
-	if (!ranges_to_delete.empty())
+	std::vector<BatchEdit> edits;
+	edits.reserve(ranges_to_delete.size());
+	for (const auto &range : ranges_to_delete)
 	{
-		merged_ranges.push_back(ranges_to_delete[0]);
-		for (size_t i = 1; i < ranges_to_delete.size(); ++i)
-		{
-			MultiSelectionRange &last_merged = merged_ranges.back();
-			const MultiSelectionRange &current_range = ranges_to_delete[i];
-
-			if (current_range.start_index <= last_merged.end_index)
-			{
-				last_merged.end_index =
-					std::max(last_merged.end_index, current_range.end_index);
-			} else
-			{
-				merged_ranges.push_back(current_range);
-			}
-		}
-	}
-
-	int total_chars_deleted_this_op = 0;
-	std::set<int> new_caret_positions;
-
-	if (!merged_ranges.empty())
-	{
-		for (const auto &range : merged_ranges)
-		{
-			int effective_start = range.start_index - total_chars_deleted_this_op;
-			int effective_end = range.end_index - total_chars_deleted_this_op;
-
-			effective_start =
-				std::max(0,
-						 std::min(effective_start,
-								  static_cast<int>(editor_state.fileContent.size())));
-			effective_end =
-				std::max(effective_start,
-						 std::min(effective_end,
-								  static_cast<int>(editor_state.fileContent.size())));
-
-			int length_to_delete = effective_end - effective_start;
-
-			if (length_to_delete > 0)
-			{
-				editor_state.fileContent.erase(effective_start, length_to_delete);
-
-				if (static_cast<size_t>(effective_start) < editor_state.fileColors.size())
-				{
-					editor_state.fileColors.erase(
-						editor_state.fileColors.begin() + effective_start,
-						editor_state.fileColors.begin() +
-							std::min(static_cast<size_t>(effective_end),
-									 editor_state.fileColors.size()));
-				} else if (editor_state.fileContent.empty() &&
-						   !editor_state.fileColors.empty())
-				{
-					editor_state.fileColors.clear();
-				}
-				total_chars_deleted_this_op += length_to_delete;
-			}
-			new_caret_positions.insert(effective_start);
-		}
+		edits.push_back({range.start_index, range.end_index - range.start_index, ""});
 	}
 
-	if (total_chars_deleted_this_op > 0)
+	// One pass over the buffer and colors for all cursors
+	uint64_t version = editor_state.fileContent.version();
+	std::vector<int> new_caret_positions = gEditorMultiEdit.apply(edits);
+	if (editor_state.fileContent.version() != version || selections_were_active)
 	{
-		editor_state.text_changed = true;
-
-		editor_state.multi_cursor_indices.clear();
-
-		if (!new_caret_positions.empty())
-		{
-			editor_state.cursor_index = *new_caret_positions.begin();
-			auto it = new_caret_positions.begin();
-			++it;
-			for (; it != new_caret_positions.end(); ++it)
-			{
-				editor_state.multi_cursor_indices.push_back(*it);
-			}
-		} else
-		{
-			editor_state.cursor_index =
-				std::min(editor_state.cursor_index,
-						 static_cast<int>(editor_state.fileContent.size()));
-		}
-
-		editor_state.cursor_column_prefered = 0;
-		editor_state.multi_cursor_prefered_columns.assign(
-			editor_state.multi_cursor_indices.size(), 0);
-	} else if (selections_were_active && !new_caret_positions.empty())
+		gEditorMultiEdit.placeCursors(std::move(new_caret_positions));
+	} else
 	{
-		editor_state.multi_cursor_indices.clear();
-		editor_state.cursor_index = *new_caret_positions.begin();
-		auto it = new_caret_positions.begin();
-		++it;
-		for (; it != new_caret_positions.end(); ++it)
-		{
-			editor_state.multi_cursor_indices.push_back(*it);
-		}
-		editor_state.cursor_column_prefered = 0;
-		editor_state.multi_cursor_prefered_columns.assign(
-			editor_state.multi_cursor_indices.size(), 0);
+		editor_state.selection_start = editor_state.selection_end =
+			editor_state.cursor_index;
+		editor_state.selection_active = false;
+		editor_state.multi_selections.clear();
 	}
-
-	editor_state.selection_start = editor_state.selection_end = editor_state.cursor_index;
-	editor_state.selection_active = false;
-	editor_state.multi_selections.clear();
 }
 
 inline std::string WcharToUtf8(ImWchar wc)
@@ -310,130 +220,37 @@ void EditorKeyboard::handleCharacterInput()
         editor_state.block_input = false;
 
     // ===========================
-    // Selection deletion (unchanged)
+    // Replace selections, or insert at every caret, as one batch
     // ===========================
-    std::set<int> caret_positions_for_insertion;
+    std::vector<BatchEdit> edits;
     bool had_any_selections = false;
-    std::vector<MultiSelectionRange> all_active_selections;
 
     if (editor_state.selection_start != editor_state.selection_end) {
         had_any_selections = true;
-        all_active_selections.emplace_back(
-            std::min(editor_state.selection_start, editor_state.selection_end),
-            std::max(editor_state.selection_start, editor_state.selection_end));
+        int start = std::min(editor_state.selection_start, editor_state.selection_end);
+        int end = std::max(editor_state.selection_start, editor_state.selection_end);
+        edits.push_back({start, end - start, inputText, true});
     }
     for (const auto &ms_range : editor_state.multi_selections) {
         if (ms_range.start_index != ms_range.end_index) {
             had_any_selections = true;
-            all_active_selections.emplace_back(
-                std::min(ms_range.start_index, ms_range.end_index),
-                std::max(ms_range.start_index, ms_range.end_index));
+            int start = std::min(ms_range.start_index, ms_range.end_index);
+            int end = std::max(ms_range.start_index, ms_range.end_index);
+            edits.push_back({start, end - start, inputText, true});
         }
     }
 
-    if (had_any_selections) {
-        std::sort(all_active_selections.begin(), all_active_selections.end(),
-                  [](const MultiSelectionRange &a, const MultiSelectionRange &b) {
-                      return a.start_index < b.start_index;
-                  });
-
-        std::vector<MultiSelectionRange> merged_selections;
-        if (!all_active_selections.empty()) {
-            merged_selections.push_back(all_active_selections[0]);
-            for (size_t i = 1; i < all_active_selections.size(); ++i) {
-                MultiSelectionRange &last_merged = merged_selections.back();
-                const MultiSelectionRange &current_sel = all_active_selections[i];
-
-                if (current_sel.start_index <= last_merged.end_index)
-                    last_merged.end_index = std::max(last_merged.end_index, current_sel.end_index);
-                else
-                    merged_selections.push_back(current_sel);
-            }
-        }
-        all_active_selections = merged_selections;
-
-        int total_chars_deleted_this_op = 0;
-        for (const auto &sel_to_delete : all_active_selections) {
-            int current_start = sel_to_delete.start_index - total_chars_deleted_this_op;
-            int current_end   = sel_to_delete.end_index   - total_chars_deleted_this_op;
-
-            current_start = std::max(0, std::min(current_start, (int)editor_state.fileContent.size()));
-            current_end   = std::max(current_start, std::min(current_end, (int)editor_state.fileContent.size()));
-
-            int length_to_delete = current_end - current_start;
-            if (length_to_delete > 0) {
-                editor_state.fileContent.erase(current_start, length_to_delete);
-                if ((size_t)current_start < editor_state.fileColors.size()) {
-                    editor_state.fileColors.erase(
-                        editor_state.fileColors.begin() + current_start,
-                        editor_state.fileColors.begin() + std::min(current_end, (int)editor_state.fileColors.size()));
-                } else if (!editor_state.fileColors.empty() && current_start == 0 &&
-                           length_to_delete == (int)editor_state.fileColors.size()) {
-                    editor_state.fileColors.clear();
-                }
-                total_chars_deleted_this_op += length_to_delete;
-            }
-            caret_positions_for_insertion.insert(current_start);
-        }
-    } else {
+    if (!had_any_selections) {
+        std::set<int> caret_positions_for_insertion;
         caret_positions_for_insertion.insert(editor_state.cursor_index);
-        for (int mc_idx : editor_state.multi_cursor_indices) {
-            int valid_mc_idx = std::max(0, std::min(mc_idx, (int)editor_state.fileContent.size()));
-            caret_positions_for_insertion.insert(valid_mc_idx);
-        }
-        if (editor_state.fileContent.empty() && caret_positions_for_insertion.empty())
-            caret_positions_for_insertion.insert(0);
-    }
-
-    // ===========================
-    // Insert text at all carets (unchanged)
-    // ===========================
-    std::vector<int> final_new_cursor_positions;
-    int cumulative_insertion_offset = 0;
-
-    for (int caret_pos : caret_positions_for_insertion) {
-        int actual_insert_pos = caret_pos + cumulative_insertion_offset;
-        actual_insert_pos = std::max(0, std::min(actual_insert_pos, (int)editor_state.fileContent.size()));
-
-        editor_state.fileContent.insert(actual_insert_pos, inputText);
-
-        // Theme color continuity
-        TreeSitter::updateThemeColors();
-        ImVec4 defaultColor = TreeSitter::cachedColors.text;
-        ImVec4 insertColor = defaultColor;
-        if (actual_insert_pos > 0 && actual_insert_pos <= (int)editor_state.fileColors.size())
-            insertColor = editor_state.fileColors[actual_insert_pos - 1];
-
-        if ((size_t)actual_insert_pos <= editor_state.fileColors.size())
-            editor_state.fileColors.insert(
-                editor_state.fileColors.begin() + actual_insert_pos, inputText.size(), insertColor);
-        else
-            for (size_t k = 0; k < inputText.size(); ++k) editor_state.fileColors.push_back(insertColor);
-
-        final_new_cursor_positions.push_back(actual_insert_pos + (int)inputText.size());
-        cumulative_insertion_offset += (int)inputText.size();
-    }
-
-    if (!final_new_cursor_positions.empty()) {
-        editor_state.cursor_index = final_new_cursor_positions[0];
-        editor_state.multi_cursor_indices.assign(
-            final_new_cursor_positions.begin() + 1, final_new_cursor_positions.end());
-    } else if (!caret_positions_for_insertion.empty()) {
-        auto it = caret_positions_for_insertion.begin();
-        editor_state.cursor_index = *it;
-        editor_state.multi_cursor_indices.clear();
-        ++it;
-        for (; it != caret_positions_for_insertion.end(); ++it)
-            editor_state.multi_cursor_indices.push_back(*it);
+        for (int mc_idx : editor_state.multi_cursor_indices)
+            caret_positions_for_insertion.insert(mc_idx);
+        for (int caret_pos : caret_positions_for_insertion)
+            edits.push_back({caret_pos, 0, inputText, true});
     }
 
-    // Reset selection state
-    editor_state.selection_start = editor_state.selection_end = editor_state.cursor_index;
-    editor_state.selection_active = false;
-    editor_state.multi_selections.clear();
-
-    editor_state.text_changed = true;
-    gEditor.updateLineStarts();
+    // Theme color continuity: inserted text takes the class before it
+    gEditorMultiEdit.placeCursors(gEditorMultiEdit.apply(edits));
 
     // ===========================
     // Post-insert completion triggers (FIXED - only set flags, no immediate calls)
@@ -468,7 +285,7 @@ void EditorKeyboard::handleCharacterInput()
     }
 }
 
-std::string CalculateIndentForPosition(const std::string &content,
+std::string CalculateIndentForPosition(const TextBuffer &content,
 									   int char_pos_for_newline_insertion)
 {
 	if (content.empty() && char_pos_for_newline_insertion == 0)
@@ -546,7 +363,7 @@ void EditorKeyboard::handleEnterKey()
 	std::vector<MultiSelectionRange> selections_to_delete;
 	bool selections_were_active = false;
 
-	// --- Phase 1: Collect and Delete Selections (if any) ---
+	// Collect selections (if any)
 	if (editor_state.selection_start != editor_state.selection_end)
 	{
 		selections_were_active = true;
@@ -566,76 +383,10 @@ void EditorKeyboard::handleEnterKey()
 		}
 	}
 
-	std::set<int> target_positions_for_newline; // Positions where newlines will
-												// be inserted, relative to
-												// content *after* deletions
-	int total_chars_deleted_this_op = 0;
-	bool text_changed_by_deletion = false;
-
-	if (selections_were_active)
-	{
-		std::sort(selections_to_delete.begin(),
-				  selections_to_delete.end(),
-				  [](const MultiSelectionRange &a, const MultiSelectionRange &b) {
-					  return a.start_index < b.start_index;
-				  });
-
-		std::vector<MultiSelectionRange> merged_selections;
-		if (!selections_to_delete.empty())
-		{
-			merged_selections.push_back(selections_to_delete[0]);
-			for (size_t i = 1; i < selections_to_delete.size(); ++i)
-			{
-				MultiSelectionRange &last_merged = merged_selections.back();
-				const MultiSelectionRange current_sel = selections_to_delete[i];
-				if (current_sel.start_index <= last_merged.end_index)
-				{
-					last_merged.end_index =
-						std::max(last_merged.end_index, current_sel.end_index);
-				} else
-				{
-					merged_selections.push_back(current_sel);
-				}
-			}
-		}
-
-		for (const auto &sel_to_delete : merged_selections)
-		{
-			int effective_start = sel_to_delete.start_index - total_chars_deleted_this_op;
-			int effective_end = sel_to_delete.end_index - total_chars_deleted_this_op;
-
-			effective_start =
-				std::max(0,
-						 std::min(effective_start,
-								  static_cast<int>(editor_state.fileContent.size())));
-			effective_end =
-				std::max(effective_start,
-						 std::min(effective_end,
-								  static_cast<int>(editor_state.fileContent.size())));
-
-			int length_to_delete = effective_end - effective_start;
-
-			if (length_to_delete > 0)
-			{
-				text_changed_by_deletion = true;
-				editor_state.fileContent.erase(effective_start, length_to_delete);
-				if (static_cast<size_t>(effective_start) < editor_state.fileColors.size())
-				{
-					editor_state.fileColors.erase(
-						editor_state.fileColors.begin() + effective_start,
-						editor_state.fileColors.begin() +
-							std::min(static_cast<size_t>(effective_end),
-									 editor_state.fileColors.size()));
-				} else if (editor_state.fileContent.empty() &&
-						   !editor_state.fileColors.empty())
-				{
-					editor_state.fileColors.clear();
-				}
-				total_chars_deleted_this_op += length_to_delete;
-			}
-			target_positions_for_newline.insert(effective_start);
-		}
-	} else // No selections were active, use current cursor positions
+	// Each selection is replaced by the newline, otherwise it goes in at every
+	// cursor. The indent is copied from the line the newline splits.
+	std::set<int> target_positions_for_newline;
+	if (!selections_were_active)
 	{
 		target_positions_for_newline.insert(editor_state.cursor_index);
 		for (int mc_idx : editor_state.multi_cursor_indices)
@@ -644,106 +395,22 @@ void EditorKeyboard::handleEnterKey()
 		}
 	}
 
-	// If after potential deletions, target_positions_for_newline is empty, and
-	// fileContent is also empty, ensure we have a target position 0 to insert
-	// the first newline.
-	if (target_positions_for_newline.empty() && editor_state.fileContent.empty())
-	{
-		target_positions_for_newline.insert(0);
-	}
-
-	// --- Phase 2: Insert Newlines with Indentation ---
-	std::vector<int> final_new_cursor_positions;
-	int cumulative_insertion_offset = 0;
-	bool text_changed_by_insertion = false;
-
-	if (!target_positions_for_newline.empty())
+	const TextBuffer &content = editor_state.fileContent;
+	std::vector<BatchEdit> edits;
+	for (const auto &sel_to_delete : selections_to_delete)
 	{
-		text_changed_by_insertion = true; // Will insert at least one newline
-		for (int base_pos : target_positions_for_newline) // Iterates in sorted order
-		{
-			int actual_insert_pos = base_pos + cumulative_insertion_offset;
-			// Clamp insert position, crucial if base_pos was from
-			// multi_cursor_indices which might be out of sync after deletions
-			actual_insert_pos =
-				std::max(0,
-						 std::min(actual_insert_pos,
-								  static_cast<int>(editor_state.fileContent.length())));
-
-			// Calculate indent based on the line at 'actual_insert_pos' in the
-			// *current* state of fileContent
-			std::string indent_str =
-				CalculateIndentForPosition(editor_state.fileContent, actual_insert_pos);
-			std::string to_insert = "\n" + indent_str;
-			size_t insert_length = to_insert.length();
-
-			editor_state.fileContent.insert(actual_insert_pos, to_insert);
-
-			ImVec4 default_color =
-				ImVec4(1.0f, 1.0f, 1.0f, 1.0f); // Or your editor's default
-			if (static_cast<size_t>(actual_insert_pos) <= editor_state.fileColors.size())
-			{
-				editor_state.fileColors.insert(editor_state.fileColors.begin() +
-												   actual_insert_pos,
-											   insert_length,
-											   default_color);
-			} else // Should ideally not happen if actual_insert_pos is clamped
-				   // correctly
-			{
-				for (size_t k = 0; k < insert_length; ++k)
-					editor_state.fileColors.push_back(default_color);
-			}
-
-			final_new_cursor_positions.push_back(actual_insert_pos + insert_length);
-			cumulative_insertion_offset += insert_length;
-		}
+		int start = sel_to_delete.start_index;
+		edits.push_back({start,
+						 sel_to_delete.end_index - start,
+						 "\n" + CalculateIndentForPosition(content, start)});
 	}
-
-	// --- Phase 3: Update Cursors and Editor State ---
-	if (!final_new_cursor_positions.empty())
-	{
-		editor_state.cursor_index = final_new_cursor_positions[0];
-		editor_state.multi_cursor_indices.assign(final_new_cursor_positions.begin() + 1,
-												 final_new_cursor_positions.end());
-	} else if (!target_positions_for_newline
-					.empty()) // Selections were deleted, but somehow no
-							  // newlines inserted (e.g., if CalculateIndent was
-							  // empty and newline char itself was omitted)
-	{
-		// Cursors should be at the points where deletions happened (or where
-		// they were if no deletions) target_positions_for_newline are already
-		// adjusted for deletions.
-		auto it = target_positions_for_newline.begin();
-		editor_state.cursor_index = *it;
-		editor_state.multi_cursor_indices.clear();
-		++it;
-		for (; it != target_positions_for_newline.end(); ++it)
-		{
-			editor_state.multi_cursor_indices.push_back(*it);
-		}
-	} else if (editor_state.fileContent.empty()) // Completely empty, cursor at 0
+	for (int base_pos : target_positions_for_newline)
 	{
-		editor_state.cursor_index = 0;
-		editor_state.multi_cursor_indices.clear();
+		std::string indent = CalculateIndentForPosition(content, base_pos);
+		edits.push_back({base_pos, 0, "\n" + indent});
 	}
-	// else: cursors remain as they were if no operations happened.
-
-	// Reset selection state
-	editor_state.selection_start = editor_state.selection_end = editor_state.cursor_index;
-	editor_state.selection_active = false;
-	editor_state.multi_selections.clear();
 
-	// Reset preferred columns
-	editor_state.cursor_column_prefered =
-		0; // Newline usually means new preferred col calculation
-	editor_state.multi_cursor_prefered_columns.assign(
-		editor_state.multi_cursor_indices.size(), 0);
-
-	if (text_changed_by_deletion || text_changed_by_insertion)
-	{
-		editor_state.text_changed = true;
-		gEditor.updateLineStarts();
-	}
+	gEditorMultiEdit.placeCursors(gEditorMultiEdit.apply(edits));
 }
 void EditorKeyboard::handleDeleteKey()
 {
@@ -799,10 +466,10 @@ void EditorKeyboard::handleDeleteKey()
 		}
 		for (int pos : unique_cursor_positions_for_delete)
 		{
-			std::string::iterator it = str_iter_at(editor_state.fileContent, pos);
+			TextBuffer::const_iterator it = str_iter_at(editor_state.fileContent, pos);
 			if (it == editor_state.fileContent.end())
 				continue;
-			std::string::iterator next = it;
+			TextBuffer::const_iterator next = it;
 			if (next != editor_state.fileContent.end())
 			{
 				utf8::unchecked::next(next);
@@ -811,118 +478,26 @@ void EditorKeyboard::handleDeleteKey()
 			ranges_to_delete.emplace_back(pos, end_pos);
 		}
 	}
-	std::sort(ranges_to_delete.begin(),
-			  ranges_to_delete.end(),
-			  [](const MultiSelectionRange &a, const MultiSelectionRange &b) {
-				  return a.start_index < b.start_index;
-			  });
-
-	std::vector<MultiSelectionRange> merged_ranges;
-	if (!ranges_to_delete.empty())
-	{
-		merged_ranges.push_back(ranges_to_delete[0]);
-		for (size_t i = 1; i < ranges_to_delete.size(); ++i)
-		{
-			MultiSelectionRange &last_merged = merged_ranges.back();
-			const MultiSelectionRange current_range = ranges_to_delete[i];
-
-			if (current_range.start_index <= last_merged.end_index)
-			{
-				last_merged.end_index =
-					std::max(last_merged.end_index, current_range.end_index);
-			} else
-			{
-				merged_ranges.push_back(current_range);
-			}
-		}
-	}
-
-	int total_chars_deleted_this_op = 0;
-	std::set<int> new_caret_positions;
-
-	if (!merged_ranges.empty())
+	std::vector<BatchEdit> edits;
+	edits.reserve(ranges_to_delete.size());
+	for (const auto &range : ranges_to_delete)
 	{
-		for (const auto &range : merged_ranges)
-		{
-			int effective_start = range.start_index - total_chars_deleted_this_op;
-			int effective_end = range.end_index - total_chars_deleted_this_op;
-
-			effective_start =
-				std::max(0,
-						 std::min(effective_start,
-								  static_cast<int>(editor_state.fileContent.size())));
-			effective_end =
-				std::max(effective_start,
-						 std::min(effective_end,
-								  static_cast<int>(editor_state.fileContent.size())));
-
-			int length_to_delete = effective_end - effective_start;
-
-			if (length_to_delete > 0)
-			{
-				editor_state.fileContent.erase(effective_start, length_to_delete);
-
-				if (static_cast<size_t>(effective_start) < editor_state.fileColors.size())
-				{
-					editor_state.fileColors.erase(
-						editor_state.fileColors.begin() + effective_start,
-						editor_state.fileColors.begin() +
-							std::min(static_cast<size_t>(effective_end),
-									 editor_state.fileColors.size()));
-				} else if (editor_state.fileContent.empty() &&
-						   !editor_state.fileColors.empty())
-				{
-					editor_state.fileColors.clear();
-				}
-				total_chars_deleted_this_op += length_to_delete;
-			}
-			new_caret_positions.insert(effective_start);
-		}
+		edits.push_back({range.start_index, range.end_index - range.start_index, ""});
 	}
 
-	if (total_chars_deleted_this_op > 0)
+	// One pass over the buffer and colors for all cursors
+	uint64_t version = editor_state.fileContent.version();
+	std::vector<int> new_caret_positions = gEditorMultiEdit.apply(edits);
+	if (editor_state.fileContent.version() != version || selections_were_active)
 	{
-		editor_state.text_changed = true;
-
-		editor_state.multi_cursor_indices.clear();
-
-		if (!new_caret_positions.empty())
-		{
-			editor_state.cursor_index = *new_caret_positions.begin();
-			auto it = new_caret_positions.begin();
-			++it;
-			for (; it != new_caret_positions.end(); ++it)
-			{
-				editor_state.multi_cursor_indices.push_back(*it);
-			}
-		} else
-		{
-			editor_state.cursor_index =
-				std::min(editor_state.cursor_index,
-						 static_cast<int>(editor_state.fileContent.size()));
-		}
-
-		editor_state.cursor_column_prefered = 0;
-		editor_state.multi_cursor_prefered_columns.assign(
-			editor_state.multi_cursor_indices.size(), 0);
-	} else if (selections_were_active && !new_caret_positions.empty())
+		gEditorMultiEdit.placeCursors(std::move(new_caret_positions));
+	} else
 	{
-		editor_state.multi_cursor_indices.clear();
-		editor_state.cursor_index = *new_caret_positions.begin();
-		auto it = new_caret_positions.begin();
-		++it;
-		for (; it != new_caret_positions.end(); ++it)
-		{
-			editor_state.multi_cursor_indices.push_back(*it);
-		}
-		editor_state.cursor_column_prefered = 0;
-		editor_state.multi_cursor_prefered_columns.assign(
-			editor_state.multi_cursor_indices.size(), 0);
+		editor_state.selection_start = editor_state.selection_end =
+			editor_state.cursor_index;
+		editor_state.selection_active = false;
+		editor_state.multi_selections.clear();
 	}
-
-	editor_state.selection_start = editor_state.selection_end = editor_state.cursor_index;
-	editor_state.selection_active = false;
-	editor_state.multi_selections.clear();
 }
 void EditorKeyboard::handleTextInput()
 {
@@ -941,8 +516,7 @@ void EditorKeyboard::handleTextInput()
 		int start = editor_state.selection_start;
 		int end = editor_state.selection_end;
 		editor_state.fileContent.erase(start, end - start);
-		editor_state.fileColors.erase(editor_state.fileColors.begin() + start,
-									  editor_state.fileColors.begin() + end);
+		editor_state.eraseColors(start, end - start);
 		editor_state.cursor_index = start;
 		editor_state.selection_start = editor_state.selection_end = start;
 		editor_state.text_changed = true;
@@ -1326,6 +900,9 @@ void EditorKeyboard::processUndoRedo()
 		editor_state.ensure_cursor_visible.vertical = true;
 		editor_state.ensure_cursor_visible.horizontal = true;
 
-		gFileExplorer.currentUndoManager->printStacks();
+		if (gFileExplorer.currentUndoManager)
+		{
+			gFileExplorer.currentUndoManager->printStacks();
+		}
 	}
 }
\ No newline at end of file
@@ -0,0 +1,263 @@
+/*
+	File: editor_lexer_lines.cpp
+	Description: Lexer state at each line start, so the hand-written lexers
+	relex only the lines an edit changed instead of the whole file.
+*/
+
+#include "editor_lexer_lines.h"
+
+#include <algorithm>
+#include <unordered_map>
+
+const LexerSyntax *LexerSyntax::forExtension(const std::string &extension)
+{
+	static const LexerSyntax cpp = {
+		{{"R\"(", ")\"", false}, {"/*", "*/", false}}, {"//"}, "\"'"};
+	static const LexerSyntax java = {
+		{{"\"\"\"", "\"\"\"", true}, {"/*", "*/", false}}, {"//"}, "\"'"};
+	static const LexerSyntax csharp = {
+		{{"@\"", "\"", false}, {"/*", "*/", false}}, {"//"}, "\"'"};
+	static const LexerSyntax script = {
+		{{"`", "`", true}, {"/*", "*/", false}}, {"//"}, "\"'"};
+	static const LexerSyntax python = {
+		{{"\"\"\"", "\"\"\"", true}, {"'''", "'''", true}}, {"#"}, "\"'"};
+	static const LexerSyntax css = {{{"/*", "*/", false}}, {}, "\"'"};
+	// Quotes in text are apostrophes as often as not, so none are tracked
+	static const LexerSyntax html = {{{"<!--", "-->", false},
+									  {"<script", "</script>", false},
+									  {"<style", "</style>", false}},
+									 {},
+									 ""};
+
+	// Same extensions as EditorHighlight::applyLexer
+	static const std::unordered_map<std::string, const LexerSyntax *> syntaxes = {
+		{".cpp", &cpp},
+		{".h", &cpp},
+		{".hpp", &cpp},
+		{".py", &python},
+		{".html", &html},
+		{".cshtml", &html},
+		{".js", &script},
+		{".jsx", &script},
+		{".tsx", &script},
+		{".ts", &script},
+		{".java", &java},
+		{".cs", &csharp},
+		{".css", &css}};
+
+	auto found = syntaxes.find(extension);
+	return found != syntaxes.end() ? found->second : nullptr;
+}
+
+bool LexerLines::update(const TextSnapshot &text,
+						uint64_t base_version,
+						const std::vector<TextEdit> *edits)
+{
+	bool same_document = !states.empty() && content.documentId() == text.documentId();
+	if (same_document && text.version() <= content.version())
+	{
+		// A pass that lost the race to a newer one
+		return text.version() == content.version();
+	}
+	if (!same_document || !edits || base_version != content.version() ||
+		edits->size() != text.version() - content.version())
+	{
+		reset(text);
+		return true;
+	}
+
+	// One range covering every edit, as in TreeSitter::coalesceEdits:
+	// [start, old_end) of the previous text became [start, new_end)
+	size_t start = 0;
+	size_t old_end = 0;
+	size_t new_end = 0;
+	for (size_t i = 0; i < edits->size(); ++i)
+	{
+		const TextEdit &edit = (*edits)[i];
+		size_t edit_end = edit.position + edit.removed_length;
+		if (i == 0)
+		{
+			start = edit.position;
+			old_end = edit_end;
+			new_end = edit.position + edit.inserted_length;
+			continue;
+		}
+		start = std::min(start, edit.position);
+		if (edit_end > new_end)
+		{
+			old_end += edit_end - new_end;
+		}
+		new_end =
+			std::max(new_end, edit_end) - edit.removed_length + edit.inserted_length;
+	}
+	if (old_end > content.size() || new_end > text.size())
+	{
+		reset(text);
+		return true;
+	}
+
+	// Lines first..last_old became first..last_new. The state at the start
+	// of first depends only on the text before it, so it stays.
+	size_t first = content.lineFromOffset(start);
+	size_t last_old = content.lineFromOffset(old_end);
+	size_t last_new = text.lineFromOffset(new_end);
+	states.erase(states.begin() + first + 1, states.begin() + last_old + 1);
+	states.insert(states.begin() + first + 1, last_new - first, UNKNOWN);
+	content = text;
+	if (states.size() != text.lineFromOffset(text.size()) + 1)
+	{
+		reset(text);
+		return true;
+	}
+
+	auto map = [&](size_t line) {
+		if (line <= first)
+		{
+			return line;
+		}
+		return line > last_old ? line - last_old + last_new : last_new;
+	};
+	if (dirty_from == NONE)
+	{
+		dirty_from = first;
+		dirty_to = last_new;
+	} else
+	{
+		dirty_from = std::min(map(dirty_from), first);
+		dirty_to = std::max(map(dirty_to), last_new);
+	}
+	return true;
+}
+
+void LexerLines::reset(const TextSnapshot &text)
+{
+	content = text;
+	states.assign(text.lineFromOffset(text.size()) + 1, UNKNOWN);
+	states[0] = NORMAL;
+	dirty_from = 0;
+	dirty_to = states.size() - 1;
+}
+
+size_t LexerLines::lineEnd(size_t line) const
+{
+	return line + 1 < lineCount() ? content.lineStart(line + 1) : content.size();
+}
+
+bool LexerLines::relex(const LexerSyntax &syntax, const LexChunk &lex)
+{
+	if (dirty_from == NONE)
+	{
+		return true;
+	}
+
+	// The lexers start outside any construct, so begin at such a line
+	size_t line = dirty_from;
+	while (line > 0 && states[line] != NORMAL)
+	{
+		--line;
+	}
+
+	size_t chunk_line = line;
+	std::string chunk;
+	std::vector<uint8_t> scanned; // new states of the lines after chunk_line
+	uint8_t state = NORMAL;
+	while (true)
+	{
+		size_t start = content.lineStart(line);
+		std::string text = content.substr(start, lineEnd(line) - start);
+		state = scanLine(syntax, text, state);
+		chunk += text;
+
+		// Past the edits, a line that starts in the state it had before
+		// lexes as it did before, and so does everything after it
+		size_t next = line + 1;
+		bool done = next >= lineCount() || (next > dirty_to && states[next] == state);
+		if (!done)
+		{
+			scanned.push_back(state);
+		}
+
+		if (done || (state == NORMAL && chunk.size() >= CHUNK_BYTES))
+		{
+			// States are stored only with their colors, so a chunk that was
+			// not colored is compared against the old ones next time
+			if (!lex(content.lineStart(chunk_line), chunk))
+			{
+				return false;
+			}
+			std::copy(scanned.begin(), scanned.end(), states.begin() + chunk_line + 1);
+			if (done)
+			{
+				dirty_from = NONE;
+				return true;
+			}
+			// next has its new state now, which differs from what the
+			// lines after it were lexed with
+			dirty_from = chunk_line = next;
+			dirty_to = std::max(dirty_to, next);
+			chunk.clear();
+			scanned.clear();
+		}
+		line = next;
+	}
+}
+
+uint8_t
+LexerLines::scanLine(const LexerSyntax &syntax, std::string_view line, uint8_t state)
+{
+	auto at = [&line](size_t i, std::string_view token) {
+		return line.compare(i, token.size(), token) == 0;
+	};
+
+	size_t i = 0;
+	while (i < line.size())
+	{
+		if (state != NORMAL)
+		{
+			const LexerSyntax::Block &block = syntax.blocks[state - 1];
+			if (block.escapes && line[i] == '\\')
+			{
+				i += 2;
+			} else if (at(i, block.close))
+			{
+				i += block.close.size();
+				state = NORMAL;
+			} else
+			{
+				++i;
+			}
+			continue;
+		}
+
+		auto block = std::find_if(
+			syntax.blocks.begin(), syntax.blocks.end(), [&](const LexerSyntax::Block &b) {
+				return at(i, b.open);
+			});
+		if (block != syntax.blocks.end())
+		{
+			state = static_cast<uint8_t>(block - syntax.blocks.begin() + 1);
+			i += block->open.size();
+			continue;
+		}
+		for (std::string_view comment : syntax.line_comments)
+		{
+			if (at(i, comment))
+			{
+				return NORMAL;
+			}
+		}
+		if (syntax.quotes.find(line[i]) != std::string_view::npos)
+		{
+			char quote = line[i];
+			for (++i; i < line.size() && line[i] != quote; ++i)
+			{
+				if (line[i] == '\\')
+				{
+					++i;
+				}
+			}
+		}
+		++i;
+	}
+	return state;
+}
@@ -0,0 +1,88 @@
+/*
+	File: editor_lexer_lines.h
+	Description: Lexer state at each line start, so the hand-written lexers
+	relex only the lines an edit changed instead of the whole file.
+
+	The state at a line start is the multi-line construct it falls in, such
+	as a block comment, a template literal or a script element, and is found
+	by a small scanner per language rather than by the lexers themselves.
+	Lexing restarts at the nearest line before an edit that is outside any
+	construct, where the lexers can start from scratch, and stops at the
+	first line after it whose state matches the one stored from the last
+	run: from there on the text lexes as it did before.
+*/
+
+#pragma once
+#include "editor_buffer.h"
+
+#include <cstddef>
+#include <cstdint>
+#include <functional>
+#include <string>
+#include <string_view>
+#include <vector>
+
+// The constructs of a language that can span lines, and the ones that can
+// hide their delimiters on a single line.
+struct LexerSyntax
+{
+	struct Block
+	{
+		std::string_view open;
+		std::string_view close;
+		bool escapes; // a backslash escapes the next char inside
+	};
+
+	// Checked first and in order, so a triple quote wins over a quote
+	std::vector<Block> blocks;
+	// Run to the end of the line
+	std::vector<std::string_view> line_comments;
+	// Strings that end with the line at the latest
+	std::string_view quotes;
+
+	// Syntax for the lexer of extension, nullptr when there is no lexer.
+	static const LexerSyntax *forExtension(const std::string &extension);
+};
+
+class LexerLines
+{
+  public:
+	// Colors code, the text at start; false stops the relex with the rest
+	// left for the next one.
+	using LexChunk = std::function<bool(size_t start, const std::string &code)>;
+
+	// Brings the line states in step with text, which must have its lines
+	// counted. edits lead from the text of the last update at base_version
+	// to text; without them, or when they do not, every line is lexed again.
+	// False when text is older than the last text, which is then kept.
+	bool update(const TextSnapshot &text,
+				uint64_t base_version,
+				const std::vector<TextEdit> *edits);
+
+	// Lexes the lines that changed, a chunk at a time, until the states agree
+	// with the stored ones again. True once nothing is left.
+	bool relex(const LexerSyntax &syntax, const LexChunk &lex);
+
+  private:
+	static constexpr uint8_t NORMAL = 0;
+	static constexpr uint8_t UNKNOWN = 0xFF; // never equal to a scanned state
+	static constexpr size_t NONE = SIZE_MAX;
+	// Lines are handed to the lexer in chunks of about this size, each
+	// starting outside any construct
+	static constexpr size_t CHUNK_BYTES = 64 * 1024;
+
+	void reset(const TextSnapshot &text);
+	size_t lineCount() const { return states.size(); }
+	size_t lineEnd(size_t line) const;
+	static uint8_t
+	scanLine(const LexerSyntax &syntax, std::string_view line, uint8_t state);
+
+	// The text the states belong to
+	TextSnapshot content;
+	// State at each line start: NORMAL, or 1 + index of the open block
+	std::vector<uint8_t> states;
+	// Lines dirty_from..dirty_to changed since they were lexed; dirty_from
+	// has a valid state and is NONE when everything is lexed
+	size_t dirty_from = NONE;
+	size_t dirty_to = 0;
+};
@@ -0,0 +1,346 @@
+/*
+	File: editor_line_chunks.h
+	Description: Per-line entries that follow the line index through edits,
+	with a summary of every range, for the caches kept per line.
+
+	Laid out like LineIndex: entries sit in chunks of up to MAX_CHUNK_LINES,
+	the nodes of a treap ordered by position, and each node keeps the
+	Summary of its subtree. splice() rebuilds only the chunks holding the
+	replaced lines, so adding or removing lines is O(log n) plus a chunk,
+	and prefix() and find() answer for the whole document along one path.
+
+	Summary is a default constructible value with
+		static Summary of(const Entry &entry);
+		void add(const Summary &later); // appends the summary of later lines
+*/
+
+#pragma once
+#include <algorithm>
+#include <cstddef>
+#include <cstdint>
+#include <iterator>
+#include <memory>
+#include <utility>
+#include <vector>
+
+template <typename Entry, typename Summary> class LineChunks
+{
+  public:
+	size_t size() const { return linesOf(root); }
+	bool empty() const { return !root; }
+
+	const Entry &operator[](size_t line) const
+	{
+		const Chunk *node = root.get();
+		while (true)
+		{
+			size_t left_lines = linesOf(node->left);
+			if (line < left_lines)
+			{
+				node = node->left.get();
+				continue;
+			}
+			line -= left_lines;
+			if (line < node->entries.size())
+			{
+				return node->entries[line];
+			}
+			line -= node->entries.size();
+			node = node->right.get();
+		}
+	}
+
+	Summary total() const { return root ? root->subtree : Summary(); }
+
+	// Summary of the first count lines.
+	Summary prefix(size_t count) const
+	{
+		Summary sum;
+		const Chunk *node = root.get();
+		while (node && count > 0)
+		{
+			size_t left_lines = linesOf(node->left);
+			if (count <= left_lines)
+			{
+				node = node->left.get();
+				continue;
+			}
+			if (node->left)
+			{
+				sum.add(node->left->subtree);
+			}
+			count -= left_lines;
+			size_t taken = std::min(count, node->entries.size());
+			if (taken == node->entries.size())
+			{
+				sum.add(node->summary);
+			} else
+			{
+				for (size_t i = 0; i < taken; ++i)
+				{
+					sum.add(Summary::of(node->entries[i]));
+				}
+			}
+			count -= taken;
+			node = node->right.get();
+		}
+		return sum;
+	}
+
+	// First line whose prefix summary, that line included, is reached;
+	// size() if there is none. Once reached, later prefixes must be too.
+	template <typename Reached> size_t find(Reached &&reached) const
+	{
+		Summary sum;
+		size_t line = 0;
+		const Chunk *node = root.get();
+		while (node)
+		{
+			if (node->left)
+			{
+				Summary with_left = sum;
+				with_left.add(node->left->subtree);
+				if (reached(with_left))
+				{
+					node = node->left.get();
+					continue;
+				}
+				sum = with_left;
+				line += node->left->subtree_lines;
+			}
+			Summary with_chunk = sum;
+			with_chunk.add(node->summary);
+			if (reached(with_chunk))
+			{
+				for (const Entry &entry : node->entries)
+				{
+					sum.add(Summary::of(entry));
+					if (reached(sum))
+					{
+						return line;
+					}
+					++line;
+				}
+			}
+			sum = with_chunk;
+			line += node->entries.size();
+			node = node->right.get();
+		}
+		return line;
+	}
+
+	// removed lines starting at first are replaced by inserted default
+	// constructed entries.
+	void splice(size_t first, size_t removed, size_t inserted)
+	{
+		first = std::min(first, size());
+		removed = std::min(removed, size() - first);
+		if (removed == 0 && inserted == 0)
+		{
+			return;
+		}
+
+		// Take out the whole chunks holding the replaced lines, or the one
+		// lines are inserted into. When little of them would be left, the
+		// next chunk joins in, so removing lines does not leave slivers.
+		size_t begin = first;
+		size_t end = first + removed;
+		if (root)
+		{
+			size_t last = removed ? first + removed - 1 : std::min(first, size() - 1);
+			begin = chunkAround(std::min(first, size() - 1)).first;
+			end = std::max(end, chunkAround(last).second);
+			if (end < size() && end - begin - removed + inserted < MAX_CHUNK_LINES / 2)
+			{
+				end = chunkAround(end).second;
+			}
+		}
+
+		auto [head, rest] = split(std::move(root), begin);
+		auto [middle, tail] = split(std::move(rest), end - begin);
+
+		std::vector<Entry> rebuilt;
+		rebuilt.reserve(end - begin - removed + inserted);
+		takeEntries(middle.get(), rebuilt);
+		rebuilt.erase(rebuilt.begin() + (first - begin),
+					  rebuilt.begin() + (first - begin + removed));
+		rebuilt.insert(rebuilt.begin() + (first - begin), inserted, Entry());
+		root = merge(merge(std::move(head), makeChunks(rebuilt)), std::move(tail));
+	}
+
+	// Calls change(line, entry) for the lines in [begin, end) and brings the
+	// summaries up to date.
+	template <typename Change> void modify(size_t begin, size_t end, Change &&change)
+	{
+		modifyIn(root.get(), 0, begin, std::min(end, size()), change);
+	}
+
+  private:
+	// Smaller than the chunks of LineIndex, as a summary of part of a chunk
+	// is added up entry by entry
+	static constexpr size_t MAX_CHUNK_LINES = 64;
+
+	struct Chunk
+	{
+		std::vector<Entry> entries;
+		Summary summary;
+		Summary subtree;
+		size_t subtree_lines = 0;
+		uint32_t priority = 0;
+		std::unique_ptr<Chunk> left;
+		std::unique_ptr<Chunk> right;
+	};
+	using ChunkPtr = std::unique_ptr<Chunk>;
+
+	static size_t linesOf(const ChunkPtr &node) { return node ? node->subtree_lines : 0; }
+
+	static void summarize(Chunk *node)
+	{
+		node->summary = Summary();
+		for (const Entry &entry : node->entries)
+		{
+			node->summary.add(Summary::of(entry));
+		}
+	}
+
+	static void update(Chunk *node)
+	{
+		node->subtree_lines =
+			linesOf(node->left) + node->entries.size() + linesOf(node->right);
+		node->subtree = node->left ? node->left->subtree : Summary();
+		node->subtree.add(node->summary);
+		if (node->right)
+		{
+			node->subtree.add(node->right->subtree);
+		}
+	}
+
+	static ChunkPtr merge(ChunkPtr a, ChunkPtr b)
+	{
+		if (!a)
+			return b;
+		if (!b)
+			return a;
+
+		if (a->priority > b->priority)
+		{
+			a->right = merge(std::move(a->right), std::move(b));
+			update(a.get());
+			return a;
+		}
+		b->left = merge(std::move(a), std::move(b->left));
+		update(b.get());
+		return b;
+	}
+
+	// Splits off the chunks that end within the first lines, as
+	// LineIndex::split does.
+	static std::pair<ChunkPtr, ChunkPtr> split(ChunkPtr node, size_t lines)
+	{
+		if (!node)
+		{
+			return {nullptr, nullptr};
+		}
+
+		size_t through = linesOf(node->left) + node->entries.size();
+		if (lines >= through)
+		{
+			auto [a, b] = split(std::move(node->right), lines - through);
+			node->right = std::move(a);
+			update(node.get());
+			return {std::move(node), std::move(b)};
+		}
+		auto [a, b] = split(std::move(node->left), lines);
+		node->left = std::move(b);
+		update(node.get());
+		return {std::move(a), std::move(node)};
+	}
+
+	static void takeEntries(Chunk *node, std::vector<Entry> &out)
+	{
+		if (!node)
+		{
+			return;
+		}
+		takeEntries(node->left.get(), out);
+		std::move(node->entries.begin(), node->entries.end(), std::back_inserter(out));
+		takeEntries(node->right.get(), out);
+	}
+
+	template <typename Change>
+	static void modifyIn(Chunk *node, size_t base, size_t begin, size_t end, Change &change)
+	{
+		if (!node || begin >= end || end <= base || begin >= base + node->subtree_lines)
+		{
+			return;
+		}
+		modifyIn(node->left.get(), base, begin, end, change);
+		size_t own = base + linesOf(node->left);
+		size_t from = std::max(begin, own);
+		size_t to = std::min(end, own + node->entries.size());
+		if (from < to)
+		{
+			for (size_t line = from; line < to; ++line)
+			{
+				change(line, node->entries[line - own]);
+			}
+			summarize(node);
+		}
+		modifyIn(node->right.get(), own + node->entries.size(), begin, end, change);
+		update(node);
+	}
+
+	// First line of the chunk holding line, and the line after that chunk
+	std::pair<size_t, size_t> chunkAround(size_t line) const
+	{
+		size_t first = 0;
+		const Chunk *node = root.get();
+		while (true)
+		{
+			size_t left_lines = linesOf(node->left);
+			if (line < left_lines)
+			{
+				node = node->left.get();
+				continue;
+			}
+			line -= left_lines;
+			first += left_lines;
+			if (line < node->entries.size())
+			{
+				return {first, first + node->entries.size()};
+			}
+			line -= node->entries.size();
+			first += node->entries.size();
+			node = node->right.get();
+		}
+	}
+
+	ChunkPtr makeChunks(std::vector<Entry> &entries)
+	{
+		// Evenly filled, so a rebuilt run does not end in a sliver of a chunk
+		size_t count = (entries.size() + MAX_CHUNK_LINES - 1) / MAX_CHUNK_LINES;
+		ChunkPtr result;
+		size_t line = 0;
+		for (size_t i = 0; i < count; ++i)
+		{
+			// xorshift32, as for the pieces of TextBuffer
+			rng_state ^= rng_state << 13;
+			rng_state ^= rng_state >> 17;
+			rng_state ^= rng_state << 5;
+
+			ChunkPtr node = std::make_unique<Chunk>();
+			size_t end = entries.size() * (i + 1) / count;
+			node->entries.assign(std::make_move_iterator(entries.begin() + line),
+								 std::make_move_iterator(entries.begin() + end));
+			line = end;
+			node->priority = rng_state;
+			summarize(node.get());
+			update(node.get());
+			result = merge(std::move(result), std::move(node));
+		}
+		return result;
+	}
+
+	ChunkPtr root;
+	uint32_t rng_state = 0x9E3779B9u;
+};
@@ -0,0 +1,343 @@
+/*
+	File: editor_line_index.cpp
+	Description: Line start index for EditorState::editor_content_lines.
+*/
+
+#include "editor_line_index.h"
+
+#include <algorithm>
+
+LineIndex::LineIndex() { root = makeChunks({0}); }
+
+void LineIndex::update(Chunk *node)
+{
+	node->subtree_lines = linesOf(node->left) + node->starts.size() + linesOf(node->right);
+	node->subtree_bytes = bytesOf(node->left) + node->bytes + bytesOf(node->right);
+}
+
+LineIndex::ChunkPtr LineIndex::merge(ChunkPtr a, ChunkPtr b)
+{
+	if (!a)
+		return b;
+	if (!b)
+		return a;
+
+	if (a->priority > b->priority)
+	{
+		a->right = merge(std::move(a->right), std::move(b));
+		update(a.get());
+		return a;
+	}
+	b->left = merge(std::move(a), std::move(b->left));
+	update(b.get());
+	return b;
+}
+
+std::pair<LineIndex::ChunkPtr, LineIndex::ChunkPtr> LineIndex::split(ChunkPtr node,
+																	 size_t lines)
+{
+	if (!node)
+	{
+		return {nullptr, nullptr};
+	}
+
+	size_t through = linesOf(node->left) + node->starts.size();
+	if (lines >= through)
+	{
+		auto [a, b] = split(std::move(node->right), lines - through);
+		node->right = std::move(a);
+		update(node.get());
+		return {std::move(node), std::move(b)};
+	}
+	auto [a, b] = split(std::move(node->left), lines);
+	node->left = std::move(b);
+	update(node.get());
+	return {std::move(a), std::move(node)};
+}
+
+void LineIndex::collectLengths(const Chunk *node, std::vector<size_t> &out)
+{
+	if (!node)
+	{
+		return;
+	}
+	collectLengths(node->left.get(), out);
+	for (size_t i = 0; i < node->starts.size(); ++i)
+	{
+		size_t end = i + 1 < node->starts.size() ? node->starts[i + 1] : node->bytes;
+		out.push_back(end - node->starts[i]);
+	}
+	collectLengths(node->right.get(), out);
+}
+
+LineIndex::ChunkPtr LineIndex::makeChunks(const std::vector<size_t> &lengths)
+{
+	// Evenly filled, so a rebuilt run does not end in a sliver of a chunk
+	size_t count = (lengths.size() + MAX_CHUNK_LINES - 1) / MAX_CHUNK_LINES;
+	ChunkPtr result;
+	size_t line = 0;
+	for (size_t i = 0; i < count; ++i)
+	{
+		// xorshift32, as for the pieces of TextBuffer
+		rng_state ^= rng_state << 13;
+		rng_state ^= rng_state >> 17;
+		rng_state ^= rng_state << 5;
+
+		ChunkPtr node = std::make_unique<Chunk>();
+		size_t end = lengths.size() * (i + 1) / count;
+		node->starts.reserve(end - line);
+		for (; line < end; ++line)
+		{
+			node->starts.push_back(node->bytes);
+			node->bytes += lengths[line];
+		}
+		node->priority = rng_state;
+		update(node.get());
+		result = merge(std::move(result), std::move(node));
+	}
+	return result;
+}
+
+const LineIndex::Chunk *LineIndex::findLine(size_t &line, size_t &bytes) const
+{
+	bytes = 0;
+	const Chunk *node = root.get();
+	while (node)
+	{
+		size_t left_lines = linesOf(node->left);
+		if (line < left_lines)
+		{
+			node = node->left.get();
+			continue;
+		}
+		line -= left_lines;
+		bytes += bytesOf(node->left);
+		if (line < node->starts.size())
+		{
+			return node;
+		}
+		line -= node->starts.size();
+		bytes += node->bytes;
+		node = node->right.get();
+	}
+	return nullptr;
+}
+
+std::pair<size_t, size_t> LineIndex::chunkAround(size_t line) const
+{
+	size_t index = line;
+	size_t bytes = 0;
+	const Chunk *chunk = findLine(index, bytes);
+	size_t first = line - index;
+	return {first, first + chunk->starts.size()};
+}
+
+size_t LineIndex::prefix(size_t count) const
+{
+	size_t bytes = 0;
+	const Chunk *chunk = findLine(count, bytes);
+	return chunk ? bytes + chunk->starts[count] : bytesOf(root);
+}
+
+size_t LineIndex::lineLength(size_t line) const
+{
+	size_t bytes = 0;
+	const Chunk *chunk = findLine(line, bytes);
+	size_t end = line + 1 < chunk->starts.size() ? chunk->starts[line + 1] : chunk->bytes;
+	return end - chunk->starts[line];
+}
+
+size_t LineIndex::lineFromOffset(size_t offset) const
+{
+	// Walk down to the chunk holding offset, then find the last line in it
+	// that starts at or before offset.
+	size_t line = 0;
+	const Chunk *node = root.get();
+	while (node)
+	{
+		size_t left_bytes = bytesOf(node->left);
+		if (offset < left_bytes)
+		{
+			node = node->left.get();
+			continue;
+		}
+		offset -= left_bytes;
+		line += linesOf(node->left);
+		if (offset < node->bytes)
+		{
+			auto next = std::upper_bound(node->starts.begin(), node->starts.end(), offset);
+			return line + (next - node->starts.begin()) - 1;
+		}
+		offset -= node->bytes;
+		line += node->starts.size();
+		node = node->right.get();
+	}
+	return size() - 1;
+}
+
+void LineIndex::replace(size_t first, size_t removed, const std::vector<size_t> &lengths)
+{
+	// Take out the whole chunks holding the replaced lines. When little of
+	// them would be left, the next chunk joins in, so deleting lines does
+	// not leave slivers behind.
+	size_t begin = chunkAround(first).first;
+	size_t end = chunkAround(first + removed - 1).second;
+	if (end < size() &&
+		end - begin - removed + lengths.size() < MAX_CHUNK_LINES / 2)
+	{
+		end = chunkAround(end).second;
+	}
+
+	auto [head, rest] = split(std::move(root), begin);
+	auto [middle, tail] = split(std::move(rest), end - begin);
+
+	std::vector<size_t> rebuilt;
+	rebuilt.reserve(end - begin - removed + lengths.size());
+	collectLengths(middle.get(), rebuilt);
+	rebuilt.erase(rebuilt.begin() + (first - begin),
+				  rebuilt.begin() + (first - begin + removed));
+	rebuilt.insert(rebuilt.begin() + (first - begin), lengths.begin(), lengths.end());
+	root = merge(merge(std::move(head), makeChunks(rebuilt)), std::move(tail));
+}
+
+size_t LineIndex::splitLines(const TextBuffer &buffer,
+							 size_t line_start,
+							 size_t scan_from,
+							 size_t scan_end,
+							 std::vector<size_t> &out)
+{
+	size_t chunk_pos = scan_from;
+	buffer.forEachChunk(scan_from, scan_end - scan_from, [&](std::string_view chunk) {
+		for (size_t newline = chunk.find('\n'); newline != std::string_view::npos;
+			 newline = chunk.find('\n', newline + 1))
+		{
+			size_t line_end = chunk_pos + newline + 1;
+			out.push_back(line_end - line_start);
+			line_start = line_end;
+		}
+		chunk_pos += chunk.size();
+		return true;
+	});
+	return line_start;
+}
+
+LineIndex::Change LineIndex::rebuild(const TextBuffer &buffer)
+{
+	// Start out with the whole document as one unscanned line and split the
+	// first chunk of it; documents smaller than a chunk are done right away.
+	root = makeChunks({buffer.size()});
+	tail_pending = true;
+	tail_scanned = 0;
+	scanTail(buffer);
+
+	Change change;
+	change.rebuilt = true;
+	change.removed_lines = change.inserted_lines = size();
+	return change;
+}
+
+LineIndex::Change LineIndex::scanTail(const TextBuffer &buffer)
+{
+	size_t last = size() - 1;
+	size_t line_start = prefix(last);
+	size_t end = line_start + lineLength(last);
+	size_t scan_from = line_start + tail_scanned;
+	size_t scan_end = std::min(end, scan_from + SCAN_CHUNK_BYTES);
+
+	scanned_lines.clear();
+	size_t rest = splitLines(buffer, line_start, scan_from, scan_end, scanned_lines);
+	tail_pending = scan_end < end;
+	tail_scanned = scan_end - rest;
+
+	// Without a newline in this chunk the lines stay the same; the finished
+	// tail is still reported once so its width gets measured.
+	Change change;
+	change.first_line = last;
+	change.removed_lines = change.inserted_lines = tail_pending ? 0 : 1;
+	if (scanned_lines.empty())
+	{
+		return change;
+	}
+
+	scanned_lines.push_back(end - rest);
+	replace(last, 1, scanned_lines);
+	change.removed_lines = 1;
+	change.inserted_lines = scanned_lines.size();
+	return change;
+}
+
+LineIndex::Change LineIndex::update(const TextBuffer &buffer)
+{
+	Change change;
+	if (buffer.documentId() == synced_document && buffer.version() == synced_version)
+	{
+		return tail_pending ? scanTail(buffer) : change;
+	}
+
+	bool incremental = buffer.documentId() == synced_document &&
+					   buffer.editsSince(synced_version, pending_edits);
+	synced_document = buffer.documentId();
+	synced_version = buffer.version();
+	if (!incremental)
+	{
+		return rebuild(buffer);
+	}
+
+	// Merge the edits into one dirty range [start, new_end) of the current
+	// text. Everything before start is untouched and everything after it is
+	// only shifted, so the old range ends at new_end minus the size change.
+	size_t start = TextBuffer::npos;
+	size_t new_end = 0;
+	size_t grown = 0;
+	size_t shrunk = 0;
+	for (const TextEdit &edit : pending_edits)
+	{
+		size_t edit_end = edit.position + edit.inserted_length;
+		if (start == TextBuffer::npos)
+		{
+			start = edit.position;
+			new_end = edit_end;
+		} else
+		{
+			if (new_end >= edit.position + edit.removed_length)
+			{
+				new_end = new_end - edit.removed_length + edit.inserted_length;
+			} else if (new_end > edit.position)
+			{
+				new_end = edit_end;
+			}
+			start = std::min(start, edit.position);
+			new_end = std::max(new_end, edit_end);
+		}
+		grown += edit.inserted_length;
+		shrunk += edit.removed_length;
+	}
+	size_t old_end = new_end + shrunk - grown;
+
+	// Replace the whole lines covering the dirty range.
+	size_t first = lineFromOffset(start);
+	size_t last = lineFromOffset(old_end);
+	size_t span_start = prefix(first);
+	size_t span_end = prefix(last + 1) + grown - shrunk;
+
+	// Elsewhere the span ends right after a newline, but the last line runs to
+	// the end of the document. If that is the unscanned tail, only split it up
+	// to the end of the edits and leave the rest pending.
+	bool ends_document = last + 1 == size();
+	size_t scan_end = ends_document && tail_pending ? new_end : span_end;
+
+	std::vector<size_t> new_lengths;
+	size_t rest = splitLines(buffer, span_start, span_start, scan_end, new_lengths);
+	if (ends_document)
+	{
+		new_lengths.push_back(span_end - rest);
+		tail_pending = scan_end < span_end;
+		tail_scanned = scan_end - rest;
+	}
+
+	change.first_line = first;
+	change.removed_lines = last - first + 1;
+	change.inserted_lines = new_lengths.size();
+	replace(first, change.removed_lines, new_lengths);
+	return change;
+}
@@ -0,0 +1,122 @@
+/*
+	File: editor_line_index.h
+	Description: Line start index for EditorState::editor_content_lines.
+
+	Lines are kept in chunks of up to MAX_CHUNK_LINES, the nodes of a treap
+	ordered by position like the pieces of TextBuffer. Each node sums up
+	the lines and bytes below it, so line -> offset and offset -> line walk
+	down one path and then into one chunk, and replacing lines rebuilds only
+	the chunks that hold them: O(log n) per edit, newlines included.
+	update() replays the edits the TextBuffer logged since the last sync and
+	re-splits only the lines they touched; a full rescan only happens when a
+	new document is loaded.
+
+	That rescan is spread over several update() calls for large documents:
+	each call splits at most SCAN_CHUNK_BYTES more, and until the end is
+	reached the last line holds the whole unscanned rest of the document.
+*/
+
+#pragma once
+#include "editor_buffer.h"
+
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+#include <utility>
+#include <vector>
+
+class LineIndex
+{
+  public:
+	// Lines replaced by the last update(): removed_lines lines starting at
+	// first_line became inserted_lines lines.
+	struct Change
+	{
+		size_t first_line = 0;
+		size_t removed_lines = 0;
+		size_t inserted_lines = 0;
+		bool rebuilt = false;
+	};
+
+	LineIndex();
+
+	// Brings the index in sync with buffer and reports which lines changed.
+	// Called every frame; keeps scanning a partially indexed document.
+	Change update(const TextBuffer &buffer);
+
+	// False while the last line is still the unscanned rest of a document.
+	bool complete() const { return !tail_pending; }
+
+	size_t size() const { return linesOf(root); }
+	bool empty() const { return size() == 0; }
+
+	// Offset of the first char of line, same as the old flat vector entry.
+	int operator[](size_t line) const { return static_cast<int>(prefix(line)); }
+	int back() const { return (*this)[size() - 1]; }
+
+	// Bytes in line, including its trailing newline.
+	size_t lineLength(size_t line) const;
+
+	// Line that contains offset; offsets past the end map to the last line.
+	size_t lineFromOffset(size_t offset) const;
+
+  private:
+	static constexpr size_t SCAN_CHUNK_BYTES = 16 * 1024 * 1024;
+	static constexpr size_t MAX_CHUNK_LINES = 512;
+
+	struct Chunk
+	{
+		std::vector<size_t> starts; // of each line, from the chunk start
+		size_t bytes = 0;
+		uint32_t priority = 0;
+		size_t subtree_lines = 0;
+		size_t subtree_bytes = 0;
+		std::unique_ptr<Chunk> left;
+		std::unique_ptr<Chunk> right;
+	};
+	using ChunkPtr = std::unique_ptr<Chunk>;
+
+	static size_t linesOf(const ChunkPtr &node)
+	{
+		return node ? node->subtree_lines : 0;
+	}
+	static size_t bytesOf(const ChunkPtr &node)
+	{
+		return node ? node->subtree_bytes : 0;
+	}
+	static void update(Chunk *node);
+	static ChunkPtr merge(ChunkPtr a, ChunkPtr b);
+	// Splits off the chunks that end within the first lines; the chunk
+	// that line is in, if it is not the first of its chunk, goes right.
+	static std::pair<ChunkPtr, ChunkPtr> split(ChunkPtr node, size_t lines);
+	static void collectLengths(const Chunk *node, std::vector<size_t> &out);
+	// Chunk holding line; line becomes its index there and bytes the offset
+	// of the chunk.
+	const Chunk *findLine(size_t &line, size_t &bytes) const;
+	// First line of the chunk holding line, and the line after that chunk
+	std::pair<size_t, size_t> chunkAround(size_t line) const;
+	ChunkPtr makeChunks(const std::vector<size_t> &lengths);
+
+	Change rebuild(const TextBuffer &buffer);
+	Change scanTail(const TextBuffer &buffer);
+	size_t prefix(size_t count) const;
+	// Replaces removed lines starting at first, at least one, with lines of
+	// the given lengths.
+	void replace(size_t first, size_t removed, const std::vector<size_t> &lengths);
+	// Appends the lengths of the lines that start at line_start and end in
+	// [scan_from, scan_end), and returns where the unterminated rest begins.
+	static size_t splitLines(const TextBuffer &buffer,
+							 size_t line_start,
+							 size_t scan_from,
+							 size_t scan_end,
+							 std::vector<size_t> &out);
+
+	ChunkPtr root;
+	uint32_t rng_state = 0x9E3779B9u;
+	uint64_t synced_document = 0;
+	uint64_t synced_version = UINT64_MAX;
+	std::vector<TextEdit> pending_edits;
+	std::vector<size_t> scanned_lines;
+	bool tail_pending = false;
+	size_t tail_scanned = 0; // bytes at the start of the tail known to hold no newline
+};
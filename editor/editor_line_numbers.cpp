@@ -19,15 +19,17 @@ void EditorLineNumbers::renderLineNumbers()
 	static char line_number_buffer[LINE_NUMBER_BUFFER_SIZE];
 	ImDrawList *draw_list = ImGui::GetWindowDrawList();
 
-	// Calculate visible line range
-	int start_line =
+	// Calculate visible line range from the visible rows; a wrapped line is
+	// numbered on its first row only
+	int start_row =
 		static_cast<int>(gEditorScroll.getScrollPosition().y / editor_state.line_height);
+	int end_row = static_cast<int>(
+		(gEditorScroll.getScrollPosition().y +
+		 (editor_state.size.y - editor_state.editor_top_margin)) /
+		editor_state.line_height);
+	int start_line = static_cast<int>(gEditorWrap.lineAtRow(start_row));
 	int end_line = std::min(static_cast<int>(editor_state.editor_content_lines.size()),
-							static_cast<int>(
-								(gEditorScroll.getScrollPosition().y +
-								 (editor_state.size.y - editor_state.editor_top_margin)) /
-								editor_state.line_height) +
-								1);
+							static_cast<int>(gEditorWrap.lineAtRow(end_row)) + 1);
 
 	// Pre-calculate rainbow color if needed
 	bool rainbow_mode = gSettings.getRainbowMode();
@@ -56,7 +58,8 @@ void EditorLineNumbers::renderLineNumbers()
 	for (int i = start_line; i < end_line; i++)
 	{
 		// Calculate vertical position
-		float y_pos = editor_state.line_numbers_pos.y + (i * editor_state.line_height) -
+		float y_pos = editor_state.line_numbers_pos.y +
+					  (gEditorWrap.firstRow(i) * editor_state.line_height) -
 					  gEditorScroll.getScrollPosition().y;
 
 		// Format line number text
@@ -215,14 +218,13 @@ void EditorLineNumbers::calculateSelectionLines(int &selection_start_line,
 	int selection_end =
 		std::max(editor_state.selection_start, editor_state.selection_end);
 
-	// Convert character positions to line indices
-	selection_start_line = std::lower_bound(editor_state.editor_content_lines.begin(),
-											editor_state.editor_content_lines.end(),
-											selection_start) -
-						   editor_state.editor_content_lines.begin();
-
-	selection_end_line = std::lower_bound(editor_state.editor_content_lines.begin(),
-										  editor_state.editor_content_lines.end(),
-										  selection_end) -
-						 editor_state.editor_content_lines.begin();
+	// Convert character positions to line indices: the first line starting at
+	// or after the position
+	const LineIndex &lines = editor_state.editor_content_lines;
+	auto firstLineStartingAt = [&lines](int pos) {
+		int line = static_cast<int>(lines.lineFromOffset(std::max(pos, 0)));
+		return lines[line] < pos ? line + 1 : line;
+	};
+	selection_start_line = firstLineStartingAt(selection_start);
+	selection_end_line = firstLineStartingAt(selection_end);
 }
\ No newline at end of file
@@ -0,0 +1,46 @@
+/*
+	File: editor_line_widths.cpp
+	Description: Per-line widths with a cached maximum, used for the
+	horizontal extent of the editor.
+*/
+
+#include "editor_line_widths.h"
+
+#include <algorithm>
+
+void LineWidths::splice(size_t first, size_t removed, size_t inserted)
+{
+	first = std::min(first, widths.size());
+	removed = std::min(removed, widths.size() - first);
+	if (removed == 0 && inserted == 0)
+	{
+		return;
+	}
+
+	widths.splice(first, removed, inserted);
+
+	// Shift the pending range into the new numbering and widen it to cover
+	// the spliced lines. Clean lines caught in between just get re-measured.
+	auto remap = [&](size_t line, size_t inside) {
+		if (line < first)
+			return line;
+		if (line >= first + removed)
+			return line - removed + inserted;
+		return inside;
+	};
+	if (dirty_begin == dirty_end)
+	{
+		dirty_begin = first;
+		dirty_end = first + inserted;
+	} else
+	{
+		dirty_begin = std::min(remap(dirty_begin, first), first);
+		dirty_end = std::max(remap(dirty_end, first + inserted), first + inserted);
+	}
+}
+
+void LineWidths::invalidateAll()
+{
+	dirty_begin = 0;
+	dirty_end = widths.size();
+}
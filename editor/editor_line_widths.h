@@ -0,0 +1,52 @@
+/*
+	File: editor_line_widths.h
+	Description: Per-line widths with a cached maximum, used for the
+	horizontal extent of the editor.
+
+	Edits only splice placeholder entries in; the lines they cover are
+	measured later by measurePending() from the render pass, where the
+	editor font is active. Widths live in LineChunks, whose summaries keep
+	the maximum, so it is available in O(1) and adding or removing lines or
+	measuring the touched ones costs O(log n) each.
+*/
+
+#pragma once
+#include "editor_line_chunks.h"
+
+#include <algorithm>
+#include <cstddef>
+
+class LineWidths
+{
+  public:
+	// removed lines starting at first were replaced by inserted new lines,
+	// which stay pending until the next measurePending().
+	void splice(size_t first, size_t removed, size_t inserted);
+
+	// Marks every line pending, e.g. after a font change.
+	void invalidateAll();
+
+	// Calls measure(line) -> float for every pending line.
+	template <typename Measure> void measurePending(Measure &&measure)
+	{
+		widths.modify(dirty_begin, dirty_end,
+					  [&](size_t line, float &width) { width = measure(line); });
+		dirty_begin = dirty_end = 0;
+	}
+
+	float max() const { return widths.total().max; }
+	size_t size() const { return widths.size(); }
+	float operator[](size_t line) const { return widths[line]; }
+
+  private:
+	struct Widest
+	{
+		float max = 0.0f;
+		static Widest of(float width) { return {width}; }
+		void add(const Widest &later) { max = std::max(max, later.max); }
+	};
+
+	LineChunks<float, Widest> widths;
+	size_t dirty_begin = 0; // lines [dirty_begin, dirty_end) await measuring
+	size_t dirty_end = 0;
+};
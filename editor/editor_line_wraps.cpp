@@ -0,0 +1,49 @@
+/*
+	File: editor_line_wraps.cpp
+	Description: Per-line soft wrap break positions with a cumulative index
+	of visual rows, used when word wrap is on.
+*/
+
+#include "editor_line_wraps.h"
+
+#include <algorithm>
+#include <utility>
+
+void LineWraps::splice(size_t first, size_t removed, size_t inserted)
+{
+	// New lines are dirty and count as one row until measured
+	lines.splice(first, removed, inserted);
+}
+
+void LineWraps::invalidateAll()
+{
+	lines.modify(0, lines.size(), [](size_t, Line &line) { line.dirty = true; });
+}
+
+size_t LineWraps::nextDirty(size_t line) const
+{
+	if (!anyDirty())
+	{
+		return lines.size();
+	}
+	size_t before = lines.prefix(line).dirty;
+	return lines.find([before](const Rows &rows) { return rows.dirty > before; });
+}
+
+void LineWraps::setBreaks(size_t line, std::vector<uint32_t> breaks)
+{
+	lines.modify(line, line + 1, [&](size_t, Line &entry) {
+		entry.breaks = std::move(breaks);
+		entry.dirty = false;
+	});
+}
+
+size_t LineWraps::lineAtRow(size_t row) const
+{
+	if (lines.empty())
+	{
+		return 0;
+	}
+	size_t line = lines.find([row](const Rows &rows) { return rows.rows > row; });
+	return std::min(line, lines.size() - 1);
+}
@@ -0,0 +1,74 @@
+/*
+	File: editor_line_wraps.h
+	Description: Per-line soft wrap break positions with a cumulative index
+	of visual rows, used when word wrap is on.
+
+	Each line keeps the offsets where its later visual rows start. Edits
+	only splice dirty entries in, and a width or font change marks every
+	line dirty; dirty lines keep their old breaks as an estimate until
+	EditorWrap measures them again. Lines live in LineChunks, whose
+	summaries count rows and dirty lines, so line -> first row, row -> line
+	and the next dirty line are O(log n), and so is a splice.
+*/
+
+#pragma once
+#include "editor_line_chunks.h"
+
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+class LineWraps
+{
+  public:
+	// removed lines starting at first were replaced by inserted new lines,
+	// which are dirty and count as one row until measured.
+	void splice(size_t first, size_t removed, size_t inserted);
+
+	// Marks every line dirty, e.g. after the wrap width changed.
+	void invalidateAll();
+
+	size_t size() const { return lines.size(); }
+	bool dirty(size_t line) const { return lines[line].dirty; }
+	bool anyDirty() const { return lines.total().dirty > 0; }
+
+	// First dirty line at or after line, size() if there is none.
+	size_t nextDirty(size_t line) const;
+
+	// Offsets from the line start where rows after the first begin, ascending.
+	const std::vector<uint32_t> &breaks(size_t line) const { return lines[line].breaks; }
+	void setBreaks(size_t line, std::vector<uint32_t> breaks);
+
+	size_t rowCount(size_t line) const { return lines[line].breaks.size() + 1; }
+	size_t totalRows() const { return lines.total().rows; }
+
+	// Visual row the line starts on.
+	size_t firstRow(size_t line) const { return lines.prefix(line).rows; }
+
+	// Line that covers row; rows past the end map to the last line.
+	size_t lineAtRow(size_t row) const;
+
+  private:
+	struct Line
+	{
+		std::vector<uint32_t> breaks;
+		bool dirty = true;
+	};
+
+	struct Rows
+	{
+		size_t rows = 0;
+		size_t dirty = 0; // lines
+		static Rows of(const Line &line)
+		{
+			return {line.breaks.size() + 1, line.dirty ? size_t(1) : size_t(0)};
+		}
+		void add(const Rows &later)
+		{
+			rows += later.rows;
+			dirty += later.dirty;
+		}
+	};
+
+	LineChunks<Line, Rows> lines;
+};
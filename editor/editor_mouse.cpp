@@ -18,6 +18,7 @@
 #include "editor.h"
 #include "editor/utf8_utils.h"
 #include "editor_copy_paste.h"
+#include "editor_glyphs.h"
 #include <algorithm>
 #include <iostream>
 #include "../lsp/lsp_globals.h"
@@ -41,7 +42,7 @@ bool isWordBoundary(char c)
 }
 
 // Helper function to find word boundaries
-void findWordBoundaries(const std::string &text, int cursor_pos, int &start, int &end)
+void findWordBoundaries(const TextBuffer &text, int cursor_pos, int &start, int &end)
 {
 	// Find start boundary (move left until we hit a boundary)
 	start = cursor_pos;
@@ -524,25 +525,19 @@ int EditorMouse::getCharIndexFromCoords()
 {
 	ImVec2 mouse_pos = ImGui::GetMousePos();
 
-	// Determine which line was clicked (clamped to valid indices)
-	int clicked_line =
+	// Determine which visual row was clicked (clamped to valid indices)
+	int clicked_row =
 		std::clamp(static_cast<int>((mouse_pos.y - editor_state.text_pos.y) /
 									editor_state.line_height),
 				   0,
-				   static_cast<int>(editor_state.editor_content_lines.size()) - 1);
+				   static_cast<int>(gEditorWrap.totalRows()) - 1);
 
-	// Get start/end indices for that line in the text.
-	int line_start = editor_state.editor_content_lines[clicked_line];
-	int line_end = (clicked_line + 1 < editor_state.editor_content_lines.size())
-					   ? editor_state.editor_content_lines[clicked_line + 1]
-					   : editor_state.fileContent.size();
-
-	// Adjust line_end to exclude newline character if present
-	if (line_end > line_start && line_end <= editor_state.fileContent.size() &&
-		editor_state.fileContent[line_end - 1] == '\n')
-	{
-		line_end--;
-	}
+	// Get start/end indices for that row in the text, without the newline
+	// or the first char of the next row of a wrapped line.
+	size_t row_start, row_end;
+	gEditorWrap.rowBounds(clicked_row, row_start, row_end);
+	int line_start = static_cast<int>(row_start);
+	int line_end = static_cast<int>(row_end);
 
 	// If the line is empty, return its start.
 	if (line_end <= line_start)
@@ -556,34 +551,29 @@ int EditorMouse::getCharIndexFromCoords()
 	std::vector<size_t> codepointIndices; // maps codepoint index to byte index
 	std::vector<float> insertionPositions;
 
+	std::string line_text =
+		editor_state.fileContent.substr(line_start, line_end - line_start);
+	const char *line_text_end = line_text.data() + line_text.size();
+
 	size_t char_idx = line_start;
 	float cumulative_x = 0.0f;
 	insertionPositions.push_back(0.0f);
 
 	while (char_idx < (size_t)line_end)
 	{
-		const char *char_start = &editor_state.fileContent[char_idx];
+		const char *char_start = line_text.data() + (char_idx - line_start);
 		const char *char_end = char_start + 1;
 		float width;
 
-		// Handle tab characters specially to match rendering logic
+		// Same advances and tab stops as the renderer
 		if (*char_start == '\t')
 		{
-			// Calculate tab width based on current position
-			float space_width = ImGui::CalcTextSize(" ").x;
-			const int TAB_SIZE = 4;
-			int current_column = static_cast<int>(cumulative_x / space_width);
-			int next_tab_stop = ((current_column / TAB_SIZE) + 1) * TAB_SIZE;
-			width = (next_tab_stop - current_column) * space_width;
+			width = gEditorGlyphs.tabWidth(cumulative_x);
 		} else
 		{
-			if ((*char_start & 0x80) != 0)
-			{
-				while (char_end < &editor_state.fileContent[line_end] &&
-					   (*char_end & 0xC0) == 0x80)
-					++char_end;
-			}
-			width = ImGui::CalcTextSize(char_start, char_end).x;
+			size_t length = 1;
+			width = gEditorGlyphs.charAdvance(char_start, line_text_end, length);
+			char_end = char_start + length;
 		}
 
 		charWidths.push_back(width);
@@ -0,0 +1,145 @@
+/*
+	File: editor_multi_edit.cpp
+	Description: Applies one edit per cursor as a single batch.
+*/
+
+#include "editor_multi_edit.h"
+#include "editor.h"
+#include <algorithm>
+
+EditorMultiEdit gEditorMultiEdit;
+
+void EditorMultiEdit::normalize(std::vector<BatchEdit> &edits)
+{
+	const int size = static_cast<int>(editor_state.fileContent.size());
+	for (BatchEdit &edit : edits)
+	{
+		edit.position = std::clamp(edit.position, 0, size);
+		edit.removed_length = std::clamp(edit.removed_length, 0, size - edit.position);
+	}
+	std::stable_sort(edits.begin(),
+					 edits.end(),
+					 [](const BatchEdit &a, const BatchEdit &b) {
+						 return a.position < b.position;
+					 });
+
+	// Overlapping ranges become one edit with the texts in cursor order
+	size_t kept = 0;
+	for (size_t i = 0; i < edits.size(); ++i)
+	{
+		if (kept > 0)
+		{
+			BatchEdit &last = edits[kept - 1];
+			int last_end = last.position + last.removed_length;
+			if (edits[i].position < last_end)
+			{
+				int end = edits[i].position + edits[i].removed_length;
+				last.removed_length = std::max(last_end, end) - last.position;
+				last.text += edits[i].text;
+				continue;
+			}
+		}
+		if (kept != i)
+		{
+			edits[kept] = std::move(edits[i]);
+		}
+		++kept;
+	}
+	edits.resize(kept);
+}
+
+void EditorMultiEdit::rebuildColors(const std::vector<BatchEdit> &edits)
+{
+	// Highlight workers write into the vector in place, see EditorState
+	std::lock_guard<std::mutex> lock(editor_state.colorsMutex);
+	std::vector<HighlightClass> &colors = editor_state.fileColors;
+	size_t inserted = 0;
+	size_t removed = 0;
+	for (const BatchEdit &edit : edits)
+	{
+		inserted += edit.text.size();
+		removed += edit.removed_length;
+	}
+
+	std::vector<HighlightClass> rebuilt;
+	rebuilt.reserve(colors.size() - removed + inserted);
+	size_t copied = 0;
+	for (const BatchEdit &edit : edits)
+	{
+		size_t position = edit.position;
+		rebuilt.insert(rebuilt.end(), colors.begin() + copied, colors.begin() + position);
+		HighlightClass cls = HighlightClass::Text;
+		if (edit.inherit_color && position > 0)
+		{
+			cls = colors[position - 1];
+		}
+		rebuilt.insert(rebuilt.end(), edit.text.size(), cls);
+		copied = position + edit.removed_length;
+	}
+	rebuilt.insert(rebuilt.end(), colors.begin() + copied, colors.end());
+	colors.swap(rebuilt);
+}
+
+std::vector<int> EditorMultiEdit::apply(std::vector<BatchEdit> &edits)
+{
+	normalize(edits);
+
+	std::vector<int> positions;
+	positions.reserve(edits.size());
+	bool changed = false;
+	int shift = 0;
+	for (const BatchEdit &edit : edits)
+	{
+		int inserted = static_cast<int>(edit.text.size());
+		positions.push_back(edit.position + shift + inserted);
+		shift += inserted - edit.removed_length;
+		changed = changed || edit.removed_length > 0 || !edit.text.empty();
+	}
+	if (!changed)
+	{
+		return positions;
+	}
+
+	// Colors are only kept per char while they match the buffer, see
+	// EditorState::eraseColors
+	bool keep_colors = !editor_state.large_file &&
+					   editor_state.fileColors.size() == editor_state.fileContent.size();
+
+	// Back to front, so each edit's position is still valid when it is
+	// applied and every logged edit is in the coordinates right before it
+	for (auto it = edits.rbegin(); it != edits.rend(); ++it)
+	{
+		editor_state.fileContent.replace(it->position, it->removed_length, it->text);
+	}
+
+	// Only after the buffer moved on: a highlight pass then no longer matches
+	// it and leaves the colors alone once they are in the new layout
+	if (keep_colors)
+	{
+		rebuildColors(edits);
+	}
+
+	editor_state.text_changed = true;
+	gEditor.updateLineStarts();
+	return positions;
+}
+
+void EditorMultiEdit::placeCursors(std::vector<int> positions)
+{
+	std::sort(positions.begin(), positions.end());
+	positions.erase(std::unique(positions.begin(), positions.end()), positions.end());
+
+	editor_state.multi_cursor_indices.clear();
+	if (!positions.empty())
+	{
+		editor_state.cursor_index = positions.front();
+		editor_state.multi_cursor_indices.assign(positions.begin() + 1, positions.end());
+	}
+	editor_state.cursor_column_prefered = 0;
+	editor_state.multi_cursor_prefered_columns.assign(
+		editor_state.multi_cursor_indices.size(), 0);
+
+	editor_state.selection_start = editor_state.selection_end = editor_state.cursor_index;
+	editor_state.selection_active = false;
+	editor_state.multi_selections.clear();
+}
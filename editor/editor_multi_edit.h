@@ -0,0 +1,50 @@
+/*
+	File: editor_multi_edit.h
+	Description: Applies one edit per cursor as a single batch.
+
+	Typing with many cursors used to insert at each cursor in turn, and every
+	insert shifted the whole color buffer behind it. A batch rebuilds the
+	colors in one pass, applies the buffer edits back to front so no position
+	needs adjusting, and updates the line index and change flag once, so the
+	highlighter and LSP see a single change per keystroke.
+*/
+
+#pragma once
+#include "editor_types.h"
+#include <string>
+#include <vector>
+
+// Forward declarations
+class Editor;
+extern Editor gEditor;
+
+// One replacement of a batch: removed_length bytes at position become text.
+// Positions are in the coordinates of the document before the batch.
+struct BatchEdit
+{
+	int position = 0;
+	int removed_length = 0;
+	std::string text;
+	// Inserted text takes the class of the char before it instead of Text
+	bool inherit_color = false;
+};
+
+class EditorMultiEdit
+{
+  public:
+	// Applies all edits at once. They are sorted by position first, and
+	// edits whose ranges overlap are merged. Returns the position right after
+	// each applied edit in the document after the batch, in ascending order.
+	std::vector<int> apply(std::vector<BatchEdit> &edits);
+
+	// Puts the primary cursor on the first position and the other cursors on
+	// the rest, dropping duplicates, and clears all selections.
+	void placeCursors(std::vector<int> positions);
+
+  private:
+	void normalize(std::vector<BatchEdit> &edits);
+	void rebuildColors(const std::vector<BatchEdit> &edits);
+};
+
+// Global instance
+extern EditorMultiEdit gEditorMultiEdit;
@@ -6,6 +6,7 @@
 
 #include "editor_render.h"
 #include "../files/file_finder.h"
+#include "../files/files.h"
 #include "../lsp/lsp.h"
 #include "../lsp/lsp_autocomplete.h"
 #include "../lsp/lsp_goto_def.h"
@@ -14,6 +15,7 @@
 #include "editor.h"
 #include "editor_bookmarks.h"
 #include "editor_cursor.h"
+#include "editor_glyphs.h"
 #include "editor_highlight.h"
 #include "editor_line_jump.h"
 #include "editor_line_numbers.h"
@@ -80,24 +82,22 @@ void EditorRender::renderEditorFrame()
 }
 bool EditorRender::validateAndResizeColors()
 {
-	// Ensure theme colors are updated first
+	// Keep the palette in sync with the theme before anything is drawn
 	TreeSitter::updateThemeColors();
 
+	if (editor_state.large_file)
+	{
+		return false; // no per-char classes, lines are classified as drawn
+	}
 	if (editor_state.fileColors.size() != editor_state.fileContent.size())
 	{
 		std::cout << "Warning: colors vector size (" << editor_state.fileColors.size()
 				  << ") does not match text size (" << editor_state.fileContent.size()
 				  << "). Resizing." << std::endl;
 
-		// Use text color if available, otherwise fallback to white
-		ImVec4 defaultColor = TreeSitter::cachedColors.text;
-		if (defaultColor.x == 0 && defaultColor.y == 0 && defaultColor.z == 0)
-		{
-			defaultColor = ImVec4(1.0f, 1.0f, 1.0f, 1.0f);
-		}
-		std::cout << "set to default color.... " << std::endl;
-
-		editor_state.fileColors.resize(editor_state.fileContent.size(), defaultColor);
+		std::lock_guard<std::mutex> lock(editor_state.colorsMutex);
+		editor_state.fileColors.resize(editor_state.fileContent.size(),
+									   HighlightClass::Text);
 		return true;
 	}
 	return false;
@@ -221,130 +221,153 @@ void EditorRender::renderLineBackground(int line_num,
 											  highlight_color);
 }
 
-void EditorRender::renderCharacterAndSelection(size_t char_index,
-											   int selection_start,
-											   int selection_end,
-											   ImVec2 &current_draw_pos)
+void EditorRender::collectSelectionRanges()
 {
-	if (char_index >= editor_state.fileColors.size())
+	selection_ranges.clear();
+
+	int start = std::min(editor_state.selection_start, editor_state.selection_end);
+	int end = std::max(editor_state.selection_start, editor_state.selection_end);
+	if (start < end)
 	{
-		return; // Skip rendering this char if color is missing
+		selection_ranges.emplace_back(start, end);
 	}
-
-	const char *char_start = &editor_state.fileContent[char_index];
-	const char *char_end = (char_index + 1 < editor_state.fileContent.size())
-							   ? &editor_state.fileContent[char_index + 1]
-							   : nullptr;
-
-	// Handle tab characters specially to avoid font-specific rendering issues
-	if (*char_start == '\t')
+	if (editor_state.selection_active)
 	{
-		// Calculate tab width based on current position
-		float space_width = ImGui::CalcTextSize(" ").x;
-		const int TAB_SIZE = 4;
-		float current_column_pixels = current_draw_pos.x - editor_state.text_pos.x;
-		int current_column = static_cast<int>(current_column_pixels / space_width);
-		int next_tab_stop = ((current_column / TAB_SIZE) + 1) * TAB_SIZE;
-		float tab_width = (next_tab_stop - current_column) * space_width;
-
-		// Render selection if needed
-		int s_start = selection_start;
-		int s_end = selection_end;
-		int current_char_idx = static_cast<int>(char_index);
-
-		bool is_selected = (s_start <= s_end && // Normal order: start <= end
-							current_char_idx >= s_start && current_char_idx < s_end) ||
-						   (s_start > s_end && // Inverse order: start > end
-							current_char_idx >= s_end && current_char_idx < s_start);
-
-		if (!is_selected && editor_state.selection_active &&
-			!editor_state.multi_selections.empty())
+		for (const auto &multi_sel : editor_state.multi_selections)
 		{
-			for (const auto &multi_sel : editor_state.multi_selections)
+			int sel_start = std::min(multi_sel.start_index, multi_sel.end_index);
+			int sel_end = std::max(multi_sel.start_index, multi_sel.end_index);
+			if (sel_start < sel_end)
 			{
-				if (static_cast<int>(char_index) >=
-						std::min(multi_sel.start_index, multi_sel.end_index) &&
-					static_cast<int>(char_index) <
-						std::max(multi_sel.start_index, multi_sel.end_index))
-				{
-					is_selected = true;
-					break;
-				}
+				selection_ranges.emplace_back(sel_start, sel_end);
 			}
 		}
-
-		if (is_selected)
-		{
-			ImVec2 sel_start_pos = current_draw_pos;
-			ImVec2 sel_end_pos = ImVec2(sel_start_pos.x + tab_width,
-										sel_start_pos.y + editor_state.line_height);
-			const ImU32 selection_color =
-				ImGui::ColorConvertFloat4ToU32(ImVec4(1.0f, 0.1f, 0.7f, 0.3f));
-			ImGui::GetWindowDrawList()->AddRectFilled(sel_start_pos,
-													  sel_end_pos,
-													  selection_color);
-		}
-
-		// Don't render anything - just advance the cursor by tab width
-		current_draw_pos.x += tab_width;
-		return;
 	}
 
-	// For multi-byte characters (like emojis), we need to find the end of the character
-	if (char_end && (*char_start & 0x80)) // Check if it's a multi-byte character
+	// Merge overlapping selections so each line gets one rect per stretch
+	std::sort(selection_ranges.begin(), selection_ranges.end());
+	size_t merged = 0;
+	for (const auto &range : selection_ranges)
 	{
-		// Find the end of this UTF-8 character
-		while (char_end < &editor_state.fileContent[editor_state.fileContent.size()] &&
-			   (*char_end & 0xC0) == 0x80) // Continuation byte
+		if (merged > 0 && range.first <= selection_ranges[merged - 1].second)
 		{
-			char_end++;
+			int &merged_end = selection_ranges[merged - 1].second;
+			merged_end = std::max(merged_end, range.second);
+		} else
+		{
+			selection_ranges[merged++] = range;
 		}
 	}
+	selection_ranges.resize(merged);
+}
 
-	float char_width = ImGui::CalcTextSize(char_start, char_end).x;
+void EditorRender::renderLine(std::string_view line_text,
+							  size_t line_start,
+							  const ImVec2 &line_pos,
+							  const HighlightClass *classes)
+{
+	line_runs.clear();
+	line_selection_spans.clear();
+
+	// First selection that ends inside or after this line
+	auto selection = std::upper_bound(selection_ranges.begin(),
+									  selection_ranges.end(),
+									  static_cast<int>(line_start),
+									  [](int pos, const std::pair<int, int> &range) {
+										  return pos < range.second;
+									  });
+	bool in_selection = false;
+	float selection_x = 0.0f;
+
+	const char *text = line_text.data();
+	const char *text_end = text + line_text.size();
+	float x = line_pos.x;
+
+	for (const char *p = text; p < text_end && *p != '\n';)
+	{
+		size_t index = line_start + (p - text);
 
-	int s_start = selection_start; // Or editor_state.selection_start
-	int s_end = selection_end;	   // Or editor_state.selection_end
-	int current_char_idx = static_cast<int>(char_index);
+		while (selection != selection_ranges.end() &&
+			   selection->second <= static_cast<int>(index))
+		{
+			++selection;
+		}
+		bool selected = selection != selection_ranges.end() &&
+						selection->first <= static_cast<int>(index);
+		if (selected != in_selection)
+		{
+			if (in_selection)
+			{
+				line_selection_spans.emplace_back(selection_x, x);
+			}
+			selection_x = x;
+			in_selection = selected;
+		}
 
-	bool is_selected = (s_start <= s_end && // Normal order: start <= end
-						current_char_idx >= s_start && current_char_idx < s_end) ||
-					   (s_start > s_end && // Inverse order: start > end
-						current_char_idx >= s_end && current_char_idx < s_start);
+		size_t length = 1;
+		float advance;
+		bool drawn = true;
+		if (*p == '\t')
+		{
+			// Tabs advance to the next stop but draw nothing
+			advance = gEditorGlyphs.tabWidth(x - editor_state.text_pos.x);
+			drawn = false;
+		} else if ((*p & 0xC0) == 0x80)
+		{
+			advance = 0.0f; // stray continuation byte
+			drawn = false;
+		} else
+		{
+			advance = gEditorGlyphs.charAdvance(p, text_end, length);
+		}
 
-	if (!is_selected && editor_state.selection_active &&
-		!editor_state.multi_selections.empty())
-	{
-		for (const auto &multi_sel : editor_state.multi_selections)
+		// Colors not resized yet draw as text
+		size_t offset = p - text;
+		HighlightClass cls = HighlightClass::Text;
+		if (classes)
 		{
-			if (static_cast<int>(char_index) >=
-					std::min(multi_sel.start_index, multi_sel.end_index) &&
-				static_cast<int>(char_index) <
-					std::max(multi_sel.start_index, multi_sel.end_index))
+			cls = classes[offset];
+		} else if (index < editor_state.fileColors.size())
+		{
+			cls = editor_state.fileColors[index];
+		}
+		if (drawn)
+		{
+			if (!line_runs.empty() && line_runs.back().end == offset &&
+				line_runs.back().cls == cls)
 			{
-				is_selected = true;
-				break;
+				line_runs.back().end = offset + length;
+			} else
+			{
+				line_runs.push_back({x, cls, offset, offset + length});
 			}
 		}
+
+		x += advance;
+		p += length;
 	}
-	if (is_selected)
+	if (in_selection)
 	{
-		ImVec2 sel_start_pos = current_draw_pos;
-		ImVec2 sel_end_pos = ImVec2(sel_start_pos.x + char_width,
-									sel_start_pos.y + editor_state.line_height);
-		const ImU32 selection_color =
-			ImGui::ColorConvertFloat4ToU32(ImVec4(1.0f, 0.1f, 0.7f, 0.3f));
-		ImGui::GetWindowDrawList()->AddRectFilled(sel_start_pos,
-												  sel_end_pos,
-												  selection_color);
+		line_selection_spans.emplace_back(selection_x, x);
 	}
 
-	ImU32 text_color =
-		ImGui::ColorConvertFloat4ToU32(editor_state.fileColors[char_index]);
-	ImGui::GetWindowDrawList()->AddText(
-		current_draw_pos, text_color, char_start, char_end);
-
-	current_draw_pos.x += char_width;
+	// Selections go behind the text, then one AddText per color run
+	ImDrawList *draw_list = ImGui::GetWindowDrawList();
+	const ImU32 selection_color =
+		ImGui::ColorConvertFloat4ToU32(ImVec4(1.0f, 0.1f, 0.7f, 0.3f));
+	const float line_bottom = line_pos.y + editor_state.line_height;
+	for (const auto &span : line_selection_spans)
+	{
+		draw_list->AddRectFilled(ImVec2(span.first, line_pos.y),
+								 ImVec2(span.second, line_bottom),
+								 selection_color);
+	}
+	for (const TextRun &run : line_runs)
+	{
+		ImU32 text_color = ImGui::ColorConvertFloat4ToU32(TreeSitter::colorFor(run.cls));
+		draw_list->AddText(
+			ImVec2(run.x, line_pos.y), text_color, text + run.begin, text + run.end);
+	}
 }
 
 bool EditorRender::skipLineIfAboveVisible(size_t &char_index,
@@ -390,13 +413,12 @@ void EditorRender::renderWhitespaceGuides()
 		return;
 	}
 
-	// Calculate visible line range
-	int start_line_idx = static_cast<int>(scroll_y / line_height);
-	start_line_idx = std::max(0, start_line_idx - 2);
-	int end_line_idx = static_cast<int>((scroll_y + window_height) / line_height);
-	end_line_idx =
-		std::min(static_cast<int>(editor_state.editor_content_lines.size() - 1),
-				 end_line_idx + 2);
+	// Calculate visible line range: lines whose first row is in view, since
+	// guides are only drawn next to a line's own indentation
+	int start_row = std::max(0, static_cast<int>(scroll_y / line_height) - 2);
+	int end_row = static_cast<int>((scroll_y + window_height) / line_height) + 2;
+	int start_line_idx = static_cast<int>(gEditorWrap.lineAtRow(start_row));
+	int end_line_idx = static_cast<int>(gEditorWrap.lineAtRow(end_row));
 
 	if (start_line_idx > end_line_idx)
 	{
@@ -404,7 +426,7 @@ void EditorRender::renderWhitespaceGuides()
 	}
 
 	// Calculate character width for spaces and tabs
-	float space_width = ImGui::CalcTextSize(" ").x;
+	float space_width = gEditorGlyphs.advance(' ');
 	float tab_width = space_width * 4; // Assuming 4-space tabs
 
 	// Color for whitespace guides (subtle gray)
@@ -451,7 +473,8 @@ void EditorRender::renderWhitespaceGuides()
 
 		// Draw vertical guides for each indentation level (full height, shifted up)
 		float line_y_start =
-			base_text_pos.y + (static_cast<float>(line_num) * line_height) - 2.0f;
+			base_text_pos.y +
+			(static_cast<float>(gEditorWrap.firstRow(line_num)) * line_height) - 2.0f;
 		float line_y_end = line_y_start + line_height;
 
 		// Draw guides every 4 characters, but stop before where text begins
@@ -543,25 +566,25 @@ void EditorRender::renderCurrentLineHighlight()
 		cached_cursor_pos = cursor_pos;
 	}
 
-	// Calculate visible line range
-	int start_line_idx = static_cast<int>(scroll_y / line_height);
-	start_line_idx = std::max(0, start_line_idx - 2);
-	int end_line_idx = static_cast<int>((scroll_y + window_height) / line_height);
-	end_line_idx =
-		std::min(static_cast<int>(editor_state.editor_content_lines.size() - 1),
-				 end_line_idx + 2);
+	// Calculate visible row range
+	int start_row = static_cast<int>(scroll_y / line_height);
+	start_row = std::max(0, start_row - 2);
+	int end_row = static_cast<int>((scroll_y + window_height) / line_height) + 2;
+
+	// The highlight covers every row of a wrapped line
+	int cursor_row = static_cast<int>(gEditorWrap.firstRow(cursor_line));
+	int cursor_rows =
+		static_cast<int>(gEditorWrap.lineBreaks(cursor_line).size()) + 1;
 
 	// Only highlight if the cursor line is visible
-	if (static_cast<int>(cursor_line) < start_line_idx ||
-		static_cast<int>(cursor_line) > end_line_idx)
+	if (cursor_row + cursor_rows <= start_row || cursor_row > end_row)
 	{
 		return;
 	}
 
 	// Calculate line position
-	float line_y_start =
-		base_text_pos.y + (static_cast<float>(cursor_line) * line_height);
-	float line_y_end = line_y_start + line_height;
+	float line_y_start = base_text_pos.y + (static_cast<float>(cursor_row) * line_height);
+	float line_y_end = line_y_start + cursor_rows * line_height;
 
 	// Get window bounds for full-width highlight (shifted 6px to the right)
 	ImVec2 window_pos = ImGui::GetWindowPos();
@@ -583,14 +606,12 @@ void EditorRender::renderText()
 {
 	ImVec2 base_text_pos = editor_state.text_pos; // Base screen position for text area
 
-	const float scroll_x = ImGui::GetScrollX(); // Current horizontal scroll
 	const float scroll_y = ImGui::GetScrollY(); // Current vertical scroll
 	// Use ImGui::GetContentRegionAvail().y for window_height if you are inside
 	// a child window or ImGui::GetWindowHeight() if 'this' is the main editor
 	// window. For a child window like "##editor", ImGui::GetWindowHeight()
 	// refers to child window height.
 	const float window_height = ImGui::GetWindowHeight();
-	const float window_width = ImGui::GetWindowWidth();
 	const float line_height = editor_state.line_height;
 
 	if (line_height <= 0.0f || editor_state.editor_content_lines.empty())
@@ -598,38 +619,50 @@ void EditorRender::renderText()
 		return; // Nothing to render or invalid state
 	}
 
-	// 1. Calculate the range of line numbers that are visible.
-	//    `start_line_idx` is the 0-based index for editor_content_lines.
+	// 1. Calculate the range of visual rows that are visible. Without word
+	//    wrap every line is one row.
 	const int VIRTUAL_RENDER_BUFFER_LINES = 2; // Render a few lines above/below viewport
-	int start_line_idx = static_cast<int>(scroll_y / line_height);
-	start_line_idx = std::max(0, start_line_idx - VIRTUAL_RENDER_BUFFER_LINES);
+	int start_row = static_cast<int>(scroll_y / line_height);
+	start_row = std::max(0, start_row - VIRTUAL_RENDER_BUFFER_LINES);
 
-	int end_line_idx = static_cast<int>((scroll_y + window_height) / line_height);
-	end_line_idx =
-		std::min(static_cast<int>(editor_state.editor_content_lines.size() - 1),
-				 end_line_idx + VIRTUAL_RENDER_BUFFER_LINES);
+	int end_row = static_cast<int>((scroll_y + window_height) / line_height);
+	end_row = std::min(static_cast<int>(gEditorWrap.totalRows()) - 1,
+					   end_row + VIRTUAL_RENDER_BUFFER_LINES);
 
-	if (start_line_idx > end_line_idx)
+	if (start_row > end_row)
 	{
 		return; // No lines in the visible range
 	}
 
-	// Horizontal culling values (for characters on a visible line)
-	const float visible_x_start_cull =
-		scroll_x - 100.0f; // Cull chars starting before this
-	const float visible_x_end_cull =
-		scroll_x + window_width + 100.0f; // Cull chars starting after this
+	ImVec2 current_draw_pos; // Will be set for each row
 
-	ImVec2 current_draw_pos; // Will be set for each line
+	collectSelectionRanges();
 
-	// 2. Iterate *only* through the visible lines using editor_content_lines.
-	for (int line_num = start_line_idx; line_num <= end_line_idx; ++line_num)
+	// Large files keep no classes, but their JSON and log lines are cheap
+	// enough to classify each time they are drawn
+	FastHighlight::Format fast_format =
+		editor_state.large_file ? largeFileFormat() : FastHighlight::Format::None;
+	// Server classes are drawn over fileColors where the edits since left them
+	editor_state.semantic_spans.rebase(editor_state.fileContent);
+
+	// 2. Iterate *only* through the lines holding visible rows.
+	const size_t line_count = editor_state.editor_content_lines.size();
+	for (size_t line_num = gEditorWrap.lineAtRow(start_row); line_num < line_count;
+		 ++line_num)
 	{
+		// Measures the line first if its wrap is not known yet
+		const std::vector<uint32_t> &breaks = gEditorWrap.lineBreaks(line_num);
+		int first_row = static_cast<int>(gEditorWrap.firstRow(line_num));
+		if (first_row > end_row)
+		{
+			break;
+		}
+
 		// Determine the character range for the current line_num
 		size_t line_char_start_idx = editor_state.editor_content_lines[line_num];
 		size_t line_char_end_idx; // Exclusive: points to the newline or end of file
 
-		if (static_cast<size_t>(line_num + 1) < editor_state.editor_content_lines.size())
+		if (line_num + 1 < line_count)
 		{
 			line_char_end_idx = editor_state.editor_content_lines[line_num + 1];
 		} else // This is the last line of the file
@@ -637,63 +670,76 @@ void EditorRender::renderText()
 			line_char_end_idx = editor_state.fileContent.size();
 		}
 
-		// Set the drawing position for the start of this line.
-		// The Y position is relative to the top of the document, ImGui handles
-		// scrolling it into view.
-		current_draw_pos.x = base_text_pos.x;
-		current_draw_pos.y =
-			base_text_pos.y + (static_cast<float>(line_num) * line_height);
-
-		// 3. Iterate through characters *of this specific line*.
-		for (size_t char_idx_in_file = line_char_start_idx;
-			 char_idx_in_file < line_char_end_idx;)
+		// Lines of a large file can be huge, e.g. minified JSON or the part of
+		// the file not indexed yet; only the start of those is drawn.
+		if (editor_state.large_file)
 		{
-			// Skip continuation bytes of multi-byte characters
-			if (char_idx_in_file < editor_state.fileContent.size() &&
-				(editor_state.fileContent[char_idx_in_file] & 0xC0) == 0x80)
-			{
-				char_idx_in_file++;
-				continue;
-			}
-
-			// This character is (at least partially) horizontally visible.
-			renderCharacterAndSelection(
-				char_idx_in_file,
-				editor_state.selection_start,
-				editor_state.selection_end,
-				current_draw_pos); // This function advances current_draw_pos.x
-
-			if (editor_state.fileContent[char_idx_in_file] == '\n')
-			{
-				break; // Reached end of current line's content (before
-					   // line_char_end_idx if line_char_end_idx pointed to
-					   // newline itself)
-			}
+			line_char_end_idx =
+				std::min(line_char_end_idx, line_char_start_idx + MAX_DRAWN_LINE_BYTES);
+		}
+		size_t line_length = line_char_end_idx - line_char_start_idx;
+
+		// Row i of the line covers [rowBegin(i), rowBegin(i + 1))
+		auto rowBegin = [&breaks, line_length](size_t row) -> size_t {
+			return row == 0 ? 0 : row <= breaks.size() ? breaks[row - 1] : line_length;
+		};
+		size_t first_visible = std::max(start_row, first_row) - first_row;
+		size_t last_visible =
+			std::min<size_t>(end_row - first_row, breaks.size());
+
+		// Copy just the visible rows once so glyphs can be measured and drawn
+		// from contiguous memory.
+		size_t copy_begin = rowBegin(first_visible);
+		size_t text_start = line_char_start_idx + copy_begin;
+		std::string line_text = editor_state.fileContent.substr(
+			text_start, rowBegin(last_visible + 1) - copy_begin);
+		const HighlightClass *classes = nullptr;
+		if (fast_format != FastHighlight::Format::None)
+		{
+			line_classes.resize(line_text.size());
+			FastHighlight::classify(fast_format, line_text, line_classes.data());
+			classes = line_classes.data();
+		} else if (editor_state.semantic_spans.overlaps(text_start, line_text.size()))
+		{
+			// Chars not colored yet read as text, as in renderLine
+			const std::vector<HighlightClass> &colors = editor_state.fileColors;
+			size_t known = colors.size() > text_start
+							   ? std::min(line_text.size(), colors.size() - text_start)
+							   : 0;
+			line_classes.assign(line_text.size(), HighlightClass::Text);
+			std::copy_n(colors.begin() + (known ? text_start : 0),
+						known,
+						line_classes.begin());
+			editor_state.semantic_spans.paint(
+				text_start, line_text.size(), line_classes.data());
+			classes = line_classes.data();
+		}
 
-			// Advance to next character, handling multi-byte UTF-8 characters
-			if (char_idx_in_file < editor_state.fileContent.size())
-			{
-				const char *current_char = &editor_state.fileContent[char_idx_in_file];
-				if ((*current_char & 0x80) == 0)
-				{
-					// Single byte character
-					char_idx_in_file++;
-				} else
-				{
-					// Multi-byte character, find the end
-					while (char_idx_in_file < editor_state.fileContent.size() &&
-						   (editor_state.fileContent[char_idx_in_file] & 0xC0) == 0x80)
-					{
-						char_idx_in_file++;
-					}
-					char_idx_in_file++; // Move past the last byte of the character
-				}
-			} else
-			{
-				char_idx_in_file++;
-			}
+		// 3. Draw each row as runs of same-colored text. The Y position is
+		//    relative to the top of the document, ImGui handles scrolling it
+		//    into view.
+		for (size_t row = first_visible; row <= last_visible; ++row)
+		{
+			size_t begin = rowBegin(row);
+			current_draw_pos.x = base_text_pos.x;
+			current_draw_pos.y =
+				base_text_pos.y + static_cast<float>(first_row + row) * line_height;
+			renderLine(std::string_view(line_text).substr(begin - copy_begin,
+														   rowBegin(row + 1) - begin),
+					   line_char_start_idx + begin,
+					   current_draw_pos,
+					   classes ? classes + (begin - copy_begin) : nullptr);
 		}
-		// If the line ended without a newline char (e.g., last line of file),
-		// the inner loop completes when char_idx_in_file == line_char_end_idx.
 	}
-}
\ No newline at end of file
+}
+
+FastHighlight::Format EditorRender::largeFileFormat()
+{
+	const std::string &path = gFileExplorer.currentFile;
+	if (path != fast_format_path)
+	{
+		fast_format_path = path;
+		fast_format = FastHighlight::formatFor(fs::path(path).extension().string());
+	}
+	return fast_format;
+}
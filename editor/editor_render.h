@@ -5,10 +5,12 @@
 */
 
 #pragma once
+#include "editor_fast_highlight.h"
 #include "editor_types.h"
 #include "imgui.h"
 
 #include <string>
+#include <string_view>
 #include <vector>
 
 // Forward declarations
@@ -31,17 +33,45 @@ class EditorRender
 							  float content_height);
 
   private:
+	// Longest prefix of a line drawn in large files
+	static constexpr size_t MAX_DRAWN_LINE_BYTES = 64 * 1024;
+
 	void renderLineBackground(int line_num,
 							  int start_visible_line,
 							  int end_visible_line,
 							  size_t cursor_line,
 							  const ImVec2 &line_start_draw_pos);
-	void renderCharacterAndSelection(size_t char_index,
-									 int selection_start,
-									 int selection_end,
-									 ImVec2 &current_draw_pos);
+	void collectSelectionRanges();
+	// classes holds the class of each byte of line_text, or is nullptr to
+	// read them from fileColors
+	void renderLine(std::string_view line_text,
+					size_t line_start,
+					const ImVec2 &line_pos,
+					const HighlightClass *classes);
 	bool skipLineIfAboveVisible(size_t &char_index,
 								int line_num,
 								int start_visible_line,
 								ImVec2 &current_draw_pos);
+
+	// Span of same-class text drawn with a single AddText
+	struct TextRun
+	{
+		float x;
+		HighlightClass cls;
+		size_t begin;
+		size_t end;
+	};
+
+	// Sorted, merged [start, end) selections for the current frame
+	std::vector<std::pair<int, int>> selection_ranges;
+	// Per-line scratch, kept to avoid allocating for every line
+	std::vector<TextRun> line_runs;
+	std::vector<std::pair<float, float>> line_selection_spans;
+
+	// Format of the current large file, found again when the file changes
+	FastHighlight::Format largeFileFormat();
+	std::string fast_format_path;
+	FastHighlight::Format fast_format = FastHighlight::Format::None;
+	// Classes of the line being drawn, when they are not fileColors as is
+	std::vector<HighlightClass> line_classes;
 };
\ No newline at end of file
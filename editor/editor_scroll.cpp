@@ -17,10 +17,13 @@ EditorScroll::EditorScroll()
 
 // Private helper that doesn't reference Editor directly to avoid circular
 // dependency
-int EditorScroll::getLineFromPosition(const std::vector<int> &line_starts, int pos)
+int EditorScroll::getLineFromPosition(const LineIndex &line_starts, int pos)
 {
-	auto it = std::upper_bound(line_starts.begin(), line_starts.end(), pos);
-	return std::distance(line_starts.begin(), it) - 1;
+	if (pos < 0)
+	{
+		return -1;
+	}
+	return static_cast<int>(line_starts.lineFromOffset(pos));
 }
 
 void EditorScroll::updateScrollAnimation()
@@ -201,7 +204,10 @@ float EditorScroll::calculateCursorXPosition()
 		return editor_state.text_pos.x;
 	}
 
-	size_t line_start_char_index = editor_state.editor_content_lines[current_cursor_line];
+	// Wrapped lines restart at the left edge on every row
+	size_t line_start_char_index =
+		gEditorWrap.enabled() ? gEditorWrap.rowStartOfPosition(editor_state.cursor_index)
+							  : editor_state.editor_content_lines[current_cursor_line];
 
 	// Ensure cursor_index is not before the calculated line_start_char_index
 	// (could happen if there's an issue with line_starts or cursor_index update
@@ -211,8 +217,10 @@ float EditorScroll::calculateCursorXPosition()
 		// Fallback for inconsistent state.
 		return editor_state.text_pos.x;
 	}
-	const char *line_start_ptr = editor_state.fileContent.c_str() + line_start_char_index;
-	const char *cursor_ptr = editor_state.fileContent.c_str() + editor_state.cursor_index;
+	std::string line_segment = editor_state.fileContent.substr(
+		line_start_char_index, editor_state.cursor_index - line_start_char_index);
+	const char *line_start_ptr = line_segment.c_str();
+	const char *cursor_ptr = line_start_ptr + line_segment.size();
 	const size_t segment_length = cursor_ptr - line_start_ptr;
 
 	float relative_x_offset_on_line = 0.0f;
@@ -263,10 +271,9 @@ ScrollChange EditorScroll::ensureCursorVisible()
 
 	// Calculate cursor position
 	float abs_cursor_x = calculateCursorXPosition();
-	// Use our own getLineFromPosition to avoid circular dependency
-	int cursor_line =
-		getLineFromPosition(editor_state.editor_content_lines, editor_state.cursor_index);
-	float abs_cursor_y = editor_state.text_pos.y + cursor_line * editor_state.line_height;
+	// Visual row, the same as the line unless word wrap is on
+	size_t cursor_row = gEditorWrap.rowOfPosition(editor_state.cursor_index);
+	float abs_cursor_y = editor_state.text_pos.y + cursor_row * editor_state.line_height;
 
 	// Calculate cursor position relative to viewport
 	float visible_cursor_x = abs_cursor_x - editor_state.text_pos.x - scroll_x;
@@ -413,10 +420,8 @@ void EditorScroll::handleCursorMovementScroll()
 	float visible_end_x = visible_start_x + window_width;
 
 	// Get cursor position
-	// Use our own method for getting line from position
-	int cursor_line =
-		getLineFromPosition(editor_state.editor_content_lines, editor_state.cursor_index);
-	float cursor_y = editor_state.text_pos.y + (cursor_line * editor_state.line_height);
+	size_t cursor_row = gEditorWrap.rowOfPosition(editor_state.cursor_index);
+	float cursor_y = editor_state.text_pos.y + (cursor_row * editor_state.line_height);
 	float cursor_x = calculateCursorXPosition();
 
 	// Handle vertical scrolling
@@ -440,10 +445,9 @@ void EditorScroll::handleCursorMovementScroll()
 
 void EditorScroll::centerCursorVertically()
 {
-	// Calculate cursor line position
-	int cursor_line =
-		getLineFromPosition(editor_state.editor_content_lines, editor_state.cursor_index);
-	float cursor_y = cursor_line * editor_state.line_height;
+	// Calculate cursor row position
+	size_t cursor_row = gEditorWrap.rowOfPosition(editor_state.cursor_index);
+	float cursor_y = cursor_row * editor_state.line_height;
 
 	// Calculate center position
 	float viewport_height = editor_state.size.y;
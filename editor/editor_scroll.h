@@ -72,7 +72,7 @@ class EditorScroll
 
 	// Helper that doesn't need direct access to Editor (to avoid circular
 	// dependency)
-	int getLineFromPosition(const std::vector<int> &line_starts, int pos);
+	int getLineFromPosition(const LineIndex &line_starts, int pos);
 
 	// Check if scroll animation is currently active
 	bool isScrollAnimationActive() const;
@@ -11,7 +11,7 @@
 // Global instance
 EditorSelection gEditorSelection;
 
-void EditorSelection::selectAllText(const std::string &text)
+void EditorSelection::selectAllText(const TextBuffer &text)
 {
 	const size_t MAX_SELECTION_SIZE = 100000; // Limit for very large files
 	editor_state.selection_active = true;
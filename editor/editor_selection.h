@@ -18,7 +18,7 @@ class EditorSelection
 	~EditorSelection() = default;
 
 	// Special selection operations
-	void selectAllText(const std::string &text);
+	void selectAllText(const TextBuffer &text);
 };
 
 // Global instance
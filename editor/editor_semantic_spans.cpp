@@ -0,0 +1,94 @@
+/*
+	File: editor_semantic_spans.cpp
+	Description: Sparse overlay of the classes a language server gave ranges
+	of the document, drawn over the tree-sitter or lexer colors.
+*/
+
+#include "editor_semantic_spans.h"
+
+#include <algorithm>
+#include <utility>
+
+void SemanticSpans::assign(uint64_t new_document,
+						   uint64_t new_version,
+						   std::vector<Span> new_spans)
+{
+	std::lock_guard<std::mutex> lock(mutex);
+	spans = std::move(new_spans);
+	document = new_document;
+	version = new_version;
+}
+
+void SemanticSpans::clear()
+{
+	std::lock_guard<std::mutex> lock(mutex);
+	spans.clear();
+}
+
+void SemanticSpans::rebase(const TextBuffer &text)
+{
+	std::lock_guard<std::mutex> lock(mutex);
+	if (spans.empty() || (document == text.documentId() && version == text.version()))
+	{
+		return;
+	}
+
+	edits.clear();
+	if (document != text.documentId() || !text.editsSince(version, edits))
+	{
+		spans.clear();
+		return;
+	}
+	version = text.version();
+
+	for (const TextEdit &edit : edits)
+	{
+		size_t removed_end = edit.position + edit.removed_length;
+		// Spans ending at or before the edit stay where they are
+		auto first = std::lower_bound(
+			spans.begin(), spans.end(), edit.position, [](const Span &span, size_t pos) {
+				return span.end <= pos;
+			});
+		auto last = std::find_if(
+			first, spans.end(), [removed_end](const Span &span) {
+				return span.start >= removed_end;
+			});
+		for (auto span = last; span != spans.end(); ++span)
+		{
+			span->start = span->start - edit.removed_length + edit.inserted_length;
+			span->end = span->end - edit.removed_length + edit.inserted_length;
+		}
+		// Typing inside a span changes the token, so it is not drawn until
+		// the server has classified it again
+		spans.erase(first, last);
+	}
+}
+
+bool SemanticSpans::overlaps(size_t start, size_t length) const
+{
+	std::lock_guard<std::mutex> lock(mutex);
+	auto span = firstEndingAfter(start);
+	return span != spans.end() && span->start < start + length;
+}
+
+void SemanticSpans::paint(size_t start, size_t length, HighlightClass *classes) const
+{
+	std::lock_guard<std::mutex> lock(mutex);
+	size_t end = start + length;
+	for (auto span = firstEndingAfter(start); span != spans.end() && span->start < end;
+		 ++span)
+	{
+		size_t from = std::max(span->start, start);
+		size_t to = std::min(span->end, end);
+		std::fill(classes + (from - start), classes + (to - start), span->cls);
+	}
+}
+
+std::vector<SemanticSpans::Span>::const_iterator
+SemanticSpans::firstEndingAfter(size_t pos) const
+{
+	return std::lower_bound(
+		spans.begin(), spans.end(), pos, [](const Span &span, size_t pos) {
+			return span.end <= pos;
+		});
+}
@@ -0,0 +1,55 @@
+/*
+	File: editor_semantic_spans.h
+	Description: Sparse overlay of the classes a language server gave ranges
+	of the document, drawn over the tree-sitter or lexer colors.
+
+	Spans are set from the text of one version and carried along the edits
+	made since, so they stay in place while the next answer is on its way.
+	A span an edit touched is dropped rather than guessed at; the underlying
+	highlighter colors that text until the server sends it again.
+*/
+
+#pragma once
+#include "editor_buffer.h"
+#include "editor_highlight_class.h"
+
+#include <cstddef>
+#include <cstdint>
+#include <mutex>
+#include <vector>
+
+class SemanticSpans
+{
+  public:
+	struct Span
+	{
+		size_t start;
+		size_t end; // exclusive
+		HighlightClass cls;
+	};
+
+	// Replaces the spans with ones found on version of document. spans must
+	// be sorted and not overlap. Called from the LSP worker.
+	void assign(uint64_t document, uint64_t version, std::vector<Span> spans);
+	void clear();
+
+	// Moves the spans to the current version of text, dropping all of them
+	// when it is another document or its edit log does not reach back.
+	void rebase(const TextBuffer &text);
+
+	// Whether any span overlaps [start, start + length)
+	bool overlaps(size_t start, size_t length) const;
+	// Paints the spans overlapping [start, start + length) over classes, the
+	// classes of that range
+	void paint(size_t start, size_t length, HighlightClass *classes) const;
+
+  private:
+	// First span ending after pos
+	std::vector<Span>::const_iterator firstEndingAfter(size_t pos) const;
+
+	mutable std::mutex mutex;
+	std::vector<Span> spans;
+	uint64_t document = 0;
+	uint64_t version = 0;
+	std::vector<TextEdit> edits; // scratch of rebase()
+};
@@ -1,6 +1,8 @@
 #include "editor_tree_sitter.h"
 #include "../files/files.h"
 #include "editor.h"
+#include <cstdlib>
+#include <cstring>
 #include <fstream>
 #include <iostream>
 #include <sstream>
@@ -25,16 +27,68 @@
 // Define static members
 bool TreeSitter::colorsNeedUpdate = true;
 ThemeColors TreeSitter::cachedColors;
-TSParser *TreeSitter::parser = nullptr;
-std::mutex TreeSitter::parserMutex;
-std::unordered_map<std::string, TSQuery *> TreeSitter::queryCache;
+std::array<ImVec4, HIGHLIGHT_CLASS_COUNT> TreeSitter::palette;
+std::mutex TreeSitter::parserPoolMutex;
+std::vector<TSParser *> TreeSitter::idleParsers;
 
 // incremental parsing
-TSTree *TreeSitter::previousTree = nullptr;
-std::string TreeSitter::previousContent;
+std::mutex TreeSitter::activeMutex;
+std::shared_ptr<TreeSitter::SyntaxState> TreeSitter::active =
+	std::make_shared<TreeSitter::SyntaxState>();
 
-const TSLanguage *TreeSitter::currentLanguage = nullptr;
-std::string TreeSitter::currentExtension = "";
+TreeSitter::SyntaxState::~SyntaxState()
+{
+	reset();
+	if (cursor)
+	{
+		ts_query_cursor_delete(cursor);
+	}
+}
+
+void TreeSitter::SyntaxState::reset()
+{
+	if (tree)
+	{
+		ts_tree_delete(tree);
+		tree = nullptr;
+	}
+	content = TextSnapshot();
+	language = nullptr;
+	query.reset();
+	extension.clear();
+	file.clear();
+	filled_up_to = 0;
+	tree_stale = false;
+	unparsed = {0, 0};
+}
+
+TreeSitter::CompiledQuery::~CompiledQuery()
+{
+	if (query)
+	{
+		ts_query_delete(query);
+	}
+}
+
+std::shared_ptr<TreeSitter::SyntaxState> TreeSitter::activeSyntax()
+{
+	std::lock_guard<std::mutex> lock(activeMutex);
+	return active;
+}
+
+std::shared_ptr<TreeSitter::SyntaxState> TreeSitter::detachSyntax()
+{
+	std::lock_guard<std::mutex> lock(activeMutex);
+	std::shared_ptr<SyntaxState> state = std::move(active);
+	active = std::make_shared<SyntaxState>();
+	return state;
+}
+
+void TreeSitter::attachSyntax(std::shared_ptr<SyntaxState> state)
+{
+	std::lock_guard<std::mutex> lock(activeMutex);
+	active = state ? std::move(state) : std::make_shared<SyntaxState>();
+}
 
 // Declare language parser functions
 extern "C" TSLanguage *tree_sitter_cpp();
@@ -55,154 +109,254 @@ extern "C" TSLanguage *tree_sitter_toml();
 extern "C" TSLanguage *tree_sitter_ruby();
 extern "C" TSLanguage *tree_sitter_luau();
 
-TSParser *TreeSitter::getParser()
+TSParser *TreeSitter::acquireParser()
 {
-	if (!parser)
 	{
-		parser = ts_parser_new();
-		ts_parser_set_language(parser, tree_sitter_cpp());
+		std::lock_guard<std::mutex> lock(parserPoolMutex);
+		if (!idleParsers.empty())
+		{
+			TSParser *parser = idleParsers.back();
+			idleParsers.pop_back();
+			return parser;
+		}
 	}
-	return parser;
+	// One more thread is parsing than ever before
+	return ts_parser_new();
 }
-std::pair<TSLanguage *, std::string>
-TreeSitter::detectLanguageAndQuery(const std::string &extension)
+
+void TreeSitter::releaseParser(TSParser *parser)
 {
+	std::lock_guard<std::mutex> lock(parserPoolMutex);
+	idleParsers.push_back(parser);
+}
 
-	// First check if we're running in a bundle
-	static bool isBundle = []() {
+const std::unordered_map<std::string, std::shared_ptr<TreeSitter::Language>> &
+TreeSitter::languages()
+{
+	static const auto registry = []() {
+		// First check if we're running in a bundle
+		static bool isBundle = []() {
 #ifdef __APPLE__
-		CFURLRef bundleURL = CFBundleCopyBundleURL(CFBundleGetMainBundle());
-		return bundleURL != nullptr;
+			CFURLRef bundleURL = CFBundleCopyBundleURL(CFBundleGetMainBundle());
+			return bundleURL != nullptr;
 #else
-		return false;
+			return false;
 #endif
-	}();
+		}();
 
-	std::string query_prefix = isBundle ? "queries/" : "editor/queries/";
 #ifdef __APPLE__
-	query_prefix = isBundle ? "queries/" : "editor/queries/";
+		std::string query_prefix = isBundle ? "queries/" : "editor/queries/";
 #else
-	query_prefix = "queries/";
+		std::string query_prefix = "queries/";
 #endif
-	if (extension == ".c")
-	{
-		return {tree_sitter_c(), query_prefix + "c.scm"};
-	} else if (extension == ".cpp" || extension == ".h" || extension == ".hpp" ||
-			   extension == ".mm")
-	{
-		return {tree_sitter_cpp(), query_prefix + "cpp.scm"};
-	} else if (extension == ".js" || extension == ".jsx")
-	{
-		return {tree_sitter_javascript(), query_prefix + "jsx.scm"};
-	} else if (extension == ".py")
-	{
-		return {tree_sitter_python(), query_prefix + "python.scm"};
-	} else if (extension == ".cs")
-	{
-		return {tree_sitter_c_sharp(), query_prefix + "csharp.scm"};
-	} else if (extension == ".html" || extension == ".cshtml")
-	{
-		return {tree_sitter_html(), query_prefix + "html.scm"};
-	} else if (extension == ".tsx" || extension == ".ts")
-	{
-		return {tree_sitter_tsx(), query_prefix + "tsx.scm"};
-	} else if (extension == ".css")
-	{
-		return {tree_sitter_css(), query_prefix + "css.scm"};
-	} else if (extension == ".java")
-	{
-		return {tree_sitter_java(), query_prefix + "java.scm"};
-	} else if (extension == ".go")
-	{
-		return {tree_sitter_go(), query_prefix + "go.scm"};
-	} else if (extension == ".tf")
-	{
-		return {tree_sitter_hcl(), query_prefix + "hcl.scm"};
-	} else if (extension == ".json")
-	{
-		return {tree_sitter_json(), query_prefix + "json.scm"};
-	} else if (extension == ".sh")
-	{
-		return {tree_sitter_bash(), query_prefix + "sh.scm"};
-	} else if (extension == ".rs")
-	{
-		return {tree_sitter_rust(), query_prefix + "rs.scm"};
-	} else if (extension == ".toml")
-	{
-		return {tree_sitter_toml(), query_prefix + "toml.scm"};
-	} else if (extension == ".rb")
+
+		struct Entry
+		{
+			std::vector<std::string> extensions;
+			const TSLanguage *grammar;
+			const char *query_file;
+		};
+		const Entry entries[] = {
+			{{".c"}, tree_sitter_c(), "c.scm"},
+			{{".cpp", ".h", ".hpp", ".mm"}, tree_sitter_cpp(), "cpp.scm"},
+			{{".js", ".jsx"}, tree_sitter_javascript(), "jsx.scm"},
+			{{".py"}, tree_sitter_python(), "python.scm"},
+			{{".cs"}, tree_sitter_c_sharp(), "csharp.scm"},
+			{{".html", ".cshtml"}, tree_sitter_html(), "html.scm"},
+			{{".tsx", ".ts"}, tree_sitter_tsx(), "tsx.scm"},
+			{{".css"}, tree_sitter_css(), "css.scm"},
+			{{".java"}, tree_sitter_java(), "java.scm"},
+			{{".go"}, tree_sitter_go(), "go.scm"},
+			{{".tf"}, tree_sitter_hcl(), "hcl.scm"},
+			{{".json"}, tree_sitter_json(), "json.scm"},
+			{{".sh"}, tree_sitter_bash(), "sh.scm"},
+			{{".rs"}, tree_sitter_rust(), "rs.scm"},
+			{{".toml"}, tree_sitter_toml(), "toml.scm"},
+			{{".rb"}, tree_sitter_ruby(), "rb.scm"},
+			{{".lua", ".luau"}, tree_sitter_luau(), "luau.scm"},
+		};
+
+		std::unordered_map<std::string, std::shared_ptr<Language>> map;
+		for (const Entry &entry : entries)
+		{
+			auto language = std::make_shared<Language>();
+			language->grammar = entry.grammar;
+			language->query_path = getResourcePath(query_prefix + entry.query_file);
+			for (const std::string &extension : entry.extensions)
+			{
+				map.emplace(extension, language);
+			}
+		}
+		return map;
+	}();
+	return registry;
+}
+
+TreeSitter::Language *TreeSitter::languageFor(const std::string &extension)
+{
+	const auto &registry = languages();
+	auto found = registry.find(extension);
+	return found != registry.end() ? found->second.get() : nullptr;
+}
+
+bool TreeSitter::hasLanguage(const std::string &extension)
+{
+	return languageFor(extension) != nullptr;
+}
+
+std::shared_ptr<const TreeSitter::CompiledQuery> TreeSitter::queryFor(Language &language)
+{
+	// A parse that needs the query while the warm-up compiles it waits for
+	// that instead of compiling it twice
+	std::lock_guard<std::mutex> lock(language.mutex);
+	if (!language.query && !language.query_failed)
 	{
-		return {tree_sitter_ruby(), query_prefix + "rb.scm"};
-	} else if (extension == ".lua" || extension == ".luau") 
+		language.query = compileQuery(language.grammar, language.query_path);
+		language.query_failed = !language.query;
+	}
+	return language.query;
+}
+
+void TreeSitter::warmUpLanguages(const std::unordered_set<std::string> &extensions)
+{
+	std::unordered_set<Language *> compiled;
+	for (const std::string &extension : extensions)
 	{
-		return {tree_sitter_luau(), query_prefix + "luau.scm"};
+		Language *language = languageFor(extension);
+		if (language && compiled.insert(language).second)
+		{
+			queryFor(*language);
+		}
 	}
-	return {};
 }
 
-void TreeSitter::computeEditRange(const std::string &newContent,
-								  size_t &start,
-								  size_t &newEnd,
-								  size_t &oldEnd)
+bool TreeSitter::editsSinceLastParse(SyntaxState &state,
+									 const TextBuffer &buffer,
+									 EditDelta &delta)
 {
-	if (previousContent == newContent)
+	std::lock_guard<std::mutex> lock(state.mutex);
+	if (!state.tree || state.content.documentId() != buffer.documentId())
 	{
-		start = 0;
-		oldEnd = previousContent.size();
-		newEnd = newContent.size();
-		return;
+		return false;
 	}
+	delta.document_id = state.content.documentId();
+	delta.base_version = state.content.version();
+	return buffer.editsSince(delta.base_version, delta.edits);
+}
 
-	oldEnd = previousContent.size();
-	newEnd = newContent.size();
+bool TreeSitter::coalesceEdits(const SyntaxState &state,
+							   const EditDelta &delta,
+							   const TextSnapshot &snapshot,
+							   size_t &start,
+							   size_t &oldEnd,
+							   size_t &newEnd)
+{
+	const TextSnapshot &previous = state.content;
+	if (delta.document_id != previous.documentId() ||
+		delta.document_id != snapshot.documentId() ||
+		delta.base_version != previous.version() ||
+		delta.edits.size() != snapshot.version() - previous.version())
+	{
+		return false;
+	}
 
-	while (start < oldEnd && start < newEnd && previousContent[start] == newContent[start])
+	// One range covering every edit: [start, oldEnd) of the previous text
+	// became [start, newEnd) of the new one. Each edit is in the coordinates
+	// of the text after the ones before it, like newEnd.
+	start = oldEnd = newEnd = 0;
+	for (size_t i = 0; i < delta.edits.size(); ++i)
 	{
-		start++;
+		const TextEdit &edit = delta.edits[i];
+		size_t edit_end = edit.position + edit.removed_length;
+		if (i == 0)
+		{
+			start = edit.position;
+			oldEnd = edit_end;
+			newEnd = edit.position + edit.inserted_length;
+			continue;
+		}
+		start = std::min(start, edit.position);
+		if (edit_end > newEnd)
+		{
+			oldEnd += edit_end - newEnd;
+		}
+		newEnd = std::max(newEnd, edit_end) - edit.removed_length + edit.inserted_length;
 	}
+	return oldEnd <= previous.size() && newEnd <= snapshot.size() &&
+		   previous.size() - oldEnd == snapshot.size() - newEnd;
+}
 
-	while (oldEnd > start && newEnd > start &&
-		   previousContent[oldEnd - 1] == newContent[newEnd - 1])
+TSPoint TreeSitter::pointAt(const TextSnapshot &text, size_t byte)
+{
+	if (text.linesCounted())
 	{
-		oldEnd--;
-		newEnd--;
+		size_t row = text.lineFromOffset(byte);
+		return {static_cast<uint32_t>(row),
+				static_cast<uint32_t>(byte - text.lineStart(row))};
 	}
+	return advancePoint({0, 0}, text, 0, byte);
+}
+
+TSPoint
+TreeSitter::advancePoint(TSPoint point, const TextSnapshot &text, size_t from, size_t to)
+{
+	// Columns are in bytes, as tree-sitter counts them
+	text.forEachChunk(from, to - from, [&](std::string_view chunk) {
+		const char *p = chunk.data();
+		const char *end = p + chunk.size();
+		while (const char *newline =
+				   static_cast<const char *>(std::memchr(p, '\n', end - p)))
+		{
+			point.row++;
+			point.column = 0;
+			p = newline + 1;
+		}
+		point.column += static_cast<uint32_t>(end - p);
+		return true;
+	});
+	return point;
 }
-TSInputEdit TreeSitter::createEdit(size_t start, size_t oldEnd, size_t newEnd)
+
+TSInputEdit TreeSitter::createEdit(const SyntaxState &state,
+								   const TextSnapshot &snapshot,
+								   size_t start,
+								   size_t oldEnd,
+								   size_t newEnd)
 {
+	// The text before start is the same in both versions, the end points
+	// only need the newlines inside the edited range
 	TSInputEdit edit;
 	edit.start_byte = static_cast<uint32_t>(start);
 	edit.old_end_byte = static_cast<uint32_t>(oldEnd);
 	edit.new_end_byte = static_cast<uint32_t>(newEnd);
-	edit.start_point = {0, static_cast<uint32_t>(start)};
-	edit.old_end_point = {0, static_cast<uint32_t>(oldEnd)};
-	edit.new_end_point = {0, static_cast<uint32_t>(newEnd)};
+	edit.start_point = pointAt(snapshot, start);
+	edit.old_end_point = advancePoint(edit.start_point, state.content, start, oldEnd);
+	edit.new_end_point = advancePoint(edit.start_point, snapshot, start, newEnd);
 	return edit;
 }
 
-TSInput TreeSitter::createInput(const std::string &content)
+TSInput TreeSitter::createInput(const TextSnapshot &snapshot)
 {
-	return {.payload = (void *)content.data(),
+	// Serves the pieces of the snapshot as they are, so nothing is flattened
+	// and each read is bounded by the piece size
+	return {.payload = const_cast<TextSnapshot *>(&snapshot),
 			.read =
 				[](void *payload, uint32_t byte, TSPoint position, uint32_t *bytes_read) {
-					const char *data = static_cast<const char *>(payload);
-					*bytes_read = static_cast<uint32_t>(strlen(data + byte));
-					return data + byte;
+					const TextSnapshot *text = static_cast<const TextSnapshot *>(payload);
+					std::string_view chunk = text->chunkAt(byte);
+					*bytes_read = static_cast<uint32_t>(chunk.size());
+					return chunk.empty() ? "" : chunk.data();
 				},
 			.encoding = TSInputEncodingUTF8};
 }
 
-TSTree *
-TreeSitter::createNewTree(TSParser *parser, bool initialParse, const std::string &content)
+TSTree *TreeSitter::createNewTree(TSParser *parser,
+								  const SyntaxState &state,
+								  bool initialParse,
+								  const TextSnapshot &snapshot)
 {
-	if (initialParse)
-	{
-		return ts_parser_parse_string(parser, nullptr, content.c_str(), content.size());
-	} else
-	{
-		TSInput input = createInput(content);
-		return ts_parser_parse(parser, previousTree, input);
-	}
+	TSInput input = createInput(snapshot);
+	return ts_parser_parse(parser, initialParse ? nullptr : state.tree, input);
 }
 
 std::string TreeSitter::getResourcePath(const std::string &relativePath)
@@ -231,20 +385,21 @@ std::string TreeSitter::getResourcePath(const std::string &relativePath)
 	}
 #elif !defined(PLATFORM_WINDOWS)
 	// --- Linux/Ubuntu Fix ---
-	char exePath[PATH_MAX];
-	ssize_t len = readlink("/proc/self/exe", exePath, sizeof(exePath) - 1);
-	if (len != -1)
-	{
+	// The executable does not move while running, so look it up once
+	static const std::string exeDir = []() {
+		char exePath[PATH_MAX];
+		ssize_t len = readlink("/proc/self/exe", exePath, sizeof(exePath) - 1);
+		if (len == -1)
+		{
+			return std::string();
+		}
 		exePath[len] = '\0';
-		std::string exeDir = dirname(exePath);
-
+		return std::string(dirname(exePath));
+	}();
+	if (!exeDir.empty())
+	{
 		// Construct path directly to "queries" folder (no "editor/queries" here)
-		std::string path = exeDir + "/" + relativePath;
-
-		// Debug
-		std::cout << "[DEBUG] Final Query Path: " << path << std::endl;
-
-		return path;
+		return exeDir + "/" + relativePath;
 	}
 	// Fallback (for development builds)
 	return "queries/" + relativePath; // Not "editor/queries"
@@ -267,7 +422,6 @@ std::string TreeSitter::getResourcePath(const std::string &relativePath)
 			std::replace(portablePath.begin(), portablePath.end(), '/', '\\');
 			std::ifstream testFile(portablePath);
 			if (testFile.good()) {
-				std::cout << "[DEBUG] Windows Portable Query Path: " << portablePath << std::endl;
 				return portablePath;
 			}
 			
@@ -279,7 +433,6 @@ std::string TreeSitter::getResourcePath(const std::string &relativePath)
 				std::string devPath = buildDir + "\\" + relativePath;
 				// Replace forward slashes with backslashes for Windows
 				std::replace(devPath.begin(), devPath.end(), '/', '\\');
-				std::cout << "[DEBUG] Windows Dev Query Path: " << devPath << std::endl;
 				return devPath;
 			}
 		}
@@ -293,18 +446,9 @@ std::string TreeSitter::getResourcePath(const std::string &relativePath)
 	return "editor/queries/" + relativePath;
 }
 
-TSQuery *TreeSitter::loadQueryFromCacheOrFile(TSLanguage *lang,
-											  const std::string &query_path)
+std::shared_ptr<const TreeSitter::CompiledQuery>
+TreeSitter::compileQuery(const TSLanguage *lang, const std::string &full_path)
 {
-	std::string full_path = getResourcePath(query_path);
-
-	// Use full_path as the cache key consistently
-	auto cacheIt = queryCache.find(full_path);
-	if (cacheIt != queryCache.end())
-	{
-		return cacheIt->second;
-	}
-
 	std::ifstream file(full_path);
 	if (!file.is_open())
 	{
@@ -327,166 +471,293 @@ TSQuery *TreeSitter::loadQueryFromCacheOrFile(TSLanguage *lang,
 		return nullptr;
 	}
 
-	// Store using full_path as key
-	queryCache[full_path] = query;
-	return query;
+	// Resolve every capture name once, matching then only indexes by id
+	auto compiled = std::make_shared<CompiledQuery>();
+	compiled->query = query;
+	uint32_t capture_count = ts_query_capture_count(query);
+	compiled->capture_classes.reserve(capture_count);
+	for (uint32_t id = 0; id < capture_count; ++id)
+	{
+		uint32_t name_length;
+		const char *name = ts_query_capture_name_for_id(query, id, &name_length);
+		compiled->capture_classes.push_back(
+			highlightClassForCapture(std::string_view(name, name_length)));
+	}
+	return compiled;
 }
 
 void TreeSitter::clearQueryCache()
 {
-	std::lock_guard<std::mutex> lock(parserMutex);
-	for (auto &[key, query] : queryCache)
+	// Queries still in use are deleted when the last document using them
+	// drops them
+	for (const auto &[extension, language] : languages())
 	{
-		ts_query_delete(query);
+		std::lock_guard<std::mutex> lock(language->mutex);
+		language->query.reset();
+		language->query_failed = false;
 	}
-	queryCache.clear();
 }
-void TreeSitter::executeQueryAndHighlight(TSQuery *query,
-										  TSTree *tree,
-										  const std::string &content,
-										  std::vector<ImVec4> &colors,
-										  bool initialParse,
-										  size_t start,
-										  size_t end)
+void TreeSitter::highlightRange(const SyntaxState &state,
+								const CompiledQuery &query,
+								std::vector<HighlightClass> &colors,
+								size_t start,
+								size_t end)
 {
-	TSQueryCursor *cursor = ts_query_cursor_new();
-	ts_query_cursor_exec(cursor, query, ts_tree_root_node(tree));
-
-	// Get theme colors once
-	const ImVec4 text_color = cachedColors.text;
+	// Only matches touching [start, end) are visited, and captures are
+	// clipped to it, so the rest of the colors stay as they are
+	TSQueryCursor *cursor = state.cursor;
+	ts_query_cursor_set_byte_range(
+		cursor, static_cast<uint32_t>(start), static_cast<uint32_t>(end));
+	ts_query_cursor_exec(cursor, query.query, ts_tree_root_node(state.tree));
 
-	// FIRST: Set ALL text to default color
-	std::fill(colors.begin(), colors.end(), text_color);
+	// FIRST: Set the range to default class
+	std::fill(colors.begin() + start, colors.begin() + end, HighlightClass::Text);
 
 	// THEN apply syntax highlights
-	const std::unordered_map<std::string, ImVec4> capture_colors = {
-		{"keyword", cachedColors.keyword},
-		{"string", cachedColors.string},
-		{"number", cachedColors.number},
-		{"comment", cachedColors.comment},
-		{"type", cachedColors.type},
-		{"function", cachedColors.function},
-		{"variable", cachedColors.variable},
-		{"tag", cachedColors.type},			 // Components
-		{"attribute", cachedColors.number},	 // JSX attributes
-		{"property", cachedColors.variable}, // Object properties
-		{"hook", cachedColors.function},	 // React hooks
-		{"variable.parameter", cachedColors.variable},
-		{"punctuation.special", cachedColors.string}};
-
 	TSQueryMatch match;
 	while (ts_query_cursor_next_match(cursor, &match))
 	{
 		for (uint32_t i = 0; i < match.capture_count; ++i)
 		{
 			TSNode node = match.captures[i].node;
-			uint32_t name_length;
-			const char *name_ptr =
-				ts_query_capture_name_for_id(query, match.captures[i].index, &name_length);
-			std::string name(name_ptr, name_length);
-
-			const ImVec4 color = capture_colors.count(name)
-									 ? capture_colors.at(name)
-									 : text_color; // Fallback to text color
-
-			const uint32_t start = ts_node_start_byte(node);
-			const uint32_t end = ts_node_end_byte(node);
-			setColors(content, colors, start, end, color);
+			const HighlightClass cls = query.capture_classes[match.captures[i].index];
+
+			size_t node_start = std::max<size_t>(ts_node_start_byte(node), start);
+			size_t node_end = std::min<size_t>(ts_node_end_byte(node), end);
+			setColors(end,
+					  colors,
+					  static_cast<int>(node_start),
+					  static_cast<int>(node_end),
+					  cls);
 		}
 	}
-
-	ts_query_cursor_delete(cursor);
 }
 
-void TreeSitter::parse(const std::string &fileContent,
-					   std::vector<ImVec4> &fileColors,
-					   const std::string &extension,
-					   bool fullRehighlight)
+bool TreeSitter::recolor(SyntaxState &state,
+						 const TextSnapshot &snapshot,
+						 std::vector<HighlightClass> &colors,
+						 std::vector<ByteRange> ranges)
 {
-
-	std::lock_guard<std::mutex> lock(parserMutex);
-	if (fileContent.empty())
+	// Colors must be those of the parsed text, or they would land on the
+	// wrong chars
+	if (!state.tree || state.tree_stale ||
+		state.content.documentId() != snapshot.documentId() ||
+		state.content.version() != snapshot.version() ||
+		colors.size() != snapshot.size())
 	{
-		std::cerr << "No content to parse!\n";
-		return;
+		return false;
 	}
-	static std::string lastFile;
-	if (lastFile != gFileExplorer.currentFile)
+	if (!state.query)
 	{
-		if (previousTree)
-		{
-			ts_tree_delete(previousTree);
-			previousTree = nullptr;
-		}
-		previousContent.clear();
-		lastFile = gFileExplorer.currentFile;
+		return false;
 	}
-	if (fullRehighlight)
+	if (!state.cursor)
 	{
-		if (previousTree)
+		state.cursor = ts_query_cursor_new();
+	}
+
+	// Sorted and merged, so overlapping ranges are colored once
+	std::sort(ranges.begin(), ranges.end(), [](const ByteRange &a, const ByteRange &b) {
+		return a.start < b.start;
+	});
+	for (size_t i = 0; i < ranges.size();)
+	{
+		size_t start = std::min(ranges[i].start, colors.size());
+		size_t end = std::min(ranges[i].end, colors.size());
+		for (++i; i < ranges.size() && ranges[i].start <= end; ++i)
+		{
+			end = std::max(end, std::min(ranges[i].end, colors.size()));
+		}
+		if (start < end)
 		{
-			ts_tree_delete(previousTree);
-			previousTree = nullptr;
+			highlightRange(state, *state.query, colors, start, end);
 		}
-		previousContent.clear();
-		lastFile.clear(); // Force reinitialization
+	}
+	return true;
+}
+
+bool TreeSitter::highlightRanges(SyntaxState &state,
+								 const TextSnapshot &snapshot,
+								 std::vector<HighlightClass> &colors,
+								 const std::vector<ByteRange> &ranges)
+{
+	std::lock_guard<std::mutex> lock(state.mutex);
+	return recolor(state, snapshot, colors, ranges);
+}
+
+bool TreeSitter::fillNextSlice(SyntaxState &state,
+							   const TextSnapshot &snapshot,
+							   std::vector<HighlightClass> &colors,
+							   size_t max_bytes)
+{
+	std::lock_guard<std::mutex> lock(state.mutex);
+	size_t start = state.filled_up_to;
+	size_t end = std::min(snapshot.size(), start + max_bytes);
+	if (start >= end || !recolor(state, snapshot, colors, {{start, end}}))
+	{
+		return false;
+	}
+	state.filled_up_to = end;
+	return end < snapshot.size();
+}
+
+TreeSitter::ParseResult TreeSitter::parse(SyntaxState &state,
+										  const TextSnapshot &snapshot,
+										  const std::string &file,
+										  const std::string &extension,
+										  bool fullRehighlight,
+										  const EditDelta *delta,
+										  const CancelFlag *cancel,
+										  std::vector<ByteRange> &stale)
+{
+
+	std::lock_guard<std::mutex> lock(state.mutex);
+	stale.clear();
+	if (snapshot.empty())
+	{
+		std::cerr << "No content to parse!\n";
+		return ParseResult::NoParser;
+	}
+	if (fullRehighlight || state.file != file)
+	{
+		state.reset();
+		state.file = file;
 	}
 	updateThemeColors();
-	TSParser *parser = getParser();
 
 	// Language detection
-	auto [lang, query_path] = detectLanguageAndQuery(extension);
-	if (!lang)
+	Language *language = languageFor(extension);
+	if (!language)
 	{
 		// std::cerr << "No parser for extension: " << extension << std::endl;
-		return;
+		return ParseResult::NoParser;
 	}
+	const TSLanguage *lang = language->grammar;
 
 	// Reset state if language changed
-	if (currentLanguage != lang || currentExtension != extension)
+	if (state.language != lang || state.extension != extension)
 	{
-		if (previousTree)
+		if (state.tree)
 		{
-			ts_tree_delete(previousTree);
-			previousTree = nullptr;
+			ts_tree_delete(state.tree);
+			state.tree = nullptr;
 		}
-		previousContent.clear();
-		currentLanguage = lang;
-		currentExtension = extension;
+		state.content = TextSnapshot();
+		state.language = lang;
+		state.extension = extension;
+		// Usually compiled by the warm-up already
+		state.query = queryFor(*language);
 	}
 
-	bool initialParse = previousContent.empty();
-	ts_parser_set_language(parser, lang);
+	bool initialParse = state.content.empty() || !state.tree;
 
 	// Handle incremental parsing
 	size_t start = 0;
-	size_t newEnd = fileContent.size();
-	size_t oldEnd = previousContent.size();
+	size_t newEnd = snapshot.size();
+	size_t oldEnd = state.content.size();
 
 	if (!initialParse)
 	{
-		computeEditRange(fileContent, start, newEnd,
-						 oldEnd); // Pass new content
-		TSInputEdit edit = createEdit(start, oldEnd, newEnd);
-		ts_tree_edit(previousTree, &edit);
+		if (delta && coalesceEdits(state, *delta, snapshot, start, oldEnd, newEnd))
+		{
+			if (oldEnd != start || newEnd != start)
+			{
+				TSInputEdit edit = createEdit(state, snapshot, start, oldEnd, newEnd);
+				ts_tree_edit(state.tree, &edit);
+			}
+			// Keep the filled prefix and text left over from a cancelled
+			// parse in step with the text
+			auto map = [&](size_t offset) {
+				if (offset <= start)
+				{
+					return offset;
+				}
+				return offset >= oldEnd ? offset - oldEnd + newEnd : newEnd;
+			};
+			size_t &filled = state.filled_up_to;
+			filled = filled > start && filled < oldEnd ? start : map(filled);
+			if (state.tree_stale)
+			{
+				state.unparsed = {std::min(map(state.unparsed.start), start),
+								  std::max(map(state.unparsed.end), newEnd)};
+			} else
+			{
+				state.unparsed = {start, newEnd};
+			}
+		} else if (state.content.documentId() != snapshot.documentId() ||
+				   state.content.version() != snapshot.version())
+		{
+			// No edits to apply to the old tree, so it cannot be reused
+			initialParse = true;
+		}
 	}
 
 	// Create new parse tree
-	TSTree *newTree = createNewTree(parser, initialParse, fileContent);
-	// printAST(newTree, fileContent); // <-- This line replaces the lambda
-	//   Update state
-	if (previousTree)
-		ts_tree_delete(previousTree);
-	previousTree = newTree;
-	previousContent = fileContent;
+	// Any idle parser will do, the tree carries all incremental state
+	TSParser *parser = acquireParser();
+	ts_parser_set_language(parser, lang);
+	// Polled while parsing, so a newer keystroke stops this parse at once
+	// instead of waiting for a whole file to be parsed
+	static_assert(sizeof(CancelFlag) == sizeof(size_t) &&
+				  CancelFlag::is_always_lock_free);
+	ts_parser_set_cancellation_flag(parser, reinterpret_cast<const size_t *>(cancel));
+	TSTree *newTree = createNewTree(parser, state, initialParse, snapshot);
+	ts_parser_set_cancellation_flag(parser, nullptr);
+	if (!newTree)
+	{
+		// Halted parsers resume on the next call; the next parse is of a
+		// newer text, so start it clean
+		ts_parser_reset(parser);
+		releaseParser(parser);
+		if (initialParse)
+		{
+			if (state.tree)
+			{
+				ts_tree_delete(state.tree);
+				state.tree = nullptr;
+			}
+			state.content = TextSnapshot();
+		} else
+		{
+			// The old tree is edited to match snapshot, so the next parse
+			// continues from there; it must not be queried until then
+			state.content = snapshot;
+			state.tree_stale = true;
+		}
+		return ParseResult::Cancelled;
+	}
+	releaseParser(parser);
+	// printAST(newTree, snapshot.str()); // <-- This line replaces the lambda
 
-	// Handle query execution
-	TSQuery *query = loadQueryFromCacheOrFile(lang, query_path);
-	if (!query)
-		return;
+	if (initialParse)
+	{
+		// Nothing was colored from this tree yet, the fill covers it all
+		state.filled_up_to = 0;
+	} else
+	{
+		// Where the syntax changed, plus the edited text itself, whose
+		// structure may not have changed at all
+		uint32_t count = 0;
+		TSRange *changed = ts_tree_get_changed_ranges(state.tree, newTree, &count);
+		for (uint32_t i = 0; i < count; ++i)
+		{
+			stale.push_back({changed[i].start_byte, changed[i].end_byte});
+		}
+		free(changed);
+		if (state.unparsed.end > state.unparsed.start)
+		{
+			stale.push_back(state.unparsed);
+		}
+	}
 
-	executeQueryAndHighlight(
-		query, newTree, fileContent, fileColors, initialParse, start, newEnd);
+	//   Update state
+	if (state.tree)
+		ts_tree_delete(state.tree);
+	state.tree = newTree;
+	state.content = snapshot;
+	state.tree_stale = false;
+	state.unparsed = {0, 0};
+	return ParseResult::Parsed;
 }
 
 void TreeSitter::printAST(TSTree *tree, const std::string &fileContent)
@@ -617,29 +888,47 @@ void TreeSitter::updateThemeColors()
 	newColor = loadColor("variable");
 	cachedColors.variable = newColor;
 
+	// Resolve highlight classes against the new theme
+	const ImVec4 &text = cachedColors.text;
+	palette[static_cast<size_t>(HighlightClass::Text)] = text;
+	palette[static_cast<size_t>(HighlightClass::Keyword)] = cachedColors.keyword;
+	palette[static_cast<size_t>(HighlightClass::String)] = cachedColors.string;
+	palette[static_cast<size_t>(HighlightClass::Number)] = cachedColors.number;
+	palette[static_cast<size_t>(HighlightClass::Comment)] = cachedColors.comment;
+	palette[static_cast<size_t>(HighlightClass::Function)] = cachedColors.function;
+	palette[static_cast<size_t>(HighlightClass::Type)] = cachedColors.type;
+	palette[static_cast<size_t>(HighlightClass::Variable)] = cachedColors.variable;
+	palette[static_cast<size_t>(HighlightClass::Operator)] =
+		theme.contains("operator") ? loadColor("operator") : text;
+	palette[static_cast<size_t>(HighlightClass::DimmedText)] =
+		ImVec4(text.x * 0.8f, text.y * 0.8f, text.z * 0.8f, text.w);
+	palette[static_cast<size_t>(HighlightClass::ReturnBlock)] =
+		ImVec4(1.0f, 0.7f, 0.75f, 1.0f);
+	palette[static_cast<size_t>(HighlightClass::Ghost)] = ImVec4(0.5f, 0.5f, 0.5f, 0.5f);
+
 	colorsNeedUpdate = false;
 }
 
-void TreeSitter::setColors(const std::string &content,
-						   std::vector<ImVec4> &colors,
+void TreeSitter::setColors(size_t contentSize,
+						   std::vector<HighlightClass> &colors,
 						   int start,
 						   int end,
-						   const ImVec4 &color)
+						   HighlightClass cls)
 {
-	if (end > content.size() || start > end)
+	if (end > contentSize || start > end)
 	{
 		return;
 	}
-	// Use content.size() for clamping instead of colors.size()
-	start = std::clamp(start, 0, static_cast<int>(content.size()) - 1);
-	end = std::clamp(end, 0, static_cast<int>(content.size()));
+	// Use contentSize for clamping instead of colors.size()
+	start = std::clamp(start, 0, static_cast<int>(contentSize) - 1);
+	end = std::clamp(end, 0, static_cast<int>(contentSize));
 
 	for (int i = start; i < end; ++i)
 	{
 		// Ensure colors vector is accessed safely
 		if (i < colors.size())
 		{
-			colors[i] = color;
+			colors[i] = cls;
 		}
 	}
-}
+}
\ No newline at end of file
@@ -1,10 +1,16 @@
 // editor_tree_sitter.h
 #pragma once
 #include "../util/settings.h"
+#include "editor_buffer.h"
+#include "editor_highlight_class.h"
 #include "imgui.h"
+#include <array>
+#include <atomic>
 #include <iostream>
+#include <memory>
 #include <mutex>
 #include <string>
+#include <string_view>
 #include <tree_sitter/api.h>
 #include <unordered_map>
 #include <unordered_set>
@@ -23,13 +29,119 @@ struct ThemeColors
 
 class TreeSitter
 {
+	struct CompiledQuery;
+
   public:
+	struct ByteRange
+	{
+		size_t start;
+		size_t end;
+	};
+
+	// Incremental parsing state of one document: the tree of its last parse
+	// and the text, language and file that tree belongs to. TreeSitter holds
+	// the state of the active document and the document cache the others;
+	// each has its own lock, so different documents parse in parallel.
+	struct SyntaxState
+	{
+		std::mutex mutex; // held while parsing or coloring from the tree
+		TSTree *tree = nullptr;
+		TSQueryCursor *cursor = nullptr; // reused by every highlight query
+		TextSnapshot content; // shares its pieces with the document buffer
+		const TSLanguage *language = nullptr;
+		std::shared_ptr<const CompiledQuery> query; // of language, set with it
+		std::string extension;
+		std::string file;
+		// Colors before this offset were set from the tree, the rest is left
+		// to the background fill after the viewport was colored
+		size_t filled_up_to = 0;
+		// Set when a parse was cancelled: tree is edited to match content but
+		// not parsed again, so it is not queried, and unparsed is the edited
+		// text the next parse has to color
+		bool tree_stale = false;
+		ByteRange unparsed = {0, 0};
+
+		SyntaxState() = default;
+		SyntaxState(const SyntaxState &) = delete;
+		SyntaxState &operator=(const SyntaxState &) = delete;
+		~SyntaxState();
+		void reset();
+	};
+
+	// State of the active document. Highlight passes keep the one they were
+	// started with, so a document switch never hands them another's tree.
+	static std::shared_ptr<SyntaxState> activeSyntax();
+
+	// Hand the active document's state to the cache and take one back from
+	// it when switching documents, so the next parse stays incremental.
+	static std::shared_ptr<SyntaxState> detachSyntax();
+	static void attachSyntax(std::shared_ptr<SyntaxState> state);
+
+	// Edits made to a document since the text of its last parse, as reported
+	// by the buffer's edit log.
+	struct EditDelta
+	{
+		uint64_t document_id = 0;
+		uint64_t base_version = 0;
+		std::vector<TextEdit> edits;
+	};
+
+	// Called with the live buffer when a snapshot of it is taken for parse().
+	// False when there is no tree of this document to update or the log no
+	// longer reaches back to it; parse() then starts over.
+	static bool
+	editsSinceLastParse(SyntaxState &state, const TextBuffer &buffer, EditDelta &delta);
+
 	static std::string getResourcePath(const std::string &relativePathToQuery);
 	static void clearQueryCache();
-	static void parse(const std::string &fileContent,
-					  std::vector<ImVec4> &fileColors,
-					  const std::string &extension,
-					  bool fullRehighlight = false);
+
+	// Compiles the highlight queries of the languages these extensions map
+	// to, so opening such a file later neither reads nor compiles anything.
+	// Blocks while compiling; called from a background thread.
+	static void warmUpLanguages(const std::unordered_set<std::string> &extensions);
+	// Whether files with extension have a grammar
+	static bool hasLanguage(const std::string &extension);
+
+	// Nonzero to stop a parse, the layout tree-sitter polls
+	using CancelFlag = std::atomic<size_t>;
+
+	enum class ParseResult
+	{
+		Parsed,
+		NoParser,
+		Cancelled
+	};
+
+	// Parses snapshot, reusing the tree of the last parse when delta leads
+	// from its text to snapshot. stale gets the ranges whose colors may have
+	// changed; after a parse from scratch it stays empty and fillNextSlice()
+	// colors the whole document. Setting cancel stops the parse, and the next
+	// one carries on from the edits this one had applied. file names the
+	// document, as copied by the pass on the UI thread; a state parsed for
+	// another file starts over.
+	static ParseResult parse(SyntaxState &state,
+							 const TextSnapshot &snapshot,
+							 const std::string &file,
+							 const std::string &extension,
+							 bool fullRehighlight,
+							 const EditDelta *delta,
+							 const CancelFlag *cancel,
+							 std::vector<ByteRange> &stale);
+
+	// Recolor ranges of colors from the tree of the last parse. colors must
+	// belong to snapshot and snapshot must be the text that was parsed, or
+	// nothing is done and false is returned.
+	static bool highlightRanges(SyntaxState &state,
+								const TextSnapshot &snapshot,
+								std::vector<HighlightClass> &colors,
+								const std::vector<ByteRange> &ranges);
+
+	// Colors up to max_bytes of the document that were not colored since it
+	// was parsed from scratch. Returns true while more remains.
+	static bool fillNextSlice(SyntaxState &state,
+							  const TextSnapshot &snapshot,
+							  std::vector<HighlightClass> &colors,
+							  size_t max_bytes);
 
 	static void updateThemeColors();
 	static void refreshColors() { colorsNeedUpdate = true; };
@@ -37,42 +149,90 @@ class TreeSitter
 	static bool colorsNeedUpdate;
 	static ThemeColors cachedColors;
 
-	static void setColors(const std::string &fileContent,
-						  std::vector<ImVec4> &fileColors,
+	// Color for each HighlightClass, rebuilt from cachedColors on theme change
+	static std::array<ImVec4, HIGHLIGHT_CLASS_COUNT> palette;
+	static const ImVec4 &colorFor(HighlightClass cls)
+	{
+		return palette[static_cast<size_t>(cls)];
+	}
+
+	static void setColors(size_t contentSize,
+						  std::vector<HighlightClass> &fileColors,
 						  int start,
 						  int end,
-						  const ImVec4 &color);
-	static TSParser *getParser();
+						  HighlightClass cls);
 
   private:
-	static TSParser *parser;
-	static std::mutex parserMutex;
-	static std::unordered_map<std::string, TSQuery *> queryCache;
+	// Idle parsers. A parser serves one parse at a time, so each parsing
+	// thread borrows one and the pool grows to the most parses at once.
+	static std::mutex parserPoolMutex;
+	static std::vector<TSParser *> idleParsers;
+	static TSParser *acquireParser();
+	static void releaseParser(TSParser *parser);
+
+	// A highlight query with the class of each capture id, resolved when the
+	// query is loaded so matching never looks up capture names. Queries are
+	// read only, so documents highlighting in parallel share them.
+	struct CompiledQuery
+	{
+		TSQuery *query = nullptr;
+		std::vector<HighlightClass> capture_classes;
+
+		CompiledQuery() = default;
+		CompiledQuery(const CompiledQuery &) = delete;
+		CompiledQuery &operator=(const CompiledQuery &) = delete;
+		~CompiledQuery();
+	};
+
+	// A grammar and its highlight query. Extensions of one grammar share an
+	// entry, whose query is compiled once, by the warm-up or by the first
+	// parse that needs it.
+	struct Language
+	{
+		const TSLanguage *grammar = nullptr;
+		std::string query_path;
+		std::mutex mutex; // held while compiling the query
+		std::shared_ptr<const CompiledQuery> query;
+		bool query_failed = false; // not retried until clearQueryCache()
+	};
+	// Built on first use and never changed after, so lookups need no lock
+	static const std::unordered_map<std::string, std::shared_ptr<Language>> &languages();
+	static Language *languageFor(const std::string &extension);
+	static std::shared_ptr<const CompiledQuery> queryFor(Language &language);
 	// incremental parsing
-	static TSTree *previousTree;
-	static std::string previousContent;
-
-	static std::pair<TSLanguage *, std::string>
-	detectLanguageAndQuery(const std::string &extension);
-	static void computeEditRange(const std::string &newContent,
-								 size_t &start,
-								 size_t &newEnd,
-								 size_t &oldEnd);
-	static TSInputEdit createEdit(size_t start, size_t oldEnd, size_t newEnd);
-	static TSInput createInput(const std::string &content);
-	static TSTree *
-	createNewTree(TSParser *parser, bool initialParse, const std::string &content);
-	static TSQuery *loadQueryFromCacheOrFile(TSLanguage *lang,
-											 const std::string &query_path);
-	static void executeQueryAndHighlight(TSQuery *query,
-										 TSTree *tree,
-										 const std::string &content,
-										 std::vector<ImVec4> &colors,
-										 bool initialParse,
-										 size_t start,
-										 size_t end);
-	static const TSLanguage *currentLanguage;
-	static std::string currentExtension;
+	static std::mutex activeMutex;
+	static std::shared_ptr<SyntaxState> active;
+
+	static bool coalesceEdits(const SyntaxState &state,
+							  const EditDelta &delta,
+							  const TextSnapshot &snapshot,
+							  size_t &start,
+							  size_t &oldEnd,
+							  size_t &newEnd);
+	static TSPoint pointAt(const TextSnapshot &text, size_t byte);
+	static TSPoint
+	advancePoint(TSPoint point, const TextSnapshot &text, size_t from, size_t to);
+	static TSInputEdit createEdit(const SyntaxState &state,
+								  const TextSnapshot &snapshot,
+								  size_t start,
+								  size_t oldEnd,
+								  size_t newEnd);
+	static TSInput createInput(const TextSnapshot &snapshot);
+	static TSTree *createNewTree(TSParser *parser,
+								 const SyntaxState &state,
+								 bool initialParse,
+								 const TextSnapshot &snapshot);
+	static std::shared_ptr<const CompiledQuery>
+	compileQuery(const TSLanguage *lang, const std::string &full_path);
+	static bool recolor(SyntaxState &state,
+						const TextSnapshot &snapshot,
+						std::vector<HighlightClass> &colors,
+						std::vector<ByteRange> ranges);
+	static void highlightRange(const SyntaxState &state,
+							   const CompiledQuery &query,
+							   std::vector<HighlightClass> &colors,
+							   size_t start,
+							   size_t end);
 	static void printAST(TSTree *tree, const std::string &fileContent);
 
   private:
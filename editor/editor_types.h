@@ -1,6 +1,14 @@
 // editor_types.h global state, include editor.h for external access
 #pragma once
+#include "editor_buffer.h"
+#include "editor_highlight_class.h"
+#include "editor_line_index.h"
+#include "editor_line_widths.h"
+#include "editor_line_wraps.h"
+#include "editor_semantic_spans.h"
 #include "imgui.h"
+#include <algorithm>
+#include <cstdint>
 #include <mutex>
 #include <string>
 #include <unordered_map>
@@ -37,13 +45,41 @@ struct MultiSelectionRange
 };
 struct EditorState
 {
-	// Content of file being edited as string
-	std::string fileContent;
+	// Content of file being edited, stored as a piece table
+	TextBuffer fileContent;
 
-	// syntax colors for every char
-	std::vector<ImVec4> fileColors;
+	// syntax class for every char, resolved to a color through the theme
+	// palette when drawing. Left empty for large files, which draw as text.
+	std::vector<HighlightClass> fileColors;
 	std::mutex colorsMutex;
 
+	// File is too large to keep per-char state for: it is mapped instead of
+	// read, and highlighting, undo history and LSP sync are off for it.
+	bool large_file = false;
+
+	// Keep fileColors in step with an edit of fileContent. Ranges are clamped
+	// to the colors there are, so a short or empty vector is never overrun.
+	// The highlight worker writes colors in place, so resizing takes the lock.
+	void eraseColors(size_t pos, size_t length)
+	{
+		std::lock_guard<std::mutex> lock(colorsMutex);
+		pos = std::min(pos, fileColors.size());
+		length = std::min(length, fileColors.size() - pos);
+		fileColors.erase(fileColors.begin() + pos, fileColors.begin() + pos + length);
+	}
+	void insertColors(size_t pos,
+					  size_t length,
+					  HighlightClass cls = HighlightClass::Text)
+	{
+		if (large_file)
+		{
+			return;
+		}
+		std::lock_guard<std::mutex> lock(colorsMutex);
+		pos = std::min(pos, fileColors.size());
+		fileColors.insert(fileColors.begin() + pos, length, cls);
+	}
+
 	// Size of editor window
 	ImVec2 size;
 
@@ -77,23 +113,40 @@ struct EditorState
 	 * first line. Each subsequent entry represents the character position where
 	 * a new line begins. These positions correspond to the character
 	 * immediately after a newline character.
+	 * Kept up to date from the buffer's edit log by Editor::updateLineStarts.
 	 */
-	std::vector<int> editor_content_lines;
+	LineIndex editor_content_lines;
 
 	/*
 	 * Line Widths
-	 * Stores the pixel width of each line in the editor.
-	 * Each entry corresponds to the rendered width of a line in pixels.
+	 * Stores the measured width of each line in the editor, pixels for
+	 * proportional fonts and columns for monospace ones.
 	 * Used for layout calculations, particularly for horizontal scrolling.
 	 */
-	std::vector<float> line_widths;
+	LineWidths line_widths;
+	ImFont *line_widths_font = nullptr; // font the widths were measured with
+	float line_widths_font_size = 0.0f;
+	bool line_widths_monospace = false;
+	float line_widths_advance = 0.0f; // monospace: pixels per column
+	float line_widths_tab_columns = 4.0f;
+
+	/*
+	 * Line Wraps
+	 * Soft wrap break positions of each line and the visual row index built
+	 * from them. Laid out and queried through gEditorWrap.
+	 */
+	LineWraps line_wraps;
+
+	/*
+	 * Semantic Spans
+	 * Classes the language server gave ranges of the document, drawn over
+	 * fileColors. Moved along with edits by the renderer every frame.
+	 */
+	SemanticSpans semantic_spans;
 
 	// scalling values
 	float current_scroll_x, current_scroll_y;
 
-	// Caching for expensive measurements
-	std::string cached_text;
-
 	// Miscellaneous state variables
 	bool rainbow_mode;		 // Visual setting for cursor mode, line numbers, and file
 	bool active_find_box;	 // Cmd+F search file dialog open
@@ -124,7 +177,7 @@ struct EditorState
 	EditorState()
 		: cursor_column_prefered(0), cursor_index(0), selection_start(0),
 		  selection_end(0), selection_active(false), full_text_selected(false),
-		  editor_content_lines({0}), line_widths(), rainbow_mode(true),
+		  editor_content_lines(), line_widths(), rainbow_mode(true),
 		  cursor_blink_time(0.0f), active_find_box(false), block_input(false)
 	{
 	}
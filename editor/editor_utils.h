@@ -1,4 +1,5 @@
 #pragma once
+#include "editor_line_index.h"
 #include "imgui.h"
 #include <GLFW/glfw3.h> // For time functions
 #include <algorithm>
@@ -29,10 +30,13 @@ inline ImVec4 GetRainbowColor(float timeScale = 2.0f)
 }
 
 // Helper method to calculate the line number from cursor position
-inline int GetLineFromPosition(const std::vector<int> &line_starts, int content_index)
+inline int GetLineFromPosition(const LineIndex &line_starts, int content_index)
 {
-	auto it = std::upper_bound(line_starts.begin(), line_starts.end(), content_index);
-	return std::distance(line_starts.begin(), it) - 1;
+	if (content_index < 0)
+	{
+		return -1;
+	}
+	return static_cast<int>(line_starts.lineFromOffset(content_index));
 }
 
 } // namespace EditorUtils
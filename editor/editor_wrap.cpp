@@ -0,0 +1,224 @@
+/*
+	File: editor_wrap.cpp
+	Description: Soft wrap layout. Maps between logical lines, document
+	positions and the visual rows they are drawn on.
+*/
+
+#include "editor_wrap.h"
+#include "../util/settings.h"
+#include "editor.h"
+#include "editor_glyphs.h"
+
+#include <algorithm>
+
+EditorWrap gEditorWrap;
+
+void EditorWrap::update(float wrap_width)
+{
+	LineWraps &wraps = editor_state.line_wraps;
+	const LineIndex &lines = editor_state.editor_content_lines;
+	if (wraps.size() != lines.size())
+	{
+		wraps.splice(0, wraps.size(), lines.size());
+	}
+
+	// Large files draw only a prefix of long lines, so they never wrap
+	bool wanted = gSettings.getWordWrap() && !editor_state.large_file;
+	if (wanted != active)
+	{
+		active = wanted;
+		wraps.invalidateAll(); // breaks went stale while wrap was off
+	}
+	if (!active)
+	{
+		return;
+	}
+
+	wrap_width = std::max(wrap_width, MIN_WRAP_WIDTH);
+	ImFont *current_font = ImGui::GetFont();
+	float current_size = ImGui::GetFontSize();
+	if (wrap_width != width || current_font != font || current_size != font_size)
+	{
+		width = wrap_width;
+		font = current_font;
+		font_size = current_size;
+		wraps.invalidateAll();
+	}
+	if (!wraps.anyDirty() || editor_state.line_height <= 0.0f)
+	{
+		return;
+	}
+
+	// Remember where the top visible line sits, so correcting the estimates
+	// above it does not move the text under the user
+	const float line_height = editor_state.line_height;
+	const float scroll_y = editor_state.current_scroll_y;
+	size_t top_line = wraps.lineAtRow(static_cast<size_t>(scroll_y / line_height));
+	size_t top_row = wraps.firstRow(top_line);
+	float offset_in_line = scroll_y - top_row * line_height;
+
+	// Visible lines first, then a slice of the rest
+	size_t visible_rows = static_cast<size_t>(editor_state.size.y / line_height) + 2;
+	size_t rows = 0;
+	for (size_t line = top_line; line < wraps.size() && rows < visible_rows; ++line)
+	{
+		ensureMeasured(line);
+		rows += wraps.rowCount(line);
+	}
+	size_t measured_bytes = 0;
+	for (size_t line = wraps.nextDirty(0);
+		 line < wraps.size() && measured_bytes < MEASURE_BUDGET_BYTES;
+		 line = wraps.nextDirty(line + 1))
+	{
+		measured_bytes += lines.lineLength(line);
+		ensureMeasured(line);
+	}
+
+	size_t new_top_row = wraps.firstRow(top_line);
+	if (new_top_row != top_row)
+	{
+		float new_scroll_y = new_top_row * line_height + offset_in_line;
+		editor_state.current_scroll_y = new_scroll_y;
+		ImGui::SetNextWindowScroll(ImVec2(-1.0f, new_scroll_y));
+	}
+}
+
+size_t EditorWrap::totalRows() const
+{
+	return active ? editor_state.line_wraps.totalRows()
+				  : editor_state.editor_content_lines.size();
+}
+
+size_t EditorWrap::firstRow(size_t line) const
+{
+	return active ? editor_state.line_wraps.firstRow(line) : line;
+}
+
+size_t EditorWrap::lineAtRow(size_t row) const
+{
+	if (active)
+	{
+		return editor_state.line_wraps.lineAtRow(row);
+	}
+	size_t line_count = editor_state.editor_content_lines.size();
+	return std::min(row, line_count > 0 ? line_count - 1 : 0);
+}
+
+size_t EditorWrap::rowOfPosition(size_t pos)
+{
+	size_t line = editor_state.editor_content_lines.lineFromOffset(pos);
+	if (!active)
+	{
+		return line;
+	}
+	const std::vector<uint32_t> &breaks = lineBreaks(line);
+	size_t offset = pos - editor_state.editor_content_lines[line];
+	size_t row_in_line = std::upper_bound(breaks.begin(), breaks.end(), offset) -
+						 breaks.begin();
+	return editor_state.line_wraps.firstRow(line) + row_in_line;
+}
+
+size_t EditorWrap::rowStartOfPosition(size_t pos)
+{
+	size_t line = editor_state.editor_content_lines.lineFromOffset(pos);
+	size_t line_start = editor_state.editor_content_lines[line];
+	if (!active)
+	{
+		return line_start;
+	}
+	const std::vector<uint32_t> &breaks = lineBreaks(line);
+	auto next = std::upper_bound(breaks.begin(), breaks.end(), pos - line_start);
+	return next == breaks.begin() ? line_start : line_start + *(next - 1);
+}
+
+void EditorWrap::rowBounds(size_t row, size_t &start, size_t &end)
+{
+	const LineIndex &lines = editor_state.editor_content_lines;
+	size_t line = lineAtRow(row);
+	if (active)
+	{
+		// Measuring a line can change which line the row falls on
+		while (editor_state.line_wraps.dirty(line))
+		{
+			ensureMeasured(line);
+			line = lineAtRow(row);
+		}
+	}
+
+	size_t line_start = lines[line];
+	size_t line_end = line + 1 < lines.size() ? lines[line + 1] - 1
+											  : editor_state.fileContent.size();
+	const std::vector<uint32_t> &breaks = lineBreaks(line);
+	size_t row_in_line = std::min(row - firstRow(line), breaks.size());
+
+	start = row_in_line > 0 ? line_start + breaks[row_in_line - 1] : line_start;
+	end = row_in_line < breaks.size() ? line_start + breaks[row_in_line] - 1 : line_end;
+}
+
+const std::vector<uint32_t> &EditorWrap::lineBreaks(size_t line)
+{
+	static const std::vector<uint32_t> no_breaks;
+	if (!active || line >= editor_state.line_wraps.size())
+	{
+		return no_breaks;
+	}
+	ensureMeasured(line);
+	return editor_state.line_wraps.breaks(line);
+}
+
+void EditorWrap::ensureMeasured(size_t line)
+{
+	LineWraps &wraps = editor_state.line_wraps;
+	if (!active || !wraps.dirty(line))
+	{
+		return;
+	}
+	const LineIndex &lines = editor_state.editor_content_lines;
+	std::string text =
+		editor_state.fileContent.substr(lines[line], lines.lineLength(line));
+	if (!text.empty() && text.back() == '\n')
+	{
+		text.pop_back();
+	}
+	wraps.setBreaks(line, computeBreaks(text));
+}
+
+std::vector<uint32_t> EditorWrap::computeBreaks(std::string_view text) const
+{
+	std::vector<uint32_t> breaks;
+	const char *data = text.data();
+	const char *data_end = data + text.size();
+	size_t row_start = 0;
+	size_t after_space = 0; // where the row could break after a space or tab
+	float x = 0.0f;
+
+	for (size_t i = 0; i < text.size();)
+	{
+		// Same advances and tab stops as EditorRender::renderLine, with each
+		// row starting at x = 0
+		size_t length = 1;
+		bool space = data[i] == ' ' || data[i] == '\t';
+		float advance = data[i] == '\t'
+							? gEditorGlyphs.tabWidth(x)
+							: gEditorGlyphs.charAdvance(data + i, data_end, length);
+
+		// Spaces may hang past the edge, anything else starts a new row
+		if (!space && x + advance > width && i > row_start)
+		{
+			size_t at = after_space > row_start ? after_space : i;
+			breaks.push_back(static_cast<uint32_t>(at));
+			row_start = at;
+			i = at;
+			x = 0.0f;
+			continue;
+		}
+
+		x += advance;
+		i += length;
+		if (space)
+		{
+			after_space = i;
+		}
+	}
+	return breaks;
+}
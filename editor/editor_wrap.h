@@ -0,0 +1,66 @@
+/*
+	File: editor_wrap.h
+	Description: Soft wrap layout. Maps between logical lines, document
+	positions and the visual rows they are drawn on.
+
+	Lines break at the last space or tab that fits the text area, or mid-word
+	when a single word is wider than it. Breaks are cached per line in
+	EditorState::line_wraps: visible lines are measured on demand, the rest a
+	slice per frame, and scrolling keeps the top visible line in place while
+	estimates above it are corrected. With wrap off, or for large files, every
+	line is one row and all queries fall back to plain line numbers.
+*/
+
+#pragma once
+#include "imgui.h"
+
+#include <cstddef>
+#include <cstdint>
+#include <string_view>
+#include <vector>
+
+// Forward declarations
+class EditorWrap;
+extern EditorWrap gEditorWrap;
+
+class EditorWrap
+{
+  public:
+	// Called once per frame before the editor child window begins, with the
+	// width text may take up. Measures visible and some pending lines.
+	void update(float wrap_width);
+
+	bool enabled() const { return active; }
+
+	size_t totalRows() const;
+	size_t firstRow(size_t line) const;
+	size_t lineAtRow(size_t row) const;
+
+	// Visual row that pos is drawn on.
+	size_t rowOfPosition(size_t pos);
+
+	// Document position the row holding pos starts at.
+	size_t rowStartOfPosition(size_t pos);
+
+	// Bounds of a row: start, and the end a caret can still be placed at,
+	// which is the newline for the last row of a line and the char before
+	// the next row otherwise.
+	void rowBounds(size_t row, size_t &start, size_t &end);
+
+	// Offsets from the line start where its later rows begin.
+	const std::vector<uint32_t> &lineBreaks(size_t line);
+
+  private:
+	// Bytes of pending lines measured per frame, on top of visible ones
+	static constexpr size_t MEASURE_BUDGET_BYTES = 256 * 1024;
+	// Widths below this would leave just a few chars per row
+	static constexpr float MIN_WRAP_WIDTH = 100.0f;
+
+	void ensureMeasured(size_t line);
+	std::vector<uint32_t> computeBreaks(std::string_view text) const;
+
+	bool active = false;
+	float width = 0.0f;
+	ImFont *font = nullptr;
+	float font_size = 0.0f;
+};
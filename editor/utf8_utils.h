@@ -1,7 +1,8 @@
 #pragma once
 #include <string>
 
-inline int snapToUtf8CharBoundary(const std::string &str, int idx)
+// Works with std::string and TextBuffer alike
+template <typename Text> inline int snapToUtf8CharBoundary(const Text &str, int idx)
 {
 	if (idx <= 0 || idx >= (int)str.size())
 		return idx;
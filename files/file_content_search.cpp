@@ -36,7 +36,7 @@ void FileContentSearch::findNext(bool ignoreCase)
 	size_t foundPos;
 	if (ignoreCase)
 	{
-		std::string fileContentLower = toLower(editor_state.fileContent);
+		std::string fileContentLower = toLower(editor_state.fileContent.str());
 		std::string findTextLower = toLower(findText);
 		foundPos = fileContentLower.find(findTextLower, startPos);
 	} else
@@ -54,7 +54,7 @@ void FileContentSearch::findNext(bool ignoreCase)
 		// Wrap around to the beginning
 		if (ignoreCase)
 		{
-			std::string fileContentLower = toLower(editor_state.fileContent);
+			std::string fileContentLower = toLower(editor_state.fileContent.str());
 			std::string findTextLower = toLower(findText);
 			foundPos = fileContentLower.find(findTextLower);
 		} else
@@ -98,7 +98,7 @@ void FileContentSearch::findPrevious(bool ignoreCase)
 	size_t foundPos;
 	if (ignoreCase)
 	{
-		std::string fileContentLower = toLower(editor_state.fileContent);
+		std::string fileContentLower = toLower(editor_state.fileContent.str());
 		std::string findTextLower = toLower(findText);
 		foundPos = fileContentLower.rfind(findTextLower, startPos);
 	} else
@@ -117,7 +117,7 @@ void FileContentSearch::findPrevious(bool ignoreCase)
 		// Wrap around to the end
 		if (ignoreCase)
 		{
-			std::string fileContentLower = toLower(editor_state.fileContent);
+			std::string fileContentLower = toLower(editor_state.fileContent.str());
 			std::string findTextLower = toLower(findText);
 			foundPos = fileContentLower.rfind(findTextLower);
 		} else
@@ -316,7 +316,7 @@ std::vector<size_t> FileContentSearch::findAllOccurrences(bool ignoreCase)
 		size_t foundPos;
 		if (ignoreCase)
 		{
-			std::string fileContentLower = toLower(editor_state.fileContent);
+			std::string fileContentLower = toLower(editor_state.fileContent.str());
 			std::string findTextLower = toLower(findText);
 			foundPos = fileContentLower.find(findTextLower, startPos);
 		} else
@@ -0,0 +1,164 @@
+/*
+	File: file_document_cache.cpp
+	Description: Keeps recently closed documents in memory so switching back
+	to them swaps the editor state instead of reading and parsing the file again.
+*/
+
+#include "file_document_cache.h"
+#include "../editor/editor.h"
+
+#include <algorithm>
+#include <iostream>
+#include <system_error>
+#include <utility>
+
+size_t DocumentCache::CachedDocument::memoryBytes() const
+{
+	// Mapped content lives in the page cache, only edits take heap memory
+	size_t bytes = content.mapsFile() ? 0 : content.size();
+	bytes += colors.capacity() * sizeof(HighlightClass);
+	bytes += lines.size() * sizeof(size_t); // line starts, in chunks
+	bytes += widths.size() * sizeof(float);
+	bytes += wraps.size() * (sizeof(std::vector<uint32_t>) + sizeof(size_t));
+	// syntax.content shares its pieces with content
+	return bytes;
+}
+
+bool DocumentCache::statFile(const std::string &path,
+							 fs::file_time_type &write_time,
+							 uintmax_t &file_size)
+{
+	std::error_code ec;
+	write_time = fs::last_write_time(path, ec);
+	if (ec)
+	{
+		return false;
+	}
+	file_size = fs::file_size(path, ec);
+	return !ec;
+}
+
+void DocumentCache::storeActive(const std::string &path, bool colors_current)
+{
+	remove(path);
+
+	auto doc = std::make_unique<CachedDocument>();
+	if (!statFile(path, doc->write_time, doc->file_size))
+	{
+		return;
+	}
+	doc->path = path;
+
+	// Moves only: the buffer, index and tree change hands without copying
+	doc->content = std::move(editor_state.fileContent);
+	doc->colors = std::move(editor_state.fileColors);
+	doc->colors_current = colors_current;
+	doc->large_file = editor_state.large_file;
+	doc->lines = std::move(editor_state.editor_content_lines);
+	doc->widths = std::move(editor_state.line_widths);
+	doc->widths_font = editor_state.line_widths_font;
+	doc->widths_font_size = editor_state.line_widths_font_size;
+	doc->widths_monospace = editor_state.line_widths_monospace;
+	doc->widths_advance = editor_state.line_widths_advance;
+	doc->widths_tab_columns = editor_state.line_widths_tab_columns;
+	doc->wraps = std::move(editor_state.line_wraps);
+	doc->syntax = TreeSitter::detachSyntax();
+	doc->cursor_index = editor_state.cursor_index;
+	doc->selection_start = editor_state.selection_start;
+	doc->selection_end = editor_state.selection_end;
+	doc->selection_active = editor_state.selection_active;
+	doc->scroll_x = editor_state.current_scroll_x;
+	doc->scroll_y = editor_state.current_scroll_y;
+
+	// Leave editor_state empty rather than moved-from, so the next document
+	// starts from a fresh line index
+	editor_state.fileContent = TextBuffer();
+	editor_state.fileColors.clear();
+	editor_state.editor_content_lines = LineIndex();
+	editor_state.line_widths = LineWidths();
+	editor_state.line_wraps = LineWraps();
+
+	memory_used += doc->memoryBytes();
+	entries.push_front(std::move(doc));
+	index[path] = entries.begin();
+	evict();
+}
+
+bool DocumentCache::restoreActive(const std::string &path, bool &colors_current)
+{
+	auto found = index.find(path);
+	if (found == index.end())
+	{
+		return false;
+	}
+	std::unique_ptr<CachedDocument> doc = std::move(*found->second);
+	memory_used -= doc->memoryBytes();
+	entries.erase(found->second);
+	index.erase(found);
+
+	fs::file_time_type write_time;
+	uintmax_t file_size = 0;
+	if (!statFile(path, write_time, file_size) || write_time != doc->write_time ||
+		file_size != doc->file_size)
+	{
+		std::cout << "Document cache: " << path << " changed on disk, reloading"
+				  << std::endl;
+		return false;
+	}
+
+	editor_state.fileContent = std::move(doc->content);
+	editor_state.fileColors = std::move(doc->colors);
+	colors_current = doc->colors_current;
+	editor_state.large_file = doc->large_file;
+	editor_state.editor_content_lines = std::move(doc->lines);
+	editor_state.line_widths = std::move(doc->widths);
+	editor_state.line_widths_font = doc->widths_font;
+	editor_state.line_widths_font_size = doc->widths_font_size;
+	editor_state.line_widths_monospace = doc->widths_monospace;
+	editor_state.line_widths_advance = doc->widths_advance;
+	editor_state.line_widths_tab_columns = doc->widths_tab_columns;
+	// The wrap width may have changed since; old breaks serve as estimates
+	editor_state.line_wraps = std::move(doc->wraps);
+	editor_state.line_wraps.invalidateAll();
+	TreeSitter::attachSyntax(std::move(doc->syntax));
+
+	int length = static_cast<int>(editor_state.fileContent.size());
+	auto clamp = [length](int pos) { return std::clamp(pos, 0, length); };
+	editor_state.cursor_index = clamp(doc->cursor_index);
+	editor_state.selection_start = clamp(doc->selection_start);
+	editor_state.selection_end = clamp(doc->selection_end);
+	editor_state.selection_active = doc->selection_active;
+	editor_state.current_scroll_x = doc->scroll_x;
+	editor_state.current_scroll_y = doc->scroll_y;
+	return true;
+}
+
+void DocumentCache::remove(const std::string &path)
+{
+	auto found = index.find(path);
+	if (found == index.end())
+	{
+		return;
+	}
+	memory_used -= (*found->second)->memoryBytes();
+	entries.erase(found->second);
+	index.erase(found);
+}
+
+void DocumentCache::clear()
+{
+	entries.clear();
+	index.clear();
+	memory_used = 0;
+}
+
+void DocumentCache::evict()
+{
+	while (!entries.empty() &&
+		   (entries.size() > MAX_DOCUMENTS || memory_used > MEMORY_BUDGET))
+	{
+		memory_used -= entries.back()->memoryBytes();
+		index.erase(entries.back()->path);
+		entries.pop_back();
+	}
+}
@@ -0,0 +1,91 @@
+/*
+	File: file_document_cache.h
+	Description: Keeps recently closed documents in memory so switching back
+	to them swaps the editor state instead of reading and parsing the file again.
+
+	A cached document holds everything the editor built for it: the buffer,
+	highlight classes, line index, widths and wraps, the tree-sitter tree,
+	cursor and scroll position. Only saved documents are cached, and an entry is dropped
+	when the file's write time or size no longer matches, so the cache never
+	shows stale text. Entries are evicted least recently used first once there
+	are more than MAX_DOCUMENTS or they use more than MEMORY_BUDGET bytes.
+*/
+
+#pragma once
+#include "../editor/editor_tree_sitter.h"
+#include "../editor/editor_types.h"
+
+#include <cstddef>
+#include <cstdint>
+#include <filesystem>
+#include <list>
+#include <memory>
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+namespace fs = std::filesystem;
+
+class DocumentCache
+{
+  public:
+	static constexpr size_t MAX_DOCUMENTS = 16;
+	static constexpr size_t MEMORY_BUDGET = 256 * 1024 * 1024;
+
+	struct CachedDocument
+	{
+		std::string path;
+		fs::file_time_type write_time;
+		uintmax_t file_size = 0;
+
+		TextBuffer content;
+		std::vector<HighlightClass> colors;
+		bool colors_current = false; // false when highlighting was cut short
+		bool large_file = false;
+		LineIndex lines;
+		LineWidths widths;
+		ImFont *widths_font = nullptr;
+		float widths_font_size = 0.0f;
+		bool widths_monospace = false;
+		float widths_advance = 0.0f;
+		float widths_tab_columns = 4.0f;
+		LineWraps wraps;
+		std::shared_ptr<TreeSitter::SyntaxState> syntax;
+
+		int cursor_index = 0;
+		int selection_start = 0;
+		int selection_end = 0;
+		bool selection_active = false;
+		float scroll_x = 0.0f;
+		float scroll_y = 0.0f;
+
+		size_t memoryBytes() const;
+	};
+
+	// Moves the active document out of editor_state into the cache. Nothing is
+	// cached when the file cannot be stat'ed.
+	void storeActive(const std::string &path, bool colors_current);
+
+	// Moves the cached document for path into editor_state. Returns false and
+	// leaves editor_state alone when there is no entry or it is out of date.
+	// colors_current tells whether its highlighting finished before it was stored.
+	bool restoreActive(const std::string &path, bool &colors_current);
+
+	void remove(const std::string &path);
+	void clear();
+
+	size_t documentCount() const { return entries.size(); }
+	size_t memoryUsed() const { return memory_used; }
+
+  private:
+	static bool statFile(const std::string &path,
+						 fs::file_time_type &write_time,
+						 uintmax_t &file_size);
+	void evict();
+
+	// Most recently used first
+	std::list<std::unique_ptr<CachedDocument>> entries;
+	std::unordered_map<std::string, std::list<std::unique_ptr<CachedDocument>>::iterator>
+		index;
+	size_t memory_used = 0;
+};
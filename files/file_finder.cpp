@@ -6,7 +6,9 @@
 #include "../util/close_popper.h"
 #include "../util/keybinds.h"
 #include "editor.h"
+#include "editor_tree_sitter.h"
 #include <thread>
+#include <unordered_set>
 FileFinder gFileFinder;
 
 FileFinder::FileFinder()
@@ -44,6 +46,10 @@ void FileFinder::backgroundRefresh()
 				currentProjectDir = projectDir;
 				refreshFileListBackground(projectDir);
 				lastScanTime = now;
+				if (directoryChanged)
+				{
+					warmUpProjectLanguages();
+				}
 			}
 		}
 
@@ -122,6 +128,25 @@ void FileFinder::refreshFileListBackground(const std::string &projectDir)
 		std::cerr << "Error refreshing file list: " << e.what() << std::endl;
 	}
 }
+void FileFinder::warmUpProjectLanguages()
+{
+	// Compile the queries of the languages in the project now, rather than
+	// when the first file of each is opened
+	if (!gSettings.getTreesitterMode())
+	{
+		return;
+	}
+	std::unordered_set<std::string> extensions;
+	{
+		std::lock_guard<std::mutex> lock(fileListMutex);
+		for (const FileEntry &entry : fileList)
+		{
+			extensions.insert(fs::path(entry.fullPath).extension().string());
+		}
+	}
+	TreeSitter::warmUpLanguages(extensions);
+}
+
 void FileFinder::updateFilteredList()
 {
 	std::string searchTerm(searchBuffer);
@@ -39,6 +39,7 @@ class FileFinder
 
 	void backgroundRefresh();
 	void refreshFileListBackground(const std::string &projectDir);
+	void warmUpProjectLanguages();
 	// Helper functions to break up the renderWindow() logic:
 	void renderHeader();
 	bool renderSearchInput();
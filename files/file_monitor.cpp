@@ -9,6 +9,8 @@
 #include <fstream>
 #include <iostream>
 #include <sstream>
+#include <string_view>
+#include <vector>
 
 // Constructor
 FileMonitor::FileMonitor() { initializeMonitoredExtensions(); }
@@ -146,12 +148,10 @@ void FileMonitor::addFileToMonitoring(const std::string &filePath)
 			// Calculate content hash for change detection
 			try
 			{
-				std::ifstream file(filePath, std::ios::binary);
-				if (file)
+				std::string hash = calculateFileHash(filePath);
+				if (!hash.empty())
 				{
-					std::stringstream buffer;
-					buffer << file.rdbuf();
-					_fileContentHashes[filePath] = calculateFileHash(buffer.str());
+					_fileContentHashes[filePath] = hash;
 				}
 			} catch (...)
 			{
@@ -178,12 +178,10 @@ void FileMonitor::refreshFileState(const std::string &filePath)
 		// Update the content hash to current
 		try
 		{
-			std::ifstream file(filePath, std::ios::binary);
-			if (file)
+			std::string hash = calculateFileHash(filePath);
+			if (!hash.empty())
 			{
-				std::stringstream buffer;
-				buffer << file.rdbuf();
-				_fileContentHashes[filePath] = calculateFileHash(buffer.str());
+				_fileContentHashes[filePath] = hash;
 			}
 		} catch (...)
 		{
@@ -250,20 +248,13 @@ bool FileMonitor::shouldReloadFile(const std::string &filePath)
 {
 	try
 	{
-		// Read the current file content
-		std::ifstream file(filePath, std::ios::binary);
-		if (!file)
+		// Calculate hash of current content
+		std::string currentHash = calculateFileHash(filePath);
+		if (currentHash.empty())
 		{
 			return false;
 		}
 
-		std::stringstream buffer;
-		buffer << file.rdbuf();
-		std::string currentContent = buffer.str();
-
-		// Calculate hash of current content
-		std::string currentHash = calculateFileHash(currentContent);
-
 		// Compare with stored hash
 		auto it = _fileContentHashes.find(filePath);
 		if (it != _fileContentHashes.end())
@@ -280,10 +271,34 @@ bool FileMonitor::shouldReloadFile(const std::string &filePath)
 	}
 }
 
-std::string FileMonitor::calculateFileHash(const std::string &content)
+std::string FileMonitor::calculateFileHash(const std::string &filePath)
 {
-	std::hash<std::string> hasher;
 	std::stringstream ss;
-	ss << std::hex << hasher(content);
+
+	// Large files are not read at all; any newer write time counts as a change
+	std::error_code ec;
+	uintmax_t fileSize = fs::file_size(filePath, ec);
+	if (!ec && fileSize > HASH_CONTENT_LIMIT)
+	{
+		ss << "size:" << fileSize << ":"
+		   << fs::last_write_time(filePath, ec).time_since_epoch().count();
+		return ss.str();
+	}
+
+	// Hash block by block so the file is never held in memory as a whole
+	std::ifstream file(filePath, std::ios::binary);
+	if (!file)
+	{
+		return "";
+	}
+	std::hash<std::string_view> hasher;
+	std::vector<char> block(64 * 1024);
+	size_t hash = 0;
+	while (file.read(block.data(), block.size()) || file.gcount() > 0)
+	{
+		std::string_view data(block.data(), static_cast<size_t>(file.gcount()));
+		hash = hash * 31 + hasher(data);
+	}
+	ss << std::hex << hash;
 	return ss.str();
 }
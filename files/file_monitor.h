@@ -5,6 +5,7 @@
 
 #pragma once
 
+#include <cstdint>
 #include <filesystem>
 #include <functional>
 #include <map>
@@ -47,7 +48,10 @@ class FileMonitor
 
 	// File change detection helpers
 	bool shouldReloadFile(const std::string &filePath);
-	std::string calculateFileHash(const std::string &content);
+	std::string calculateFileHash(const std::string &filePath);
+
+	// Files above this are compared by size and write time instead of content
+	static constexpr uintmax_t HASH_CONTENT_LIMIT = 8 * 1024 * 1024;
 
 	// Member variables
 	std::string _projectFolder;
@@ -1,4 +1,5 @@
 #pragma once
+#include "../editor/editor_buffer.h"
 #include "../lib/json.hpp"
 #include <algorithm>
 #include <chrono>
@@ -19,26 +20,27 @@ class UndoRedoManager
 		int cursor_before;	  // Cursor position before the change
 		int cursor_after;	  // Cursor position after the change
 
-		// Helper to apply this operation to a string
-		std::string apply(const std::string &current) const
+		// Helper to apply this operation to a snapshot. The result shares all
+		// untouched text with current, so this is O(log n) rather than a copy.
+		TextSnapshot apply(const TextSnapshot &current) const
 		{
-			std::string result = current;
+			TextBuffer result(current);
 			if (position >= 0 && position <= static_cast<int>(result.length()))
 			{
 				result.replace(position, inserted.length(), removed);
 			}
-			return result;
+			return result.snapshot();
 		}
 
 		// Helper to apply inverse (redo) operation
-		std::string applyInverse(const std::string &current) const
+		TextSnapshot applyInverse(const TextSnapshot &current) const
 		{
-			std::string result = current;
+			TextBuffer result(current);
 			if (position >= 0 && position <= static_cast<int>(result.length()))
 			{
 				result.replace(position, removed.length(), inserted);
 			}
-			return result;
+			return result.snapshot();
 		}
 	};
 
@@ -46,7 +48,7 @@ class UndoRedoManager
 	{
 		json j;
 		j["maxStackSize"] = maxStackSize;
-		j["lastCommittedState"] = lastCommittedState;
+		j["lastCommittedState"] = lastCommittedState.str();
 		j["undoStack"] = json::array();
 		j["redoStack"] = json::array();
 
@@ -78,7 +80,8 @@ class UndoRedoManager
 		try
 		{
 			maxStackSize = j.value("maxStackSize", 50); // Reduced default
-			lastCommittedState = j.value("lastCommittedState", "");
+			lastCommittedState =
+				TextBuffer(j.value("lastCommittedState", std::string())).snapshot();
 			undoStack.clear();
 			redoStack.clear();
 
@@ -129,13 +132,14 @@ class UndoRedoManager
 			std::cerr << "Error loading undo/redo state: " << e.what() << std::endl;
 			undoStack.clear();
 			redoStack.clear();
-			lastCommittedState = "";
+			lastCommittedState = TextSnapshot();
 			maxStackSize = 50;
 		}
 	}
 
-	// Simplified API: Only current content and cursor index
-	void addState(const std::string &currentContent, int cursor_after)
+	// Simplified API: Only current content and cursor index. Snapshots make
+	// recording a state O(1), the diff is only computed once typing pauses.
+	void addState(const TextSnapshot &currentContent, int cursor_after)
 	{
 		std::cout << "Adding state: " << cursor_after << std::endl;
 		if (!hasPending)
@@ -205,7 +209,7 @@ class UndoRedoManager
 		return {op, true};
 	}
 
-	void initialize(const std::string &content, int cursor)
+	void initialize(const TextSnapshot &content, int cursor)
 	{
 		lastCommittedState = content;
 		pendingFinalCursor = cursor;
@@ -235,11 +239,11 @@ class UndoRedoManager
 	std::vector<Operation> undoStack;
 	std::vector<Operation> redoStack;
 	size_t maxStackSize = 50;		// Reduced from 100 to 50
-	std::string lastCommittedState; // Last known state after commit
+	TextSnapshot lastCommittedState; // Last known state after commit
 
 	// Debounce members
-	std::string pendingInitialContent;
-	std::string pendingFinalContent;
+	TextSnapshot pendingInitialContent;
+	TextSnapshot pendingFinalContent;
 	int pendingInitialCursor = 0;
 	int pendingFinalCursor = 0;
 	bool hasPending = false;
@@ -258,24 +262,29 @@ class UndoRedoManager
 	void computeAndSaveOperation()
 	{
 		// Compute diff between initial and final states
-		const std::string &oldStr = pendingInitialContent;
-		const std::string &newStr = pendingFinalContent;
+		const TextSnapshot &oldStr = pendingInitialContent;
+		const TextSnapshot &newStr = pendingFinalContent;
 
 		// Find first difference
 		size_t start = 0;
 		size_t minLen = std::min(oldStr.length(), newStr.length());
+		TextBuffer::const_iterator oldIt = oldStr.begin();
+		TextBuffer::const_iterator newIt = newStr.begin();
 
-		while (start < minLen && oldStr[start] == newStr[start])
+		while (start < minLen && *oldIt == *newIt)
 		{
 			start++;
+			++oldIt;
+			++newIt;
 		}
 
 		// Find last difference
 		size_t oldEnd = oldStr.length();
 		size_t newEnd = newStr.length();
+		oldIt = oldStr.begin() + oldEnd;
+		newIt = newStr.begin() + newEnd;
 
-		while (oldEnd > start && newEnd > start &&
-			   oldStr[oldEnd - 1] == newStr[newEnd - 1])
+		while (oldEnd > start && newEnd > start && *--oldIt == *--newIt)
 		{
 			oldEnd--;
 			newEnd--;
@@ -6,6 +6,7 @@
 
 #include <algorithm>
 #include <chrono>
+#include <climits>
 #include <fstream>
 #include <iostream>
 #include <nfd.h>
@@ -13,6 +14,7 @@
 #include <thread>
 
 #include "../lsp/lsp_globals.h"
+#include "../editor/editor_file_mapping.h"
 #include "../editor/editor_highlight.h"
 #include "../editor/editor_line_jump.h"
 #include "../lib/json.hpp"
@@ -317,6 +319,24 @@ bool FileExplorer::handleFileDialogWorkflow()
 
 bool FileExplorer::handleFileDialog() { return handleFileDialogWorkflow(); }
 
+// Guess from the first part of a file whether it is binary
+static bool looksBinary(std::string_view content)
+{
+	int nullCount = 0;
+	size_t checkSize = std::min(content.length(), size_t(1024));
+
+	for (size_t i = 0; i < checkSize; i++)
+	{
+		if (content[i] == 0 ||
+			(static_cast<unsigned char>(content[i]) < 32 && content[i] != '\n' &&
+			 content[i] != '\r' && content[i] != '\t'))
+		{
+			nullCount++;
+		}
+	}
+	return nullCount > checkSize / 10;
+}
+
 bool FileExplorer::readFileContent(const std::string &path)
 {
 	try
@@ -343,7 +363,40 @@ bool FileExplorer::readFileContent(const std::string &path)
 			return false;
 		}
 
-		bool isTruncated = fileSize > MAX_FILE_SIZE;
+		// Offsets in the editor are ints
+		if (fileSize > static_cast<uintmax_t>(INT_MAX))
+		{
+			std::cout << "File is too large to open: " << fileSize << " bytes"
+					  << std::endl;
+			editor_state.fileContent = "Error: File is too large to be displayed "
+									   "in editor.";
+			return false;
+		}
+
+		if (fileSize > LARGE_FILE_SIZE)
+		{
+			// Map large files instead of reading them: opening reads nothing,
+			// pages are loaded as they are viewed and edits go on top of the
+			// mapping in the piece table
+			std::string error;
+			std::unique_ptr<FileMapping> mapping = FileMapping::open(path, error);
+			if (!mapping)
+			{
+				std::cout << "Failed to map file: " << error << std::endl;
+				return false;
+			}
+			if (looksBinary(mapping->view()))
+			{
+				std::cout << "File appears to be binary" << std::endl;
+				editor_state.fileContent = "Error: File appears to be binary and "
+										   "cannot be displayed in editor.";
+				return false;
+			}
+
+			editor_state.fileContent.assign(std::move(mapping));
+			editor_state.large_file = true;
+			return true;
+		}
 
 		// Open file in binary mode
 		std::ifstream file(path, std::ios::binary);
@@ -353,10 +406,8 @@ bool FileExplorer::readFileContent(const std::string &path)
 			return false;
 		}
 
-		// Read content (either full file or truncated)
-		size_t readSize = isTruncated ? MAX_FILE_SIZE : fileSize;
-		std::vector<char> buffer(readSize);
-		file.read(buffer.data(), readSize);
+		std::vector<char> buffer(fileSize);
+		file.read(buffer.data(), fileSize);
 
 		if (file.bad())
 		{
@@ -366,21 +417,7 @@ bool FileExplorer::readFileContent(const std::string &path)
 
 		std::string content(buffer.data(), file.gcount());
 
-		// Check for binary content in the first part
-		int nullCount = 0;
-		size_t checkSize = std::min(content.length(), size_t(1024));
-
-		for (size_t i = 0; i < checkSize; i++)
-		{
-			if (content[i] == 0 ||
-				(static_cast<unsigned char>(content[i]) < 32 && content[i] != '\n' &&
-				 content[i] != '\r' && content[i] != '\t'))
-			{
-				nullCount++;
-			}
-		}
-
-		if (nullCount > checkSize / 10)
+		if (looksBinary(content))
 		{
 			std::cout << "File appears to be binary" << std::endl;
 			editor_state.fileContent = "Error: File appears to be binary and "
@@ -388,17 +425,8 @@ bool FileExplorer::readFileContent(const std::string &path)
 			return false;
 		}
 
-		// Add truncation notice if needed
-		if (isTruncated)
-		{
-			std::string notice = "\n\n[File truncated - No Edits - showing first " +
-								 std::to_string(MAX_FILE_SIZE / (1024 * 1024)) +
-								 "MB of " + std::to_string(fileSize / (1024 * 1024)) +
-								 "MB]\n";
-			content = notice + content;
-		}
-
 		editor_state.fileContent = std::move(content);
+		editor_state.large_file = false;
 		return true;
 	} catch (const std::exception &e)
 	{
@@ -410,9 +438,15 @@ bool FileExplorer::readFileContent(const std::string &path)
 
 void FileExplorer::updateFileColorBuffer()
 {
+	std::lock_guard<std::mutex> lock(editor_state.colorsMutex);
 	editor_state.fileColors.clear();
+	if (editor_state.large_file)
+	{
+		editor_state.fileColors.shrink_to_fit();
+		return;
+	}
 	editor_state.fileColors.resize(editor_state.fileContent.size(),
-								   ImVec4(1.0f, 1.0f, 1.0f, 1.0f));
+								   HighlightClass::Text);
 
 	if (editor_state.fileContent.size() != editor_state.fileColors.size())
 	{
@@ -437,12 +471,20 @@ void FileExplorer::updateFilePathStates(const std::string &path)
 
 void FileExplorer::setupUndoManager(const std::string &path)
 {
+	// Undo history diffs snapshots of the whole file, so large files get none
+	if (editor_state.large_file)
+	{
+		currentUndoManager = nullptr;
+		return;
+	}
+
 	auto it = fileUndoManagers.find(path);
 	if (it == fileUndoManagers.end())
 	{
 		it = fileUndoManagers.emplace(path, UndoRedoManager()).first;
 		// Initialize with current state
-		it->second.initialize(editor_state.fileContent, editor_state.cursor_index);
+		it->second.initialize(editor_state.fileContent.snapshot(),
+							  editor_state.cursor_index);
 	}
 	currentUndoManager = &(it->second);
 }
@@ -450,6 +492,7 @@ void FileExplorer::setupUndoManager(const std::string &path)
 void FileExplorer::handleLoadError()
 {
 	editor_state.fileContent = "Error: Unable to open file.";
+	editor_state.large_file = false;
 	currentFile = "";
 	editor_state.fileColors.clear();
 	currentUndoManager = nullptr;
@@ -466,21 +509,50 @@ void FileExplorer::loadFileContent(const std::string &path,
 	try
 	{
 		// cancel any ongoing highlighting.,..
+		bool colorsCurrent = !gEditorHighlight.isHighlighting();
 		gEditorHighlight.cancelHighlighting();
 
-		if (!readFileContent(path))
+		// Keep the saved document we are leaving, reopening it is then a swap.
+		// Reloading the same path always goes back to disk.
+		if (!currentFile.empty() && currentFile != path && !_unsavedChanges)
 		{
-			handleLoadError();
-			return;
+			_documentCache.storeActive(currentFile, colorsCurrent);
 		}
 
-		_unsavedChanges = false;
-		updateFilePathStates(path);
-		updateFileColorBuffer();
-		setupUndoManager(path);
+		if (_documentCache.restoreActive(path, colorsCurrent))
+		{
+			editor_state.ensure_cursor_visible.horizontal = false;
+			editor_state.ensure_cursor_visible.vertical = false;
+			_unsavedChanges = false;
+			updateFilePathStates(path);
+			setupUndoManager(path);
+			// Finish highlighting that was cut short when the document was left
+			bool sizeMismatch =
+				editor_state.fileColors.size() != editor_state.fileContent.size();
+			if (!editor_state.large_file && (!colorsCurrent || sizeMismatch))
+			{
+				if (sizeMismatch)
+				{
+					updateFileColorBuffer();
+				}
+				gEditorHighlight.highlightContent();
+			}
+		} else
+		{
+			if (!readFileContent(path))
+			{
+				handleLoadError();
+				return;
+			}
 
-		// Use synchronous highlighting to prevent white flash on file load
-		gEditorHighlight.highlightContent(false, true);
+			_unsavedChanges = false;
+			updateFilePathStates(path);
+			updateFileColorBuffer();
+			setupUndoManager(path);
+
+			// Use synchronous highlighting to prevent white flash on file load
+			gEditorHighlight.highlightContent(false, true);
+		}
 
 		// Initialize file tracking for external change detection
 		_fileMonitor.addFileToMonitoring(path);
@@ -509,7 +581,8 @@ void FileExplorer::addUndoState()
 		// Print the cursor index before saving the undo state
 		printf("[addUndoState] Saving undo state. Cursor index: %d\n",
 			   editor_state.cursor_index);
-		currentUndoManager->addState(editor_state.fileContent, editor_state.cursor_index);
+		currentUndoManager->addState(editor_state.fileContent.snapshot(),
+									 editor_state.cursor_index);
 
 		// Mark that we have unsaved undo state
 		_undoStateDirty = true;
@@ -551,23 +624,21 @@ void FileExplorer::renderFileContent()
 	// LSP: debounced didChange while editing
 	{
 		static auto lastSent = std::chrono::steady_clock::now();
-		static std::string lastContent;
+		static TextSnapshot lastContent;
 		
-		if (!currentFile.empty() && _unsavedChanges) {
+		if (!currentFile.empty() && _unsavedChanges && !editor_state.large_file) {
 			auto now = std::chrono::steady_clock::now();
 			auto ms  = std::chrono::duration_cast<std::chrono::milliseconds>(now - lastSent).count();
 			
 			// Only send if content actually changed and enough time passed
-			if (ms >= 150 && editor_state.fileContent != lastContent) {
+			if (ms >= 150 && !lastContent.matches(editor_state.fileContent)) {
 				int &version = _documentVersions[currentFile];
 				version = version == 0 ? 1 : version + 1;
 				
-				// Only send if LSP is properly initialized
-				if (gLSPManager.isInitialized() && gLSPManager.hasWorkingAdapter()) {
-					gEditorLSP.didChange(currentFile, version);
-					lastSent = now;
-					lastContent = editor_state.fileContent;
-				}
+				// didChange starts the file's server again if it stopped
+				gEditorLSP.didChange(currentFile, version);
+				lastSent = now;
+				lastContent = editor_state.fileContent.snapshot();
 			}
 		}
 	}
@@ -629,10 +700,10 @@ void FileExplorer::resetColorBuffer()
 	// editor_state.fileColors.clear();
 
 	// Resize and fill ALL elements with white
-	editor_state.fileColors.resize(new_size, ImVec4(0.5f, 0.5f, 0.5f, 0.5f));
+	editor_state.fileColors.resize(new_size, HighlightClass::Ghost);
 
 	// Alternative: Use assign() for atomic operation
-	// editor_state.fileColors.assign(new_size, ImVec4(1.0f, 1.0f, 1.0f, 1.0f));
+	// editor_state.fileColors.assign(new_size, HighlightClass::Text);
 
 	std::cout << "Reset " << new_size << " colors to white\n";
 }
@@ -642,10 +713,6 @@ void FileExplorer::applyOperation(const UndoRedoManager::Operation &op, bool isU
 {
 	gEditorHighlight.cancelHighlighting();
 
-	// Apply the operation to get new content
-	std::string newContent = isUndo ? op.apply(editor_state.fileContent)
-									: op.applyInverse(editor_state.fileContent);
-
 	// Synchronize colors vector with content changes
 	// This prevents the visual glitch where colors vector doesn't match content
 	// vector
@@ -669,7 +736,7 @@ void FileExplorer::applyOperation(const UndoRedoManager::Operation &op, bool isU
 		{
 			// Original operation removed text, so we need to add colors back
 			// Get the proper default text color from the theme
-			ImVec4 defaultColor = ImVec4(1.0f, 1.0f, 1.0f, 1.0f); // Default white
+			HighlightClass defaultColor = HighlightClass::Text;
 			if (op.position >= 0 && op.position <= editor_state.fileColors.size())
 			{
 				editor_state.fileColors.insert(editor_state.fileColors.begin() +
@@ -687,7 +754,7 @@ void FileExplorer::applyOperation(const UndoRedoManager::Operation &op, bool isU
 		{
 			// Original operation inserted text, so we need to add colors
 			// Get the proper default text color from the theme
-			ImVec4 defaultColor = ImVec4(1.0f, 1.0f, 1.0f, 1.0f); // Default white
+			HighlightClass defaultColor = HighlightClass::Text;
 			if (op.position >= 0 && op.position <= editor_state.fileColors.size())
 			{
 				editor_state.fileColors.insert(editor_state.fileColors.begin() +
@@ -709,17 +776,26 @@ void FileExplorer::applyOperation(const UndoRedoManager::Operation &op, bool isU
 		}
 	}
 
-	// Update editor state
-	editor_state.fileContent = newContent;
+	// Apply the operation in place; the piece table only touches the edited range
+	if (op.position >= 0 &&
+		op.position <= static_cast<int>(editor_state.fileContent.size()))
+	{
+		if (isUndo)
+			editor_state.fileContent.replace(
+				op.position, op.inserted.length(), op.removed);
+		else
+			editor_state.fileContent.replace(
+				op.position, op.removed.length(), op.inserted);
+	}
 
 	// Set appropriate cursor position based on the operation
 	int cursor_pos = isUndo ? op.cursor_before : op.cursor_after;
 
 	if (cursor_pos < 0)
 		cursor_pos = 0;
-	if (cursor_pos > static_cast<int>(newContent.length()))
+	if (cursor_pos > static_cast<int>(editor_state.fileContent.length()))
 	{
-		cursor_pos = newContent.length();
+		cursor_pos = editor_state.fileContent.length();
 	}
 	editor_state.cursor_index = cursor_pos;
 
@@ -876,21 +952,53 @@ void FileExplorer::saveCurrentFile()
 {
 	if (!currentFile.empty() && _unsavedChanges)
 	{
-		// Check if we're dealing with a truncated file
-		if (editor_state.fileContent.find("[File truncated - showing first") !=
-			std::string::npos)
-		{
-			std::cerr << "Cannot save truncated file content" << std::endl;
-			// TODO: Show warning to user that they can't save changes to
-			// truncated files
-			return;
-		}
+		// A mapped document still reads unchanged text from the file, so the
+		// file must not be truncated under it: write a new one and rename it
+		// over the old one
+		bool replace = editor_state.fileContent.mapsFile();
+		std::string writePath = replace ? currentFile + ".ned-save" : currentFile;
 
-		std::ofstream file(currentFile, std::ios::binary);
+		std::ofstream file(writePath, std::ios::binary);
 		if (file.is_open())
 		{
-			file << editor_state.fileContent;
+			editor_state.fileContent.forEachChunk(
+				0, TextBuffer::npos, [&file](std::string_view chunk) {
+					file.write(chunk.data(), chunk.size());
+					return true;
+				});
 			file.close();
+			if (replace)
+			{
+				std::error_code ec;
+				std::string error;
+				std::unique_ptr<FileMapping> saved =
+					file.fail() ? nullptr : FileMapping::open(writePath, error);
+				if (!saved)
+				{
+					std::cerr << "Unable to save file: " << currentFile << " " << error
+							  << std::endl;
+					fs::remove(writePath, ec);
+					return;
+				}
+
+				// Windows does not replace a file that is still mapped, so the
+				// document first moves to the new file, which holds the same
+				// text, and drops the old mapping. Renaming a mapped file is
+				// fine, it is only the one replaced that must be unmapped.
+				editor_state.fileContent.assign(std::move(saved));
+				gEditor.updateLineStarts();
+				fs::perms perms = fs::status(currentFile, ec).permissions();
+				fs::permissions(writePath, perms, ec);
+				fs::rename(writePath, currentFile, ec);
+				if (ec)
+				{
+					// The document reads from the new file now, keep it
+					std::cerr << "Unable to save file: " << currentFile << " "
+							  << ec.message() << ", the text is in " << writePath
+							  << std::endl;
+					return;
+				}
+			}
 			_unsavedChanges = false;
 			// std::cout << "File saved: " << currentFile << std::endl;
 			//  Track document version - start at 1 and increment on each save
@@ -913,7 +1021,13 @@ void FileExplorer::saveCurrentFile()
 
 void FileExplorer::notifyLSPFileOpen(const std::string &filePath)
 {
-	gEditorLSP.didOpen(filePath, editor_state.fileContent);
+	// Large files are never sent to language servers, which would get the
+	// whole text again on every change
+	if (editor_state.large_file)
+	{
+		return;
+	}
+	gEditorLSP.didOpen(filePath, editor_state.fileContent.str());
 }
 
 void FileExplorer::forceSaveUndoState()
@@ -929,6 +1043,23 @@ void FileExplorer::checkForExternalFileChanges()
 {
 	// Delegate to the FileMonitor class
 	_fileMonitor.checkForExternalFileChanges();
+
+	// A mapped file truncated on disk reads as zeros past its new end. The
+	// monitor reloads it on its own only for files of an open project.
+	if (editor_state.large_file && editor_state.fileContent.mappedFileShrunk() &&
+		_shrunkDocument != editor_state.fileContent.documentId())
+	{
+		_shrunkDocument = editor_state.fileContent.documentId();
+		std::cerr << "File was truncated on disk: " << currentFile << std::endl;
+		if (_unsavedChanges)
+		{
+			gSettings.renderNotification(
+				"File was truncated on disk while it was open", 3.0f);
+		} else
+		{
+			reloadCurrentFile();
+		}
+	}
 }
 
 void FileExplorer::reloadCurrentFile()
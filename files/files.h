@@ -10,6 +10,7 @@
 #include "../editor/editor.h"
 #include "../lsp/lsp.h"
 #include "file_content_search.h"
+#include "file_document_cache.h"
 #include "file_monitor.h"
 #include "file_tree.h"
 #include "file_undo_redo.h"
@@ -28,7 +29,8 @@ namespace fs = std::filesystem;
 class FileExplorer
 {
   public:
-	const size_t MAX_FILE_SIZE = 1 * 1024 * 1024 * 1; // 1mb
+	// Files above this are opened in large file mode, see EditorState::large_file
+	const size_t LARGE_FILE_SIZE = 8 * 1024 * 1024; // 8mb
 
 	UndoRedoManager *currentUndoManager = nullptr;
 	std::map<std::string, UndoRedoManager> fileUndoManagers;
@@ -138,6 +140,11 @@ class FileExplorer
 
 	// External file change detection
 	FileMonitor _fileMonitor;
+	// Document whose mapped file was found truncated, handled once
+	uint64_t _shrunkDocument = 0;
+
+	// Recently left documents, reopened without touching the disk
+	DocumentCache _documentCache;
 
 	// External file change detection methods
 	void checkForExternalFileChanges();
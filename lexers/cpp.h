@@ -2,15 +2,11 @@
 
 #include <iostream>
 #include <string>
-#include <unordered_map>
-#include <unordered_set>
+#include <string_view>
 #include <vector>
 
-#include "../util/settings.h"
-#include "imgui.h"
-
-class Settings;
-extern Settings gSettings;
+#include "../editor/editor_highlight_class.h"
+#include "lexer_tables.h"
 
 namespace CppLexer {
 
@@ -42,30 +38,6 @@ enum class TokenType {
 
 };
 
-struct Context
-{
-	bool inClassDef = false;
-	bool inFuncDef = false;
-	bool inTemplate = false;
-	std::vector<std::string> knownClasses;
-	std::vector<std::string> knownFunctions;
-	std::unordered_set<std::string> knownTypes = {"int",
-												  "char",
-												  "bool",
-												  "float",
-												  "double",
-												  "void",
-												  "size_t",
-												  "std::string",
-												  "vector",
-												  "map",
-												  "set",
-												  "string",
-												  "array",
-												  "unique_ptr",
-												  "shared_ptr"};
-};
-
 struct Token
 {
 	TokenType type;
@@ -76,62 +48,6 @@ struct Token
 class Lexer
 {
   public:
-	// Theme colors cache
-	struct ThemeColors
-	{
-		ImVec4 keyword;
-		ImVec4 string;
-		ImVec4 number;
-		ImVec4 comment;
-		ImVec4 text;
-
-		ImVec4 function;
-		ImVec4 className;
-		ImVec4 memberVar;
-		ImVec4 memberFunc;
-		ImVec4 type;
-		ImVec4 macro;
-	};
-
-	Lexer()
-	{
-		keywords = {"auto",			"break",	 "case",	 "char",
-					"const",		"continue",	 "default",	 "do",
-					"double",		"else",		 "enum",	 "extern",
-					"float",		"for",		 "goto",	 "if",
-					"int",			"long",		 "register", "return",
-					"short",		"signed",	 "sizeof",	 "static",
-					"struct",		"switch",	 "typedef",	 "union",
-					"unsigned",		"void",		 "volatile", "while",
-					"class",		"namespace", "try",		 "catch",
-					"throw",		"new",		 "delete",	 "public",
-					"private",		"protected", "virtual",	 "friend",
-					"inline",		"template",	 "typename", "using",
-					"bool",			"true",		 "false",	 "nullptr",
-					"and",			"or",		 "not",		 "xor",
-					"and_eq",		"or_eq",	 "not_eq",	 "xor_eq",
-					"bitand",		"bitor",	 "compl",	 "constexpr",
-					"decltype",		"mutable",	 "noexcept", "static_assert",
-					"thread_local", "alignas",	 "alignof",	 "char16_t",
-					"char32_t",		"export",	 "explicit", "final",
-					"override",		"operator",	 "this"};
-
-		operators = {{"+", TokenType::Operator},  {"-", TokenType::Operator},
-					 {"*", TokenType::Operator},  {"/", TokenType::Operator},
-					 {"%", TokenType::Operator},  {"=", TokenType::Operator},
-					 {"==", TokenType::Operator}, {"!=", TokenType::Operator},
-					 {">", TokenType::Operator},  {"<", TokenType::Operator},
-					 {">=", TokenType::Operator}, {"<=", TokenType::Operator},
-					 {"&&", TokenType::Operator}, {"||", TokenType::Operator},
-					 {"!", TokenType::Operator},  {"&", TokenType::Operator},
-					 {"|", TokenType::Operator},  {"^", TokenType::Operator},
-					 {"~", TokenType::Operator},  {"<<", TokenType::Operator},
-					 {">>", TokenType::Operator}, {"++", TokenType::Operator},
-					 {"--", TokenType::Operator}, {"->", TokenType::Operator},
-					 {".*", TokenType::Operator}, {"->*", TokenType::Operator},
-					 {"::", TokenType::Operator}};
-	}
-	void themeChanged() { colorsNeedUpdate = true; }
 	std::vector<Token> tokenize(const std::string &code)
 	{
 		std::cout << "Inside C++ tokenizer.." << std::endl;
@@ -201,8 +117,9 @@ class Lexer
 		std::cout << "Exiting C++ tokenizer, tokens size: " << tokens.size() << std::endl;
 		return tokens;
 	}
-	void
-	applyHighlighting(const std::string &code, std::vector<ImVec4> &colors, int start_pos)
+	void applyHighlighting(const std::string &code,
+						   std::vector<HighlightClass> &colors,
+						   int start_pos)
 	{
 		std::cout << "Entering C++ applyHighlighting, code length: " << code.length()
 				  << ", colors size: " << colors.size() << ", start_pos: " << start_pos
@@ -215,7 +132,7 @@ class Lexer
 			int colorChanges = 0;
 			for (const auto &token : tokens)
 			{
-				ImVec4 color = getColorForTokenType(token.type);
+				HighlightClass color = getClassForTokenType(token.type);
 				for (size_t i = 0; i < token.length; ++i)
 				{
 					size_t index = start_pos + token.start + i;
@@ -234,54 +151,42 @@ class Lexer
 					  << std::endl;
 			std::fill(colors.begin() + start_pos,
 					  colors.end(),
-					  ImVec4(1.0f, 1.0f, 1.0f, 1.0f));
+					  HighlightClass::Text);
 		} catch (...)
 		{
 			std::cerr << "🔴 Unknown exception in C++ applyHighlighting" << std::endl;
 			std::fill(colors.begin() + start_pos,
 					  colors.end(),
-					  ImVec4(1.0f, 1.0f, 1.0f, 1.0f));
+					  HighlightClass::Text);
 		}
 	}
-	void forceColorUpdate() { colorsNeedUpdate = true; }
 
   private:
-	std::unordered_set<std::string> keywords;
-	std::unordered_map<std::string, TokenType> operators;
-	mutable ThemeColors cachedColors;
-	mutable bool colorsNeedUpdate = true;
-	void updateThemeColors() const
-	{
-		if (!colorsNeedUpdate)
-			return;
-
-		auto &theme = gSettings.getSettings()["themes"][gSettings.getCurrentTheme()];
-
-		auto loadColor = [&theme](const char *key) -> ImVec4 {
-			auto &c = theme[key];
-			return ImVec4(c[0], c[1], c[2], c[3]);
-		};
-
-		cachedColors.keyword = loadColor("keyword");
-		cachedColors.string = loadColor("string");
-		cachedColors.number = loadColor("number");
-		cachedColors.comment = loadColor("comment");
-		cachedColors.text = loadColor("text");
-		cachedColors.function = loadColor("function"); // Cache the function color
-
-		colorsNeedUpdate = false;
-	}
-
-	bool isWhitespace(char c) const
-	{
-		return c == ' ' || c == '\t' || c == '\n' || c == '\r';
-	}
-	bool isAlpha(char c) const
-	{
-		return (c >= 'a' && c <= 'z') || (c >= 'A' && c <= 'Z');
-	}
-	bool isDigit(char c) const { return c >= '0' && c <= '9'; }
-	bool isAlphaNumeric(char c) const { return isAlpha(c) || isDigit(c) || c == '_'; }
+	// Looked up with views into the code, so no token is copied
+	static constexpr auto keywords = LexerTables::makeKeywordSet({
+		"auto", "break", "case", "char", "const", "continue", "default", "do", "double",
+		"else", "enum", "extern", "float", "for", "goto", "if", "int", "long",
+		"register", "return", "short", "signed", "sizeof", "static", "struct", "switch",
+		"typedef", "union", "unsigned", "void", "volatile", "while", "class",
+		"namespace", "try", "catch", "throw", "new", "delete", "public", "private",
+		"protected", "virtual", "friend", "inline", "template", "typename", "using",
+		"bool", "true", "false", "nullptr", "and", "or", "not", "xor", "and_eq",
+		"or_eq", "not_eq", "xor_eq", "bitand", "bitor", "compl", "constexpr",
+		"decltype", "mutable", "noexcept", "static_assert", "thread_local", "alignas",
+		"alignof", "char16_t", "char32_t", "export", "explicit", "final", "override",
+		"operator", "this"});
+	static constexpr auto basicTypes = LexerTables::makeKeywordSet({
+		"void", "bool", "char", "int", "float", "double", "long", "int8_t", "int16_t",
+		"int32_t", "int64_t", "uint8_t", "uint16_t", "uint32_t", "uint64_t", "size_t",
+		"wchar_t"});
+	static constexpr auto operators = LexerTables::makeKeywordSet({
+		"+", "-", "*", "/", "%", "=", "==", "!=", ">", "<", ">=", "<=", "&&", "||", "!",
+		"&", "|", "^", "~", "<<", ">>", "++", "--", "->", ".*", "->*", "::"});
+
+	bool isWhitespace(char c) const { return LexerTables::isSpace(c); }
+	bool isAlpha(char c) const { return LexerTables::isAlpha(c); }
+	bool isDigit(char c) const { return LexerTables::isDigit(c); }
+	bool isAlphaNumeric(char c) const { return LexerTables::isIdentPart(c); }
 
 	size_t skipWhitespace(const std::string &code, size_t pos) const
 	{
@@ -296,42 +201,23 @@ class Lexer
 		size_t start = pos;
 		while (pos < code.length() && isAlphaNumeric(code[pos]))
 			pos++;
-		std::string word = code.substr(start, pos - start);
+		std::string_view word = std::string_view(code).substr(start, pos - start);
 
 		// Look ahead for function detection
 		size_t next = skipWhitespace(code, pos);
 		bool isFunction = next < code.length() && code[next] == '(';
 
-		// Basic types that should be highlighted
-		static std::unordered_set<std::string> basicTypes = {"void",
-															 "bool",
-															 "char",
-															 "int",
-															 "float",
-															 "double",
-															 "long",
-															 "int8_t",
-															 "int16_t",
-															 "int32_t",
-															 "int64_t",
-															 "uint8_t",
-															 "uint16_t",
-															 "uint32_t",
-															 "uint64_t",
-															 "size_t",
-															 "wchar_t"};
-
-		if (keywords.find(word) != keywords.end())
+		if (keywords.contains(word))
 		{
 			return {TokenType::Keyword, start, pos - start};
 		}
 
-		if (basicTypes.find(word) != basicTypes.end())
+		if (basicTypes.contains(word))
 		{
 			return {TokenType::Keyword, start, pos - start};
 		}
 
-		if (isFunction && word.find("::") == std::string::npos)
+		if (isFunction && word.find("::") == std::string_view::npos)
 		{ // Only highlight non-scoped functions
 			return {TokenType::Function, start, pos - start};
 		}
@@ -429,12 +315,12 @@ class Lexer
 			return {TokenType::Dot, start, 1};
 
 		// Handle multi-character operators
-		std::string op;
+		std::string_view op;
 		while (pos < code.length() && !isAlphaNumeric(code[pos]) &&
 			   !isWhitespace(code[pos]))
 		{
-			op += code[pos];
-			if (operators.find(op) != operators.end())
+			op = std::string_view(code).substr(start, pos - start + 1);
+			if (operators.contains(op))
 			{
 				pos++;
 				return {TokenType::Operator, start, op.length()};
@@ -454,38 +340,34 @@ class Lexer
 		return {TokenType::Unknown, start, op.length()};
 	}
 
-	ImVec4 getColorForTokenType(TokenType type) const
+	HighlightClass getClassForTokenType(TokenType type) const
 	{
-		updateThemeColors();
 
 		switch (type)
 		{
 		case TokenType::Keyword:
-			return cachedColors.keyword;
+			return HighlightClass::Keyword;
 
 		case TokenType::String:
-			return cachedColors.string;
+			return HighlightClass::String;
 
 		case TokenType::Number:
-			return cachedColors.number;
+			return HighlightClass::Number;
 
 		case TokenType::Comment:
-			return cachedColors.comment;
+			return HighlightClass::Comment;
 
 		case TokenType::Function:
-			return cachedColors.function;
+			return HighlightClass::Function;
 
 		case TokenType::ScopeOperator: // Highlight :: in function color
-			return cachedColors.function;
+			return HighlightClass::Function;
 
 		case TokenType::Operator:
-			return ImVec4(cachedColors.text.x * 0.8f,
-						  cachedColors.text.y * 0.8f,
-						  cachedColors.text.z * 0.8f,
-						  cachedColors.text.w);
+			return HighlightClass::DimmedText;
 
 		default:
-			return cachedColors.text;
+			return HighlightClass::Text;
 		}
 	}
 };
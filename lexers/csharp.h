@@ -4,17 +4,11 @@
 #include <iostream>
 #include <stack> // Potentially useful later, not used initially
 #include <string>
-#include <unordered_map>
-#include <unordered_set>
+#include <string_view>
 #include <vector>
 
-#include "../util/settings.h" // Ensure this path is correct
-#include "imgui.h"			  // Ensure this path is correct
-
-// Forward declare Settings and json as needed
-class Settings;
-extern Settings gSettings;
-#include <lib/json.hpp> // Assuming settings.h includes this, otherwise add it here
+#include "../editor/editor_highlight_class.h"
+#include "lexer_tables.h"
 
 namespace CSharpLexer {
 
@@ -56,85 +50,6 @@ struct Token
 class Lexer
 {
   public:
-	struct ThemeColors
-	{
-		ImVec4 keyword;
-		ImVec4 builtInType;
-		ImVec4 string;
-		ImVec4 number;
-		ImVec4 comment;
-		ImVec4 text;
-		ImVec4 methodName;
-		ImVec4 className;
-		ImVec4 attributeName;
-		ImVec4 preprocessor;
-		ImVec4 operatorColor;
-	};
-
-	Lexer()
-	{
-		keywords = {
-			"abstract",	 "as",		  "base",		"break",	"case",		  "catch",
-			"checked",	 "class",	  "const",		"continue", "default",	  "delegate",
-			"do",		 "else",	  "enum",		"event",	"explicit",	  "extern",
-			"finally",	 "fixed",	  "for",		"foreach",	"goto",		  "if",
-			"implicit",	 "in",		  "interface",	"internal", "is",		  "lock",
-			"namespace", "new",		  "operator",	"out",		"override",	  "params",
-			"private",	 "protected", "public",		"readonly", "ref",		  "return",
-			"sealed",	 "sizeof",	  "stackalloc", "static",	"struct",	  "switch",
-			"this",		 "throw",	  "try",		"typeof",	"unchecked",  "unsafe",
-			"using",	 "virtual",	  "volatile",	"while",	"add",		  "alias",
-			"ascending", "async",	  "await",		"by",		"descending", "dynamic",
-			"equals",	 "from",	  "get",		"global",	"group",	  "into",
-			"join",		 "let",		  "nameof",		"on",		"orderby",	  "partial",
-			"remove",	 "select",	  "set",		"value",	"var",		  "when",
-			"where",	 "yield",	  "unmanaged",	"nint",		"nuint",	  "notnull",
-			"and",		 "or",		  "not",		"record",	"init",		  "with",
-			"managed"};
-		builtInTypes = {"bool",
-						"byte",
-						"sbyte",
-						"char",
-						"decimal",
-						"double",
-						"float",
-						"int",
-						"uint",
-						"nint",
-						"nuint",
-						"long",
-						"ulong",
-						"short",
-						"ushort",
-						"object",
-						"string",
-						"void",
-						"dynamic"};
-		literals = {"true", "false", "null"};
-		operators = {{">>=", TokenType::Operator}, {"<<=", TokenType::Operator},
-					 {"==", TokenType::Operator},  {"!=", TokenType::Operator},
-					 {">=", TokenType::Operator},  {"<=", TokenType::Operator},
-					 {"&&", TokenType::Operator},  {"||", TokenType::Operator},
-					 {"??", TokenType::Operator},  {"?.", TokenType::Operator},
-					 {"=>", TokenType::Operator},  {"++", TokenType::Operator},
-					 {"--", TokenType::Operator},  {"+=", TokenType::Operator},
-					 {"-=", TokenType::Operator},  {"*=", TokenType::Operator},
-					 {"/=", TokenType::Operator},  {"%=", TokenType::Operator},
-					 {"&=", TokenType::Operator},  {"|=", TokenType::Operator},
-					 {"^=", TokenType::Operator},  {"::", TokenType::Operator},
-					 {"<<", TokenType::Operator},  {">>", TokenType::Operator},
-					 {"+", TokenType::Operator},   {"-", TokenType::Operator},
-					 {"*", TokenType::Operator},   {"/", TokenType::Operator},
-					 {"%", TokenType::Operator},   {"=", TokenType::Operator},
-					 {">", TokenType::Operator},   {"<", TokenType::Operator},
-					 {"!", TokenType::Operator},   {"&", TokenType::Operator},
-					 {"|", TokenType::Operator},   {"^", TokenType::Operator},
-					 {"~", TokenType::Operator},   {"?", TokenType::Operator}};
-		colorsNeedUpdate = true;
-	}
-
-	void themeChanged() { colorsNeedUpdate = true; }
-
 	std::vector<Token> tokenize(const std::string &code)
 	{
 		std::vector<Token> tokens;
@@ -261,8 +176,9 @@ class Lexer
 		return tokens;
 	}
 
-	void
-	applyHighlighting(const std::string &code, std::vector<ImVec4> &colors, int start_pos)
+	void applyHighlighting(const std::string &code,
+						   std::vector<HighlightClass> &colors,
+						   int start_pos)
 	{
 		try
 		{
@@ -274,7 +190,7 @@ class Lexer
 			{
 				if (token.length == 0)
 					continue;
-				ImVec4 color = getColorForTokenType(token.type);
+				HighlightClass color = getClassForTokenType(token.type);
 				size_t globalStart = start_pos + token.start;
 				size_t globalEnd = globalStart + token.length;
 				if (globalEnd > colors.size())
@@ -295,33 +211,43 @@ class Lexer
 		{
 			std::cerr << "🔴 Exception in CSharp applyHighlighting: " << e.what()
 					  << std::endl;
-			if (!colorsNeedUpdate)
-				std::fill(colors.begin() + start_pos, colors.end(), cachedColors.text);
-			else
-				std::fill(colors.begin() + start_pos,
-						  colors.end(),
-						  ImVec4(1.0f, 1.0f, 1.0f, 1.0f));
+			std::fill(colors.begin() + start_pos, colors.end(), HighlightClass::Text);
 		} catch (...)
 		{
 			std::cerr << "🔴 Unknown exception in CSharp applyHighlighting" << std::endl;
-			if (!colorsNeedUpdate)
-				std::fill(colors.begin() + start_pos, colors.end(), cachedColors.text);
-			else
-				std::fill(colors.begin() + start_pos,
-						  colors.end(),
-						  ImVec4(1.0f, 1.0f, 1.0f, 1.0f));
+			std::fill(colors.begin() + start_pos, colors.end(), HighlightClass::Text);
 		}
 	}
 
-	void forceColorUpdate() { colorsNeedUpdate = true; }
-
   private:
-	std::unordered_set<std::string> keywords;
-	std::unordered_set<std::string> builtInTypes;
-	std::unordered_set<std::string> literals;
-	std::unordered_map<std::string, TokenType> operators;
-	mutable ThemeColors cachedColors;
-	mutable bool colorsNeedUpdate = true;
+	// Looked up with views into the code, so no token is copied
+	static constexpr auto keywords = LexerTables::makeKeywordSet({
+		"abstract", "as", "base", "break", "case", "catch", "checked", "class", "const",
+		"continue", "default", "delegate", "do", "else", "enum", "event", "explicit",
+		"extern", "finally", "fixed", "for", "foreach", "goto", "if", "implicit", "in",
+		"interface", "internal", "is", "lock", "namespace", "new", "operator", "out",
+		"override", "params", "private", "protected", "public", "readonly", "ref",
+		"return", "sealed", "sizeof", "stackalloc", "static", "struct", "switch",
+		"this", "throw", "try", "typeof", "unchecked", "unsafe", "using", "virtual",
+		"volatile", "while", "add", "alias", "ascending", "async", "await", "by",
+		"descending", "dynamic", "equals", "from", "get", "global", "group", "into",
+		"join", "let", "nameof", "on", "orderby", "partial", "remove", "select", "set",
+		"value", "var", "when", "where", "yield", "unmanaged", "nint", "nuint",
+		"notnull", "and", "or", "not", "record", "init", "with", "managed"});
+	static constexpr auto builtInTypes = LexerTables::makeKeywordSet({
+		"bool", "byte", "sbyte", "char", "decimal", "double", "float", "int", "uint",
+		"nint", "nuint", "long", "ulong", "short", "ushort", "object", "string", "void",
+		"dynamic"});
+	static constexpr auto literals = LexerTables::makeKeywordSet({
+		"true", "false", "null"});
+	static constexpr auto operators = LexerTables::makeKeywordSet({
+		">>=", "<<=", "==", "!=", ">=", "<=", "&&", "||", "??", "?.", "=>", "++", "--",
+		"+=", "-=", "*=", "/=", "%=", "&=", "|=", "^=", "::", "<<", ">>", "+", "-", "*",
+		"/", "%", "=", ">", "<", "!", "&", "|", "^", "~", "?"});
+	static constexpr auto contextKeywords = LexerTables::makeKeywordSet({
+		"public", "private", "protected", "internal", "static", "abstract", "sealed",
+		"virtual", "override", "new", "async", "unsafe", "class", "struct", "interface",
+		"enum", "delegate", "event", "void"});
 
 	int findLastNonWhitespaceTokenIndex(const std::vector<Token> &tokens) const
 	{
@@ -350,27 +276,9 @@ class Lexer
 		if (prevTokenIdx == -1)
 			return true; // Likely start of file or after only whitespace
 		const auto &prevToken = tokens[prevTokenIdx];
-		std::string prevWord = code.substr(prevToken.start, prevToken.length);
-		static const std::unordered_set<std::string> contextKeywords = {"public",
-																		"private",
-																		"protected",
-																		"internal",
-																		"static",
-																		"abstract",
-																		"sealed",
-																		"virtual",
-																		"override",
-																		"new",
-																		"async",
-																		"unsafe",
-																		"class",
-																		"struct",
-																		"interface",
-																		"enum",
-																		"delegate",
-																		"event",
-																		"void"};
-		if (prevToken.type == TokenType::Keyword && contextKeywords.count(prevWord))
+		std::string_view prevWord =
+			std::string_view(code).substr(prevToken.start, prevToken.length);
+		if (prevToken.type == TokenType::Keyword && contextKeywords.contains(prevWord))
 			return true;
 		if (prevToken.type == TokenType::BuiltInType ||
 			prevToken.type == TokenType::ClassName)
@@ -380,74 +288,12 @@ class Lexer
 		return false;
 	}
 
-	void updateThemeColors() const
-	{
-		if (!colorsNeedUpdate)
-			return;
-		try
-		{
-			auto &theme = gSettings.getSettings()["themes"][gSettings.getCurrentTheme()];
-			auto loadColor = [&theme](const char *key,
-									  ImVec4 df =
-										  ImVec4(1.0f, 1.0f, 1.0f, 1.0f)) -> ImVec4 {
-				try
-				{
-					if (theme.contains(key))
-					{
-						auto &c = theme[key];
-						if (c.is_array() && c.size() == 4)
-							return ImVec4(c[0].get<float>(),
-										  c[1].get<float>(),
-										  c[2].get<float>(),
-										  c[3].get<float>());
-					}
-				} catch (const nlohmann::json::exception &e)
-				{
-					std::cerr << "Theme Error '" << key << "': " << e.what()
-							  << ". Defaulting." << std::endl;
-				} catch (const std::exception &e)
-				{
-					std::cerr << "Theme Error '" << key << "': " << e.what()
-							  << ". Defaulting." << std::endl;
-				}
-				return df;
-			};
-			cachedColors.text = loadColor("text");
-			cachedColors.keyword = loadColor("keyword", cachedColors.text);
-			cachedColors.builtInType = loadColor("primitive_type", cachedColors.keyword);
-			cachedColors.string = loadColor("string", cachedColors.text);
-			cachedColors.number = loadColor("number", cachedColors.text);
-			cachedColors.comment = loadColor("comment", ImVec4(0.5f, 0.5f, 0.5f, 1.0f));
-			cachedColors.methodName = loadColor("function", cachedColors.text);
-			cachedColors.className = loadColor("class_name", cachedColors.builtInType);
-			cachedColors.attributeName = loadColor("decorator", cachedColors.keyword);
-			cachedColors.preprocessor = loadColor("preprocessor", cachedColors.keyword);
-			cachedColors.operatorColor = loadColor("operator", cachedColors.text);
-			colorsNeedUpdate = false;
-		} catch (const std::exception &e)
-		{
-			std::cerr << "🔴 Error updating CSharp theme colors: " << e.what()
-					  << std::endl;
-		}
-	}
-	bool isWhitespace(char c) const
-	{
-		return c == ' ' || c == '\t' || c == '\n' || c == '\r' || c == '\f';
-	}
-	bool isAlpha(char c) const
-	{
-		return (c >= 'a' && c <= 'z') || (c >= 'A' && c <= 'Z');
-	}
-	bool isDigit(char c) const { return c >= '0' && c <= '9'; }
-	bool isCSharpIdentifierStart(char c) const { return isAlpha(c) || c == '_'; }
-	bool isCSharpIdentifierPart(char c) const
-	{
-		return isAlpha(c) || isDigit(c) || c == '_';
-	}
-	bool isHexDigit(char c) const
-	{
-		return isDigit(c) || (c >= 'a' && c <= 'f') || (c >= 'A' && c <= 'F');
-	}
+	bool isWhitespace(char c) const { return LexerTables::isSpace(c); }
+	bool isAlpha(char c) const { return LexerTables::isAlpha(c); }
+	bool isDigit(char c) const { return LexerTables::isDigit(c); }
+	bool isCSharpIdentifierStart(char c) const { return LexerTables::isIdentStart(c); }
+	bool isCSharpIdentifierPart(char c) const { return LexerTables::isIdentPart(c); }
+	bool isHexDigit(char c) const { return LexerTables::isHexDigit(c); }
 
 	Token lexWhitespace(const std::string &code, size_t &pos)
 	{
@@ -761,14 +607,15 @@ class Lexer
 		pos++;
 		while (pos < code.length() && isCSharpIdentifierPart(code[pos]))
 			pos++;
-		std::string w = code.substr(s + (isV ? 1 : 0), pos - s - (isV ? 1 : 0));
+		std::string_view w =
+			std::string_view(code).substr(s + (isV ? 1 : 0), pos - s - (isV ? 1 : 0));
 		if (w.empty() && !isV)
 			return {TokenType::Unknown, s, 1};
-		if (!isV && keywords.count(w))
+		if (!isV && keywords.contains(w))
 			return {TokenType::Keyword, s, pos - s};
-		if (!isV && builtInTypes.count(w))
+		if (!isV && builtInTypes.contains(w))
 			return {TokenType::BuiltInType, s, pos - s};
-		if (!isV && literals.count(w))
+		if (!isV && literals.contains(w))
 			return {TokenType::Keyword, s, pos - s};
 		size_t nW = pos;
 		while (nW < code.length() && isWhitespace(code[nW]))
@@ -778,9 +625,7 @@ class Lexer
 		if (pTI != -1)
 		{
 			const auto &t = tokens[pTI];
-			std::string pW = "";
-			if (t.length > 0)
-				pW = code.substr(t.start, t.length);
+			std::string_view pW = std::string_view(code).substr(t.start, t.length);
 			if (t.type == TokenType::Keyword)
 			{
 				if (pW == "class" || pW == "interface" || pW == "struct" ||
@@ -832,11 +677,10 @@ class Lexer
 		for (int l = 3; l >= 1; --l)
 			if (pos + l <= code.length())
 			{
-				std::string sb = code.substr(pos, l);
-				if (operators.count(sb))
+				if (operators.contains(std::string_view(code).substr(pos, l)))
 				{
 					pos += l;
-					return {operators.at(sb), s, (size_t)l};
+					return {TokenType::Operator, s, (size_t)l};
 				}
 			}
 		char c = code[pos];
@@ -872,36 +716,35 @@ class Lexer
 		}
 	}
 
-	ImVec4 getColorForTokenType(TokenType type) const
+	HighlightClass getClassForTokenType(TokenType type) const
 	{
-		updateThemeColors();
 		switch (type)
 		{
 		case TokenType::Keyword:
-			return cachedColors.keyword;
+			return HighlightClass::Keyword;
 		case TokenType::BuiltInType:
-			return cachedColors.builtInType;
+			return HighlightClass::Keyword;
 		case TokenType::ClassName:
 		case TokenType::NamespaceName:
-			return cachedColors.className;
+			return HighlightClass::Keyword;
 		case TokenType::String:
 		case TokenType::VerbatimString:
 		case TokenType::InterpolatedString:
 		case TokenType::CharLiteral:
-			return cachedColors.string;
+			return HighlightClass::String;
 		case TokenType::Number:
-			return cachedColors.number;
+			return HighlightClass::Number;
 		case TokenType::Comment:
 		case TokenType::XmlDocComment:
-			return cachedColors.comment;
+			return HighlightClass::Comment;
 		case TokenType::MethodName:
-			return cachedColors.methodName;
+			return HighlightClass::Function;
 		case TokenType::AttributeName:
-			return cachedColors.attributeName;
+			return HighlightClass::Keyword;
 		case TokenType::Preprocessor:
-			return cachedColors.preprocessor;
+			return HighlightClass::Keyword;
 		case TokenType::Operator:
-			return cachedColors.operatorColor;
+			return HighlightClass::Operator;
 		case TokenType::Parenthesis:
 		case TokenType::Bracket:
 		case TokenType::Brace:
@@ -909,9 +752,9 @@ class Lexer
 		case TokenType::Comma:
 		case TokenType::Dot:
 		case TokenType::Colon:
-			return cachedColors.text;
+			return HighlightClass::Text;
 		default:
-			return cachedColors.text;
+			return HighlightClass::Text;
 		}
 	}
 };
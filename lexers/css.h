@@ -1,20 +1,14 @@
 #pragma once
 
-#include <algorithm> // Required for std::transform
-#include <cctype>	 // For isalpha, isdigit, isxdigit, isalnum, tolower
+#include <algorithm>
+#include <cctype> // For isalpha, tolower
 #include <iostream>
 #include <string>
-#include <unordered_map>
-#include <unordered_set>
+#include <string_view>
 #include <vector>
 
-#include "../util/settings.h" // Ensure this path is correct
-#include "imgui.h"			  // Ensure this path is correct
-
-// Forward declare Settings and json as needed
-class Settings;
-extern Settings gSettings;
-#include <lib/json.hpp> // Assuming settings.h includes this
+#include "../editor/editor_highlight_class.h"
+#include "lexer_tables.h"
 
 namespace CssLexer {
 
@@ -49,506 +43,7 @@ enum class LexerState { TopLevel, InDeclarationBlock };
 class Lexer
 {
   public:
-	// Theme colors cache - Simplified like Python's
-	struct ThemeColors
-	{
-		ImVec4 keyword; // Used for @rules, pseudo-classes, maybe important
-						// keywords
-		ImVec4 string; // Used for strings, maybe attribute selectors
-		ImVec4 number; // Used for numbers, maybe colors
-		ImVec4 comment;
-		ImVec4 text;	  // Default, punctuation, unknown
-		ImVec4 function;  // Used for function calls, maybe IDs
-		ImVec4 type;	  // Used for tag selectors, property names
-		ImVec4 className; // Used for .class selectors
-						  // We can map CSS types to these common categories
-	};
-
-	Lexer()
-	{
-		// Properties (lowercase)
-		properties = {"align-content",
-					  "align-items",
-					  "align-self",
-					  "all",
-					  "animation",
-					  "animation-delay",
-					  "animation-direction",
-					  "animation-duration",
-					  "animation-fill-mode",
-					  "animation-iteration-count",
-					  "animation-name",
-					  "animation-play-state",
-					  "animation-timing-function",
-					  "backdrop-filter",
-					  "backface-visibility",
-					  "background",
-					  "background-attachment",
-					  "background-blend-mode",
-					  "background-clip",
-					  "background-color",
-					  "background-image",
-					  "background-origin",
-					  "background-position",
-					  "background-repeat",
-					  "background-size",
-					  "border",
-					  "border-bottom",
-					  "border-bottom-color",
-					  "border-bottom-left-radius",
-					  "border-bottom-right-radius",
-					  "border-bottom-style",
-					  "border-bottom-width",
-					  "border-collapse",
-					  "border-color",
-					  "border-image",
-					  "border-image-outset",
-					  "border-image-repeat",
-					  "border-image-slice",
-					  "border-image-source",
-					  "border-image-width",
-					  "border-left",
-					  "border-left-color",
-					  "border-left-style",
-					  "border-left-width",
-					  "border-radius",
-					  "border-right",
-					  "border-right-color",
-					  "border-right-style",
-					  "border-right-width",
-					  "border-spacing",
-					  "border-style",
-					  "border-top",
-					  "border-top-color",
-					  "border-top-left-radius",
-					  "border-top-right-radius",
-					  "border-top-style",
-					  "border-top-width",
-					  "border-width",
-					  "bottom",
-					  "box-decoration-break",
-					  "box-shadow",
-					  "box-sizing",
-					  "break-after",
-					  "break-before",
-					  "break-inside",
-					  "caption-side",
-					  "caret-color",
-					  "clear",
-					  "clip",
-					  "clip-path",
-					  "color",
-					  "column-count",
-					  "column-fill",
-					  "column-gap",
-					  "column-rule",
-					  "column-rule-color",
-					  "column-rule-style",
-					  "column-rule-width",
-					  "column-span",
-					  "column-width",
-					  "columns",
-					  "content",
-					  "counter-increment",
-					  "counter-reset",
-					  "cursor",
-					  "direction",
-					  "display",
-					  "empty-cells",
-					  "filter",
-					  "flex",
-					  "flex-basis",
-					  "flex-direction",
-					  "flex-flow",
-					  "flex-grow",
-					  "flex-shrink",
-					  "flex-wrap",
-					  "float",
-					  "font",
-					  "font-family",
-					  "font-feature-settings",
-					  "font-kerning",
-					  "font-language-override",
-					  "font-size",
-					  "font-size-adjust",
-					  "font-stretch",
-					  "font-style",
-					  "font-synthesis",
-					  "font-variant",
-					  "font-variant-alternates",
-					  "font-variant-caps",
-					  "font-variant-east-asian",
-					  "font-variant-ligatures",
-					  "font-variant-numeric",
-					  "font-variant-position",
-					  "font-weight",
-					  "gap",
-					  "grid",
-					  "grid-area",
-					  "grid-auto-columns",
-					  "grid-auto-flow",
-					  "grid-auto-rows",
-					  "grid-column",
-					  "grid-column-end",
-					  "grid-column-gap",
-					  "grid-column-start",
-					  "grid-gap",
-					  "grid-row",
-					  "grid-row-end",
-					  "grid-row-gap",
-					  "grid-row-start",
-					  "grid-template",
-					  "grid-template-areas",
-					  "grid-template-columns",
-					  "grid-template-rows",
-					  "hanging-punctuation",
-					  "height",
-					  "hyphens",
-					  "image-rendering",
-					  "isolation",
-					  "justify-content",
-					  "justify-items",
-					  "justify-self",
-					  "left",
-					  "letter-spacing",
-					  "line-break",
-					  "line-height",
-					  "list-style",
-					  "list-style-image",
-					  "list-style-position",
-					  "list-style-type",
-					  "margin",
-					  "margin-bottom",
-					  "margin-left",
-					  "margin-right",
-					  "margin-top",
-					  "mask",
-					  "mask-clip",
-					  "mask-composite",
-					  "mask-image",
-					  "mask-mode",
-					  "mask-origin",
-					  "mask-position",
-					  "mask-repeat",
-					  "mask-size",
-					  "mask-type",
-					  "max-height",
-					  "max-width",
-					  "min-height",
-					  "min-width",
-					  "mix-blend-mode",
-					  "object-fit",
-					  "object-position",
-					  "opacity",
-					  "order",
-					  "orphans",
-					  "outline",
-					  "outline-color",
-					  "outline-offset",
-					  "outline-style",
-					  "outline-width",
-					  "overflow",
-					  "overflow-wrap",
-					  "overflow-x",
-					  "overflow-y",
-					  "padding",
-					  "padding-bottom",
-					  "padding-left",
-					  "padding-right",
-					  "padding-top",
-					  "page-break-after",
-					  "page-break-before",
-					  "page-break-inside",
-					  "perspective",
-					  "perspective-origin",
-					  "pointer-events",
-					  "position",
-					  "quotes",
-					  "resize",
-					  "right",
-					  "row-gap",
-					  "scroll-behavior",
-					  "tab-size",
-					  "table-layout",
-					  "text-align",
-					  "text-align-last",
-					  "text-combine-upright",
-					  "text-decoration",
-					  "text-decoration-color",
-					  "text-decoration-line",
-					  "text-decoration-skip-ink",
-					  "text-decoration-style",
-					  "text-decoration-thickness",
-					  "text-emphasis",
-					  "text-emphasis-color",
-					  "text-emphasis-position",
-					  "text-emphasis-style",
-					  "text-indent",
-					  "text-justify",
-					  "text-orientation",
-					  "text-overflow",
-					  "text-rendering",
-					  "text-shadow",
-					  "text-transform",
-					  "text-underline-offset",
-					  "text-underline-position",
-					  "top",
-					  "transform",
-					  "transform-box",
-					  "transform-origin",
-					  "transform-style",
-					  "transition",
-					  "transition-delay",
-					  "transition-duration",
-					  "transition-property",
-					  "transition-timing-function",
-					  "unicode-bidi",
-					  "user-select",
-					  "vertical-align",
-					  "visibility",
-					  "white-space",
-					  "widows",
-					  "width",
-					  "word-break",
-					  "word-spacing",
-					  "word-wrap",
-					  "writing-mode",
-					  "z-index"};
-		// Value keywords (lowercase)
-		valueKeywords = {"auto",
-						 "inherit",
-						 "initial",
-						 "unset",
-						 "revert",
-						 "none",
-						 "hidden",
-						 "visible",
-						 "solid",
-						 "dashed",
-						 "dotted",
-						 "double",
-						 "groove",
-						 "ridge",
-						 "inset",
-						 "outset",
-						 "block",
-						 "inline",
-						 "inline-block",
-						 "flex",
-						 "grid",
-						 "table",
-						 "table-row",
-						 "table-cell",
-						 "absolute",
-						 "relative",
-						 "fixed",
-						 "static",
-						 "sticky",
-						 "center",
-						 "left",
-						 "right",
-						 "top",
-						 "bottom",
-						 "start",
-						 "end",
-						 "justify",
-						 "stretch",
-						 "normal",
-						 "bold",
-						 "italic",
-						 "underline",
-						 "overline",
-						 "line-through",
-						 "uppercase",
-						 "lowercase",
-						 "capitalize",
-						 "pointer",
-						 "default",
-						 "move",
-						 "not-allowed",
-						 "wait",
-						 "help",
-						 "crosshair",
-						 "text",
-						 "vertical-text",
-						 "alias",
-						 "copy",
-						 "no-drop",
-						 "grab",
-						 "grabbing",
-						 "all-scroll",
-						 "col-resize",
-						 "row-resize",
-						 "n-resize",
-						 "e-resize",
-						 "s-resize",
-						 "w-resize",
-						 "ne-resize",
-						 "nw-resize",
-						 "se-resize",
-						 "sw-resize",
-						 "ew-resize",
-						 "ns-resize",
-						 "nesw-resize",
-						 "nwse-resize",
-						 "zoom-in",
-						 "zoom-out",
-						 "transparent",
-						 "currentcolor",
-						 "aliceblue",
-						 "antiquewhite",
-						 "aqua",
-						 "aquamarine",
-						 "azure",
-						 "beige",
-						 "bisque",
-						 "black",
-						 "blanchedalmond",
-						 "blue",
-						 "blueviolet",
-						 "brown",
-						 "burlywood",
-						 "cadetblue",
-						 "chartreuse",
-						 "chocolate",
-						 "coral",
-						 "cornflowerblue",
-						 "cornsilk",
-						 "crimson",
-						 "cyan",
-						 "darkblue",
-						 "darkcyan",
-						 "darkgoldenrod",
-						 "darkgray",
-						 "darkgreen",
-						 "darkgrey",
-						 "darkkhaki",
-						 "darkmagenta",
-						 "darkolivegreen",
-						 "darkorange",
-						 "darkorchid",
-						 "darkred",
-						 "darksalmon",
-						 "darkseagreen",
-						 "darkslateblue",
-						 "darkslategray",
-						 "darkslategrey",
-						 "darkturquoise",
-						 "darkviolet",
-						 "deeppink",
-						 "deepskyblue",
-						 "dimgray",
-						 "dimgrey",
-						 "dodgerblue",
-						 "firebrick",
-						 "floralwhite",
-						 "forestgreen",
-						 "fuchsia",
-						 "gainsboro",
-						 "ghostwhite",
-						 "gold",
-						 "goldenrod",
-						 "gray",
-						 "green",
-						 "greenyellow",
-						 "grey",
-						 "honeydew",
-						 "hotpink",
-						 "indianred",
-						 "indigo",
-						 "ivory",
-						 "khaki",
-						 "lavender",
-						 "lavenderblush",
-						 "lawngreen",
-						 "lemonchiffon",
-						 "lightblue",
-						 "lightcoral",
-						 "lightcyan",
-						 "lightgoldenrodyellow",
-						 "lightgray",
-						 "lightgreen",
-						 "lightgrey",
-						 "lightpink",
-						 "lightsalmon",
-						 "lightseagreen",
-						 "lightskyblue",
-						 "lightslategray",
-						 "lightslategrey",
-						 "lightsteelblue",
-						 "lightyellow",
-						 "lime",
-						 "limegreen",
-						 "linen",
-						 "magenta",
-						 "maroon",
-						 "mediumaquamarine",
-						 "mediumblue",
-						 "mediumorchid",
-						 "mediumpurple",
-						 "mediumseagreen",
-						 "mediumslateblue",
-						 "mediumspringgreen",
-						 "mediumturquoise",
-						 "mediumvioletred",
-						 "midnightblue",
-						 "mintcream",
-						 "mistyrose",
-						 "moccasin",
-						 "navajowhite",
-						 "navy",
-						 "oldlace",
-						 "olive",
-						 "olivedrab",
-						 "orange",
-						 "orangered",
-						 "orchid",
-						 "palegoldenrod",
-						 "palegreen",
-						 "paleturquoise",
-						 "palevioletred",
-						 "papayawhip",
-						 "peachpuff",
-						 "peru",
-						 "pink",
-						 "plum",
-						 "powderblue",
-						 "purple",
-						 "rebeccapurple",
-						 "red",
-						 "rosybrown",
-						 "royalblue",
-						 "saddlebrown",
-						 "salmon",
-						 "sandybrown",
-						 "seagreen",
-						 "seashell",
-						 "sienna",
-						 "silver",
-						 "skyblue",
-						 "slateblue",
-						 "slategray",
-						 "slategrey",
-						 "snow",
-						 "springgreen",
-						 "steelblue",
-						 "tan",
-						 "teal",
-						 "thistle",
-						 "tomato",
-						 "turquoise",
-						 "violet",
-						 "wheat",
-						 "white",
-						 "whitesmoke",
-						 "yellow",
-						 "yellowgreen"};
-
-		colorsNeedUpdate = true;
-		currentState = LexerState::TopLevel;
-	}
-
-	void themeChanged() { colorsNeedUpdate = true; }
+	Lexer() { currentState = LexerState::TopLevel; }
 
 	// --- PUBLIC METHODS ---
 
@@ -661,8 +156,9 @@ class Lexer
 		return tokens;
 	}
 
-	void
-	applyHighlighting(const std::string &code, std::vector<ImVec4> &colors, int start_pos)
+	void applyHighlighting(const std::string &code,
+						   std::vector<HighlightClass> &colors,
+						   int start_pos)
 	{
 		try
 		{
@@ -674,7 +170,7 @@ class Lexer
 			{
 				if (token.length == 0)
 					continue;
-				ImVec4 color = getColorForTokenType(token.type);
+				HighlightClass color = getClassForTokenType(token.type);
 				size_t globalStart = start_pos + token.start;
 				size_t globalEnd = globalStart + token.length;
 				if (globalEnd > colors.size())
@@ -695,32 +191,117 @@ class Lexer
 		{
 			std::cerr << "🔴 Exception in CSS applyHighlighting: " << e.what()
 					  << std::endl;
-			if (!colorsNeedUpdate)
-				std::fill(colors.begin() + start_pos, colors.end(), cachedColors.text);
-			else
-				std::fill(colors.begin() + start_pos,
-						  colors.end(),
-						  ImVec4(1.0f, 1.0f, 1.0f, 1.0f));
+			std::fill(colors.begin() + start_pos, colors.end(), HighlightClass::Text);
 		} catch (...)
 		{
 			std::cerr << "🔴 Unknown exception in CSS applyHighlighting" << std::endl;
-			if (!colorsNeedUpdate)
-				std::fill(colors.begin() + start_pos, colors.end(), cachedColors.text);
-			else
-				std::fill(colors.begin() + start_pos,
-						  colors.end(),
-						  ImVec4(1.0f, 1.0f, 1.0f, 1.0f));
+			std::fill(colors.begin() + start_pos, colors.end(), HighlightClass::Text);
 		}
 	}
 
-	void forceColorUpdate() { colorsNeedUpdate = true; }
-
   private:
 	// --- Member Variables ---
-	std::unordered_set<std::string> properties;
-	std::unordered_set<std::string> valueKeywords;
-	mutable ThemeColors cachedColors;
-	mutable bool colorsNeedUpdate = true;
+	// Lowercase
+	static constexpr auto properties = LexerTables::makeKeywordSet({
+		"align-content", "align-items", "align-self", "all", "animation",
+		"animation-delay", "animation-direction", "animation-duration",
+		"animation-fill-mode", "animation-iteration-count", "animation-name",
+		"animation-play-state", "animation-timing-function", "backdrop-filter",
+		"backface-visibility", "background", "background-attachment",
+		"background-blend-mode", "background-clip", "background-color",
+		"background-image", "background-origin", "background-position",
+		"background-repeat", "background-size", "border", "border-bottom",
+		"border-bottom-color", "border-bottom-left-radius",
+		"border-bottom-right-radius", "border-bottom-style", "border-bottom-width",
+		"border-collapse", "border-color", "border-image", "border-image-outset",
+		"border-image-repeat", "border-image-slice", "border-image-source",
+		"border-image-width", "border-left", "border-left-color", "border-left-style",
+		"border-left-width", "border-radius", "border-right", "border-right-color",
+		"border-right-style", "border-right-width", "border-spacing", "border-style",
+		"border-top", "border-top-color", "border-top-left-radius",
+		"border-top-right-radius", "border-top-style", "border-top-width",
+		"border-width", "bottom", "box-decoration-break", "box-shadow", "box-sizing",
+		"break-after", "break-before", "break-inside", "caption-side", "caret-color",
+		"clear", "clip", "clip-path", "color", "column-count", "column-fill",
+		"column-gap", "column-rule", "column-rule-color", "column-rule-style",
+		"column-rule-width", "column-span", "column-width", "columns", "content",
+		"counter-increment", "counter-reset", "cursor", "direction", "display",
+		"empty-cells", "filter", "flex", "flex-basis", "flex-direction", "flex-flow",
+		"flex-grow", "flex-shrink", "flex-wrap", "float", "font", "font-family",
+		"font-feature-settings", "font-kerning", "font-language-override", "font-size",
+		"font-size-adjust", "font-stretch", "font-style", "font-synthesis",
+		"font-variant", "font-variant-alternates", "font-variant-caps",
+		"font-variant-east-asian", "font-variant-ligatures", "font-variant-numeric",
+		"font-variant-position", "font-weight", "gap", "grid", "grid-area",
+		"grid-auto-columns", "grid-auto-flow", "grid-auto-rows", "grid-column",
+		"grid-column-end", "grid-column-gap", "grid-column-start", "grid-gap",
+		"grid-row", "grid-row-end", "grid-row-gap", "grid-row-start", "grid-template",
+		"grid-template-areas", "grid-template-columns", "grid-template-rows",
+		"hanging-punctuation", "height", "hyphens", "image-rendering", "isolation",
+		"justify-content", "justify-items", "justify-self", "left", "letter-spacing",
+		"line-break", "line-height", "list-style", "list-style-image",
+		"list-style-position", "list-style-type", "margin", "margin-bottom",
+		"margin-left", "margin-right", "margin-top", "mask", "mask-clip",
+		"mask-composite", "mask-image", "mask-mode", "mask-origin", "mask-position",
+		"mask-repeat", "mask-size", "mask-type", "max-height", "max-width",
+		"min-height", "min-width", "mix-blend-mode", "object-fit", "object-position",
+		"opacity", "order", "orphans", "outline", "outline-color", "outline-offset",
+		"outline-style", "outline-width", "overflow", "overflow-wrap", "overflow-x",
+		"overflow-y", "padding", "padding-bottom", "padding-left", "padding-right",
+		"padding-top", "page-break-after", "page-break-before", "page-break-inside",
+		"perspective", "perspective-origin", "pointer-events", "position", "quotes",
+		"resize", "right", "row-gap", "scroll-behavior", "tab-size", "table-layout",
+		"text-align", "text-align-last", "text-combine-upright", "text-decoration",
+		"text-decoration-color", "text-decoration-line", "text-decoration-skip-ink",
+		"text-decoration-style", "text-decoration-thickness", "text-emphasis",
+		"text-emphasis-color", "text-emphasis-position", "text-emphasis-style",
+		"text-indent", "text-justify", "text-orientation", "text-overflow",
+		"text-rendering", "text-shadow", "text-transform", "text-underline-offset",
+		"text-underline-position", "top", "transform", "transform-box",
+		"transform-origin", "transform-style", "transition", "transition-delay",
+		"transition-duration", "transition-property", "transition-timing-function",
+		"unicode-bidi", "user-select", "vertical-align", "visibility", "white-space",
+		"widows", "width", "word-break", "word-spacing", "word-wrap", "writing-mode",
+		"z-index"});
+	static constexpr auto valueKeywords = LexerTables::makeKeywordSet({
+		"auto", "inherit", "initial", "unset", "revert", "none", "hidden", "visible",
+		"solid", "dashed", "dotted", "double", "groove", "ridge", "inset", "outset",
+		"block", "inline", "inline-block", "flex", "grid", "table", "table-row",
+		"table-cell", "absolute", "relative", "fixed", "static", "sticky", "center",
+		"left", "right", "top", "bottom", "start", "end", "justify", "stretch",
+		"normal", "bold", "italic", "underline", "overline", "line-through",
+		"uppercase", "lowercase", "capitalize", "pointer", "default", "move",
+		"not-allowed", "wait", "help", "crosshair", "text", "vertical-text", "alias",
+		"copy", "no-drop", "grab", "grabbing", "all-scroll", "col-resize", "row-resize",
+		"n-resize", "e-resize", "s-resize", "w-resize", "ne-resize", "nw-resize",
+		"se-resize", "sw-resize", "ew-resize", "ns-resize", "nesw-resize",
+		"nwse-resize", "zoom-in", "zoom-out", "transparent", "currentcolor",
+		"aliceblue", "antiquewhite", "aqua", "aquamarine", "azure", "beige", "bisque",
+		"black", "blanchedalmond", "blue", "blueviolet", "brown", "burlywood",
+		"cadetblue", "chartreuse", "chocolate", "coral", "cornflowerblue", "cornsilk",
+		"crimson", "cyan", "darkblue", "darkcyan", "darkgoldenrod", "darkgray",
+		"darkgreen", "darkgrey", "darkkhaki", "darkmagenta", "darkolivegreen",
+		"darkorange", "darkorchid", "darkred", "darksalmon", "darkseagreen",
+		"darkslateblue", "darkslategray", "darkslategrey", "darkturquoise",
+		"darkviolet", "deeppink", "deepskyblue", "dimgray", "dimgrey", "dodgerblue",
+		"firebrick", "floralwhite", "forestgreen", "fuchsia", "gainsboro", "ghostwhite",
+		"gold", "goldenrod", "gray", "green", "greenyellow", "grey", "honeydew",
+		"hotpink", "indianred", "indigo", "ivory", "khaki", "lavender", "lavenderblush",
+		"lawngreen", "lemonchiffon", "lightblue", "lightcoral", "lightcyan",
+		"lightgoldenrodyellow", "lightgray", "lightgreen", "lightgrey", "lightpink",
+		"lightsalmon", "lightseagreen", "lightskyblue", "lightslategray",
+		"lightslategrey", "lightsteelblue", "lightyellow", "lime", "limegreen", "linen",
+		"magenta", "maroon", "mediumaquamarine", "mediumblue", "mediumorchid",
+		"mediumpurple", "mediumseagreen", "mediumslateblue", "mediumspringgreen",
+		"mediumturquoise", "mediumvioletred", "midnightblue", "mintcream", "mistyrose",
+		"moccasin", "navajowhite", "navy", "oldlace", "olive", "olivedrab", "orange",
+		"orangered", "orchid", "palegoldenrod", "palegreen", "paleturquoise",
+		"palevioletred", "papayawhip", "peachpuff", "peru", "pink", "plum",
+		"powderblue", "purple", "rebeccapurple", "red", "rosybrown", "royalblue",
+		"saddlebrown", "salmon", "sandybrown", "seagreen", "seashell", "sienna",
+		"silver", "skyblue", "slateblue", "slategray", "slategrey", "snow",
+		"springgreen", "steelblue", "tan", "teal", "thistle", "tomato", "turquoise",
+		"violet", "wheat", "white", "whitesmoke", "yellow", "yellowgreen"});
 	LexerState currentState;
 
 	// --- Helper Functions --- (Defined before use)
@@ -738,72 +319,26 @@ class Lexer
 	}
 
 	// Using simplified theme loading like Python example
-	void updateThemeColors() const
-	{
-		if (!colorsNeedUpdate)
-			return;
-		try
-		{
-			auto &theme = gSettings.getSettings()["themes"][gSettings.getCurrentTheme()];
-			auto loadColor = [&theme](const char *key,
-									  ImVec4 df =
-										  ImVec4(1.0f, 1.0f, 1.0f, 1.0f)) -> ImVec4 {
-				try
-				{
-					if (theme.contains(key))
-					{
-						auto &c = theme[key];
-						if (c.is_array() && c.size() == 4)
-							return ImVec4(c[0].get<float>(),
-										  c[1].get<float>(),
-										  c[2].get<float>(),
-										  c[3].get<float>());
-					}
-				} catch (const nlohmann::json::exception &e)
-				{
-					std::cerr << "Theme Error '" << key << "': " << e.what()
-							  << ". Defaulting." << std::endl;
-				} catch (const std::exception &e)
-				{
-					std::cerr << "Theme Error '" << key << "': " << e.what()
-							  << ". Defaulting." << std::endl;
-				}
-				return df;
-			};
-			// Load colors into simplified struct
-			cachedColors.keyword = loadColor("keyword");
-			cachedColors.string = loadColor("string");
-			cachedColors.number = loadColor("number"); // <<< NOW DEFINED
-			cachedColors.comment = loadColor("comment");
-			cachedColors.text = loadColor("text");
-			cachedColors.function = loadColor("function");
-			cachedColors.type =
-				loadColor("type", cachedColors.keyword); // Default type to keyword color
-			cachedColors.className =
-				loadColor("class_name",
-						  cachedColors.type); // Default class to type color
-
-			colorsNeedUpdate = false;
-		} catch (const std::exception &e)
-		{
-			std::cerr << "🔴 Error updating CSS theme colors: " << e.what() << std::endl;
-		}
-	}
 
-	bool isWhitespace(char c) const
-	{
-		return c == ' ' || c == '\t' || c == '\n' || c == '\r' || c == '\f';
-	}
+	bool isWhitespace(char c) const { return LexerTables::isSpace(c); }
 	bool isIdentStartChar(char c) const
 	{
-		return std::isalpha(static_cast<unsigned char>(c)) || c == '_' || c == '-';
+		return LexerTables::isIdentStart(c) || c == '-';
 	}
-	bool isIdentChar(char c) const
+	bool isIdentChar(char c) const { return LexerTables::isIdentPart(c) || c == '-'; }
+	bool isHexDigit(char c) const { return LexerTables::isHexDigit(c); }
+	bool isDigit(char c) const { return LexerTables::isDigit(c); }
+
+	// prefix must be lowercase
+	static bool startsWithNoCase(std::string_view text, std::string_view prefix)
 	{
-		return std::isalnum(static_cast<unsigned char>(c)) || c == '_' || c == '-';
+		if (text.size() < prefix.size())
+			return false;
+		for (size_t i = 0; i < prefix.size(); ++i)
+			if (std::tolower(static_cast<unsigned char>(text[i])) != prefix[i])
+				return false;
+		return true;
 	}
-	bool isHexDigit(char c) const { return std::isxdigit(static_cast<unsigned char>(c)); }
-	bool isDigit(char c) const { return std::isdigit(static_cast<unsigned char>(c)); }
 
 	Token lexWhitespace(const std::string &code, size_t &pos)
 	{
@@ -907,9 +442,6 @@ class Lexer
 			pos++;
 		while (pos < code.length() && isIdentChar(code[pos]))
 			pos++;
-		std::string prop = code.substr(s, pos - s);
-		std::string lowerProp = prop;
-		std::transform(lowerProp.begin(), lowerProp.end(), lowerProp.begin(), ::tolower);
 		return {TokenType::PropertyName, s, pos - s};
 	}
 
@@ -990,23 +522,16 @@ class Lexer
 				}
 				if (pos < code.length() && pL == 0)
 					pos++;
-				std::string fN = code.substr(s, pos - s);
-				std::string lFN = fN;
-				std::transform(lFN.begin(), lFN.end(), lFN.begin(), ::tolower);
-				if (lFN.rfind("rgb(", 0) == 0 || lFN.rfind("rgba(", 0) == 0 ||
-					lFN.rfind("hsl(", 0) == 0 || lFN.rfind("hsla(", 0) == 0)
+				std::string_view fN = std::string_view(code).substr(s, pos - s);
+				if (startsWithNoCase(fN, "rgb(") || startsWithNoCase(fN, "rgba(") ||
+					startsWithNoCase(fN, "hsl(") || startsWithNoCase(fN, "hsla("))
 					return {TokenType::PropertyValueColor, s, pos - s};
 				else
 					return {TokenType::PropertyValueFunction, s, pos - s};
 			} else
 			{
-				std::string w = code.substr(s, pos - s);
-				std::string lW = w;
-				std::transform(lW.begin(), lW.end(), lW.begin(), ::tolower);
-				if (valueKeywords.count(lW))
-					return {TokenType::PropertyValueKeyword, s, pos - s};
-				else
-					return {TokenType::PropertyValueKeyword, s, pos - s};
+				// Known to valueKeywords or not, a word is colored as a keyword
+				return {TokenType::PropertyValueKeyword, s, pos - s};
 			}
 		}
 		pos++;
@@ -1016,36 +541,35 @@ class Lexer
 	}
 
 	// Map CSS tokens to simplified theme colors
-	ImVec4 getColorForTokenType(TokenType type) const
+	HighlightClass getClassForTokenType(TokenType type) const
 	{
-		updateThemeColors();
 		switch (type)
 		{
 		case TokenType::Comment:
-			return cachedColors.comment;
+			return HighlightClass::Comment;
 		case TokenType::PropertyValueString:
 		case TokenType::SelectorAttribute:
-			return cachedColors.string;
+			return HighlightClass::String;
 		case TokenType::PropertyValueNumber:
 		case TokenType::PropertyValueColor:
 		case TokenType::PropertyValueKeyword: // <<< NOW MAPPED TO NUMBER COLOR
-			return cachedColors.number;
+			return HighlightClass::Number;
 		case TokenType::AtRule:
 		case TokenType::SelectorPseudo:
-			return cachedColors.keyword;
+			return HighlightClass::Keyword;
 		case TokenType::SelectorId:
 		case TokenType::PropertyValueFunction:
-			return cachedColors.function;
+			return HighlightClass::Function;
 		case TokenType::SelectorTag:
 		case TokenType::PropertyName:
-			return cachedColors.type;
+			return HighlightClass::Type;
 		case TokenType::SelectorClass:
-			return cachedColors.className;
+			return HighlightClass::Type;
 		case TokenType::Punctuation:
 		case TokenType::Whitespace:
 		case TokenType::Unknown:
 		default:
-			return cachedColors.text;
+			return HighlightClass::Text;
 		}
 	}
 
@@ -1,15 +1,11 @@
 #pragma once
-#include "../util/settings.h"
-#include "imgui.h"
+#include "../editor/editor_highlight_class.h"
+#include "lexer_tables.h"
 #include <iostream>
 #include <string>
-#include <unordered_map>
-#include <unordered_set>
+#include <string_view>
 #include <vector>
 
-class Settings;
-extern Settings gSettings;
-
 namespace HtmlLexer {
 
 enum class TokenType {
@@ -65,43 +61,6 @@ struct Token
 class Lexer
 {
   public:
-	struct ThemeColors
-	{
-		ImVec4 text;
-		ImVec4 tagName;
-		ImVec4 attributeName;
-		ImVec4 attributeValue;
-		ImVec4 string;
-		ImVec4 comment;
-		ImVec4 bracket;
-		ImVec4 entityRef;
-		// Add these for JavaScript
-		ImVec4 keyword;	 // For JS keywords
-		ImVec4 number;	 // For JS numbers
-		ImVec4 function; // For JS functions
-	};
-
-	Lexer()
-	{
-		tags = {"html",
-				"head",
-				"body",
-				"div",
-				"span",
-				"p",
-				"a",
-				"img",
-				"script",
-				"style",
-				"link",
-				"meta",
-				"title"};
-
-		attributes = {"class", "id", "href", "src", "type", "rel", "style", "onclick"};
-	}
-
-	void themeChanged() { colorsNeedUpdate = true; }
-
 	std::vector<Token> tokenize(const std::string &code)
 	{
 		std::vector<Token> tokens;
@@ -131,7 +90,7 @@ class Lexer
 				pos++;
 			} else if (c == '<')
 			{
-				if (pos + 3 < code.length() && code.substr(pos, 4) == "<!--")
+				if (pos + 3 < code.length() && code.compare(pos, 4, "<!--") == 0)
 				{
 					tokens.push_back(lexComment(code, pos));
 				} else
@@ -190,8 +149,9 @@ class Lexer
 		}
 		return tokens;
 	}
-	void
-	applyHighlighting(const std::string &code, std::vector<ImVec4> &colors, int start_pos)
+	void applyHighlighting(const std::string &code,
+						   std::vector<HighlightClass> &colors,
+						   int start_pos)
 	{
 		try
 		{
@@ -210,7 +170,7 @@ class Lexer
 						Token jsToken = lexJavaScript(jsContent, jsPos);
 
 						// Apply color based on JavaScript token type
-						ImVec4 color = getColorForTokenType(jsToken.type);
+						HighlightClass color = getClassForTokenType(jsToken.type);
 						for (size_t i = 0; i < jsToken.length; ++i)
 						{
 							size_t index = start_pos + token.start + jsToken.start + i;
@@ -235,7 +195,7 @@ class Lexer
 						Token cssToken = lexCss(cssContent, cssPos);
 
 						// Apply color based on CSS token type
-						ImVec4 color = getColorForTokenType(cssToken.type);
+						HighlightClass color = getClassForTokenType(cssToken.type);
 						for (size_t i = 0; i < cssToken.length; ++i)
 						{
 							size_t index = start_pos + token.start + cssToken.start + i;
@@ -249,7 +209,7 @@ class Lexer
 				}
 
 				// Normal HTML token handling
-				ImVec4 color = getColorForTokenType(token.type);
+				HighlightClass color = getClassForTokenType(token.type);
 				for (size_t i = 0; i < token.length; ++i)
 				{
 					size_t index = start_pos + token.start + i;
@@ -265,127 +225,82 @@ class Lexer
 		}
 	}
 
-	void forceColorUpdate() { colorsNeedUpdate = true; }
-
   private:
-	std::unordered_set<std::string> tags;
-	std::unordered_set<std::string> attributes;
-	mutable ThemeColors cachedColors;
-	mutable bool colorsNeedUpdate = true;
-
-	ImVec4 getColorForTokenType(TokenType type) const
+	// Looked up with views into the code, so no token is copied
+	static constexpr auto tags = LexerTables::makeKeywordSet({
+		"html", "head", "body", "div", "span", "p", "a", "img", "script", "style",
+		"link", "meta", "title"});
+	static constexpr auto attributes = LexerTables::makeKeywordSet({
+		"class", "id", "href", "src", "type", "rel", "style", "onclick"});
+
+	HighlightClass getClassForTokenType(TokenType type) const
 	{
-		updateThemeColors();
 
 		switch (type)
 		{
 		case TokenType::TagName:
-			return cachedColors.tagName;
+			return HighlightClass::Keyword;
 		case TokenType::AttributeName:
-			return cachedColors.attributeName;
+			return HighlightClass::Function;
 		case TokenType::AttributeValue:
-			return cachedColors.attributeValue;
+			return HighlightClass::String;
 		case TokenType::String:
-			return cachedColors.string;
+			return HighlightClass::String;
 		case TokenType::Comment:
-			return cachedColors.comment;
+			return HighlightClass::Comment;
 		case TokenType::AngledBracket:
-			return cachedColors.bracket;
+			return HighlightClass::Keyword;
 		case TokenType::EntityRef:
-			return cachedColors.entityRef;
+			return HighlightClass::Number;
 
 		case TokenType::JsKeyword:
-			return cachedColors.keyword;
+			return HighlightClass::Keyword;
 		case TokenType::JsString:
-			return cachedColors.string;
+			return HighlightClass::String;
 		case TokenType::JsNumber:
-			return cachedColors.number;
+			return HighlightClass::Number;
 		case TokenType::JsComment:
-			return cachedColors.comment;
+			return HighlightClass::Comment;
 		case TokenType::JsFunction:
-			return cachedColors.function;
+			return HighlightClass::Function;
 		case TokenType::JsOperator:
-			return ImVec4(cachedColors.text.x * 0.8f,
-						  cachedColors.text.y * 0.8f,
-						  cachedColors.text.z * 0.8f,
-						  cachedColors.text.w);
+			return HighlightClass::DimmedText;
 		case TokenType::JsBrace:
-			return cachedColors.bracket;
+			return HighlightClass::Keyword;
 		case TokenType::JsIdentifier:
-			return cachedColors.text;
+			return HighlightClass::Text;
 
 		case TokenType::CssProperty:
-			return cachedColors.keyword;
+			return HighlightClass::Keyword;
 		case TokenType::CssValue:
-			return cachedColors.text;
+			return HighlightClass::Text;
 		case TokenType::CssNumber:
-			return cachedColors.number;
+			return HighlightClass::Number;
 		case TokenType::CssColor:
-			return cachedColors.string;
+			return HighlightClass::String;
 		case TokenType::CssComment:
-			return cachedColors.comment;
+			return HighlightClass::Comment;
 		case TokenType::CssBrace:
-			return cachedColors.bracket;
+			return HighlightClass::Keyword;
 		case TokenType::CssColon:
 		case TokenType::CssSemicolon:
 		case TokenType::CssOperator:
-			return ImVec4(cachedColors.text.x * 0.8f,
-						  cachedColors.text.y * 0.8f,
-						  cachedColors.text.z * 0.8f,
-						  cachedColors.text.w);
+			return HighlightClass::DimmedText;
 		case TokenType::CssImportant:
-			return cachedColors.function;
+			return HighlightClass::Function;
 
 		default:
-			return cachedColors.text;
+			return HighlightClass::Text;
 		}
 	}
 
-	void updateThemeColors() const
-	{
-		if (!colorsNeedUpdate)
-			return;
-
-		auto &theme = gSettings.getSettings()["themes"][gSettings.getCurrentTheme()];
-
-		auto loadColor = [&theme](const char *key) -> ImVec4 {
-			auto &c = theme[key];
-			return ImVec4(c[0], c[1], c[2], c[3]);
-		};
-
-		cachedColors.text = loadColor("text");
-		cachedColors.tagName = loadColor("keyword"); // Use keyword color for tags
-		cachedColors.attributeName =
-			loadColor("function"); // Use function color for attributes
-		cachedColors.attributeValue = loadColor("string"); // Use string color for values
-		cachedColors.string = loadColor("string");
-		cachedColors.comment = loadColor("comment");
-		cachedColors.bracket = loadColor("keyword");  // Use keyword color for brackets
-		cachedColors.entityRef = loadColor("number"); // Use number color for entities
-
-		// Cache JavaScript colors
-		cachedColors.keyword = loadColor("keyword");
-		cachedColors.number = loadColor("number");
-		cachedColors.function = loadColor("function");
-
-		colorsNeedUpdate = false;
-	}
-	bool isWhitespace(char c) const
-	{
-		return c == ' ' || c == '\t' || c == '\n' || c == '\r';
-	}
+	bool isWhitespace(char c) const { return LexerTables::isSpace(c); }
 
-	bool isAlpha(char c) const
-	{
-		return (c >= 'a' && c <= 'z') || (c >= 'A' && c <= 'Z');
-	}
+	bool isAlpha(char c) const { return LexerTables::isAlpha(c); }
 
-	bool isDigit(char c) const { return c >= '0' && c <= '9'; }
+	bool isDigit(char c) const { return LexerTables::isDigit(c); }
 
-	bool isAlphaNumeric(char c) const
-	{
-		return isAlpha(c) || isDigit(c) || c == '_' || c == '-';
-	}
+	bool isAlphaNumeric(char c) const { return LexerTables::isIdentPart(c) || c == '-'; }
 
 	Token lexTag(const std::string &code, size_t &pos)
 	{
@@ -445,7 +360,7 @@ class Lexer
 	{
 		if (token.type != TokenType::TagName)
 			return false;
-		std::string tagName = code.substr(token.start + 1, token.length - 1);
+		std::string_view tagName(code.data() + token.start + 1, token.length - 1);
 		return tagName == "script";
 	}
 
@@ -453,7 +368,7 @@ class Lexer
 	{
 		if (token.type != TokenType::TagName)
 			return false;
-		std::string tagName = code.substr(token.start + 1, token.length - 1);
+		std::string_view tagName(code.data() + token.start + 1, token.length - 1);
 		return tagName == "style";
 	}
 
@@ -465,7 +380,7 @@ class Lexer
 		// Find the end of script tag
 		while (pos < code.length())
 		{
-			if (pos + 8 < code.length() && code.substr(pos, 9) == "</script>")
+			if (pos + 8 < code.length() && code.compare(pos, 9, "</script>") == 0)
 			{
 				// Create a ScriptContent token that only includes the JS
 				// content not including the closing tag
@@ -484,7 +399,7 @@ class Lexer
 
 		while (pos < code.length())
 		{
-			if (pos + 7 < code.length() && code.substr(pos, 8) == "</style>")
+			if (pos + 7 < code.length() && code.compare(pos, 8, "</style>") == 0)
 			{
 				// Create a StyleContent token that only includes the CSS
 				// content
@@ -496,10 +411,10 @@ class Lexer
 		return {TokenType::StyleContent, contentStart, pos - contentStart};
 	}
 
-	std::unordered_set<std::string> jsKeywords = {
-		"function", "var",		 "let",	  "const",	  "if",		"else",	  "for",
-		"while",	"do",		 "break", "continue", "return", "class",  "new",
-		"this",		"undefined", "null",  "true",	  "false",	"typeof", "instanceof"};
+	static constexpr auto jsKeywords = LexerTables::makeKeywordSet({
+		"function", "var", "let", "const", "if", "else", "for", "while", "do", "break",
+		"continue", "return", "class", "new", "this", "undefined", "null", "true",
+		"false", "typeof", "instanceof"});
 
 	Token lexJavaScript(const std::string &code, size_t &pos)
 	{
@@ -568,8 +483,7 @@ class Lexer
 				   (isAlphaNumeric(code[pos]) || code[pos] == '_' || code[pos] == '$'))
 				pos++;
 
-			std::string word = code.substr(start, pos - start);
-			if (jsKeywords.find(word) != jsKeywords.end())
+			if (jsKeywords.contains(std::string_view(code).substr(start, pos - start)))
 			{
 				return {TokenType::JsKeyword, start, pos - start};
 			}
@@ -594,7 +508,7 @@ class Lexer
 		// Operators
 		return {TokenType::JsOperator, start, 1};
 	}
-	std::unordered_set<std::string> cssProperties = {
+	static constexpr auto cssProperties = LexerTables::makeKeywordSet({
 		// Existing properties
 		"cursor",
 
@@ -737,7 +651,7 @@ class Lexer
 		"-webkit-box-shadow",
 
 		// CSS Custom Properties
-		"--*"};
+		"--*"});
 
 	Token lexCss(const std::string &code, size_t &pos)
 	{
@@ -774,7 +688,7 @@ class Lexer
 
 		// Colors and Functions
 		if (c == 'r' && pos + 3 < code.length() &&
-			(code.substr(pos, 4) == "rgba" || code.substr(pos, 3) == "rgb"))
+			(code.compare(pos, 4, "rgba") == 0 || code.compare(pos, 3, "rgb") == 0))
 		{
 			size_t start = pos;
 			while (pos < code.length() && code[pos] != ')')
@@ -786,7 +700,7 @@ class Lexer
 
 		// HSL/HSLA Functions
 		if (c == 'h' && pos + 3 < code.length() &&
-			(code.substr(pos, 4) == "hsla" || code.substr(pos, 3) == "hsl"))
+			(code.compare(pos, 4, "hsla") == 0 || code.compare(pos, 3, "hsl") == 0))
 		{
 			size_t start = pos;
 			while (pos < code.length() && code[pos] != ')')
@@ -797,7 +711,7 @@ class Lexer
 		}
 
 		// URL Function
-		if (c == 'u' && pos + 3 < code.length() && code.substr(pos, 4) == "url(")
+		if (c == 'u' && pos + 3 < code.length() && code.compare(pos, 4, "url(") == 0)
 		{
 			size_t start = pos;
 			while (pos < code.length() && code[pos] != ')')
@@ -849,28 +763,15 @@ class Lexer
 				pos++;
 			}
 
-			std::string word = code.substr(start, pos - start);
+			std::string_view word = std::string_view(code).substr(start, pos - start);
 
 			// Check for properties
-			if (cssProperties.find(word) != cssProperties.end() ||
-				(word.substr(0, 2) == "--"))
+			if (cssProperties.contains(word) || word.substr(0, 2) == "--")
 			{ // Custom properties
 				return {TokenType::CssProperty, start, pos - start};
 			}
 
-			// Special values
-			static const std::unordered_set<std::string> specialValues = {
-				"inherit",	"initial",	"unset",		"none",	  "auto",
-				"block",	"inline",	"inline-block", "flex",	  "grid",
-				"absolute", "relative", "fixed",		"sticky", "bold",
-				"normal",	"italic",	"center",		"left",	  "right"};
-
-			if (specialValues.find(word) != specialValues.end())
-			{
-				return {TokenType::CssValue, start, pos - start};
-			}
-
-			// Fallback to generic value
+			// Special values and anything else alike
 			return {TokenType::CssValue, start, pos - start};
 		}
 
@@ -3,17 +3,11 @@
 #include <iostream>
 #include <stack> // Might be useful later
 #include <string>
-#include <unordered_map>
-#include <unordered_set>
+#include <string_view>
 #include <vector>
 
-#include "../util/settings.h" // Ensure this path is correct
-#include "imgui.h"			  // Ensure this path is correct
-
-// Forward declare Settings and json as needed
-class Settings;
-extern Settings gSettings;
-#include <lib/json.hpp>
+#include "../editor/editor_highlight_class.h"
+#include "lexer_tables.h"
 
 namespace JavaLexer {
 
@@ -49,62 +43,6 @@ struct Token
 class Lexer
 {
   public:
-	struct ThemeColors
-	{
-		ImVec4 keyword;
-		ImVec4 primitiveType;
-		ImVec4 string;
-		ImVec4 number;
-		ImVec4 comment;
-		ImVec4 text;
-		ImVec4 methodName;
-		ImVec4 className;
-		ImVec4 annotation;
-		ImVec4 operatorColor;
-	};
-
-	Lexer()
-	{
-		keywords = {"abstract",	  "assert",	   "break",		 "case",		 "catch",
-					"class",	  "const",	   "continue",	 "default",		 "do",
-					"else",		  "enum",	   "extends",	 "final",		 "finally",
-					"for",		  "goto",	   "if",		 "implements",	 "import",
-					"instanceof", "interface", "native",	 "new",			 "package",
-					"private",	  "protected", "public",	 "return",		 "static",
-					"strictfp",	  "super",	   "switch",	 "synchronized", "this",
-					"throw",	  "throws",	   "transient",	 "try",			 "volatile",
-					"while",	  "exports",   "module",	 "non-sealed",	 "open",
-					"opens",	  "permits",   "provides",	 "record",		 "requires",
-					"sealed",	  "to",		   "transitive", "uses",		 "var",
-					"when",		  "yield"};
-		primitiveTypes = {
-			"boolean", "byte", "char", "short", "int", "long", "float", "double", "void"};
-		literals = {"true", "false", "null"};
-		operators = {{"<<=", TokenType::Operator},	{">>=", TokenType::Operator},
-					 {">>>=", TokenType::Operator}, {"==", TokenType::Operator},
-					 {"!=", TokenType::Operator},	{">=", TokenType::Operator},
-					 {"<=", TokenType::Operator},	{"&&", TokenType::Operator},
-					 {"||", TokenType::Operator},	{"++", TokenType::Operator},
-					 {"--", TokenType::Operator},	{"+=", TokenType::Operator},
-					 {"-=", TokenType::Operator},	{"*=", TokenType::Operator},
-					 {"/=", TokenType::Operator},	{"%=", TokenType::Operator},
-					 {"&=", TokenType::Operator},	{"|=", TokenType::Operator},
-					 {"^=", TokenType::Operator},	{"<<", TokenType::Operator},
-					 {">>", TokenType::Operator},	{">>>", TokenType::Operator},
-					 {"->", TokenType::Operator},	{"::", TokenType::Operator},
-					 {"+", TokenType::Operator},	{"-", TokenType::Operator},
-					 {"*", TokenType::Operator},	{"/", TokenType::Operator},
-					 {"%", TokenType::Operator},	{"=", TokenType::Operator},
-					 {">", TokenType::Operator},	{"<", TokenType::Operator},
-					 {"!", TokenType::Operator},	{"&", TokenType::Operator},
-					 {"|", TokenType::Operator},	{"^", TokenType::Operator},
-					 {"~", TokenType::Operator},	{"?", TokenType::Operator},
-					 {":", TokenType::Operator}};
-		colorsNeedUpdate = true;
-	}
-
-	void themeChanged() { colorsNeedUpdate = true; }
-
 	std::vector<Token> tokenize(const std::string &code)
 	{
 		std::vector<Token> tokens;
@@ -175,8 +113,9 @@ class Lexer
 		return tokens;
 	}
 
-	void
-	applyHighlighting(const std::string &code, std::vector<ImVec4> &colors, int start_pos)
+	void applyHighlighting(const std::string &code,
+						   std::vector<HighlightClass> &colors,
+						   int start_pos)
 	{
 		try
 		{
@@ -191,7 +130,7 @@ class Lexer
 			{
 				if (token.length == 0)
 					continue;
-				ImVec4 color = getColorForTokenType(token.type);
+				HighlightClass color = getClassForTokenType(token.type);
 				size_t globalStart = start_pos + token.start;
 				size_t globalEnd = globalStart + token.length;
 				if (globalEnd > colors.size())
@@ -212,33 +151,33 @@ class Lexer
 		{
 			std::cerr << "🔴 Exception in Java applyHighlighting: " << e.what()
 					  << std::endl;
-			if (!colorsNeedUpdate)
-				std::fill(colors.begin() + start_pos, colors.end(), cachedColors.text);
-			else
-				std::fill(colors.begin() + start_pos,
-						  colors.end(),
-						  ImVec4(1.0f, 1.0f, 1.0f, 1.0f));
+			std::fill(colors.begin() + start_pos, colors.end(), HighlightClass::Text);
 		} catch (...)
 		{
 			std::cerr << "🔴 Unknown exception in Java applyHighlighting" << std::endl;
-			if (!colorsNeedUpdate)
-				std::fill(colors.begin() + start_pos, colors.end(), cachedColors.text);
-			else
-				std::fill(colors.begin() + start_pos,
-						  colors.end(),
-						  ImVec4(1.0f, 1.0f, 1.0f, 1.0f));
+			std::fill(colors.begin() + start_pos, colors.end(), HighlightClass::Text);
 		}
 	}
 
-	void forceColorUpdate() { colorsNeedUpdate = true; }
-
   private:
-	std::unordered_set<std::string> keywords;
-	std::unordered_set<std::string> primitiveTypes;
-	std::unordered_set<std::string> literals;
-	std::unordered_map<std::string, TokenType> operators;
-	mutable ThemeColors cachedColors;
-	mutable bool colorsNeedUpdate = true;
+	// Looked up with views into the code, so no token is copied
+	static constexpr auto keywords = LexerTables::makeKeywordSet({
+		"abstract", "assert", "break", "case", "catch", "class", "const", "continue",
+		"default", "do", "else", "enum", "extends", "final", "finally", "for", "goto",
+		"if", "implements", "import", "instanceof", "interface", "native", "new",
+		"package", "private", "protected", "public", "return", "static", "strictfp",
+		"super", "switch", "synchronized", "this", "throw", "throws", "transient",
+		"try", "volatile", "while", "exports", "module", "non-sealed", "open", "opens",
+		"permits", "provides", "record", "requires", "sealed", "to", "transitive",
+		"uses", "var", "when", "yield"});
+	static constexpr auto primitiveTypes = LexerTables::makeKeywordSet({
+		"boolean", "byte", "char", "short", "int", "long", "float", "double", "void"});
+	static constexpr auto literals = LexerTables::makeKeywordSet({
+		"true", "false", "null"});
+	static constexpr auto operators = LexerTables::makeKeywordSet({
+		"<<=", ">>=", ">>>=", "==", "!=", ">=", "<=", "&&", "||", "++", "--", "+=",
+		"-=", "*=", "/=", "%=", "&=", "|=", "^=", "<<", ">>", ">>>", "->", "::", "+",
+		"-", "*", "/", "%", "=", ">", "<", "!", "&", "|", "^", "~", "?", ":"});
 
 	int findLastNonWhitespaceTokenIndex(const std::vector<Token> &tokens) const
 	{
@@ -248,81 +187,21 @@ class Lexer
 		return -1;
 	}
 
-	void updateThemeColors() const
-	{
-		if (!colorsNeedUpdate)
-			return;
-		try
-		{
-			auto &theme = gSettings.getSettings()["themes"][gSettings.getCurrentTheme()];
-			auto loadColor = [&theme](const char *key,
-									  ImVec4 defaultColor =
-										  ImVec4(1.0f, 1.0f, 1.0f, 1.0f)) -> ImVec4 {
-				try
-				{
-					if (theme.contains(key))
-					{
-						auto &c = theme[key];
-						if (c.is_array() && c.size() == 4)
-							return ImVec4(c[0].get<float>(),
-										  c[1].get<float>(),
-										  c[2].get<float>(),
-										  c[3].get<float>());
-					}
-				} catch (const nlohmann::json::exception &e)
-				{
-					std::cerr << "Error loading theme color '" << key
-							  << "' (JSON error): " << e.what() << ". Using default."
-							  << std::endl;
-				} catch (const std::exception &e)
-				{
-					std::cerr << "Error loading theme color '" << key << "': " << e.what()
-							  << ". Using default." << std::endl;
-				}
-				return defaultColor;
-			};
-			cachedColors.text = loadColor("text");
-			cachedColors.keyword = loadColor("keyword", cachedColors.text);
-			cachedColors.primitiveType =
-				loadColor("primitive_type", cachedColors.keyword);
-			cachedColors.string = loadColor("string", cachedColors.text);
-			cachedColors.number = loadColor("number", cachedColors.text);
-			cachedColors.comment = loadColor("comment", ImVec4(0.5f, 0.5f, 0.5f, 1.0f));
-			cachedColors.methodName = loadColor("function", cachedColors.text);
-			cachedColors.className =
-				loadColor("class_name",
-						  cachedColors.primitiveType); // <<< CORRECTED DEFAULT
-			cachedColors.annotation = loadColor("decorator", cachedColors.keyword);
-			cachedColors.operatorColor = loadColor("operator", cachedColors.text);
-			colorsNeedUpdate = false;
-		} catch (const std::exception &e)
-		{
-			std::cerr << "🔴 Error updating Java theme colors: " << e.what() << std::endl;
-		}
-	}
-
 	// --- Basic Character Checks ---
-	bool isWhitespace(char c) const
-	{
-		return c == ' ' || c == '\t' || c == '\n' || c == '\r' || c == '\f';
-	}
-	bool isAlpha(char c) const
-	{
-		return (c >= 'a' && c <= 'z') || (c >= 'A' && c <= 'Z');
-	}
-	bool isDigit(char c) const { return c >= '0' && c <= '9'; }
+	bool isWhitespace(char c) const { return LexerTables::isSpace(c); }
+	bool isAlpha(char c) const { return LexerTables::isAlpha(c); }
+	bool isDigit(char c) const { return LexerTables::isDigit(c); }
 	bool isJavaIdentifierStart(char c) const
 	{
-		return isAlpha(c) || c == '_' || c == '$';
+		using namespace LexerTables;
+		return hasClass(c, Alpha | Underscore | Dollar);
 	}
 	bool isJavaIdentifierPart(char c) const
 	{
-		return (isAlpha(c) || isDigit(c)) || c == '_' || c == '$';
-	} // <<< CORRECTED
-	bool isHexDigit(char c) const
-	{
-		return isDigit(c) || (c >= 'a' && c <= 'f') || (c >= 'A' && c <= 'F');
+		using namespace LexerTables;
+		return hasClass(c, Alpha | Digit | Underscore | Dollar);
 	}
+	bool isHexDigit(char c) const { return LexerTables::isHexDigit(c); }
 	bool isOctalDigit(char c) const { return c >= '0' && c <= '7'; }
 
 	// --- Lexing Helper Functions ---
@@ -498,14 +377,14 @@ class Lexer
 		pos++;
 		while (pos < code.length() && isJavaIdentifierPart(code[pos]))
 			pos++;
-		std::string word = code.substr(start, pos - start);
+		std::string_view word = std::string_view(code).substr(start, pos - start);
 		if (word.empty())
 			return {TokenType::Unknown, start, 0};
-		if (keywords.count(word))
+		if (keywords.contains(word))
 			return {TokenType::Keyword, start, pos - start};
-		if (primitiveTypes.count(word))
+		if (primitiveTypes.contains(word))
 			return {TokenType::PrimitiveType, start, pos - start};
-		if (literals.count(word))
+		if (literals.contains(word))
 			return {TokenType::Keyword, start, pos - start};
 		size_t nextNonWs = pos;
 		while (nextNonWs < code.length() && isWhitespace(code[nextNonWs]))
@@ -515,9 +394,7 @@ class Lexer
 		if (prevTokenIdx != -1)
 		{
 			const auto &t = tokens[prevTokenIdx];
-			std::string pW = "";
-			if (t.length > 0)
-				pW = code.substr(t.start, t.length);
+			std::string_view pW = std::string_view(code).substr(t.start, t.length);
 			if (t.type == TokenType::Keyword)
 			{
 				if (pW == "class" || pW == "interface" || pW == "enum" || pW == "record")
@@ -562,11 +439,10 @@ class Lexer
 		for (int len = 3; len >= 1; --len)
 			if (pos + len <= code.length())
 			{
-				std::string sub = code.substr(pos, len);
-				if (operators.count(sub))
+				if (operators.contains(std::string_view(code).substr(pos, len)))
 				{
 					pos += len;
-					return {operators.at(sub), start, (size_t)len};
+					return {TokenType::Operator, start, (size_t)len};
 				}
 			}
 		char c = code[pos];
@@ -599,39 +475,38 @@ class Lexer
 		}
 	}
 
-	ImVec4 getColorForTokenType(TokenType type) const
+	HighlightClass getClassForTokenType(TokenType type) const
 	{
-		updateThemeColors();
 		switch (type)
 		{
 		case TokenType::Keyword:
-			return cachedColors.keyword;
+			return HighlightClass::Keyword;
 		case TokenType::PrimitiveType:
-			return cachedColors.primitiveType;
+			return HighlightClass::Keyword;
 		case TokenType::ClassName:
-			return cachedColors.className;
+			return HighlightClass::Keyword;
 		case TokenType::String:
 		case TokenType::CharLiteral:
-			return cachedColors.string;
+			return HighlightClass::String;
 		case TokenType::Number:
-			return cachedColors.number;
+			return HighlightClass::Number;
 		case TokenType::Comment:
-			return cachedColors.comment;
+			return HighlightClass::Comment;
 		case TokenType::MethodName:
-			return cachedColors.methodName;
+			return HighlightClass::Function;
 		case TokenType::Annotation:
-			return cachedColors.annotation;
+			return HighlightClass::Keyword;
 		case TokenType::Operator:
-			return cachedColors.operatorColor;
+			return HighlightClass::Operator;
 		case TokenType::Parenthesis:
 		case TokenType::Bracket:
 		case TokenType::Brace:
 		case TokenType::Semicolon:
 		case TokenType::Comma:
 		case TokenType::Dot:
-			return cachedColors.text;
+			return HighlightClass::Text;
 		default:
-			return cachedColors.text;
+			return HighlightClass::Text;
 		}
 	}
 }; // End class Lexer
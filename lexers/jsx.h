@@ -1,15 +1,11 @@
 #include <iostream>
 #include <stack> // Useful for brace/tag matching
 #include <string>
-#include <unordered_map>
-#include <unordered_set>
+#include <string_view>
 #include <vector>
 
-#include "../util/settings.h"
-#include "imgui.h"
-
-class Settings;
-extern Settings gSettings;
+#include "../editor/editor_highlight_class.h"
+#include "lexer_tables.h"
 
 namespace JsxLexer {
 enum class TokenType {
@@ -56,47 +52,6 @@ enum class LexerState {
 class Lexer
 {
   public:
-	// --- ThemeColors struct remains the same ---
-	struct ThemeColors
-	{
-		ImVec4 keyword, string, number, comment, text, function, componentName, reactHook,
-			operatorColor, returnBlock;
-	};
-
-	Lexer()
-	{
-		// --- Keyword, ReactKeyword, Operator sets remain the same ---
-		keywords = {"function", "const",   "let",	 "var",		  "if",
-					"else",		"return",  "import", "export",	  "default",
-					"class",	"extends", "super",	 "this",	  "new",
-					"try",		"catch",   "throw",	 "typeof",	  "instanceof",
-					"async",	"await",   "for",	 "of",		  "while",
-					"do",		"switch",  "case",	 "break",	  "continue",
-					"static",	"true",	   "false",	 "null",	  "undefined",
-					"void",		"delete",  "yield",	 "interface", "type",
-					"as",		"from",	   "in",	 "is"};
-		reactKeywords = {"useState",
-						 "useEffect",
-						 "useContext",
-						 "useReducer",
-						 "useCallback",
-						 "useMemo",
-						 "useRef",
-						 "useLayoutEffect",
-						 "useImperativeHandle",
-						 "Fragment",
-						 "createContext",
-						 "createRef",
-						 "forwardRef"};
-		operators = {"=",	"+",   "-",	 "*",  "/",	 "%",  "==", "===", "!=",
-					 "!==", ">",   "<",	 ">=", "<=", "&&", "||", "!",	"?",
-					 "=>",	"...", "++", "--", "+=", "-=", "*=", "/=",	"%=",
-					 "??",	"&",   "|",	 "^",  "~",	 "<<", ">>", ";"};
-		colorsNeedUpdate = true;
-	}
-
-	void themeChanged() { colorsNeedUpdate = true; }
-
 	// ========================================================================
 	// TOKENIZE - Rewritten Logic
 	// ========================================================================
@@ -158,7 +113,8 @@ class Lexer
 
 					// Check for 'return' followed by potential JSX starter
 					if (currentToken.type == TokenType::Keyword &&
-						code.substr(currentToken.start, currentToken.length) == "return")
+						std::string_view(code).substr(currentToken.start,
+													  currentToken.length) == "return")
 					{
 						size_t nextCharPos = pos; // Position after the 'return' token
 						// Skip whitespace
@@ -291,14 +247,15 @@ class Lexer
 	}
 
 	// --- applyHighlighting (unchanged, uses tokenize) ---
-	void
-	applyHighlighting(const std::string &code, std::vector<ImVec4> &colors, int start_pos)
+	void applyHighlighting(const std::string &code,
+						   std::vector<HighlightClass> &colors,
+						   int start_pos)
 	{ /* ... unchanged ... */
 		if (colors.size() < code.length())
 		{
 			try
 			{
-				colors.resize(code.length(), getColorForTokenType(TokenType::Unknown));
+				colors.resize(code.length(), getClassForTokenType(TokenType::Unknown));
 			} catch (...)
 			{ /* error handling */
 				return;
@@ -307,7 +264,7 @@ class Lexer
 		{
 			std::fill(colors.begin(),
 					  colors.begin() + code.length(),
-					  getColorForTokenType(TokenType::Unknown));
+					  getClassForTokenType(TokenType::Unknown));
 		}
 		try
 		{
@@ -316,7 +273,7 @@ class Lexer
 			{
 				if (token.start >= code.size() || token.start + token.length > code.size())
 					continue;
-				ImVec4 color = getColorForTokenType(token.type);
+				HighlightClass color = getClassForTokenType(token.type);
 				for (size_t i = token.start; i < token.start + token.length; ++i)
 				{
 					if (i < colors.size())
@@ -329,67 +286,32 @@ class Lexer
 		{ /* error handling */
 		}
 	}
-	// --- forceColorUpdate (unchanged) ---
-	void forceColorUpdate() { colorsNeedUpdate = true; }
 
   private:
-	std::unordered_set<std::string> keywords;
-	std::unordered_set<std::string> reactKeywords;
-	std::unordered_set<std::string> operators;
-	mutable ThemeColors cachedColors;
-	mutable bool colorsNeedUpdate = true;
-
-	// --- updateThemeColors (unchanged) ---
-	void updateThemeColors() const
-	{ /* ... unchanged ... */
-		if (!colorsNeedUpdate)
-			return;
-		auto &theme = gSettings.getSettings()["themes"][gSettings.getCurrentTheme()];
-		auto loadColor = [&theme](const char *key,
-								  ImVec4 defaultColor = {1, 1, 1, 1}) -> ImVec4 {
-			try
-			{
-				if (theme.contains(key) && theme[key].is_array() && theme[key].size() >= 4)
-				{
-					return ImVec4(theme[key][0].get<float>(),
-								  theme[key][1].get<float>(),
-								  theme[key][2].get<float>(),
-								  theme[key][3].get<float>());
-				}
-			} catch (...)
-			{
-			}
-			return defaultColor;
-		};
-		cachedColors.keyword = loadColor("keyword");
-		cachedColors.string = loadColor("string");
-		cachedColors.number = loadColor("number");
-		cachedColors.comment = loadColor("comment");
-		cachedColors.text = loadColor("text");
-		cachedColors.function = loadColor("function");
-		cachedColors.componentName = loadColor("className", cachedColors.text);
-		cachedColors.reactHook = loadColor("reactHook", cachedColors.function);
-		cachedColors.operatorColor = loadColor("operator",
-											   ImVec4(cachedColors.text.x * 0.8f,
-													  cachedColors.text.y * 0.8f,
-													  cachedColors.text.z * 0.8f,
-													  cachedColors.text.w));
-		cachedColors.returnBlock = ImVec4(1.0f, 0.7f, 0.75f, 1.0f);
-		colorsNeedUpdate = false;
-	}
+	// Looked up with views into the code, so no token is copied
+	static constexpr auto keywords = LexerTables::makeKeywordSet({
+		"function", "const", "let", "var", "if", "else", "return", "import", "export",
+		"default", "class", "extends", "super", "this", "new", "try", "catch", "throw",
+		"typeof", "instanceof", "async", "await", "for", "of", "while", "do", "switch",
+		"case", "break", "continue", "static", "true", "false", "null", "undefined",
+		"void", "delete", "yield", "interface", "type", "as", "from", "in", "is"});
+	static constexpr auto reactKeywords = LexerTables::makeKeywordSet({
+		"useState", "useEffect", "useContext", "useReducer", "useCallback", "useMemo",
+		"useRef", "useLayoutEffect", "useImperativeHandle", "Fragment", "createContext",
+		"createRef", "forwardRef"});
+	static constexpr auto operators = LexerTables::makeKeywordSet({
+		"=", "+", "-", "*", "/", "%", "==", "===", "!=", "!==", ">", "<", ">=", "<=",
+		"&&", "||", "!", "?", "=>", "...", "++", "--", "+=", "-=", "*=", "/=", "%=",
+		"??", "&", "|", "^", "~", "<<", ">>", ";"});
+
 	// --- Character Checks (unchanged) ---
-	bool isWhitespace(char c) const
-	{
-		return c == ' ' || c == '\t' || c == '\n' || c == '\r';
-	}
-	bool isAlpha(char c) const
-	{
-		return (c >= 'a' && c <= 'z') || (c >= 'A' && c <= 'Z');
-	}
-	bool isDigit(char c) const { return c >= '0' && c <= '9'; }
+	bool isWhitespace(char c) const { return LexerTables::isSpace(c); }
+	bool isAlpha(char c) const { return LexerTables::isAlpha(c); }
+	bool isDigit(char c) const { return LexerTables::isDigit(c); }
 	bool isAlphaNumeric(char c) const
 	{
-		return isAlpha(c) || isDigit(c) || c == '_' || c == '$';
+		using namespace LexerTables;
+		return hasClass(c, Alpha | Digit | Underscore | Dollar);
 	}
 
 	// --- Basic Lexing Helpers (unchanged) ---
@@ -421,10 +343,10 @@ class Lexer
 		size_t start = pos;
 		while (pos < code.length() && isAlphaNumeric(code[pos]))
 			pos++;
-		std::string word = code.substr(start, pos - start);
-		if (keywords.count(word))
+		std::string_view word = std::string_view(code).substr(start, pos - start);
+		if (keywords.contains(word))
 			return {TokenType::Keyword, start, pos - start};
-		if (reactKeywords.count(word))
+		if (reactKeywords.contains(word))
 			return {TokenType::ReactHook, start, pos - start};
 		size_t nextCharPos = pos;
 		while (nextCharPos < code.length() && isWhitespace(code[nextCharPos]))
@@ -450,7 +372,8 @@ class Lexer
 		while (pos < code.length() && (isAlphaNumeric(code[pos]) || code[pos] == '.'))
 		{
 			if (code[pos] == '.' &&
-				code.substr(start, pos - start).find('.') != std::string::npos)
+				std::string_view(code).substr(start, pos - start).find('.') !=
+					std::string_view::npos)
 				break;
 			if (!isDigit(code[pos]) && code[pos] != '.' &&
 				!((code[pos] >= 'a' && code[pos] <= 'f') ||
@@ -496,11 +419,11 @@ class Lexer
 	{ /* ... unchanged ... */
 		size_t start = pos;
 		size_t maxLength = 3;
-		std::string longestMatch;
+		std::string_view longestMatch;
 		for (size_t len = 1; len <= maxLength && start + len <= code.length(); ++len)
 		{
-			std::string sub = code.substr(start, len);
-			if (operators.count(sub))
+			std::string_view sub = std::string_view(code).substr(start, len);
+			if (operators.contains(sub))
 				longestMatch = sub;
 		}
 		if (!longestMatch.empty())
@@ -544,8 +467,7 @@ class Lexer
 			pos++;
 			return {TokenType::Dot, start, 1};
 		}
-		std::string singleCharStr(1, c);
-		if (operators.count(singleCharStr))
+		if (operators.contains(std::string_view(&code[pos], 1)))
 		{
 			pos++;
 			return {TokenType::Operator, start, 1};
@@ -938,26 +860,25 @@ class Lexer
 		}
 	}
 
-	ImVec4 getColorForTokenType(TokenType type) const
+	HighlightClass getClassForTokenType(TokenType type) const
 	{
-		updateThemeColors();
 		switch (type)
 		{
 		case TokenType::Keyword:
-			return cachedColors.keyword;
+			return HighlightClass::Keyword;
 		case TokenType::ReactHook:
-			return cachedColors.reactHook;
+			return HighlightClass::Function;
 		case TokenType::String:
 		case TokenType::TemplateString:
-			return cachedColors.string;
+			return HighlightClass::String;
 		case TokenType::Number:
-			return cachedColors.number;
+			return HighlightClass::Number;
 		case TokenType::Comment:
-			return cachedColors.comment;
+			return HighlightClass::Comment;
 		case TokenType::Function:
-			return cachedColors.function;
+			return HighlightClass::Function;
 		case TokenType::ComponentName:
-			return cachedColors.componentName;
+			return HighlightClass::Text;
 		case TokenType::Operator:
 		case TokenType::ArrowFunction:
 		case TokenType::Parenthesis:
@@ -965,18 +886,18 @@ class Lexer
 		case TokenType::Colon:
 		case TokenType::Comma:
 		case TokenType::Dot:
-			return cachedColors.operatorColor;
+			return HighlightClass::DimmedText;
 		case TokenType::Brace:
 		case TokenType::TemplateExprStart:
 		case TokenType::TemplateExprEnd:
-			return cachedColors.operatorColor;
+			return HighlightClass::DimmedText;
 		case TokenType::RETURN_BLOCK_CONTENT:
-			return cachedColors.returnBlock;
+			return HighlightClass::ReturnBlock;
 		case TokenType::Identifier:
 		case TokenType::Whitespace:
 		case TokenType::Unknown:
 		default:
-			return cachedColors.text;
+			return HighlightClass::Text;
 		}
 	}
 };
@@ -0,0 +1,215 @@
+/*
+	File: lexer_tables.h
+	Description: Compile-time tables shared by the lexers: a character class
+	per byte, and perfect hash sets for keyword lookups.
+
+	KeywordSet places its words with hash and displace while compiling. The
+	words are grouped into buckets by one hash. Starting with the largest
+	bucket, each bucket gets the first seed that sends all its words to free
+	slots. A lookup then hashes the word twice and compares it with the one
+	word in its slot. No strings are built and nothing is allocated.
+*/
+
+#pragma once
+#include <algorithm>
+#include <array>
+#include <bit>
+#include <cstddef>
+#include <cstdint>
+#include <stdexcept>
+#include <string_view>
+#include <utility>
+
+namespace LexerTables {
+
+enum CharClass : uint8_t
+{
+	Space = 1 << 0,
+	Alpha = 1 << 1,
+	Digit = 1 << 2,
+	HexDigit = 1 << 3,
+	Underscore = 1 << 4,
+	Dollar = 1 << 5,
+};
+
+inline constexpr std::array<uint8_t, 256> charClasses = []() {
+	std::array<uint8_t, 256> classes{};
+	for (unsigned char c : std::string_view(" \t\n\r\f\v"))
+	{
+		classes[c] |= Space;
+	}
+	for (int c = 'a'; c <= 'z'; ++c)
+	{
+		classes[c] |= Alpha;
+		classes[c - 'a' + 'A'] |= Alpha;
+	}
+	for (int c = '0'; c <= '9'; ++c)
+	{
+		classes[c] |= Digit | HexDigit;
+	}
+	for (int c = 'a'; c <= 'f'; ++c)
+	{
+		classes[c] |= HexDigit;
+		classes[c - 'a' + 'A'] |= HexDigit;
+	}
+	classes['_'] |= Underscore;
+	classes['$'] |= Dollar;
+	return classes;
+}();
+
+constexpr bool hasClass(char c, uint8_t mask)
+{
+	return (charClasses[static_cast<unsigned char>(c)] & mask) != 0;
+}
+constexpr bool isSpace(char c) { return hasClass(c, Space); }
+constexpr bool isAlpha(char c) { return hasClass(c, Alpha); }
+constexpr bool isDigit(char c) { return hasClass(c, Digit); }
+constexpr bool isHexDigit(char c) { return hasClass(c, HexDigit); }
+constexpr bool isAlphaNumeric(char c) { return hasClass(c, Alpha | Digit); }
+constexpr bool isIdentStart(char c) { return hasClass(c, Alpha | Underscore); }
+constexpr bool isIdentPart(char c) { return hasClass(c, Alpha | Digit | Underscore); }
+
+constexpr uint32_t hashWord(std::string_view word, uint32_t seed)
+{
+	// FNV-1a with the seed folded into the offset basis
+	uint32_t hash = 2166136261u ^ (seed * 0x9E3779B9u);
+	for (char c : word)
+	{
+		hash ^= static_cast<unsigned char>(c);
+		hash *= 16777619u;
+	}
+	return hash ^ (hash >> 15);
+}
+
+template <size_t N> class KeywordSet
+{
+  public:
+	constexpr explicit KeywordSet(const std::string_view (&list)[N])
+	{
+		// Words in bucket order, duplicates dropped
+		std::array<std::string_view, N> sorted{};
+		std::array<size_t, BUCKETS + 1> bucket_start{};
+		size_t count = 0;
+		for (size_t i = 0; i < N; ++i)
+		{
+			bool duplicate = false;
+			for (size_t j = 0; j < i; ++j)
+			{
+				duplicate = duplicate || list[j] == list[i];
+			}
+			if (!duplicate)
+			{
+				++bucket_start[bucketOf(list[i]) + 1];
+				sorted[count++] = list[i];
+				size_t length = list[i].size();
+				min_length = count == 1 ? length : std::min(min_length, length);
+				max_length = std::max(max_length, length);
+			}
+		}
+		for (size_t b = 0; b < BUCKETS; ++b)
+		{
+			bucket_start[b + 1] += bucket_start[b];
+		}
+		std::array<size_t, BUCKETS> filled{};
+		for (size_t i = 0; i < count; ++i)
+		{
+			size_t b = bucketOf(sorted[i]);
+			words[bucket_start[b] + filled[b]++] = sorted[i];
+		}
+
+		// Largest buckets are the hardest to place, so they go first
+		std::array<size_t, BUCKETS> order{};
+		for (size_t b = 0; b < BUCKETS; ++b)
+		{
+			order[b] = b;
+		}
+		auto size_of = [&](size_t b) { return bucket_start[b + 1] - bucket_start[b]; };
+		for (size_t i = 1; i < BUCKETS; ++i)
+		{
+			for (size_t j = i; j > 0 && size_of(order[j]) > size_of(order[j - 1]); --j)
+			{
+				std::swap(order[j], order[j - 1]);
+			}
+		}
+
+		std::array<bool, SLOTS> used{};
+		for (size_t b : order)
+		{
+			size_t first = bucket_start[b];
+			size_t last = bucket_start[b + 1];
+			if (first == last)
+			{
+				break;
+			}
+			for (uint32_t seed = 1;; ++seed)
+			{
+				if (seed > MAX_SEED)
+				{
+					throw std::logic_error("KeywordSet: no perfect hash found");
+				}
+				std::array<size_t, N> slot_of{};
+				bool fits = true;
+				for (size_t i = first; i < last && fits; ++i)
+				{
+					size_t slot = hashWord(words[i], seed) & (SLOTS - 1);
+					fits = !used[slot];
+					for (size_t j = first; j < i && fits; ++j)
+					{
+						fits = slot_of[j] != slot;
+					}
+					slot_of[i] = slot;
+				}
+				if (fits)
+				{
+					for (size_t i = first; i < last; ++i)
+					{
+						used[slot_of[i]] = true;
+						slots[slot_of[i]] = static_cast<uint16_t>(i + 1);
+					}
+					seeds[b] = seed;
+					break;
+				}
+			}
+		}
+	}
+
+	constexpr bool contains(std::string_view word) const
+	{
+		if (word.size() < min_length || word.size() > max_length)
+		{
+			return false;
+		}
+		uint32_t seed = seeds[bucketOf(word)];
+		if (seed == 0)
+		{
+			return false;
+		}
+		uint16_t slot = slots[hashWord(word, seed) & (SLOTS - 1)];
+		return slot != 0 && words[slot - 1] == word;
+	}
+
+  private:
+	static constexpr size_t BUCKETS = N / 2 + 1;
+	static constexpr size_t SLOTS = std::bit_ceil(N * 2);
+	static constexpr uint32_t MAX_SEED = 1u << 16;
+
+	static constexpr size_t bucketOf(std::string_view word)
+	{
+		return hashWord(word, 0) % BUCKETS;
+	}
+
+	std::array<uint32_t, BUCKETS> seeds{}; // 0 for empty buckets
+	std::array<std::string_view, N> words{}; // in bucket order
+	std::array<uint16_t, SLOTS> slots{};	 // 1 + index into words, 0 if free
+	size_t min_length = 0;
+	size_t max_length = 0;
+};
+
+// makeKeywordSet({"if", "else"}), with the size deduced from the list
+template <size_t N>
+constexpr KeywordSet<N> makeKeywordSet(const std::string_view (&words)[N])
+{
+	return KeywordSet<N>(words);
+}
+
+} // namespace LexerTables
@@ -2,15 +2,11 @@
 
 #include <iostream>
 #include <string>
-#include <unordered_map>
-#include <unordered_set>
+#include <string_view>
 #include <vector>
 
-#include "../util/settings.h"
-#include "imgui.h"
-
-class Settings;
-extern Settings gSettings;
+#include "../editor/editor_highlight_class.h"
+#include "lexer_tables.h"
 
 namespace PythonLexer {
 enum class TokenType {
@@ -48,63 +44,6 @@ struct Token
 class Lexer
 {
   public:
-	// Theme colors cache
-	struct ThemeColors
-	{
-		ImVec4 keyword;
-		ImVec4 string;
-		ImVec4 number;
-		ImVec4 comment;
-		ImVec4 text;
-		ImVec4 function; // Add this
-	};
-
-	Lexer()
-	{
-		keywords = {"and",	"as",		"assert", "break",	"class", "continue", "def",
-					"del",	"elif",		"else",	  "except", "False", "finally",	 "for",
-					"from", "global",	"if",	  "import", "in",	 "is",		 "lambda",
-					"None", "nonlocal", "not",	  "or",		"pass",	 "raise",	 "return",
-					"True", "try",		"while",  "with",	"yield"};
-
-		// Add built-in types
-		builtinTypes = {"int",
-						"str",
-						"float",
-						"bool",
-						"list",
-						"dict",
-						"set",
-						"tuple",
-						"bytes",
-						"object",
-						"BaseException",
-						"Exception"};
-
-		operators = {{"+", TokenType::Operator},
-					 {"-", TokenType::Operator},
-					 {"*", TokenType::Operator},
-					 {"/", TokenType::Operator},
-					 {"//", TokenType::Operator},
-					 {"%", TokenType::Operator},
-					 {"**", TokenType::Operator},
-					 {"=", TokenType::Operator},
-					 {"==", TokenType::Operator},
-					 {"!=", TokenType::Operator},
-					 {">", TokenType::Operator},
-					 {"<", TokenType::Operator},
-					 {">=", TokenType::Operator},
-					 {"<=", TokenType::Operator},
-					 {"and", TokenType::Operator},
-					 {"or", TokenType::Operator},
-					 {"not", TokenType::Operator},
-					 {"in", TokenType::Operator},
-					 {"is", TokenType::Operator}};
-		colorsNeedUpdate = true;
-	}
-
-	void themeChanged() { colorsNeedUpdate = true; }
-
 	std::vector<Token> tokenize(const std::string &code)
 	{
 		std::vector<Token> tokens;
@@ -164,8 +103,9 @@ class Lexer
 		return tokens;
 	}
 
-	void
-	applyHighlighting(const std::string &code, std::vector<ImVec4> &colors, int start_pos)
+	void applyHighlighting(const std::string &code,
+						   std::vector<HighlightClass> &colors,
+						   int start_pos)
 	{
 		try
 		{
@@ -173,7 +113,7 @@ class Lexer
 
 			for (const auto &token : tokens)
 			{
-				ImVec4 color = getColorForTokenType(token.type);
+				HighlightClass color = getClassForTokenType(token.type);
 				for (size_t i = 0; i < token.length; ++i)
 				{
 					size_t index = start_pos + token.start + i;
@@ -188,54 +128,32 @@ class Lexer
 			std::cerr << "🔴 Exception in applyHighlighting: " << e.what() << std::endl;
 		}
 	}
-	void forceColorUpdate() { colorsNeedUpdate = true; }
 
   private:
-	std::unordered_set<std::string> keywords;
-	std::unordered_set<std::string> builtinTypes; // Add this
-	std::unordered_map<std::string, TokenType> operators;
-	mutable ThemeColors cachedColors;
-	mutable bool colorsNeedUpdate = true;
-
-	void updateThemeColors() const
-	{
-		if (!colorsNeedUpdate)
-			return;
-
-		auto &theme = gSettings.getSettings()["themes"][gSettings.getCurrentTheme()];
-
-		auto loadColor = [&theme](const char *key) -> ImVec4 {
-			auto &c = theme[key];
-			return ImVec4(c[0], c[1], c[2], c[3]);
-		};
-
-		cachedColors.keyword = loadColor("keyword");
-		cachedColors.string = loadColor("string");
-		cachedColors.number = loadColor("number");
-		cachedColors.comment = loadColor("comment");
-		cachedColors.text = loadColor("text");
-		cachedColors.function = loadColor("function"); // Add this
-
-		colorsNeedUpdate = false;
-	}
-
-	bool isWhitespace(char c) const
-	{
-		return c == ' ' || c == '\t' || c == '\n' || c == '\r';
-	}
-	bool isAlpha(char c) const
-	{
-		return (c >= 'a' && c <= 'z') || (c >= 'A' && c <= 'Z');
-	}
-	bool isDigit(char c) const { return c >= '0' && c <= '9'; }
-	bool isAlphaNumeric(char c) const { return isAlpha(c) || isDigit(c) || c == '_'; }
+	// Looked up with views into the code, so no token is copied
+	static constexpr auto keywords = LexerTables::makeKeywordSet({
+		"and", "as", "assert", "break", "class", "continue", "def", "del", "elif",
+		"else", "except", "False", "finally", "for", "from", "global", "if", "import",
+		"in", "is", "lambda", "None", "nonlocal", "not", "or", "pass", "raise",
+		"return", "True", "try", "while", "with", "yield"});
+	static constexpr auto builtinTypes = LexerTables::makeKeywordSet({
+		"int", "str", "float", "bool", "list", "dict", "set", "tuple", "bytes",
+		"object", "BaseException", "Exception"});
+	static constexpr auto operators = LexerTables::makeKeywordSet({
+		"+", "-", "*", "/", "//", "%", "**", "=", "==", "!=", ">", "<", ">=", "<=",
+		"and", "or", "not", "in", "is"});
+
+	bool isWhitespace(char c) const { return LexerTables::isSpace(c); }
+	bool isAlpha(char c) const { return LexerTables::isAlpha(c); }
+	bool isDigit(char c) const { return LexerTables::isDigit(c); }
+	bool isAlphaNumeric(char c) const { return LexerTables::isIdentPart(c); }
 
 	Token lexIdentifierOrKeyword(const std::string &code, size_t &pos)
 	{
 		size_t start = pos;
 		while (pos < code.length() && isAlphaNumeric(code[pos]))
 			pos++;
-		std::string word = code.substr(start, pos - start);
+		std::string_view word = std::string_view(code).substr(start, pos - start);
 
 		// Look ahead for function detection
 		size_t next = pos;
@@ -250,7 +168,7 @@ class Lexer
 		}
 
 		// Check priority in this order
-		if (keywords.find(word) != keywords.end())
+		if (keywords.contains(word))
 		{
 			if (word == "class")
 			{
@@ -259,7 +177,7 @@ class Lexer
 			return {TokenType::Keyword, start, pos - start};
 		}
 
-		if (builtinTypes.find(word) != builtinTypes.end())
+		if (builtinTypes.contains(word))
 		{
 			return {TokenType::BuiltinType, start, pos - start};
 		}
@@ -324,65 +242,60 @@ class Lexer
 		if (code[pos] == '.')
 			return {TokenType::Dot, start, 1};
 
-		std::string op;
+		std::string_view op;
 		while (pos < code.length() && !isAlphaNumeric(code[pos]) &&
 			   !isWhitespace(code[pos]))
 		{
-			op += code[pos++];
-			if (operators.find(op) != operators.end())
+			op = std::string_view(code).substr(start, ++pos - start);
+			if (operators.contains(op))
 				break;
 		}
 
 		if (op.empty())
 		{
-			op = code[pos++];
+			op = std::string_view(code).substr(start, ++pos - start);
 		}
 
-		return {operators.find(op) != operators.end() ? TokenType::Operator
-													  : TokenType::Unknown,
+		return {operators.contains(op) ? TokenType::Operator : TokenType::Unknown,
 				start,
 				op.length()};
 	}
 
-	ImVec4 getColorForTokenType(TokenType type) const
+	HighlightClass getClassForTokenType(TokenType type) const
 	{
-		updateThemeColors();
 
 		switch (type)
 		{
 		case TokenType::Keyword:
 		case TokenType::BuiltinType:
-			return cachedColors.keyword;
+			return HighlightClass::Keyword;
 
 		case TokenType::String:
-			return cachedColors.string;
+			return HighlightClass::String;
 
 		case TokenType::Number:
-			return cachedColors.number;
+			return HighlightClass::Number;
 
 		case TokenType::Comment:
-			return cachedColors.comment;
+			return HighlightClass::Comment;
 
 		case TokenType::Function:
-			return cachedColors.function;
+			return HighlightClass::Function;
 
 		case TokenType::ClassName:
-			return cachedColors.keyword;
+			return HighlightClass::Keyword;
 
 		case TokenType::Decorator:
-			return cachedColors.function; // Use function color for decorators
+			return HighlightClass::Function; // Use function color for decorators
 
 		case TokenType::ScopeOperator:
-			return cachedColors.function; // Use function color for .
+			return HighlightClass::Function; // Use function color for .
 
 		case TokenType::Operator:
-			return ImVec4(cachedColors.text.x * 0.8f,
-						  cachedColors.text.y * 0.8f,
-						  cachedColors.text.z * 0.8f,
-						  cachedColors.text.w);
+			return HighlightClass::DimmedText;
 
 		default:
-			return cachedColors.text;
+			return HighlightClass::Text;
 		}
 	}
 };
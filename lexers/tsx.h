@@ -3,21 +3,11 @@
 #include <iostream>
 #include <stack> // Needed for JSX tag balancing (optional but good) and state management
 #include <string>
-#include <unordered_map>
-#include <unordered_set>
+#include <string_view>
 #include <vector>
 
-#include "../util/settings.h" // Ensure this path is correct for your project
-
-#include "imgui.h" // Ensure this path is correct for your project
-
-// Forward declare Settings to avoid circular dependency if needed,
-// but ensure gSettings definition is available at link time.
-class Settings;
-extern Settings gSettings;
-
-// Forward declare json if needed (likely included via settings.h)
-#include <lib/json.hpp> // Assuming settings.h includes this, otherwise add it here
+#include "../editor/editor_highlight_class.h"
+#include "lexer_tables.h"
 
 namespace TsxLexer {
 
@@ -72,200 +62,7 @@ enum class LexerState {
 class Lexer
 {
   public:
-	// Theme colors cache
-	struct ThemeColors
-	{
-		ImVec4 keyword;
-		ImVec4 type; // Added for TS types
-		ImVec4 string;
-		ImVec4 number;
-		ImVec4 comment;
-		ImVec4 text;
-		ImVec4 function;
-		ImVec4 className; // Often same as type or keyword
-		ImVec4 decorator;
-		ImVec4 jsxTag;
-		ImVec4 jsxAttribute;
-		ImVec4 jsxText;		  // Often same as default text
-		ImVec4 operatorColor; // Using a separate name to avoid conflict
-		ImVec4 templateLiteral;
-		ImVec4 regexLiteral;
-	};
-
-	Lexer()
-	{
-		// Combined TypeScript & JavaScript Keywords
-		keywords = {"abstract",
-					"as",
-					"async",
-					"await",
-					"break",
-					"case",
-					"catch",
-					"class",
-					"const",
-					"continue",
-					"debugger",
-					"default",
-					"delete",
-					"do",
-					"else",
-					"enum",
-					"export",
-					"extends",
-					"false",
-					"finally",
-					"for",
-					"from",
-					"function",
-					"if",
-					"implements",
-					"import",
-					"in",
-					"instanceof",
-					"interface",
-					"let",
-					"new",
-					"null",
-					"package", // reserved
-					"private",
-					"protected",
-					"public",
-					"return",
-					"static",
-					"super",
-					"switch",
-					"this",
-					"throw",
-					"true",
-					"try",
-					"typeof",
-					"var",
-					"void",
-					"while",
-					"with", // reserved in strict mode
-					"yield",
-					// TS Specific
-					"any",
-					"boolean",
-					"constructor",
-					"declare",
-					"get",
-					"module", // legacy
-					"namespace",
-					"never",
-					"readonly",
-					"require", // legacy
-					"number",
-					"set",
-					"string",
-					"symbol",
-					"type",
-					"undefined", // Also a value
-					"unique",
-					"unknown",
-					"accessor",
-					"asserts",
-					"infer",
-					"is",
-					"keyof",
-					"out",
-					"override",
-					// Common Contextual Keywords (often highlighted)
-					"useState",
-					"useEffect",
-					"useContext",
-					"useReducer",
-					"useCallback",
-					"useMemo",
-					"useRef",
-					"useImperativeHandle",
-					"useLayoutEffect",
-					"useDebugValue"};
-
-		// Basic built-in types (others identified contextually)
-		builtinTypes = {"any",
-						"boolean",
-						"number",
-						"string",
-						"symbol",
-						"void",
-						"null",		 // Also a value
-						"undefined", // Also a keyword/value
-						"never",
-						"object",
-						"unknown",
-						"bigint",
-						// Common DOM/React types (add more as needed)
-						"ReactElement",
-						"JSX.Element",
-						"ReactNode",
-						"ChangeEvent",
-						"MouseEvent",
-						"KeyboardEvent",
-						"CSSProperties",
-						"HTMLElement",
-						"HTMLDivElement", // etc.
-						"Promise",
-						"Array",
-						"Map",
-						"Set",
-						"Date"};
-
-		// Operators (including TS specific ones)
-		operators = {
-			// Length 3
-			{"===", TokenType::Operator},
-			{"!==", TokenType::Operator},
-			{"**=", TokenType::Operator},
-			// Length 2
-			{"==", TokenType::Operator},
-			{"!=", TokenType::Operator},
-			{">=", TokenType::Operator},
-			{"<=", TokenType::Operator},
-			{"&&", TokenType::Operator},
-			{"||", TokenType::Operator},
-			{"??", TokenType::Operator},
-			{"?.", TokenType::OptionalChain},
-			{"=>", TokenType::Operator},
-			{"++", TokenType::Operator},
-			{"--", TokenType::Operator},
-			{"+=", TokenType::Operator},
-			{"-=", TokenType::Operator},
-			{"*=", TokenType::Operator},
-			{"/=", TokenType::Operator},
-			{"%=", TokenType::Operator},
-			{"&=", TokenType::Operator},
-			{"|=", TokenType::Operator},
-			{"^=", TokenType::Operator},
-			{"<<=", TokenType::Operator},
-			{">>=", TokenType::Operator}, // Add missing shift assignments
-			{"<<", TokenType::Operator},
-			{">>", TokenType::Operator}, // {">>>", TokenType::Operator} // Add
-										 // >>> if needed
-			{"**", TokenType::Operator},
-			// Length 1
-			{"+", TokenType::Operator},
-			{"-", TokenType::Operator},
-			{"*", TokenType::Operator},
-			{"/", TokenType::Operator},
-			{"%", TokenType::Operator},
-			{"=", TokenType::Operator},
-			{">", TokenType::Operator},
-			{"<", TokenType::Operator},
-			{"!", TokenType::Operator},
-			{"&", TokenType::Operator},
-			{"|", TokenType::Operator},
-			{"^", TokenType::Operator},
-			{"~", TokenType::Operator},
-			{"?", TokenType::Operator} // Ternary conditional
-		};
-
-		colorsNeedUpdate = true;
-		currentState = LexerState::Default;
-	}
-
-	void themeChanged() { colorsNeedUpdate = true; }
+	Lexer() { currentState = LexerState::Default; }
 
 	std::vector<Token> tokenize(const std::string &code)
 	{
@@ -392,8 +189,9 @@ class Lexer
 								// Contexts expecting JSX
 								if (prevToken.type == TokenType::Keyword)
 								{
-									std::string prevWord =
-										code.substr(prevToken.start, prevToken.length);
+									std::string_view prevWord =
+										std::string_view(code).substr(prevToken.start,
+																	  prevToken.length);
 									if (prevWord == "return" || prevWord == "yield" ||
 										prevWord == "case" || prevWord == "default" ||
 										prevWord == "throw" || prevWord == "export")
@@ -408,8 +206,9 @@ class Lexer
 									isJsxContext = true;
 								else if (prevToken.type == TokenType::Operator)
 								{
-									std::string opStr =
-										code.substr(prevToken.start, prevToken.length);
+									std::string_view opStr =
+										std::string_view(code).substr(prevToken.start,
+																	  prevToken.length);
 									if (opStr != "++" && opStr != "--")
 										isJsxContext = true;
 								}
@@ -694,8 +493,9 @@ class Lexer
 		return tokens;
 	}
 
-	void
-	applyHighlighting(const std::string &code, std::vector<ImVec4> &colors, int start_pos)
+	void applyHighlighting(const std::string &code,
+						   std::vector<HighlightClass> &colors,
+						   int start_pos)
 	{
 		// std::cout << "Entering TSX applyHighlighting, code length: " <<
 		// code.length() << ", colors size: " << colors.size() << ", start_pos:
@@ -717,7 +517,7 @@ class Lexer
 					continue; // Skip zero-length tokens from lexJsxText edge
 							  // case
 
-				ImVec4 color = getColorForTokenType(token.type);
+				HighlightClass color = getClassForTokenType(token.type);
 				size_t globalStart = start_pos + token.start;
 				size_t globalEnd = globalStart + token.length;
 
@@ -746,39 +546,139 @@ class Lexer
 		{
 			std::cerr << "🔴 Exception in TSX applyHighlighting: " << e.what()
 					  << std::endl;
-			if (!colorsNeedUpdate)
-			{ // <<< CORRECTED VARIABLE NAME
-				std::fill(colors.begin() + start_pos, colors.end(), cachedColors.text);
-			} else
-			{
-				std::fill(colors.begin() + start_pos,
-						  colors.end(),
-						  ImVec4(1.0f, 1.0f, 1.0f, 1.0f));
-			}
+			std::fill(colors.begin() + start_pos, colors.end(), HighlightClass::Text);
 		} catch (...)
 		{
 			std::cerr << "🔴 Unknown exception in TSX applyHighlighting" << std::endl;
-			if (!colorsNeedUpdate)
-			{ // <<< CORRECTED VARIABLE NAME
-				std::fill(colors.begin() + start_pos, colors.end(), cachedColors.text);
-			} else
-			{
-				std::fill(colors.begin() + start_pos,
-						  colors.end(),
-						  ImVec4(1.0f, 1.0f, 1.0f, 1.0f));
-			}
+			std::fill(colors.begin() + start_pos, colors.end(), HighlightClass::Text);
 		}
 	}
 
-	void forceColorUpdate() { colorsNeedUpdate = true; }
-
   private:
 	// --- Member Variables ---
-	std::unordered_set<std::string> keywords;
-	std::unordered_set<std::string> builtinTypes;
-	std::unordered_map<std::string, TokenType> operators;
-	mutable ThemeColors cachedColors;
-	mutable bool colorsNeedUpdate = true;
+	// Looked up with views into the code, so no token is copied
+	// Combined TypeScript & JavaScript Keywords
+	static constexpr auto keywords = LexerTables::makeKeywordSet({
+		"abstract",
+		"as",
+		"async",
+		"await",
+		"break",
+		"case",
+		"catch",
+		"class",
+		"const",
+		"continue",
+		"debugger",
+		"default",
+		"delete",
+		"do",
+		"else",
+		"enum",
+		"export",
+		"extends",
+		"false",
+		"finally",
+		"for",
+		"from",
+		"function",
+		"if",
+		"implements",
+		"import",
+		"in",
+		"instanceof",
+		"interface",
+		"let",
+		"new",
+		"null",
+		"package", // reserved
+		"private",
+		"protected",
+		"public",
+		"return",
+		"static",
+		"super",
+		"switch",
+		"this",
+		"throw",
+		"true",
+		"try",
+		"typeof",
+		"var",
+		"void",
+		"while",
+		"with", // reserved in strict mode
+		"yield",
+		// TS Specific
+		"any",
+		"boolean",
+		"constructor",
+		"declare",
+		"get",
+		"module", // legacy
+		"namespace",
+		"never",
+		"readonly",
+		"require", // legacy
+		"number",
+		"set",
+		"string",
+		"symbol",
+		"type",
+		"undefined", // Also a value
+		"unique",
+		"unknown",
+		"accessor",
+		"asserts",
+		"infer",
+		"is",
+		"keyof",
+		"out",
+		"override",
+		// Common Contextual Keywords (often highlighted)
+		"useState",
+		"useEffect",
+		"useContext",
+		"useReducer",
+		"useCallback",
+		"useMemo",
+		"useRef",
+		"useImperativeHandle",
+		"useLayoutEffect",
+		"useDebugValue"});
+	static constexpr auto builtinTypes = LexerTables::makeKeywordSet({
+		"any",
+		"boolean",
+		"number",
+		"string",
+		"symbol",
+		"void",
+		"null",		 // Also a value
+		"undefined", // Also a keyword/value
+		"never",
+		"object",
+		"unknown",
+		"bigint",
+		// Common DOM/React types (add more as needed)
+		"ReactElement",
+		"JSX.Element",
+		"ReactNode",
+		"ChangeEvent",
+		"MouseEvent",
+		"KeyboardEvent",
+		"CSSProperties",
+		"HTMLElement",
+		"HTMLDivElement", // etc.
+		"Promise",
+		"Array",
+		"Map",
+		"Set",
+		"Date"});
+	// Including TS specific ones; all but ?. are Operator tokens
+	static constexpr auto operators = LexerTables::makeKeywordSet({
+		"===", "!==", "**=", "==", "!=", ">=", "<=", "&&", "||", "??", "?.", "=>", "++",
+		"--", "+=", "-=", "*=", "/=", "%=", "&=", "|=", "^=", "<<=", ">>=", "<<", ">>",
+		"**", "+", "-", "*", "/", "%", "=", ">", "<", "!", "&", "|", "^", "~", "?"});
 	LexerState currentState;
 	std::stack<std::string> jsxTagStack; // Optional
 	std::stack<LexerState> stateStack;	 // <<< STATE STACK FOR JSX/TS CONTEXT
@@ -796,82 +696,12 @@ class Lexer
 		return -1;
 	}
 
-	void updateThemeColors() const
-	{
-		if (!colorsNeedUpdate)
-			return;
-		try
-		{
-			auto &theme = gSettings.getSettings()["themes"][gSettings.getCurrentTheme()];
-			auto loadColor = [&theme](const char *key,
-									  ImVec4 defaultColor =
-										  ImVec4(1.0f, 1.0f, 1.0f, 1.0f)) -> ImVec4 {
-				try
-				{
-					if (theme.contains(key))
-					{
-						auto &c = theme[key];
-						if (c.is_array() && c.size() == 4)
-						{
-							return ImVec4(c[0].get<float>(),
-										  c[1].get<float>(),
-										  c[2].get<float>(),
-										  c[3].get<float>());
-						}
-					}
-				} catch (const nlohmann::json::exception &e)
-				{
-					std::cerr << "Error loading theme color '" << key
-							  << "' (JSON error): " << e.what() << ". Using default."
-							  << std::endl;
-				} catch (const std::exception &e)
-				{
-					std::cerr << "Error loading theme color '" << key << "': " << e.what()
-							  << ". Using default." << std::endl;
-				}
-				return defaultColor;
-			};
-			cachedColors.text = loadColor("text");
-			cachedColors.keyword = loadColor("keyword", cachedColors.text);
-			cachedColors.type = loadColor("type", cachedColors.keyword);
-			cachedColors.string = loadColor("string", cachedColors.text);
-			cachedColors.number = loadColor("number", cachedColors.text);
-			cachedColors.comment = loadColor("comment", ImVec4(0.5f, 0.5f, 0.5f, 1.0f));
-			cachedColors.function = loadColor("function", cachedColors.text);
-			cachedColors.className = loadColor("class_name", cachedColors.type);
-			cachedColors.decorator = loadColor("decorator", cachedColors.function);
-			cachedColors.jsxTag = loadColor("jsx_tag", cachedColors.keyword);
-			cachedColors.jsxAttribute = loadColor("jsx_attribute", cachedColors.text);
-			cachedColors.jsxText = loadColor("jsx_text", cachedColors.text);
-			cachedColors.operatorColor = loadColor("operator", cachedColors.text);
-			cachedColors.templateLiteral =
-				loadColor("template_literal", cachedColors.string);
-			cachedColors.regexLiteral = loadColor("regex_literal", cachedColors.string);
-			colorsNeedUpdate = false;
-		} catch (const std::exception &e)
-		{
-			std::cerr << "🔴 Error updating theme colors: " << e.what() << std::endl;
-		}
-	}
-
 	// --- Basic Character Checks ---
-	bool isWhitespace(char c) const
-	{
-		return c == ' ' || c == '\t' || c == '\n' || c == '\r';
-	}
-	bool isAlpha(char c) const
-	{
-		return (c >= 'a' && c <= 'z') || (c >= 'A' && c <= 'Z');
-	}
-	bool isDigit(char c) const { return c >= '0' && c <= '9'; }
-	bool isAlphaNumeric(char c) const
-	{
-		return isAlpha(c) || isDigit(c) || c == '_';
-	} // Allow _
-	bool isHexDigit(char c) const
-	{
-		return isDigit(c) || (c >= 'a' && c <= 'f') || (c >= 'A' && c <= 'F');
-	}
+	bool isWhitespace(char c) const { return LexerTables::isSpace(c); }
+	bool isAlpha(char c) const { return LexerTables::isAlpha(c); }
+	bool isDigit(char c) const { return LexerTables::isDigit(c); }
+	bool isAlphaNumeric(char c) const { return LexerTables::isIdentPart(c); } // Allow _
+	bool isHexDigit(char c) const { return LexerTables::isHexDigit(c); }
 	bool isOctalDigit(char c) const { return c >= '0' && c <= '7'; }
 
 	// --- Lexing Helper Functions ---
@@ -1100,8 +930,8 @@ class Lexer
 			(prevToken.type == TokenType::Bracket && prevChar == ']') ||
 			(prevToken.type == TokenType::Brace && prevChar == '}') ||
 			(prevToken.type == TokenType::Operator &&
-			 (code.substr(prevToken.start, prevToken.length) == "++" ||
-			  code.substr(prevToken.start, prevToken.length) == "--")))
+			 (code.compare(prevToken.start, prevToken.length, "++") == 0 ||
+			  code.compare(prevToken.start, prevToken.length, "--") == 0)))
 		{
 			return false;
 		}
@@ -1109,7 +939,8 @@ class Lexer
 		// Contexts likely REGEX
 		if (prevToken.type == TokenType::Keyword)
 		{
-			std::string kw = code.substr(prevToken.start, prevToken.length);
+			std::string_view kw =
+				std::string_view(code).substr(prevToken.start, prevToken.length);
 			if (kw == "return" || kw == "yield" || kw == "case" || kw == "throw" ||
 				kw == "new" || kw == "await" || kw == "delete" || kw == "typeof" ||
 				kw == "void")
@@ -1126,7 +957,8 @@ class Lexer
 		}
 		if (prevToken.type == TokenType::Operator)
 		{
-			std::string opStr = code.substr(prevToken.start, prevToken.length);
+			std::string_view opStr =
+				std::string_view(code).substr(prevToken.start, prevToken.length);
 			if (opStr != "++" && opStr != "--")
 			{
 				return true;
@@ -1200,12 +1032,12 @@ class Lexer
 		size_t start = pos;
 		while (pos < code.length() && (isAlphaNumeric(code[pos]) || code[pos] == '$'))
 			pos++;
-		std::string word = code.substr(start, pos - start);
+		std::string_view word = std::string_view(code).substr(start, pos - start);
 		if (word.empty())
 			return {TokenType::Unknown, start, 0}; // Should not happen
 
 		// 1. Keywords
-		if (keywords.count(word))
+		if (keywords.contains(word))
 		{
 			if (word == "class" || word == "interface" || word == "enum" ||
 				word == "type" || word == "namespace")
@@ -1222,7 +1054,7 @@ class Lexer
 		}
 
 		// 2. Builtin Types
-		if (builtinTypes.count(word))
+		if (builtinTypes.contains(word))
 			return {TokenType::Type, start, pos - start};
 
 		// 3. Contextual Checks
@@ -1234,9 +1066,8 @@ class Lexer
 		if (prevTokenIdx != -1)
 		{
 			const auto &prevToken = tokens[prevTokenIdx];
-			std::string prevWord = "";
-			if (prevToken.length > 0)
-				prevWord = code.substr(prevToken.start, prevToken.length);
+			std::string_view prevWord =
+				std::string_view(code).substr(prevToken.start, prevToken.length);
 			if (prevToken.type == TokenType::Keyword)
 			{
 				if (prevWord == "class" || prevWord == "interface" ||
@@ -1299,11 +1130,13 @@ class Lexer
 		{
 			if (pos + len <= code.length())
 			{
-				std::string sub = code.substr(pos, len);
-				if (operators.count(sub))
+				std::string_view sub = std::string_view(code).substr(pos, len);
+				if (operators.contains(sub))
 				{
 					pos += len;
-					return {operators.at(sub), start, (size_t)len};
+					TokenType type =
+						sub == "?." ? TokenType::OptionalChain : TokenType::Operator;
+					return {type, start, (size_t)len};
 				}
 			}
 		}
@@ -1363,43 +1196,42 @@ class Lexer
 				pos - start};
 	}
 
-	ImVec4 getColorForTokenType(TokenType type) const
+	HighlightClass getClassForTokenType(TokenType type) const
 	{
-		updateThemeColors();
 		switch (type)
 		{
 		case TokenType::Keyword:
-			return cachedColors.keyword;
+			return HighlightClass::Keyword;
 		case TokenType::Type:
-			return cachedColors.type;
+			return HighlightClass::Type;
 		case TokenType::ClassName:
-			return cachedColors.className;
+			return HighlightClass::Type;
 		case TokenType::String:
-			return cachedColors.string;
+			return HighlightClass::String;
 		case TokenType::TemplateLiteral:
-			return cachedColors.templateLiteral;
+			return HighlightClass::String;
 		case TokenType::RegexLiteral:
-			return cachedColors.regexLiteral;
+			return HighlightClass::String;
 		case TokenType::Number:
-			return cachedColors.number;
+			return HighlightClass::Number;
 		case TokenType::Comment:
 		case TokenType::JsxComment:
-			return cachedColors.comment;
+			return HighlightClass::Comment;
 		case TokenType::Function:
-			return cachedColors.function;
+			return HighlightClass::Function;
 		case TokenType::Decorator:
-			return cachedColors.decorator;
+			return HighlightClass::Function;
 		case TokenType::Operator:
 		case TokenType::OptionalChain:
-			return cachedColors.operatorColor;
+			return HighlightClass::Operator;
 		case TokenType::JsxTag:
-			return cachedColors.jsxTag;
+			return HighlightClass::Keyword;
 		case TokenType::JsxTagName:
-			return cachedColors.className; // Reuse class color for tags
+			return HighlightClass::Type; // Reuse class color for tags
 		case TokenType::JsxAttribute:
-			return cachedColors.jsxAttribute;
+			return HighlightClass::Text;
 		case TokenType::JsxText:
-			return cachedColors.jsxText;
+			return HighlightClass::Text;
 		case TokenType::Parenthesis:
 		case TokenType::Bracket:
 		case TokenType::Brace:
@@ -1407,13 +1239,13 @@ class Lexer
 		case TokenType::Comma:
 		case TokenType::Dot:
 		case TokenType::Colon:
-			return cachedColors.text; // Or slightly dimmed?
+			return HighlightClass::Text; // Or slightly dimmed?
 		case TokenType::Whitespace:
 		case TokenType::Identifier:
 		case TokenType::Unknown:
 		case TokenType::Preprocessor:
 		default:
-			return cachedColors.text;
+			return HighlightClass::Text;
 		}
 	}
 }; // End class Lexer
@@ -1,12 +1,93 @@
 #include "lsp.h"
 #include "../editor/editor.h"
+#include "../lib/json.hpp"
+#include <algorithm>
 #include <cstdio>
 #include <iostream>
 #include <sstream>
 #include <string>
+#include "lsp_globals.h"
 #include "lsp_utils.h"
 
-EditorLSP::EditorLSP() : currentRequestId(1000) {}
+using json = nlohmann::json;
+
+namespace {
+
+// Part of the document replaced by the edits since the last sync, in the
+// synced text and in the current one
+struct ChangedRange
+{
+	size_t old_start;
+	size_t old_end;
+	size_t new_start;
+	size_t new_end;
+};
+
+// Beyond this many ranges the whole text is sent instead
+constexpr size_t MAX_CHANGED_RANGES = 64;
+
+// Folds edits, oldest first, into disjoint ranges sorted by position. An
+// edit that overlaps or touches ranges is merged with them. False when the
+// edits are too scattered to be worth sending one by one.
+bool mergeEdits(const std::vector<TextEdit> &edits, std::vector<ChangedRange> &ranges)
+{
+	for (const TextEdit &edit : edits)
+	{
+		size_t edit_end = edit.position + edit.removed_length;
+		auto first = std::lower_bound(
+			ranges.begin(), ranges.end(), edit.position,
+			[](const ChangedRange &range, size_t pos) { return range.new_end < pos; });
+		auto last = first;
+		while (last != ranges.end() && last->new_start <= edit_end)
+		{
+			++last;
+		}
+
+		// Synced minus current position, for text before range
+		auto shiftBefore = [&](auto range) {
+			return range == ranges.begin()
+					   ? ptrdiff_t(0)
+					   : ptrdiff_t((range - 1)->old_end) - ptrdiff_t((range - 1)->new_end);
+		};
+		ChangedRange merged;
+		if (first != last && first->new_start <= edit.position)
+		{
+			merged.new_start = first->new_start;
+			merged.old_start = first->old_start;
+		} else
+		{
+			merged.new_start = edit.position;
+			merged.old_start = edit.position + shiftBefore(first);
+		}
+		size_t end = edit_end;
+		if (first != last && (last - 1)->new_end >= edit_end)
+		{
+			end = (last - 1)->new_end;
+			merged.old_end = (last - 1)->old_end;
+		} else
+		{
+			merged.old_end = edit_end + shiftBefore(last);
+		}
+		merged.new_end = end - edit.removed_length + edit.inserted_length;
+
+		ptrdiff_t delta = ptrdiff_t(edit.inserted_length) - ptrdiff_t(edit.removed_length);
+		for (auto range = last; range != ranges.end(); ++range)
+		{
+			range->new_start += delta;
+			range->new_end += delta;
+		}
+		ranges.insert(ranges.erase(first, last), merged);
+		if (ranges.size() > MAX_CHANGED_RANGES)
+		{
+			return false;
+		}
+	}
+	return true;
+}
+
+} // namespace
+
+EditorLSP::EditorLSP() = default;
 
 EditorLSP::~EditorLSP() = default;
 
@@ -19,7 +100,7 @@ bool EditorLSP::initialize(const std::string &workspacePath)
 	return gLSPManager.initialize(workspacePath);
 }
 
-std::string EditorLSP::escapeJSON(const std::string &s) const
+std::string EditorLSP::escapeJSON(const std::string &s)
 {
 	std::string out;
 	out.reserve(s.length() * 2);
@@ -71,41 +152,12 @@ void EditorLSP::didOpen(const std::string &filePath, const std::string &content)
 		return;
 	}
 
-	// If the selected adapter is not initialized, initialize it with the
-	// current file's directory
+	// Selecting the file started its server unless it cannot run
 	if (!gLSPManager.isInitialized())
 	{
-		// Extract workspace path from file path (use directory containing the
-		// file)
-		std::string workspacePath = filePath.substr(0, filePath.find_last_of("/\\"));
-		std::cout << "\033[35mLSP:\033[0m Auto-initializing with workspace: "
-				  << workspacePath << std::endl;
-
-		try
-		{
-			if (!gLSPManager.initialize(workspacePath))
-			{
-				std::cout << "\033[31mLSP:\033[0m Failed to initialize LSP for "
-						  << filePath << std::endl;
-				return;
-			}
-		} catch (const std::exception &e)
-		{
-			std::cout << "\033[31mLSP:\033[0m Exception during LSP initialization: "
-					  << e.what() << std::endl;
-			std::cout
-				<< "\033[33mLSP:\033[0m LSP support will be disabled for this session"
-				<< std::endl;
-			return;
-		} catch (...)
-		{
-			std::cout << "\033[31mLSP:\033[0m Unknown exception during LSP initialization"
-					  << std::endl;
-			std::cout
-				<< "\033[33mLSP:\033[0m LSP support will be disabled for this session"
-				<< std::endl;
-			return;
-		}
+		std::cout << "\033[33mLSP:\033[0m No running server for " << filePath
+				  << std::endl;
+		return;
 	}
 
 	const std::string uri = pathToFileUri(filePath);
@@ -128,7 +180,14 @@ void EditorLSP::didOpen(const std::string &filePath, const std::string &content)
 	// Only send request if we have a working adapter
 	if (gLSPManager.hasWorkingAdapter())
 	{
-		gLSPManager.sendRequest(notification);
+		if (gLSPManager.sendRequest(notification))
+		{
+			gLSPManager.documentOpened(filePath);
+			// Counted lines let the next didChange find positions in it
+			editor_state.fileContent.lineCount();
+			syncedDocuments[filePath] = editor_state.fileContent.snapshot();
+		}
+		gLSPSemanticTokens.requestTokens(filePath);
 		// std::cout << "\033[32mLSP:\033[0m didOpen notification sent successfully"
 		// << std::endl;
 	} else
@@ -142,17 +201,21 @@ void EditorLSP::didOpen(const std::string &filePath, const std::string &content)
 void EditorLSP::didChange(const std::string &filePath, int version)
 {
     static std::chrono::steady_clock::time_point lastChangeTime;
-    static std::string lastChangeContent;
+    static TextSnapshot lastChangeContent;
+
+    if (editor_state.large_file) {
+        return;
+    }
     
     auto now = std::chrono::steady_clock::now();
     auto elapsed = std::chrono::duration_cast<std::chrono::milliseconds>(now - lastChangeTime).count();
 
-    if (elapsed < 50 && editor_state.fileContent == lastChangeContent) {
+    if (elapsed < 50 && lastChangeContent.matches(editor_state.fileContent)) {
         return;
     }
     
     lastChangeTime = now;
-    lastChangeContent = editor_state.fileContent;
+    lastChangeContent = editor_state.fileContent.snapshot();
     
     std::cout << "[LSP] didChange -> " << filePath 
               << " v" << version << " len=" << editor_state.fileContent.size() << "\n";
@@ -163,45 +226,38 @@ void EditorLSP::didChange(const std::string &filePath, int version)
 		return;
 	}
 
-	// Auto-initialize if needed
 	if (!gLSPManager.isInitialized())
 	{
-		std::string workspacePath = filePath.substr(0, filePath.find_last_of("/\\"));
-		std::cout << "\033[35mLSP:\033[0m Auto-initializing with workspace: "
-				  << workspacePath << std::endl;
+		return;
+	}
+	// A server that restarted since the file was opened has never seen it
+	if (!gLSPManager.isDocumentOpen(filePath))
+	{
+		didOpen(filePath, editor_state.fileContent.str());
+		return;
+	}
 
-		try
-		{
-			if (!gLSPManager.initialize(workspacePath))
-			{
-				std::cout << "\033[31mLSP:\033[0m Failed to initialize LSP for "
-						  << filePath << std::endl;
-				return;
-			}
-		} catch (const std::exception &e)
-		{
-			std::cout << "\033[31mLSP:\033[0m Exception during LSP initialization: "
-					  << e.what() << std::endl;
-			std::cout
-				<< "\033[33mLSP:\033[0m LSP support will be disabled for this session"
-				<< std::endl;
-			return;
-		} catch (...)
-		{
-			std::cout << "\033[31mLSP:\033[0m Unknown exception during LSP initialization"
-					  << std::endl;
-			std::cout
-				<< "\033[33mLSP:\033[0m LSP support will be disabled for this session"
-				<< std::endl;
-			return;
-		}
+	const SyncOptions &options = syncOptions();
+	if (options.change == 0)
+	{
+		return; // the server does not track open documents
+	}
+
+	// Servers that take incremental changes get the ranges edited since the
+	// last sync instead of the whole text
+	std::string changes;
+	auto synced = syncedDocuments.find(filePath);
+	if (options.change != 2 || synced == syncedDocuments.end() ||
+		!incrementalChanges(synced->second, changes))
+	{
+		changes = R"({"text":")" + escapeJSON(editor_state.fileContent.str()) + R"("})";
 	}
 
 	const std::string uri = pathToFileUri(filePath);
 	std::string notification = std::string(R"({
 	"jsonrpc":"2.0","method":"textDocument/didChange","params":{
 		"textDocument":{"uri":")") + uri + R"(","version":)" + std::to_string(version) + R"(},
-		"contentChanges":[{"text":")" + escapeJSON(editor_state.fileContent) + R"("}]
+		"contentChanges":[)" + changes + R"(]
 	}})";
 
 	// Only send request if we have a working adapter
@@ -209,6 +265,10 @@ void EditorLSP::didChange(const std::string &filePath, int version)
 	{
 		if (gLSPManager.sendRequest(notification))
 		{
+			editor_state.fileContent.lineCount();
+			syncedDocuments[filePath] = editor_state.fileContent.snapshot();
+			// The server has the new text, so its tokens are for it
+			gLSPSemanticTokens.requestTokens(filePath);
 			// std::cout << "\033[32mLSP:\033[0m didChange notification sent
 			// successfully (v" << version
 			// << ")\n";
@@ -226,30 +286,104 @@ void EditorLSP::didChange(const std::string &filePath, int version)
 }
 
 void EditorLSP::didSave(const std::string& filePath, int /*version*/) {
+    if (editor_state.large_file) return;
+    // Selecting a file whose server runs does not start another one
+    if (!gLSPManager.isDocumentOpen(filePath)) return;
     if (!gLSPManager.selectAdapterForFile(filePath)) return;
-    if (!gLSPManager.isInitialized()) {
-        std::string ws = filePath.substr(0, filePath.find_last_of("/\\"));
-        try { if (!gLSPManager.initialize(ws)) return; } catch (...) { return; }
-    }
     const std::string uri = pathToFileUri(filePath);
 	std::string notification = std::string(R"({
 	"jsonrpc":"2.0","method":"textDocument/didSave","params":{
 		"textDocument":{"uri":")") + uri + R"("},
-		"text":")" + escapeJSON(editor_state.fileContent) + R"("
+		"text":")" + escapeJSON(editor_state.fileContent.str()) + R"("
 	}})";
     if (gLSPManager.hasWorkingAdapter()) gLSPManager.sendRequest(notification);
 }
 
 void EditorLSP::didClose(const std::string& filePath) {
+    gLSPSemanticTokens.forgetFile(filePath);
+    syncedDocuments.erase(filePath);
+    if (!gLSPManager.isDocumentOpen(filePath)) return;
     if (!gLSPManager.selectAdapterForFile(filePath)) return;
-    if (!gLSPManager.isInitialized()) {
-        std::string ws = filePath.substr(0, filePath.find_last_of("/\\"));
-        try { if (!gLSPManager.initialize(ws)) return; } catch (...) { return; }
-    }
     const std::string uri = pathToFileUri(filePath);
 	std::string notification = std::string(R"({
 	"jsonrpc":"2.0","method":"textDocument/didClose","params":{
 		"textDocument":{"uri":")") + uri + R"("}
 	}})";
-    if (gLSPManager.hasWorkingAdapter()) gLSPManager.sendRequest(notification);
+    gLSPManager.sendRequest(notification);
+    gLSPManager.documentClosed(filePath);
+}
+
+const EditorLSP::SyncOptions &EditorLSP::syncOptions()
+{
+	std::string capabilities = gLSPManager.getServerCapabilities();
+	if (capabilities == sync.source)
+	{
+		return sync;
+	}
+
+	sync = SyncOptions();
+	sync.source = capabilities;
+	json caps = json::parse(capabilities, nullptr, false);
+	if (!caps.is_object())
+	{
+		return sync;
+	}
+	sync.utf8 = caps.value("positionEncoding", "utf-16") == "utf-8";
+	// Without textDocumentSync the whole text is sent, as before servers
+	// reported it
+	auto textDocumentSync = caps.find("textDocumentSync");
+	if (textDocumentSync != caps.end())
+	{
+		if (textDocumentSync->is_number_integer())
+		{
+			sync.change = textDocumentSync->get<int>();
+		} else if (textDocumentSync->is_object())
+		{
+			sync.change = textDocumentSync->value("change", 0);
+		}
+	}
+	return sync;
+}
+
+bool EditorLSP::incrementalChanges(const TextSnapshot &synced, std::string &changes)
+{
+	const TextBuffer &content = editor_state.fileContent;
+	std::vector<TextEdit> edits;
+	std::vector<ChangedRange> ranges;
+	if (synced.documentId() != content.documentId() || !synced.linesCounted() ||
+		!content.editsSince(synced.version(), edits) || !mergeEdits(edits, ranges))
+	{
+		return false;
+	}
+
+	// Positions are looked up in the synced text
+	auto position = [&](size_t offset) {
+		size_t line = synced.lineFromOffset(offset);
+		size_t line_start = synced.lineStart(line);
+		size_t character = offset - line_start;
+		if (!sync.utf8)
+		{
+			std::string prefix = synced.substr(line_start, character);
+			character = byteToUtf16Column(prefix, prefix.size());
+		}
+		return R"({"line":)" + std::to_string(line) + R"(,"character":)" +
+			   std::to_string(character) + "}";
+	};
+
+	// The server applies changes in order, so the last range goes first and
+	// the positions of those before it stay valid
+	changes.clear();
+	for (auto range = ranges.rbegin(); range != ranges.rend(); ++range)
+	{
+		if (!changes.empty())
+		{
+			changes += ",";
+		}
+		changes += R"({"range":{"start":)" + position(range->old_start) +
+				   R"(,"end":)" + position(range->old_end) + R"(},"text":")" +
+				   escapeJSON(content.substr(range->new_start,
+											 range->new_end - range->new_start)) +
+				   R"("})";
+	}
+	return true;
 }
\ No newline at end of file
@@ -3,6 +3,7 @@
 #include "lsp_manager.h"
 #include <memory>
 #include <string>
+#include <unordered_map>
 #include <vector>
 
 class EditorLSP
@@ -18,14 +19,29 @@ class EditorLSP
 	void didSave(const std::string& filePath, int version);
 	void didClose(const std::string& filePath);
 	void requestCompletion(const std::string& filePath, int line, int col);
-	int getNextRequestId() { return ++currentRequestId; }
+
+	// Escapes s for use inside a JSON string literal. Safe on any thread.
+	static std::string escapeJSON(const std::string &s);
 
   private:
+	// How the server wants document changes, from its capabilities
+	struct SyncOptions
+	{
+		std::string source; // capabilities these were read from
+		int change = 1;		// TextDocumentSyncKind: 0 none, 1 full, 2 incremental
+		bool utf8 = false;	// positions in bytes instead of UTF-16 units
+	};
+
 	// Helper methods
-	std::string escapeJSON(const std::string &s) const;
+	const SyncOptions &syncOptions();
+	// Writes the contentChanges for the edits made to
+	// editor_state.fileContent since synced; false when they cannot be sent
+	// as ranges and the full text has to go instead
+	bool incrementalChanges(const TextSnapshot &synced, std::string &changes);
 
-	// Request tracking
-	int currentRequestId = 1000;
+	SyncOptions sync;
+	// Text each open document had when it was last sent to the server
+	std::unordered_map<std::string, TextSnapshot> syncedDocuments;
 
 	// HANDLE m_processHandle = nullptr;
     // HANDLE m_childStdin   = nullptr;
@@ -0,0 +1,31 @@
+/*
+	File: lsp_adapter.h
+	Description: What LSPManager needs from a language server adapter.
+
+	An adapter starts one server process for one workspace root and moves
+	framed messages to and from it. The manager owns one adapter per
+	running server and reads from it on the connection's reader thread.
+*/
+
+#pragma once
+#include <string>
+
+class LSPAdapter
+{
+  public:
+	virtual ~LSPAdapter() = default;
+
+	// Starts the server and completes the initialize handshake
+	virtual bool initialize(const std::string &workspacePath) = 0;
+	virtual bool isInitialized() const = 0;
+	// Stops the server and closes its pipes, so a blocked readResponse returns
+	virtual void shutdown() = 0;
+
+	virtual bool sendRequest(const std::string &request) = 0;
+	// Blocks until the next message body, "" once the server is gone
+	virtual std::string readResponse(int *contentLength = nullptr) = 0;
+
+	virtual std::string getLanguageId(const std::string &filePath) const = 0;
+	// "capabilities" of the server's initialize result, as JSON text
+	virtual std::string getServerCapabilities() const = 0;
+};
@@ -1,233 +1,13 @@
 #include "lsp_adapter_clangd.h"
-#include <cerrno>
-#include <cstdio>
-#include <cstring>
-#include <iostream>
-#include <sstream>
-#ifndef PLATFORM_WINDOWS
-#include <sys/types.h>
-#include <sys/wait.h>
-#include <unistd.h>
-#endif
 
-class LSPAdapterClangd::ClangdImpl
+std::vector<std::string> LSPAdapterClangd::serverCommand(const std::string & /*workspacePath*/) const
 {
-  public:
-	ClangdImpl() : input(nullptr), output(nullptr) {}
-	~ClangdImpl()
+	std::string path = findExecutable("clangd", {"/usr/bin/clangd"});
+	if (path.empty())
 	{
-		if (input)
-			pclose(input);
-		if (output)
-			pclose(output);
+		return {};
 	}
-
-	FILE *input;  // To LSP server
-	FILE *output; // From LSP server
-	int pid;	  // LSP server process ID
-};
-
-LSPAdapterClangd::LSPAdapterClangd() : impl(new ClangdImpl()), initialized(false)
-{
-	// Default path for clangd
-	lspPath = "/usr/bin/clangd";
-}
-
-LSPAdapterClangd::~LSPAdapterClangd() = default;
-
-bool LSPAdapterClangd::initialize(const std::string &workspacePath)
-{
-	if (initialized)
-	{
-		std::cout << "\033[35mClangd:\033[0m Already initialized" << std::endl;
-		return true;
-	}
-
-	// Check if the LSP server executable exists and is accessible
-	// Use a more defensive approach to avoid permission issues
-	try
-	{
-		if (access(lspPath.c_str(), X_OK) != 0)
-		{
-			std::cerr
-				<< "\033[31mClangd:\033[0m LSP server not found or not executable at: "
-				<< lspPath << std::endl;
-			std::cerr << "\033[33mClangd:\033[0m Error: " << strerror(errno) << std::endl;
-			std::cerr << "\033[33mClangd:\033[0m Clangd LSP support will be disabled for "
-						 "this session"
-					  << std::endl;
-			return false;
-		}
-	} catch (...)
-	{
-		std::cerr << "\033[33mClangd:\033[0m Could not check LSP server accessibility - "
-					 "disabling LSP support"
-				  << std::endl;
-		return false;
-	}
-
-	try
-	{
-		std::cout << "\033[35mClangd:\033[0m Starting LSP server with path: " << lspPath
-				  << std::endl;
-
-		// Create pipes for communication
-		int inPipe[2], outPipe[2];
-		if (pipe(inPipe) < 0 || pipe(outPipe) < 0)
-		{
-			std::cerr << "\033[31mClangd:\033[0m Failed to create pipes" << std::endl;
-			return false;
-		}
-
-		// Fork process
-		pid_t pid = fork();
-		if (pid < 0)
-		{
-			std::cerr << "\033[31mClangd:\033[0m Fork failed" << std::endl;
-			return false;
-		}
-
-		if (pid == 0)
-		{ // Child process
-			std::cout << "\033[35mClangd:\033[0m Starting clangd process" << std::endl;
-
-			dup2(outPipe[0], STDIN_FILENO);
-			dup2(inPipe[1], STDOUT_FILENO);
-
-			close(inPipe[0]);
-			close(inPipe[1]);
-			close(outPipe[0]);
-			close(outPipe[1]);
-
-			execl(lspPath.c_str(), "clangd", "--log=error", nullptr);
-
-			std::cerr << "\033[31mClangd:\033[0m Failed to start clangd" << std::endl;
-			exit(1);
-		}
-
-		// Parent process
-		close(inPipe[1]);
-		close(outPipe[0]);
-
-		impl->input = fdopen(outPipe[1], "w");
-		impl->output = fdopen(inPipe[0], "r");
-		impl->pid = pid;
-
-		if (!impl->input || !impl->output)
-		{
-			std::cerr << "\033[31mClangd:\033[0m Failed to open pipes" << std::endl;
-			return false;
-		}
-
-		std::cout << "\033[35mClangd:\033[0m Sending initialize request for "
-					 "workspace: "
-				  << workspacePath << std::endl;
-
-		// Create the initialize request string
-		std::string initRequest = std::string(R"({
-            "jsonrpc": "2.0",
-            "id": 1,
-            "method": "initialize",
-            "params": {
-                "processId": null,
-                "rootUri": "file://)") +
-								  workspacePath + R"(",
-                "capabilities": {
-                    "textDocument": {
-                        "definition": {
-                            "dynamicRegistration": true
-                        },
-                        "completion": {
-                            "completionItem": {
-                                "sortTextSupport": true
-                            }
-                        }
-                    }
-                }
-            }
-        })";
-
-		// Send the initialization request
-		sendRequest(initRequest);
-		std::cout << "\033[35mClangd:\033[0m Waiting for initialization response"
-				  << std::endl;
-		std::string initResponse = readResponse();
-		std::cout << "\033[35mClangd:\033[0m Received initialization response: "
-				  << initResponse.substr(0, 100) << "..." << std::endl;
-
-		// Send the initialized notification
-		std::string initializedNotification = R"({
-            "jsonrpc": "2.0",
-            "method": "initialized",
-            "params": {}
-        })";
-		sendRequest(initializedNotification);
-		std::cout << "\033[32mClangd:\033[0m Sent initialized notification" << std::endl;
-
-		initialized = true;
-		return true;
-	} catch (const std::exception &e)
-	{
-		std::cerr << "\033[31mClangd:\033[0m Initialization failed: " << e.what()
-				  << std::endl;
-		return false;
-	}
-}
-
-bool LSPAdapterClangd::sendRequest(const std::string &request)
-{
-	if (!impl->input)
-	{
-		std::cerr << "\033[31mClangd:\033[0m Cannot send request - server not "
-					 "initialized"
-				  << std::endl;
-		return false;
-	}
-
-	fprintf(
-		impl->input, "Content-Length: %zu\r\n\r\n%s", request.length(), request.c_str());
-	fflush(impl->input);
-	return true;
-}
-
-std::string LSPAdapterClangd::readResponse(int *contentLength)
-{
-	if (!impl->output)
-	{
-		std::cerr << "\033[31mClangd:\033[0m Cannot read response - server not "
-					 "initialized"
-				  << std::endl;
-		return "";
-	}
-
-	char header[1024];
-	if (!fgets(header, sizeof(header), impl->output))
-	{
-		std::cerr << "\033[31mClangd:\033[0m Failed to read response header" << std::endl;
-		return "";
-	}
-
-	int length = 0;
-	if (sscanf(header, "Content-Length: %d\r\n", &length) != 1)
-	{
-		std::cerr << "\033[31mClangd:\033[0m Invalid header format" << std::endl;
-		return "";
-	}
-
-	// Skip the empty line after the header
-	fgets(header, sizeof(header), impl->output);
-
-	// Read the response body
-	std::vector<char> buffer(length + 1);
-	size_t bytes_read = fread(buffer.data(), 1, length, impl->output);
-	buffer[bytes_read] = '\0';
-
-	if (contentLength)
-	{
-		*contentLength = length;
-	}
-
-	return std::string(buffer.data(), bytes_read);
+	return {path, "--log=error"};
 }
 
 std::string LSPAdapterClangd::getLanguageId(const std::string &filePath) const
@@ -250,4 +30,4 @@ std::string LSPAdapterClangd::getLanguageId(const std::string &filePath) const
 
 	// Default for unknown extensions
 	return "plaintext";
-}
\ No newline at end of file
+}
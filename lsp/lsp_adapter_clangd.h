@@ -1,31 +1,14 @@
 #pragma once
-#include <memory>
-#include <string>
-#include <vector>
+#include "lsp_adapter_stdio.h"
 
-// Forward declarations
-class EditorLSP;
-
-class LSPAdapterClangd
+class LSPAdapterClangd : public LSPStdioAdapter
 {
   public:
-	LSPAdapterClangd();
-	~LSPAdapterClangd();
-
-	// Setup and initialization
-	bool initialize(const std::string &workspacePath);
-	bool isInitialized() const { return initialized; }
-
-	// Protocol communication
-	bool sendRequest(const std::string &request);
-	std::string readResponse(int *contentLength = nullptr);
+	LSPAdapterClangd() : LSPStdioAdapter("Clangd") {}
 
 	// Clangd-specific functionality
-	std::string getLanguageId(const std::string &filePath) const;
+	std::string getLanguageId(const std::string &filePath) const override;
 
-  private:
-	class ClangdImpl;
-	std::unique_ptr<ClangdImpl> impl;
-	bool initialized;
-	std::string lspPath;
-};
\ No newline at end of file
+  protected:
+	std::vector<std::string> serverCommand(const std::string &workspacePath) const override;
+};
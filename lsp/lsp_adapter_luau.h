@@ -1,24 +1,13 @@
 #pragma once
-#include <memory>
-#include <string>
+#include "lsp_adapter_stdio.h"
 
-class LSPAdapterLuau
+class LSPAdapterLuau : public LSPStdioAdapter
 {
-public:
-    LSPAdapterLuau();
-    ~LSPAdapterLuau();
+  public:
+	LSPAdapterLuau() : LSPStdioAdapter("Luau") {}
 
-    bool initialize(const std::string& workspacePath);
-    bool isInitialized() const { return initialized; }
+	std::string getLanguageId(const std::string &filePath) const override;
 
-    bool sendRequest(const std::string& request);
-    std::string readResponse(int* contentLength = nullptr);
-
-    std::string getLanguageId(const std::string& filePath) const;
-
-private:
-    class LuauImpl;
-    std::unique_ptr<LuauImpl> impl;
-
-    bool initialized = false;
+  protected:
+	std::vector<std::string> serverCommand(const std::string &workspacePath) const override;
 };
@@ -1,32 +1,15 @@
 #pragma once
-#include <cstring>
-#include <memory>
-#include <string>
-#include <vector>
+#include "lsp_adapter_stdio.h"
 
-// Forward declarations
-class EditorLSP;
-
-class LSPAdapterPyright
+class LSPAdapterPyright : public LSPStdioAdapter
 {
   public:
-	LSPAdapterPyright();
-	~LSPAdapterPyright();
-
-	// Setup and initialization
-	bool initialize(const std::string &workspacePath);
-	bool isInitialized() const { return initialized; }
-
-	// Protocol communication
-	bool sendRequest(const std::string &request);
-	std::string readResponse(int *contentLength = nullptr);
+	LSPAdapterPyright() : LSPStdioAdapter("Pyright") {}
 
 	// Pyright-specific functionality
-	std::string getLanguageId(const std::string &filePath) const;
+	std::string getLanguageId(const std::string &filePath) const override;
 
-  private:
-	class PyrightImpl;
-	std::unique_ptr<PyrightImpl> impl;
-	bool initialized;
-	std::string lspPath;
-};
\ No newline at end of file
+  protected:
+	std::vector<std::string> serverCommand(const std::string &workspacePath) const override;
+	nlohmann::json initializationOptions() const override;
+};
@@ -0,0 +1,231 @@
+/*
+	File: lsp_adapter_stdio.cpp
+	Description: Process, framing and initialize handshake shared by the
+	language server adapters.
+*/
+
+#include "lsp_adapter_stdio.h"
+#include "lsp_utils.h"
+
+#include <algorithm>
+#include <chrono>
+#include <cstdlib>
+#include <filesystem>
+#include <iostream>
+
+#ifdef _WIN32
+#include <windows.h>
+#else
+#include <unistd.h>
+#endif
+
+using json = nlohmann::json;
+namespace fs = std::filesystem;
+
+namespace {
+
+// How long a server may take to answer initialize, which for some includes
+// indexing the workspace
+constexpr std::chrono::seconds INITIALIZE_TIMEOUT{30};
+
+bool isExecutable(const std::string &path)
+{
+#ifdef _WIN32
+	std::error_code ec;
+	return fs::is_regular_file(path, ec);
+#else
+	return access(path.c_str(), X_OK) == 0 && !fs::is_directory(path);
+#endif
+}
+
+// What the editor handles, the same for every server
+json clientCapabilities()
+{
+	return {{"general", {{"positionEncodings", {"utf-8", "utf-16"}}}},
+			{"workspace", {{"workspaceFolders", true}}},
+			{"textDocument",
+			 {{"synchronization", {{"didSave", true}}},
+			  {"completion",
+			   {{"completionItem",
+				 {{"snippetSupport", true},
+				  {"documentationFormat", {"markdown", "plaintext"}}}},
+				{"contextSupport", true}}},
+			  {"hover", {{"contentFormat", {"markdown", "plaintext"}}}},
+			  {"definition", {{"dynamicRegistration", false}}},
+			  {"references", {{"dynamicRegistration", false}}},
+			  {"semanticTokens",
+			   {{"requests", {{"full", {{"delta", true}}}}},
+				{"tokenTypes",
+				 {"namespace", "type",	   "class",		 "enum",	 "interface",
+				  "struct",	   "typeParameter", "parameter", "variable", "property",
+				  "enumMember", "event",	   "function",	 "method",	 "macro",
+				  "keyword",   "modifier",	   "comment",	 "string",	 "number",
+				  "regexp",	   "operator",	   "decorator"}},
+				{"tokenModifiers", json::array()},
+				{"formats", {"relative"}}}}}}};
+}
+
+} // namespace
+
+LSPStdioAdapter::LSPStdioAdapter(std::string name) : name(std::move(name)) {}
+
+LSPStdioAdapter::~LSPStdioAdapter() { shutdown(); }
+
+std::string LSPStdioAdapter::findExecutable(const std::string &name,
+											const std::vector<std::string> &fallbacks)
+{
+#ifdef _WIN32
+	const char separator = ';';
+	const std::vector<std::string> suffixes = {".exe", ""};
+#else
+	const char separator = ':';
+	const std::vector<std::string> suffixes = {""};
+#endif
+	const char *path = std::getenv("PATH");
+	std::string dirs = path ? path : "";
+	size_t start = 0;
+	while (start <= dirs.size())
+	{
+		size_t end = dirs.find(separator, start);
+		if (end == std::string::npos)
+		{
+			end = dirs.size();
+		}
+		if (end > start)
+		{
+			for (const std::string &suffix : suffixes)
+			{
+				std::string candidate =
+					(fs::path(dirs.substr(start, end - start)) / (name + suffix)).string();
+				if (isExecutable(candidate))
+				{
+					return candidate;
+				}
+			}
+		}
+		start = end + 1;
+	}
+
+	for (const std::string &fallback : fallbacks)
+	{
+		if (isExecutable(fallback))
+		{
+			return fallback;
+		}
+	}
+	return "";
+}
+
+bool LSPStdioAdapter::initialize(const std::string &workspacePath)
+{
+	if (initialized)
+	{
+		return true;
+	}
+
+	std::vector<std::string> command = serverCommand(workspacePath);
+	if (command.empty())
+	{
+		std::cerr << "\033[31m" << name << ":\033[0m Language server not found"
+				  << std::endl;
+		return false;
+	}
+	std::cout << "\033[35m" << name << ":\033[0m Starting " << command[0] << std::endl;
+	if (!transport.start(command))
+	{
+		std::cerr << "\033[31m" << name << ":\033[0m Failed to start " << command[0]
+				  << std::endl;
+		return false;
+	}
+
+#ifdef _WIN32
+	int processId = int(GetCurrentProcessId());
+#else
+	int processId = int(getpid());
+#endif
+	json params = {{"processId", processId},
+				   {"clientInfo", {{"name", "NED"}}},
+				   {"rootUri", nullptr},
+				   {"workspaceFolders", json::array()},
+				   {"capabilities", clientCapabilities()}};
+	if (!workspacePath.empty())
+	{
+		std::string uri = pathToFileUri(workspacePath);
+		params["rootUri"] = uri;
+		params["workspaceFolders"] = json::array(
+			{{{"uri", uri}, {"name", fs::path(workspacePath).filename().string()}}});
+	}
+	json options = initializationOptions();
+	if (!options.is_null())
+	{
+		params["initializationOptions"] = options;
+	}
+	json request = {{"jsonrpc", "2.0"}, {"id", 1}, {"method", "initialize"}, {"params", params}};
+	if (!transport.send(request.dump()))
+	{
+		std::cerr << "\033[31m" << name << ":\033[0m Failed to send initialize"
+				  << std::endl;
+		transport.stop(0);
+		return false;
+	}
+
+	// Log messages and progress may come first
+	auto deadline = std::chrono::steady_clock::now() + INITIALIZE_TIMEOUT;
+	while (std::chrono::steady_clock::now() < deadline)
+	{
+		auto left = std::chrono::duration_cast<std::chrono::milliseconds>(
+			deadline - std::chrono::steady_clock::now());
+		std::string message = transport.receive(int(std::max<long long>(1, left.count())));
+		if (message.empty())
+		{
+			break;
+		}
+		json response = json::parse(message, nullptr, false);
+		if (response.is_discarded() || !response.contains("id") || response["id"] != 1)
+		{
+			continue;
+		}
+		if (!response.contains("result"))
+		{
+			std::cerr << "\033[31m" << name << ":\033[0m initialize failed: "
+					  << response.value("error", json::object()).dump() << std::endl;
+			break;
+		}
+		capabilities = response["result"].value("capabilities", json::object()).dump();
+		transport.send(R"({"jsonrpc":"2.0","method":"initialized","params":{}})");
+		initialized = true;
+		return true;
+	}
+
+	std::cerr << "\033[31m" << name << ":\033[0m No initialize response" << std::endl;
+	transport.stop(0);
+	return false;
+}
+
+void LSPStdioAdapter::shutdown()
+{
+	if (initialized)
+	{
+		// The reply to shutdown goes unread; the server exits on "exit" or
+		// once its input closes
+		transport.send(R"({"jsonrpc":"2.0","id":9999,"method":"shutdown","params":{}})");
+		transport.send(R"({"jsonrpc":"2.0","method":"exit","params":{}})");
+		initialized = false;
+	}
+	transport.stop();
+}
+
+bool LSPStdioAdapter::sendRequest(const std::string &request)
+{
+	return transport.send(request);
+}
+
+std::string LSPStdioAdapter::readResponse(int *contentLength)
+{
+	std::string body = transport.receive();
+	if (contentLength)
+	{
+		*contentLength = body.empty() ? -1 : int(body.size());
+	}
+	return body;
+}
@@ -0,0 +1,51 @@
+/*
+	File: lsp_adapter_stdio.h
+	Description: Base for adapters whose server speaks LSP over stdin and
+	stdout, which is all of them.
+
+	The process, the framing and the initialize handshake live here; an
+	adapter only names the command line, any initializationOptions and the
+	language ids of its files.
+*/
+
+#pragma once
+#include "../lib/json.hpp"
+#include "lsp_adapter.h"
+#include "lsp_transport.h"
+
+#include <string>
+#include <vector>
+
+class LSPStdioAdapter : public LSPAdapter
+{
+  public:
+	explicit LSPStdioAdapter(std::string name);
+	~LSPStdioAdapter() override;
+
+	bool initialize(const std::string &workspacePath) override;
+	bool isInitialized() const override { return initialized; }
+	void shutdown() override;
+
+	bool sendRequest(const std::string &request) override;
+	std::string readResponse(int *contentLength = nullptr) override;
+
+	std::string getServerCapabilities() const override { return capabilities; }
+
+  protected:
+	// Program and arguments of the server, empty when it is not installed
+	virtual std::vector<std::string> serverCommand(const std::string &workspacePath) const = 0;
+	// "initializationOptions" of the initialize request, null for none
+	virtual nlohmann::json initializationOptions() const { return nullptr; }
+
+	// Full path of name found on PATH, else the first of fallbacks that is
+	// executable, for apps started without the shell's PATH; "" if neither
+	static std::string findExecutable(const std::string &name,
+									  const std::vector<std::string> &fallbacks = {});
+
+	const std::string name; // for log messages
+
+  private:
+	LSPTransport transport;
+	std::string capabilities = "{}";
+	bool initialized = false;
+};
@@ -22,113 +22,71 @@ using json = nlohmann::json;
 
 bool LSPAutocomplete::wasShowingLastFrame = false;
 
-LSPAutocomplete::LSPAutocomplete()
-{
-	// Start the worker thread
-	workerThread = std::thread(&LSPAutocomplete::workerFunction, this);
-}
+LSPAutocomplete::LSPAutocomplete() = default;
+LSPAutocomplete::~LSPAutocomplete() = default;
 
-LSPAutocomplete::~LSPAutocomplete()
+void LSPAutocomplete::requestCompletion(const std::string &filePath,
+										int line,
+										int character)
 {
-	// Signal the worker thread to stop
-	shouldStop = true;
-	queueCondition.notify_one();
-
-	// Wait for the thread to finish
-	if (workerThread.joinable())
+	if (!gLSPManager.selectAdapterForFile(filePath))
 	{
-		workerThread.join();
+		std::cout << "\033[31mLSP Autocomplete:\033[0m No LSP adapter "
+					 "available for file: "
+				  << filePath << std::endl;
+		return;
 	}
-}
 
-void LSPAutocomplete::workerFunction()
-{
-	while (!shouldStop)
+	if (!gLSPManager.isInitialized())
 	{
-		CompletionRequest request;
-		{
-			std::unique_lock<std::mutex> lock(queueMutex);
-			queueCondition.wait(lock,
-								[this] { return !requestQueue.empty() || shouldStop; });
-
-			if (shouldStop)
-			{
-				break;
-			}
-
-			request = requestQueue.front();
-			requestQueue.pop();
-		}
-
-		// Process the request
-		if (!gLSPManager.isInitialized())
-		{
-			std::cout << "\033[31mLSP Autocomplete:\033[0m Not initialized" << std::endl;
-			continue;
-		}
-
-		if (!gLSPManager.selectAdapterForFile(request.filePath))
-		{
-			std::cout << "\033[31mLSP Autocomplete:\033[0m No LSP adapter "
-						 "available for file: "
-					  << request.filePath << std::endl;
-			continue;
-		}
-
-		std::cout << "\033[35mLSP Autocomplete:\033[0m Processing request at line "
-				  << request.line << ", char " << request.character
-				  << " (ID: " << request.requestId << ")" << std::endl;
-
-		// Store the request for later coordinate retrieval
-		{
-			std::lock_guard<std::mutex> lock(activeRequestsMutex);
-			activeRequests[request.requestId] = request;
-		}
-
-		// Form and send request
-		std::string request_str = formCompletionRequest(
-			request.requestId, request.filePath, request.line, request.character);
-		if (!gLSPManager.sendRequest(request_str))
-		{
-			std::cout << "\033[31mLSP Autocomplete:\033[0m Failed to send request"
-					  << std::endl;
-			// Remove from active requests if send failed
-			std::lock_guard<std::mutex> lock(activeRequestsMutex);
-			activeRequests.erase(request.requestId);
-			continue;
-		}
+		std::cout << "\033[31mLSP Autocomplete:\033[0m Not initialized" << std::endl;
+		return;
+	}
 
-		// Wait for response with timeout
-		const int MAX_ATTEMPTS = 15;
-		const int WAIT_MS = 50;
-		for (int attempt = 0; attempt < MAX_ATTEMPTS; ++attempt)
-		{
-			std::this_thread::sleep_for(std::chrono::milliseconds(WAIT_MS));
-			int contentLength = 0;
-			std::string response = gLSPManager.readResponse(&contentLength);
+	// The identifier being completed starts at the anchor; while it does
+	// not move, the cached list is filtered to what was typed since
+	int wordStart = findWordStart(editor_state.cursor_index);
+	auto [anchorLine, anchorChar] = getLineAndCharFromIndex(wordStart);
+	bool sameAnchor = cache.filePath == filePath && cache.line == anchorLine &&
+					  cache.character == anchorChar && anchorLine == line;
+	if (sameAnchor && cache.valid)
+	{
+		filterCompletions();
+	}
+	// A complete list covers every word typed from the anchor, and an answer
+	// on its way is filtered to the word as typed by the time it arrives
+	if (sameAnchor && (requestInFlight || (cache.valid && !cache.incomplete)))
+	{
+		return;
+	}
+	if (!sameAnchor)
+	{
+		cache = CompletionCache();
+		cache.filePath = filePath;
+		cache.line = anchorLine;
+		cache.character = anchorChar;
+	}
 
-			if (!response.empty())
+	// Only the newest request may fill the list; typing on makes the
+	// answers to the ones before it stale
+	int request = ++latestRequest;
+	requestInFlight = true;
+	bool sent = gLSPManager.request(
+		"textDocument/completion",
+		formCompletionParams(filePath, line, character, sameAnchor && cache.incomplete),
+		[this, request, line, character](const std::string &response) {
+			if (request == latestRequest)
 			{
-				if (processResponse(response, request.requestId))
-				{
-					break;
-				}
+				requestInFlight = false;
+				processResponse(response, line, character);
 			}
-		}
-	}
-}
-
-void LSPAutocomplete::requestCompletion(const std::string &filePath,
-										int line,
-										int character)
-{
-	int requestId = gEditorLSP.getNextRequestId();
-
+		});
+	if (!sent)
 	{
-		std::lock_guard<std::mutex> lock(queueMutex);
-		requestQueue.push({filePath, line, character, requestId});
+		requestInFlight = false;
+		std::cout << "\033[31mLSP Autocomplete:\033[0m Failed to send request"
+				  << std::endl;
 	}
-	queueCondition.notify_one();
 }
 
 bool LSPAutocomplete::shouldRender()
@@ -301,9 +259,7 @@ void LSPAutocomplete::insertText(
 		editor_state.fileContent.erase(start_index, end_index - start_index);
 
 		// Erase from fileColors
-		auto colors_begin = editor_state.fileColors.begin() + start_index;
-		auto colors_end = editor_state.fileColors.begin() + end_index;
-		editor_state.fileColors.erase(colors_begin, colors_end);
+		editor_state.eraseColors(start_index, end_index - start_index);
 	}
 
 	// Insert new text and colors
@@ -312,22 +268,16 @@ void LSPAutocomplete::insertText(
 		// Insert into fileContent
 		editor_state.fileContent.insert(start_index, text);
 
-		// Get the proper default text color from the theme
-		TreeSitter::updateThemeColors();
-		ImVec4 defaultColor = TreeSitter::cachedColors.text;
-
 		// Optionally extend the previous character's color for better visual
 		// continuity
-		ImVec4 insertColor = defaultColor;
+		HighlightClass insertColor = HighlightClass::Text;
 		if (start_index > 0 && start_index <= editor_state.fileColors.size())
 		{
 			// Use the color of the character before the insertion point
 			insertColor = editor_state.fileColors[start_index - 1];
 		}
 
-		editor_state.fileColors.insert(editor_state.fileColors.begin() + start_index,
-									   text.size(),
-									   insertColor);
+		editor_state.insertColors(start_index, text.size(), insertColor);
 	}
 	editor_state.cursor_index = start_index + text.size();
 	editor_state.text_changed = true;
@@ -573,14 +523,17 @@ void LSPAutocomplete::finalizeRenderState()
 	wasShowingLastFrame = showCompletions;
 }
 
-void LSPAutocomplete::renderCompletions()
+void LSPAutocomplete::processInput()
 {
-	if (!shouldRender())
+	if (shouldRender())
 	{
-		return;
+		handleInputAndCheckClose();
 	}
+}
 
-	if (handleInputAndCheckClose())
+void LSPAutocomplete::renderCompletions()
+{
+	if (!shouldRender())
 	{
 		return;
 	}
@@ -623,10 +576,10 @@ void LSPAutocomplete::renderCompletions()
 	finalizeRenderState();
 }
 
-std::string LSPAutocomplete::formCompletionRequest(int requestId,
-                                                   const std::string &filePath,
-                                                   int line,
-                                                   int character)
+std::string LSPAutocomplete::formCompletionParams(const std::string &filePath,
+												  int line,
+												  int character,
+												  bool forIncomplete)
 {
     // Figure out trigger
     char prev_char = (editor_state.cursor_index > 0)
@@ -637,6 +590,8 @@ std::string LSPAutocomplete::formCompletionRequest(int requestId,
     if (prev_char == '.' || prev_char == ':' || prev_char == '>') {
         triggerKind = 2;  // TriggerCharacter
         trig = (prev_char == '.') ? "." : (prev_char == ':') ? ":" : ">";
+    } else if (forIncomplete) {
+        triggerKind = 3;  // TriggerForIncompleteCompletions
     }
 
     const std::string uri = pathToFileUri(filePath); // gives file:///D:/... with spaces as %20
@@ -648,94 +603,59 @@ std::string LSPAutocomplete::formCompletionRequest(int requestId,
     };
     if (trig) params["context"]["triggerCharacter"] = trig;
 
-    nlohmann::json req = {
-        {"jsonrpc","2.0"},
-        {"id",     requestId},
-        {"method", "textDocument/completion"},
-        {"params", params}
-    };
-
-    std::string body = req.dump();
-    std::cout << "[TX completion] " << body.substr(0, 200) << "...\n";
-    return body;
+    return params.dump();
 }
 
 
-bool LSPAutocomplete::processResponse(const std::string &response, int requestId)
+void LSPAutocomplete::processResponse(const std::string &response,
+									  int requestLine,
+									  int requestCharacter)
 {
+	if (response.empty())
+	{
+		// The server went away before answering
+		cache.valid = false;
+		currentCompletionItems.clear();
+		showCompletions = false;
+		return;
+	}
+
 	try
 	{
 		json j = json::parse(response);
 
-		// Check if response matches our request ID
-		if (!j.contains("id") || !j["id"].is_number_integer() ||
-			j["id"].get<int>() != requestId)
-		{
-			return false;
-		}
-
-		std::cout << "\033[32mLSP Autocomplete:\033[0m Received response for ID "
-				  << requestId << std::endl;
-
 		// Handle errors
 		if (j.contains("error"))
 		{
 			std::cerr << "\033[31mLSP Autocomplete:\033[0m Error: " << j["error"].dump(2)
 					  << std::endl;
-			// Clean up failed request
-			{
-				std::lock_guard<std::mutex> lock(activeRequestsMutex);
-				activeRequests.erase(requestId);
-			}
+			cache.valid = false;
 			currentCompletionItems.clear();
 			showCompletions = false;
-			return true;
+			return;
 		}
 
 		// Process result
 		if (j.contains("result"))
 		{
-			// Retrieve original request coordinates
-			int requestLine = -1, requestCharacter = -1;
-			{
-				std::lock_guard<std::mutex> lock(activeRequestsMutex);
-				auto it = activeRequests.find(requestId);
-				if (it != activeRequests.end())
-				{
-					requestLine = it->second.line;
-					requestCharacter = it->second.character;
-					activeRequests.erase(it); // Clean up completed request
-				}
-			}
-
 			parseCompletionResult(j["result"], requestLine, requestCharacter);
-			return true;
+			return;
 		}
 
 		// Handle missing result
 		std::cout << "\033[31mLSP Autocomplete:\033[0m Response missing "
 					 "'result' field."
 				  << std::endl;
-		// Clean up failed request
-		{
-			std::lock_guard<std::mutex> lock(activeRequestsMutex);
-			activeRequests.erase(requestId);
-		}
+		cache.valid = false;
 		currentCompletionItems.clear();
 		showCompletions = false;
-		return true;
 	} catch (const json::exception &e)
 	{
 		std::cerr << "\033[31mLSP Autocomplete:\033[0m JSON error: " << e.what()
 				  << std::endl;
-		// Clean up failed request
-		{
-			std::lock_guard<std::mutex> lock(activeRequestsMutex);
-			activeRequests.erase(requestId);
-		}
+		cache.valid = false;
 		currentCompletionItems.clear();
 		showCompletions = false;
-		return true;
 	}
 }
 
@@ -772,8 +692,7 @@ bool LSPAutocomplete::shouldIncludeCompletion(const CompletionDisplayItem& item,
 }
 
 void LSPAutocomplete::prioritizeCompletions(std::vector<CompletionDisplayItem>& items, 
-                                           CompletionContext context,
-                                           const std::string& currentWord) {
+                                           CompletionContext context) {
     for (auto& item : items) {
         std::string priorityPrefix = "Z"; // Default low priority
         
@@ -811,23 +730,7 @@ void LSPAutocomplete::prioritizeCompletions(std::vector<CompletionDisplayItem>&
                 break;
         }
         
-        // Exact match boost (highest priority)
-        if (!currentWord.empty()) {
-            if (item.label.substr(0, currentWord.length()) == currentWord) {
-                priorityPrefix = "!" + priorityPrefix; // Exact match
-            } else {
-                // Case-insensitive prefix match
-                std::string labelLower = item.label;
-                std::transform(labelLower.begin(), labelLower.end(), labelLower.begin(), ::tolower);
-                std::string currentWordLower = currentWord;
-                std::transform(currentWordLower.begin(), currentWordLower.end(), currentWordLower.begin(), ::tolower);
-                
-                if (labelLower.substr(0, currentWordLower.length()) == currentWordLower) {
-                    priorityPrefix = "@" + priorityPrefix; // Case-insensitive match
-                }
-            }
-        }
-        
+        // How well the typed word matches is scored when filtering
         item.sortText = priorityPrefix + item.sortText;
     }
 }
@@ -894,12 +797,14 @@ void LSPAutocomplete::parseCompletionResult(const json &result,
         std::cout << "\033[33mLSP Autocomplete:\033[0m No completions found "
                      "(result is null)."
                   << std::endl;
+        cache.valid = false;
         currentCompletionItems.clear();
         showCompletions = false;
         return;
     } else {
         std::cout << "\033[31mLSP Autocomplete:\033[0m Unexpected result format: "
                   << result.type_name() << std::endl;
+        cache.valid = false;
         currentCompletionItems.clear();
         showCompletions = false;
         return;
@@ -908,77 +813,15 @@ void LSPAutocomplete::parseCompletionResult(const json &result,
     std::cout << "\033[32mFound " << items_json.size() << " completions"
               << (is_incomplete ? " (incomplete list)" : "") << ":\033[0m" << std::endl;
 
-    // Use the original request coordinates that were sent to server
-    int currentLine = requestLine;
-    int currentChar = requestCharacter;
-
-    // Calculate the original cursor position when the request was made
-    int request_cursor_pos = -1;
-    if (currentLine >= 0 && currentLine < editor_state.editor_content_lines.size()) {
-        int line_start = editor_state.editor_content_lines[currentLine];
-        request_cursor_pos = line_start + currentChar;
-
-        // Bounds check to ensure we don't exceed file content
-        if (request_cursor_pos < 0 || request_cursor_pos > editor_state.fileContent.size()) {
-            request_cursor_pos = editor_state.cursor_index;
-            auto [line, character] = getLineAndCharFromIndex(request_cursor_pos);
-            currentLine = line;
-            currentChar = character;
-        }
-    } else {
-        // Fallback to current cursor if coordinates are invalid
-        request_cursor_pos = editor_state.cursor_index;
-        auto [line, character] = getLineAndCharFromIndex(request_cursor_pos);
-        currentLine = line;
-        currentChar = character;
-    }
-
-    // Find the start of the current word for filtering purposes
-    std::string currentWord;
-    int word_start = request_cursor_pos;
-
-    // Smart word boundary detection for property access
-    bool isPropertyAccess = false;
-    int lastAccessorPos = -1;
-
-    // Look backwards to find the last '.' or ':'
-    for (int i = request_cursor_pos - 1; i >= 0; i--) {
-        char c = editor_state.fileContent[i];
-        if (c == '.' || c == ':') {
-            lastAccessorPos = i;
-            isPropertyAccess = true;
-            break;
-        }
-        if (!isalnum(c) && c != '_') break; // stop on non-identifier
-    }
-
-    if (isPropertyAccess && lastAccessorPos != -1) {
-        // word starts after the last accessor
-        word_start = lastAccessorPos + 1;
-    } else {
-        const std::string additionalWordChars = ":$#@";
-        while (word_start > 0) {
-            char c = editor_state.fileContent[word_start - 1];
-            if (!(isalnum(c) || c == '_' || additionalWordChars.find(c) != std::string::npos))
-                break;
-            word_start--;
+    // Detect completion context where the request was made
+    int request_cursor_pos = editor_state.cursor_index;
+    if (requestLine >= 0 && requestLine < editor_state.editor_content_lines.size()) {
+        int pos = editor_state.editor_content_lines[requestLine] + requestCharacter;
+        if (pos >= 0 && pos <= editor_state.fileContent.size()) {
+            request_cursor_pos = pos;
         }
     }
-
-    if (word_start < request_cursor_pos && word_start >= 0 &&
-        request_cursor_pos <= editor_state.fileContent.size()) {
-        currentWord =
-            editor_state.fileContent.substr(word_start, request_cursor_pos - word_start);
-    }
-
-    // Detect completion context
     CompletionContext context = detectCompletionContext(request_cursor_pos);
-    
-    // Debug output for context detection
-    const char* contextNames[] = {"Global", "PropertyAccess", "FunctionCall", 
-                                 "TableAccess", "StringMethod", "Unknown"};
-    std::cout << "Completion context: " << contextNames[static_cast<int>(context)] 
-              << ", current word: '" << currentWord << "'" << std::endl;
 
     // Use a map to deduplicate completions while preserving the best one
     std::unordered_map<std::string, CompletionDisplayItem> uniqueItems;
@@ -1035,12 +878,10 @@ void LSPAutocomplete::parseCompletionResult(const json &result,
                 // According to LSP spec, when no textEdit is provided, the
                 // completion replaces from the start of the current word to the
                 // cursor position
-                auto [wordStartLine, wordStartChar] = getLineAndCharFromIndex(word_start);
-
-                newItem.startLine = wordStartLine;
-                newItem.startChar = wordStartChar;
-                newItem.endLine = currentLine;
-                newItem.endChar = currentChar;
+                newItem.startLine = cache.line;
+                newItem.startChar = cache.character;
+                newItem.endLine = requestLine;
+                newItem.endChar = requestCharacter;
 
                 // Get insert text from either insertText or label
                 if (item_json.contains("insertText") &&
@@ -1048,89 +889,146 @@ void LSPAutocomplete::parseCompletionResult(const json &result,
                     newItem.insertText = item_json["insertText"].get<std::string>();
 					newItem.insertText = cleanSnippetFormatting(newItem.insertText);
                 } else {
-					newItem.insertText = cleanSnippetFormatting(newItem.insertText);
                     newItem.insertText = newItem.label;
                 }
             }
 
             // Apply context-aware filtering
             if (shouldIncludeCompletion(newItem, context)) {
-                // Apply prioritization scoring
-                std::string priorityPrefix = "Z"; // Default low priority
-                
-                // Context-based prioritization
-                switch (context) {
-                    case CompletionContext::PropertyAccess:
-                        if (newItem.kind == 2) priorityPrefix = "A"; // Functions first
-                        else if (newItem.kind == 5) priorityPrefix = "B"; // Properties second
-                        break;
-                        
-                    case CompletionContext::FunctionCall:
-                        if (newItem.kind == 2) priorityPrefix = "A"; // Functions
-                        else if (newItem.kind == 3) priorityPrefix = "B"; // Constructors
-                        break;
-                        
-                    case CompletionContext::Global:
-                        // Prioritize keywords and common patterns for Roblox
-                        if (newItem.label == "function" || newItem.label == "local" || 
-                            newItem.label == "game" || newItem.label == "workspace") {
-                            priorityPrefix = "A";
-                        } else if (newItem.label.find("local ") == 0) {
-                            priorityPrefix = "B";
-                        } else if (newItem.label == "print") {
-                            priorityPrefix = "C";
-                        }
-                        break;
-                        
-                    case CompletionContext::StringMethod:
-                        // Prioritize common string methods
-                        if (newItem.label == "sub" || newItem.label == "find") {
-                            priorityPrefix = "A";
-                        } else if (newItem.label == "gsub" || newItem.label == "match") {
-                            priorityPrefix = "B";
-                        }
-                        break;
-                        
-                    default:
-                        break;
-                }
-                
-                // Exact match boost (highest priority)
-                if (!currentWord.empty()) {
-                    if (newItem.label.substr(0, currentWord.length()) == currentWord) {
-                        priorityPrefix = "!" + priorityPrefix; // Exact match
-                    } else {
-                        // Case-insensitive prefix match
-                        std::string labelLower = newItem.label;
-                        std::transform(labelLower.begin(), labelLower.end(), labelLower.begin(), ::tolower);
-                        std::string currentWordLower = currentWord;
-                        std::transform(currentWordLower.begin(), currentWordLower.end(), currentWordLower.begin(), ::tolower);
-                        
-                        if (labelLower.substr(0, currentWordLower.length()) == currentWordLower) {
-                            priorityPrefix = "@" + priorityPrefix; // Case-insensitive match
-                        } else if (labelLower.find(currentWordLower) != std::string::npos) {
-                            priorityPrefix = "#" + priorityPrefix; // Contains match
-                        }
-                    }
-                }
-                
-                newItem.sortText = priorityPrefix + newItem.sortText;
                 uniqueItems[uniqueKey] = newItem;
             }
         }
     }
 
-    // Convert map to vector
-    currentCompletionItems.clear();
-    currentCompletionItems.reserve(uniqueItems.size());
+    // The list stays cached for the keystrokes that follow
+    cache.items.clear();
+    cache.items.reserve(uniqueItems.size());
     for (const auto &pair : uniqueItems) {
-        currentCompletionItems.push_back(pair.second);
+        cache.items.push_back(pair.second);
     }
+    prioritizeCompletions(cache.items, context);
+    cache.requestCharacter = requestCharacter;
+    cache.incomplete = is_incomplete;
+    cache.valid = true;
+
+    // The user may have typed on while the server answered
+    filterCompletions();
+}
+
+int LSPAutocomplete::findWordStart(int cursorPos) const
+{
+    int word_start = cursorPos;
 
-    // Sort completions using our enhanced sortText
+    // Smart word boundary detection for property access
+    for (int i = cursorPos - 1; i >= 0; i--) {
+        char c = editor_state.fileContent[i];
+        if (c == '.' || c == ':') {
+            // word starts after the last accessor
+            return i + 1;
+        }
+        if (!isalnum(c) && c != '_') break; // stop on non-identifier
+    }
+
+    const std::string additionalWordChars = ":$#@";
+    while (word_start > 0) {
+        char c = editor_state.fileContent[word_start - 1];
+        if (!(isalnum(c) || c == '_' || additionalWordChars.find(c) != std::string::npos))
+            break;
+        word_start--;
+    }
+    return word_start;
+}
+
+namespace {
+
+// How well word matches label as a case-insensitive subsequence, higher is
+// better; -1 when it does not match. Matches at the start, at word
+// boundaries and in runs score more; gaps and leftover length cost a
+// little, so among equal matches the shorter label wins.
+float fuzzyScore(const std::string &word, const std::string &label)
+{
+    if (word.empty()) {
+        return 0.0f;
+    }
+    auto lower = [](char c) { return (c >= 'A' && c <= 'Z') ? char(c - 'A' + 'a') : c; };
+
+    float score = 0.0f;
+    size_t matched = 0;
+    int previous = -1;
+    for (size_t i = 0; i < label.size() && matched < word.size(); ++i) {
+        char l = label[i];
+        char w = word[matched];
+        if (lower(l) != lower(w)) {
+            continue;
+        }
+        float bonus = 1.0f;
+        if (i == 0) {
+            bonus += 8.0f;
+        } else {
+            char before = label[i - 1];
+            bool boundary = !isalnum((unsigned char)before) ||
+                            (islower((unsigned char)before) && isupper((unsigned char)l));
+            if (boundary) {
+                bonus += 6.0f;
+            }
+        }
+        if (previous >= 0 && previous == int(i) - 1) {
+            bonus += 4.0f;
+        }
+        if (l == w) {
+            bonus += 1.0f;
+        }
+        int gap = previous < 0 ? int(i) : int(i) - previous - 1;
+        score += bonus - 0.5f * float(std::min(gap, 3));
+        previous = int(i);
+        ++matched;
+    }
+    if (matched < word.size()) {
+        return -1.0f;
+    }
+    return score - 0.05f * float(label.size() - word.size());
+}
+
+} // namespace
+
+void LSPAutocomplete::filterCompletions()
+{
+    int cursor = editor_state.cursor_index;
+    int wordStart = findWordStart(cursor);
+    auto [anchorLine, anchorChar] = getLineAndCharFromIndex(wordStart);
+    auto [line, character] = getLineAndCharFromIndex(cursor);
+    if (!cache.valid || anchorLine != cache.line || anchorChar != cache.character) {
+        // The cursor left the word the list is for
+        currentCompletionItems.clear();
+        showCompletions = false;
+        return;
+    }
+    std::string currentWord = editor_state.fileContent.substr(wordStart, cursor - wordStart);
+
+    currentCompletionItems.clear();
+    for (const auto &item : cache.items) {
+        float score = fuzzyScore(currentWord, item.label);
+        if (score < 0.0f) {
+            continue;
+        }
+        currentCompletionItems.push_back(item);
+        CompletionDisplayItem &shown = currentCompletionItems.back();
+        shown.score = score;
+        // Ranges that ended where the list was asked for now end at the
+        // cursor, so the word typed since is replaced too
+        if (shown.endLine == cache.line && shown.endChar == cache.requestCharacter) {
+            shown.endLine = line;
+            shown.endChar = character;
+        }
+    }
+
+    // Best match first, the server's and the context's order among equals
     std::sort(currentCompletionItems.begin(),
               currentCompletionItems.end(),
               [](const CompletionDisplayItem &a, const CompletionDisplayItem &b) {
+                  if (a.score != b.score) {
+                      return a.score > b.score;
+                  }
                   return a.sortText < b.sortText;
               });
 
@@ -1140,33 +1038,11 @@ void LSPAutocomplete::parseCompletionResult(const json &result,
         currentCompletionItems.resize(MAX_COMPLETIONS);
     }
 
-    // Debug output for filtered results
-    std::cout << "Filtered to " << currentCompletionItems.size() << " relevant completions:" << std::endl;
-    for (size_t i = 0; i < std::min(currentCompletionItems.size(), size_t(5)); ++i) {
-        const auto& item = currentCompletionItems[i];
-        std::cout << "  " << item.sortText << " - " << item.label 
-                  << " (kind: " << item.kind << ")" << std::endl;
-    }
-    if (currentCompletionItems.size() > 5) {
-        std::cout << "  ... and " << (currentCompletionItems.size() - 5) << " more" << std::endl;
-    }
-
     // Update UI state
     if (!currentCompletionItems.empty()) {
         updatePopupPosition();
         showCompletions = true;
         selectedCompletionIndex = 0;
-        
-        // Auto-select the best match if we have an exact prefix match
-        if (!currentWord.empty()) {
-            for (size_t i = 0; i < currentCompletionItems.size(); ++i) {
-                const auto& item = currentCompletionItems[i];
-                if (item.label.substr(0, currentWord.length()) == currentWord) {
-                    selectedCompletionIndex = i;
-                    break;
-                }
-            }
-        }
     } else {
         showCompletions = false;
     }
@@ -1192,13 +1068,13 @@ void LSPAutocomplete::updatePopupPosition()
 			lastPositionUpdate == std::chrono::steady_clock::time_point::min())
 		{
 
-			int cursor_line = gEditor.getLineFromPos(editor_state.cursor_index);
+			size_t cursor_row = gEditorWrap.rowOfPosition(editor_state.cursor_index);
 			float cursor_x = gEditorCursor.getCursorXPosition(editor_state.text_pos,
 															  editor_state.fileContent,
 															  editor_state.cursor_index);
 			completionPopupPos = editor_state.text_pos;
 			completionPopupPos.x = cursor_x;
-			completionPopupPos.y += cursor_line * editor_state.line_height;
+			completionPopupPos.y += cursor_row * editor_state.line_height;
 
 			// Cache the new position and timestamp
 			lastPopupPos = completionPopupPos;
@@ -5,26 +5,13 @@
 #include "../editor/editor_cursor.h"
 #include "../lib/json.hpp"
 #include "imgui.h"
-#include <atomic>
 #include <chrono>
-#include <condition_variable>
-#include <mutex>
-#include <queue>
 #include <string>
-#include <thread>
 #include <unordered_map>
 #include <vector>
 
 using json = nlohmann::json;
 
-struct CompletionRequest
-{
-	std::string filePath;
-	int line;
-	int character;
-	int requestId;
-};
-
 struct CompletionDisplayItem
 {
 	std::string label;
@@ -46,6 +33,10 @@ class LSPAutocomplete
 	~LSPAutocomplete();
 
 	void requestCompletion(const std::string &filePath, int line, int character);
+	// Keys the open popup takes, handled before the editor sees them
+	void processInput();
+	// Drawn after the editor handled its input, so a list filtered by the
+	// keystroke shows in the same frame
 	void renderCompletions();
 
 	bool showCompletions = false;
@@ -63,15 +54,25 @@ class LSPAutocomplete
 
   private:
 	std::vector<CompletionDisplayItem> currentCompletionItems;
-	std::queue<CompletionRequest> requestQueue;
-	std::mutex queueMutex;
-	std::condition_variable queueCondition;
-	std::atomic<bool> shouldStop{false};
-	std::thread workerThread;
-
-	// Track active requests to preserve original coordinates
-	std::unordered_map<int, CompletionRequest> activeRequests;
-	std::mutex activeRequestsMutex;
+	// Counts requests, so responses to all but the newest are dropped
+	int latestRequest = 0;
+	bool requestInFlight = false;
+
+	// The server's last list, kept while the user types the identifier it
+	// was asked for and filtered locally on each keystroke. Only an
+	// incomplete list or a new anchor goes back to the server.
+	struct CompletionCache
+	{
+		// Anchor: where the identifier being completed starts
+		std::string filePath;
+		int line = -1;
+		int character = -1;
+		// Where the request was made; items' ranges end there
+		int requestCharacter = -1;
+		bool incomplete = false;
+		bool valid = false;
+		std::vector<CompletionDisplayItem> items; // context-filtered, unranked
+	} cache;
 
 	// Position caching for smooth menu updates
 	ImVec2 lastPopupPos;
@@ -90,14 +91,18 @@ class LSPAutocomplete
 
 	// requesting logic
 	std::string cleanSnippetFormatting(const std::string& text);
-	std::string formCompletionRequest(int requestId,
-									  const std::string &filePath,
-									  int line,
-									  int character);
-	bool processResponse(const std::string &response, int requestId);
+	std::string formCompletionParams(const std::string &filePath,
+									 int line,
+									 int character,
+									 bool forIncomplete = false);
+	void processResponse(const std::string &response, int requestLine, int requestCharacter);
 	void parseCompletionResult(const json &result, int requestLine, int requestCharacter);
+	// Start of the identifier that ends at cursorPos, or after its '.'/':'
+	int findWordStart(int cursorPos) const;
+	// Scores the cached items against the word typed since the anchor and
+	// shows the best; hides the list once the cursor left that word
+	void filterCompletions();
 	void updatePopupPosition();
-	void workerFunction(); // New method for background thread
 
 	void
 	insertText(int row_start, int col__start, int row_end, int col__end, std::string text);
@@ -107,20 +112,8 @@ class LSPAutocomplete
 		if (editor_state.editor_content_lines.empty() || index < 0)
 			return {0, 0};
 
-		// Find the line containing this index
-		int line = 0;
-		for (; line < static_cast<int>(editor_state.editor_content_lines.size()); ++line)
-		{
-			if (editor_state.editor_content_lines[line] > index)
-			{
-				break;
-			}
-		}
-		line = std::max(0, line - 1);
-
-		// Calculate character position within line
-		int line_start = editor_state.editor_content_lines[line];
-		return {line, index - line_start};
+		int line = static_cast<int>(editor_state.editor_content_lines.lineFromOffset(index));
+		return {line, index - editor_state.editor_content_lines[line]};
 	}
 
 	
@@ -138,8 +131,7 @@ class LSPAutocomplete
 		// Context-aware filtering and prioritization
 		bool shouldIncludeCompletion(const CompletionDisplayItem& item, CompletionContext context);
 		void prioritizeCompletions(std::vector<CompletionDisplayItem>& items, 
-								CompletionContext context,
-								const std::string& currentWord);
+								CompletionContext context);
 		void insertCompletion(const CompletionDisplayItem& item);
 		
 		// Enhanced UI rendering
@@ -156,7 +148,7 @@ class LSPAutocomplete
     CompletionContext detectCompletionContext(int cursorPos) {
         if (cursorPos <= 0) return CompletionContext::Global;
         
-        std::string content = editor_state.fileContent;
+        const TextBuffer &content = editor_state.fileContent;
         
         // Look backwards from cursor to determine context
         for (int i = cursorPos - 1; i >= 0; i--) {
@@ -0,0 +1,213 @@
+/*
+	File: lsp_connection.cpp
+	Description: JSON-RPC dispatch for one language server.
+*/
+
+#include "lsp_connection.h"
+#include "lsp_json_scan.h"
+
+#include <iostream>
+#include <string_view>
+
+namespace {
+
+// Ids are unique across servers. Adapters use small fixed ids for their
+// initialize and shutdown requests, so these start well above them.
+std::atomic<int64_t> nextRequestId{10000};
+
+std::string makeMessage(int64_t id, const std::string &method, const std::string &params)
+{
+	std::string message = R"({"jsonrpc":"2.0",)";
+	if (id >= 0)
+	{
+		message += R"("id":)" + std::to_string(id) + ",";
+	}
+	return message + R"("method":")" + method + R"(","params":)" + params + "}";
+}
+
+// Parses the id of a response, false for string ids, which this client
+// never sends
+bool parseId(std::string_view raw, int64_t &id)
+{
+	if (raw.empty())
+	{
+		return false;
+	}
+	id = 0;
+	for (char c : raw)
+	{
+		if (c < '0' || c > '9')
+		{
+			return false;
+		}
+		id = id * 10 + (c - '0');
+	}
+	return true;
+}
+
+} // namespace
+
+LSPConnection::LSPConnection(Reader reader, Writer writer)
+	: reader(std::move(reader)), writer(std::move(writer))
+{
+	readerRunning = true;
+	readerThread = std::thread(&LSPConnection::readerLoop, this);
+}
+
+LSPConnection::~LSPConnection() { stop(); }
+
+bool LSPConnection::request(const std::string &method,
+							const std::string &params,
+							Handler handler)
+{
+	int64_t id = nextRequestId++;
+	{
+		std::lock_guard<std::mutex> lock(mutex);
+		handlers[id] = std::move(handler);
+	}
+	if (!send(makeMessage(id, method, params)))
+	{
+		std::lock_guard<std::mutex> lock(mutex);
+		handlers.erase(id);
+		return false;
+	}
+	return true;
+}
+
+std::future<std::string> LSPConnection::request(const std::string &method,
+												const std::string &params)
+{
+	int64_t id = nextRequestId++;
+	std::future<std::string> response;
+	{
+		std::lock_guard<std::mutex> lock(mutex);
+		response = promises[id].get_future();
+	}
+	if (!send(makeMessage(id, method, params)))
+	{
+		// Unless the reader failed it already when it stopped
+		std::lock_guard<std::mutex> lock(mutex);
+		if (auto promise = promises.find(id); promise != promises.end())
+		{
+			promise->second.set_value("");
+			promises.erase(promise);
+		}
+	}
+	return response;
+}
+
+bool LSPConnection::notify(const std::string &method, const std::string &params)
+{
+	return send(makeMessage(-1, method, params));
+}
+
+bool LSPConnection::send(const std::string &message)
+{
+	if (!readerRunning)
+	{
+		return false;
+	}
+	std::lock_guard<std::mutex> lock(writeMutex);
+	return writer(message);
+}
+
+void LSPConnection::dispatch(const Handler &onServerMessage)
+{
+	std::deque<std::pair<Handler, std::string>> ready;
+	std::deque<std::string> received;
+	{
+		std::lock_guard<std::mutex> lock(mutex);
+		ready.swap(responses);
+		received.swap(serverMessages);
+	}
+	// Handlers may send requests of their own, so none runs under the lock
+	for (auto &[handler, response] : ready)
+	{
+		try
+		{
+			handler(response);
+		} catch (const std::exception &e)
+		{
+			std::cerr << "\033[31mLSP:\033[0m Response handler failed: " << e.what()
+					  << std::endl;
+		}
+	}
+	for (const std::string &message : received)
+	{
+		onServerMessage(message);
+	}
+}
+
+void LSPConnection::stop()
+{
+	stopping = true;
+	if (readerThread.joinable())
+	{
+		readerThread.join();
+	}
+	failPending();
+}
+
+void LSPConnection::readerLoop()
+{
+	while (!stopping)
+	{
+		std::string message = reader();
+		if (message.empty())
+		{
+			break; // the server exited or closed its pipe
+		}
+		route(std::move(message));
+	}
+	readerRunning = false;
+	failPending();
+}
+
+void LSPConnection::route(std::string message)
+{
+	// Only the top level is looked at; params and results are skipped over
+	JsonScanner scanner(message);
+	std::string_view raw_id;
+	bool has_method = false;
+	bool ok = scanner.readObject([&](std::string_view key) {
+		if (key == "id")
+		{
+			return scanner.skipValue(&raw_id);
+		}
+		has_method = has_method || key == "method";
+		return scanner.skipValue();
+	});
+
+	std::lock_guard<std::mutex> lock(mutex);
+	int64_t id = 0;
+	if (!ok || has_method || !parseId(raw_id, id))
+	{
+		serverMessages.push_back(std::move(message));
+		return;
+	}
+	if (auto handler = handlers.find(id); handler != handlers.end())
+	{
+		responses.emplace_back(std::move(handler->second), std::move(message));
+		handlers.erase(handler);
+	} else if (auto promise = promises.find(id); promise != promises.end())
+	{
+		promise->second.set_value(std::move(message));
+		promises.erase(promise);
+	}
+	// Anything else answers a request nobody waits for anymore
+}
+
+void LSPConnection::failPending()
+{
+	std::lock_guard<std::mutex> lock(mutex);
+	for (auto &[id, handler] : handlers)
+	{
+		responses.emplace_back(std::move(handler), std::string());
+	}
+	handlers.clear();
+	for (auto &[id, promise] : promises)
+	{
+		promise.set_value("");
+	}
+	promises.clear();
+}
@@ -0,0 +1,77 @@
+/*
+	File: lsp_connection.h
+	Description: JSON-RPC dispatch for one language server.
+
+	A reader thread takes every message the server sends and routes it by
+	id: a response goes to the handler or future of the request it answers,
+	and anything the server sends on its own, notifications and requests,
+	is queued. Handlers and queued messages are run on the main thread by
+	dispatch(), so feature modules send a request and carry on in their
+	handler instead of polling for the answer, and no message is lost to a
+	reader that was waiting for another id.
+*/
+
+#pragma once
+#include <atomic>
+#include <cstdint>
+#include <deque>
+#include <functional>
+#include <future>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <unordered_map>
+#include <utility>
+
+class LSPConnection
+{
+  public:
+	using Handler = std::function<void(const std::string &message)>;
+	// Blocks until the next message body, "" once the server is gone
+	using Reader = std::function<std::string()>;
+	using Writer = std::function<bool(const std::string &body)>;
+
+	LSPConnection(Reader reader, Writer writer);
+	~LSPConnection();
+	LSPConnection(const LSPConnection &) = delete;
+	LSPConnection &operator=(const LSPConnection &) = delete;
+
+	// Sends a request with a fresh id. handler gets the response, or "" if
+	// the server went away first, on the main thread from dispatch().
+	bool request(const std::string &method, const std::string &params, Handler handler);
+	// Same for worker threads, which wait for the response themselves
+	std::future<std::string> request(const std::string &method,
+									 const std::string &params);
+	bool notify(const std::string &method, const std::string &params);
+	// Writes a complete message as is
+	bool send(const std::string &message);
+
+	// Runs the handlers of the responses that arrived, then passes what the
+	// server sent on its own to onServerMessage. Main thread only.
+	void dispatch(const Handler &onServerMessage);
+
+	// Joins the reader. The server must be gone or its pipe closed first,
+	// so that the read the thread waits in returns.
+	void stop();
+	bool running() const { return readerRunning; }
+
+  private:
+	void readerLoop();
+	void route(std::string message);
+	// Answers everything still waiting with "", the server is gone
+	void failPending();
+
+	Reader reader;
+	Writer writer;
+	std::mutex writeMutex; // one message at a time on the pipe
+
+	std::mutex mutex; // guards everything below
+	std::unordered_map<int64_t, Handler> handlers;
+	std::unordered_map<int64_t, std::promise<std::string>> promises;
+	std::deque<std::pair<Handler, std::string>> responses; // for dispatch()
+	std::deque<std::string> serverMessages;
+
+	std::atomic<bool> stopping{false};
+	std::atomic<bool> readerRunning{false};
+	std::thread readerThread;
+};
@@ -5,3 +5,4 @@ LSPAutocomplete gLSPAutocomplete;
 LSPGotoDef      gLSPGotoDef;
 LSPGotoRef      gLSPGotoRef;
 LSPSymbolInfo   gLSPSymbolInfo;
+LSPSemanticTokens gLSPSemanticTokens;
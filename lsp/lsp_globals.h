@@ -3,6 +3,7 @@
 #include "lsp_autocomplete.h"
 #include "lsp_goto_def.h"
 #include "lsp_goto_ref.h"
+#include "lsp_semantic_tokens.h"
 #include "lsp_symbol_info.h"
 
 extern EditorLSP       gEditorLSP;
@@ -10,3 +11,4 @@ extern LSPAutocomplete gLSPAutocomplete;
 extern LSPGotoDef      gLSPGotoDef;
 extern LSPGotoRef      gLSPGotoRef;
 extern LSPSymbolInfo   gLSPSymbolInfo;
+extern LSPSemanticTokens gLSPSemanticTokens;
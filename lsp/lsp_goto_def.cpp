@@ -3,6 +3,7 @@
 #include "../editor/editor_line_jump.h" // Access to gEditorScroll
 #include "editor_scroll.h"
 #include "files.h"	 // Access to gFileExplorer
+#include "lsp_utils.h"
 #include <algorithm> // For std::min, std::max
 #include <cstdio>
 #include <iostream>
@@ -11,20 +12,11 @@
 
 using json = nlohmann::json;
 
-LSPGotoDef::LSPGotoDef()
-	: currentRequestId(2000), showDefinitionOptions(false), selectedDefinitionIndex(0)
-{
-}
+LSPGotoDef::LSPGotoDef() : showDefinitionOptions(false), selectedDefinitionIndex(0) {}
 LSPGotoDef::~LSPGotoDef() = default;
 
 bool LSPGotoDef::gotoDefinition(const std::string &filePath, int line, int character)
 {
-	if (!gLSPManager.isInitialized())
-	{
-		std::cout << "\033[31mLSP GotoDef:\033[0m Not initialized" << std::endl;
-		return false;
-	}
-
 	if (!gLSPManager.selectAdapterForFile(filePath))
 	{
 		std::cout << "\033[31mLSP GotoDef:\033[0m No LSP adapter available for file: "
@@ -32,95 +24,41 @@ bool LSPGotoDef::gotoDefinition(const std::string &filePath, int line, int chara
 		return false;
 	}
 
-	int requestId = getNextRequestId();
-	std::cout << "\033[35mLSP GotoDef:\033[0m Requesting definition at line " << line
-			  << ", char " << character << " (ID: " << requestId << ")" << std::endl;
-
-	std::string request = std::string(R"({
-            "jsonrpc": "2.0",
-            "id": )" + std::to_string(requestId) +
-									  R"(,
-            "method": "textDocument/definition",
-            "params": {
-                "textDocument": {
-                    "uri": "file://)" +
-									  filePath +
-									  R"("
-                },
-                "position": {
-                    "line": )" + std::to_string(line) +
-									  R"(,
-                    "character": )" + std::to_string(character) +
-									  R"(
-                }
-            }
-        })");
-
-	if (!gLSPManager.sendRequest(request))
+	if (!gLSPManager.isInitialized())
 	{
-		std::cout << "\033[31mLSP GotoDef:\033[0m Failed to send request" << std::endl;
+		std::cout << "\033[31mLSP GotoDef:\033[0m Not initialized" << std::endl;
 		return false;
 	}
 
-	const int MAX_ATTEMPTS = 15;
-	for (int attempt = 0; attempt < MAX_ATTEMPTS; attempt++)
-	{
-		std::cout << "\033[35mLSP GotoDef:\033[0m Waiting for definition "
-					 "response (attempt "
-				  << (attempt + 1) << ")" << std::endl;
+	std::cout << "\033[35mLSP GotoDef:\033[0m Requesting definition at line " << line
+			  << ", char " << character << std::endl;
 
-		int contentLength = 0;
-		std::string response = gLSPManager.readResponse(&contentLength);
+	json params = {{"textDocument", {{"uri", pathToFileUri(filePath)}}},
+				   {"position", {{"line", line}, {"character", character}}}};
 
-		if (response.empty())
-		{
-			std::cout << "\033[31mLSP GotoDef:\033[0m Empty response received"
-					  << std::endl;
-			if (attempt == MAX_ATTEMPTS - 1)
+	// The options window opens from the handler once the server answered
+	bool sent = gLSPManager.request(
+		"textDocument/definition", params.dump(), [this](const std::string &response) {
+			if (response.empty())
 			{
-				std::cout << "\033[31mLSP GotoDef:\033[0m Timeout waiting for "
-							 "response."
+				std::cout << "\033[31mLSP GotoDef:\033[0m Server went away before "
+							 "answering."
 						  << std::endl;
-				return false;
+				return;
 			}
-			continue;
-		}
-
-		if (response.find("\"id\":" + std::to_string(requestId)) != std::string::npos)
-		{
-			std::cout << "\033[32mLSP GotoDef:\033[0m Received response for "
-						 "request ID "
-					  << requestId << std::endl;
-
-			parseDefinitionResponse(response); // Pass the raw response
-
-			if (showDefinitionOptions)
-			{
-				return true;
-			} else if (response.find("\"error\":") != std::string::npos)
+			parseDefinitionResponse(response);
+			if (!showDefinitionOptions && response.find("\"error\":") != std::string::npos)
 			{
 				std::cout << "\033[31mLSP GotoDef:\033[0m Error reported in "
 							 "server response."
 						  << std::endl;
-				return false; // Error from server
-			} else
-			{
-				std::cout << "\033[33mLSP GotoDef:\033[0m No definition "
-							 "locations found or parsed from the response."
-						  << std::endl;
-				return true;
 			}
-		}
-
-		std::cout << "\033[33mLSP GotoDef:\033[0m Received unrelated response. "
-					 "Continuing..."
-				  << std::endl;
+		});
+	if (!sent)
+	{
+		std::cout << "\033[31mLSP GotoDef:\033[0m Failed to send request" << std::endl;
 	}
-
-	std::cout << "\033[31mLSP GotoDef:\033[0m Exceeded maximum attempts "
-				 "waiting for response ID "
-			  << requestId << std::endl;
-	return false;
+	return sent;
 }
 
 void LSPGotoDef::parseDefinitionResponse(const std::string &response)
@@ -542,19 +480,9 @@ void LSPGotoDef::renderDefinitionOptions()
 					});
 				} else
 				{
-					int index = 0;
-					int currentLine = 0;
 					std::cout << "Calculating cursor position..." << std::endl;
-
-					while (currentLine < selected.startLine &&
-						   index < editor_state.fileContent.length())
-					{
-						if (editor_state.fileContent[index] == '\n')
-						{
-							currentLine++;
-						}
-						index++;
-					}
+					int index = static_cast<int>(
+						editor_state.fileContent.lineStart(selected.startLine));
 
 					index += selected.startChar;
 					index = std::min(index, (int)editor_state.fileContent.length());
@@ -26,7 +26,8 @@ class LSPGotoDef
 	LSPGotoDef();
 	~LSPGotoDef();
 
-	// Core goto definition functionality
+	// Core goto definition functionality. Returns once the request is sent,
+	// the options show when the response arrives.
 	bool gotoDefinition(const std::string &filePath, int line, int character);
 
 	// Definition options window (no changes needed in declaration)
@@ -42,10 +43,6 @@ class LSPGotoDef
 	void parseDefinitionResponse(const std::string &response);
 	// New helper to parse the array part of the response
 	void parseDefinitionArray(const json &results_array); // <<< ADDED DECLARATION
-	int getNextRequestId() { return ++currentRequestId; }
-
-	// Request tracking
-	int currentRequestId = 2000; // Start at different value than EditorLSP
 
 	// Definition options state (remains the same)
 	std::vector<DefinitionLocation> definitionLocations;
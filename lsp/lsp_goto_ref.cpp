@@ -2,27 +2,19 @@
 #include "../editor/editor.h"
 #include "../editor/editor_line_jump.h"
 #include "files.h"
+#include "lsp_utils.h"
 #include <algorithm> // For std::min
 #include <cstdio>
 #include <iostream>
 #include <sstream>
 #include <string>
 
-LSPGotoRef::LSPGotoRef()
-	: currentRequestId(3000), showReferenceOptions(false), selectedReferenceIndex(0)
-{
-}
+LSPGotoRef::LSPGotoRef() : showReferenceOptions(false), selectedReferenceIndex(0) {}
 
 LSPGotoRef::~LSPGotoRef() = default;
 
 bool LSPGotoRef::findReferences(const std::string &filePath, int line, int character)
 {
-	if (!gLSPManager.isInitialized())
-	{
-		std::cout << "\033[31mLSP FindRef:\033[0m Not initialized" << std::endl;
-		return false;
-	}
-
 	if (!gLSPManager.selectAdapterForFile(filePath))
 	{
 		std::cout << "\033[31mLSP FindRef:\033[0m No LSP adapter available for file: "
@@ -30,109 +22,51 @@ bool LSPGotoRef::findReferences(const std::string &filePath, int line, int chara
 		return false;
 	}
 
-	int requestId = getNextRequestId();
-	std::cout << "\033[35mLSP FindRef:\033[0m Requesting references at line " << line
-			  << ", char " << character << " (ID: " << requestId << ")" << std::endl;
-
-	std::string request = std::string(R"({
-        "jsonrpc": "2.0",
-        "id": )" + std::to_string(requestId) +
-									  R"(,
-        "method": "textDocument/references",
-        "params": {
-            "textDocument": {
-                "uri": "file://)" + filePath +
-									  R"("
-            },
-            "position": {
-                "line": )" + std::to_string(line) +
-									  R"(,
-                "character": )" + std::to_string(character) +
-									  R"(
-            },
-            "context": {
-                "includeDeclaration": false
-            }
-        }
-    })");
-
-	if (!gLSPManager.sendRequest(request))
+	if (!gLSPManager.isInitialized())
 	{
-		std::cout << "\033[31mLSP FindRef:\033[0m Failed to send request" << std::endl;
+		std::cout << "\033[31mLSP FindRef:\033[0m Not initialized" << std::endl;
 		return false;
 	}
 
-	const int MAX_ATTEMPTS = 15;
-	for (int attempt = 0; attempt < MAX_ATTEMPTS; attempt++)
-	{
-		std::cout << "\033[35mLSP FindRef:\033[0m Waiting for references "
-					 "response (attempt "
-				  << (attempt + 1) << ")" << std::endl;
+	std::cout << "\033[35mLSP FindRef:\033[0m Requesting references at line " << line
+			  << ", char " << character << std::endl;
 
-		int contentLength = 0;
-		std::string response = gLSPManager.readResponse(&contentLength);
+	json params = {{"textDocument", {{"uri", pathToFileUri(filePath)}}},
+				   {"position", {{"line", line}, {"character", character}}},
+				   {"context", {{"includeDeclaration", false}}}};
 
-		if (response.empty())
-		{
-			std::cout << "\033[31mLSP FindRef:\033[0m Empty response received"
-					  << std::endl;
-			if (attempt == MAX_ATTEMPTS - 1)
+	bool sent = gLSPManager.request(
+		"textDocument/references", params.dump(), [this](const std::string &response) {
+			if (response.find("\"result\":[") != std::string::npos)
 			{
-				std::cout << "\033[31mLSP FindRef:\033[0m Timeout waiting for "
-							 "response."
-						  << std::endl;
-				return false;
+				parseReferenceResponse(response);
+				return;
 			}
-			continue;
-		}
-
-		if (response.find("\"id\":" + std::to_string(requestId)) != std::string::npos)
-		{
-			std::cout << "\033[32mLSP FindRef:\033[0m Received response for "
-						 "request ID "
-					  << requestId << std::endl;
-
-			if (response.find("\"result\":[") != std::string::npos)
+			referenceLocations.clear();
+			showReferenceOptions = false;
+			if (response.empty())
 			{
-				std::cout << "\033[32mLSP FindRef:\033[0m Found result array."
+				std::cout << "\033[31mLSP FindRef:\033[0m Server went away before "
+							 "answering."
 						  << std::endl;
-				parseReferenceResponse(response); // Parse the array
-				return true;
 			} else if (response.find("\"result\":null") != std::string::npos)
 			{
 				std::cout << "\033[33mLSP FindRef:\033[0m No references found "
 							 "(result is null)."
 						  << std::endl;
-				referenceLocations.clear(); // Ensure list is empty
-				showReferenceOptions = false;
-				return true; // Successfully processed the response (no results)
-			} else if (response.find("\"error\":") != std::string::npos)
-			{
-				std::cout << "\033[31mLSP FindRef:\033[0m Error in response: " << response
-						  << std::endl;
-				referenceLocations.clear();
-				showReferenceOptions = false;
-				return false; // Indicate error
 			} else
 			{
-				std::cout << "\033[31mLSP FindRef:\033[0m Response for ID " << requestId
-						  << " has unexpected format: " << response << std::endl;
-				referenceLocations.clear();
-				showReferenceOptions = false;
-				return false; // Indicate unexpected format
+				std::cout << "\033[31mLSP FindRef:\033[0m Unexpected response: "
+						  << response << std::endl;
 			}
-		}
-
-		std::cout << "\033[33mLSP FindRef:\033[0m Received unrelated response. "
-					 "Continuing..."
-				  << std::endl;
+		});
+	if (!sent)
+	{
+		std::cout << "\033[31mLSP FindRef:\033[0m Failed to send request" << std::endl;
 	}
-
-	std::cout << "\033[31mLSP FindRef:\033[0m Exceeded maximum attempts "
-				 "waiting for response ID "
-			  << requestId << std::endl;
-	return false;
+	return sent;
 }
+
 void LSPGotoRef::parseReferenceResponse(const std::string &response)
 {
 	std::cout << "\033[36mLSP FindRef Raw Response:\033[0m\n>>>>>>>>>>\n"
@@ -524,17 +458,9 @@ void LSPGotoRef::handleReferenceSelection()
 		});
 	} else
 	{
-		int index = 0;
-		int currentLine = 0;
-		const std::string &content = editor_state.fileContent;
-
-		while (currentLine < selected.startLine && index < content.length())
-		{
-			if (content[index] == '\n')
-				currentLine++;
-			index++;
-		}
+		const TextBuffer &content = editor_state.fileContent;
 
+		int index = static_cast<int>(content.lineStart(selected.startLine));
 		index += selected.startChar;
 		index = std::min(index, static_cast<int>(content.length()));
 
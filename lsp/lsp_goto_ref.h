@@ -24,7 +24,8 @@ class LSPGotoRef
 	LSPGotoRef();
 	~LSPGotoRef();
 
-	// Core find references functionality
+	// Core find references functionality. The options show when the
+	// response arrives.
 	bool findReferences(const std::string &filePath, int line, int character);
 
 	// Reference options window rendering
@@ -38,10 +39,7 @@ class LSPGotoRef
   private:
 	// Helper methods
 	void parseReferenceResponse(const std::string &response);
-	int getNextRequestId() { return ++currentRequestId; }
 	void handleReferenceSelection();
-	// Request tracking (using a different range than LSPGotoDef)
-	int currentRequestId = 3000;
 
 	// Reference options state
 	std::vector<ReferenceLocation> referenceLocations;
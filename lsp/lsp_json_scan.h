@@ -0,0 +1,224 @@
+/*
+	File: lsp_json_scan.h
+	Description: Forward-only reader over the text of a JSON message, for
+	the few fields of LSP traffic that are read on every message or hold
+	large arrays of plain numbers.
+
+	Nothing is built for values that are skipped, so routing a message by
+	its id or reading a token array costs one pass over the text and no
+	allocation per element, where a JSON DOM allocates a node for each.
+*/
+
+#pragma once
+#include <cstddef>
+#include <cstdint>
+#include <string>
+#include <string_view>
+#include <vector>
+
+class JsonScanner
+{
+  public:
+	explicit JsonScanner(std::string_view text) : text(text) {}
+
+	// Calls onKey(key) for each key of an object, with the scanner at its
+	// value, which onKey must consume. False on malformed input.
+	template <typename Fn> bool readObject(Fn &&onKey)
+	{
+		if (!consume('{'))
+		{
+			return false;
+		}
+		if (consume('}'))
+		{
+			return true;
+		}
+		do
+		{
+			std::string key;
+			if (!readString(key) || !consume(':') || !onKey(std::string_view(key)))
+			{
+				return false;
+			}
+		} while (consume(','));
+		return consume('}');
+	}
+
+	// Calls onElement() at each element of an array, which it must consume
+	template <typename Fn> bool readArray(Fn &&onElement)
+	{
+		if (!consume('['))
+		{
+			return false;
+		}
+		if (consume(']'))
+		{
+			return true;
+		}
+		do
+		{
+			if (!onElement())
+			{
+				return false;
+			}
+		} while (consume(','));
+		return consume(']');
+	}
+
+	bool readNumbers(std::vector<uint32_t> &numbers)
+	{
+		return readArray([&]() {
+			uint32_t value = 0;
+			if (!readNumber(value))
+			{
+				return false;
+			}
+			numbers.push_back(value);
+			return true;
+		});
+	}
+
+	bool readNumber(uint32_t &value)
+	{
+		skipSpace();
+		size_t start = pos;
+		uint64_t number = 0;
+		for (; pos < text.size() && text[pos] >= '0' && text[pos] <= '9'; ++pos)
+		{
+			number = number * 10 + static_cast<uint64_t>(text[pos] - '0');
+			if (number > UINT32_MAX)
+			{
+				return false;
+			}
+		}
+		value = static_cast<uint32_t>(number);
+		return pos > start;
+	}
+
+	// Keys, ids and methods are plain ASCII, so of the escapes only \" and
+	// \\ are expected; any other is read as the char after the backslash.
+	bool readString(std::string &out)
+	{
+		if (!consume('"'))
+		{
+			return false;
+		}
+		out.clear();
+		for (; pos < text.size(); ++pos)
+		{
+			char c = text[pos];
+			if (c == '"')
+			{
+				++pos;
+				return true;
+			}
+			if (c == '\\' && ++pos < text.size())
+			{
+				c = text[pos];
+			}
+			out += c;
+		}
+		return false;
+	}
+
+	// Skips one value of any kind, and stores its text in raw when given
+	bool skipValue(std::string_view *raw = nullptr)
+	{
+		skipSpace();
+		size_t start = pos;
+		if (!skipOver())
+		{
+			return false;
+		}
+		if (raw)
+		{
+			*raw = text.substr(start, pos - start);
+		}
+		return true;
+	}
+
+	// Consumes null if it is next
+	bool readNull()
+	{
+		skipSpace();
+		if (text.compare(pos, 4, "null") == 0)
+		{
+			pos += 4;
+			return true;
+		}
+		return false;
+	}
+
+	bool consume(char c)
+	{
+		skipSpace();
+		if (pos < text.size() && text[pos] == c)
+		{
+			++pos;
+			return true;
+		}
+		return false;
+	}
+
+	void skipSpace()
+	{
+		while (pos < text.size() && (text[pos] == ' ' || text[pos] == '\n' ||
+									 text[pos] == '\r' || text[pos] == '\t'))
+		{
+			++pos;
+		}
+	}
+
+  private:
+	bool skipOver()
+	{
+		if (pos >= text.size())
+		{
+			return false;
+		}
+		char c = text[pos];
+		if (c == '"')
+		{
+			std::string ignored;
+			return readString(ignored);
+		}
+		if (c == '{' || c == '[')
+		{
+			// Brackets inside strings do not count
+			size_t depth = 0;
+			for (; pos < text.size(); ++pos)
+			{
+				c = text[pos];
+				if (c == '"')
+				{
+					std::string ignored;
+					if (!readString(ignored))
+					{
+						return false;
+					}
+					--pos;
+				} else if (c == '{' || c == '[')
+				{
+					++depth;
+				} else if ((c == '}' || c == ']') && --depth == 0)
+				{
+					++pos;
+					return true;
+				}
+			}
+			return false;
+		}
+		// Numbers and literals run up to the next delimiter
+		size_t start = pos;
+		while (pos < text.size() && text[pos] != ',' && text[pos] != '}' &&
+			   text[pos] != ']' && text[pos] != ' ' && text[pos] != '\n' &&
+			   text[pos] != '\r' && text[pos] != '\t')
+		{
+			++pos;
+		}
+		return pos > start;
+	}
+
+	std::string_view text;
+	size_t pos = 0;
+};
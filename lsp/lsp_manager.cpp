@@ -1,21 +1,72 @@
 #include "lsp_manager.h"
+#include "../lib/json.hpp"
+#include "lsp_adapter_clangd.h"
+#include "lsp_adapter_go.h"
+#include "lsp_adapter_luau.h"
+#include "lsp_adapter_pyright.h"
+#include "lsp_adapter_typescript.h"
 #include <iostream>
-// #include <sys/select.h> // Not strictly used here, can be removed if not
-// needed elsewhere by LSPManager
+#include <iterator>
+
+using json = nlohmann::json;
 
 // Global instance
 LSPManager gLSPManager;
 
-LSPManager::LSPManager() : activeAdapter(NONE)
+namespace {
+
+const char *adapterName(int type)
 {
-	// clangdAdapter = std::make_unique<LSPAdapterClangd>();
-	// pyrightAdapter = std::make_unique<LSPAdapterPyright>();
-	// typescriptAdapter = std::make_unique<LSPAdapterTypescript>();
-	// goAdapter = std::make_unique<LSPAdapterGo>(); // For Go
-	luauAdapter = std::make_unique<LSPAdapterLuau>(); // For Luau
+	static const char *names[] = {
+		"none", "clangd", "pyright", "typescript", "omnisharp", "gopls", "luau-lsp"};
+	return type >= 0 && type < int(std::size(names)) ? names[type] : "unknown";
 }
 
-LSPManager::~LSPManager() = default; // Relies on unique_ptr to clean up adapters
+} // namespace
+
+LSPManager::LSPManager()
+{
+	workerThread = std::thread(&LSPManager::workerFunction, this);
+}
+
+LSPManager::~LSPManager()
+{
+	// Starts not begun yet are dropped; one under way is waited for
+	std::deque<Job> left;
+	{
+		std::lock_guard<std::mutex> lock(queueMutex);
+		shouldStop = true;
+		left.swap(jobs);
+	}
+	queueCondition.notify_one();
+	if (workerThread.joinable())
+	{
+		workerThread.join();
+	}
+
+	std::vector<std::unique_ptr<Server>> running;
+	{
+		std::lock_guard<std::mutex> lock(serversMutex);
+		running.swap(servers);
+		for (Job &job : left)
+		{
+			if (job.stop)
+			{
+				running.push_back(std::move(job.stop));
+			}
+		}
+		for (std::unique_ptr<Server> &server : running)
+		{
+			server->starting = false;
+		}
+	}
+	serverStarted.notify_all();
+	activeServer = nullptr;
+	for (std::unique_ptr<Server> &server : running)
+	{
+		stopServer(*server);
+	}
+}
 
 bool LSPManager::initialize(const std::string &path)
 {
@@ -27,369 +78,495 @@ bool LSPManager::initialize(const std::string &path)
 		return false;
 	}
 
-	workspacePath = path; // Store for potential use by any adapter
-
-	// Only initialize the active adapter if it's not already initialized
-	bool success = false;
-
-	switch (activeAdapter)
-	{
-	// case CLANGD:
-	// 	if (!clangdAdapter->isInitialized())
-	// 	{
-	// 		success = clangdAdapter->initialize(workspacePath);
-	// 		if (success)
-	// 		{
-	// 			std::cout << "\033[32mLSP Manager:\033[0m Initialized clangd "
-	// 						 "adapter for "
-	// 					  << workspacePath << std::endl;
-	// 		} else
-	// 		{
-	// 			std::cout << "\033[33mLSP Manager:\033[0m Clangd adapter initialization "
-	// 						 "failed - "
-	// 						 "LSP support will be disabled for C/C++ files"
-	// 					  << std::endl;
-	// 			// Don't treat this as a fatal error - just disable LSP for this language
-	// 			success = false;
-	// 		}
-	// 	} else
-	// 	{
-	// 		std::cout << "\033[32mLSP Manager:\033[0m Clangd adapter already "
-	// 					 "initialized."
-	// 				  << std::endl;
-	// 		success = true; // Already initialized counts as success for this call
-	// 	}
-	// 	break;
-
-	// case PYRIGHT:
-	// 	if (!pyrightAdapter->isInitialized())
-	// 	{
-	// 		success = pyrightAdapter->initialize(workspacePath);
-	// 		if (success)
-	// 		{
-	// 			std::cout << "\033[32mLSP Manager:\033[0m Initialized pyright "
-	// 						 "adapter for "
-	// 					  << workspacePath << std::endl;
-	// 		} else
-	// 		{
-	// 			std::cout << "\033[33mLSP Manager:\033[0m Pyright adapter initialization "
-	// 						 "failed - "
-	// 						 "LSP support will be disabled for Python files"
-	// 					  << std::endl;
-	// 			// Don't treat this as a fatal error - just disable LSP for this language
-	// 			success = false;
-	// 		}
-	// 	} else
-	// 	{
-	// 		std::cout << "\033[32mLSP Manager:\033[0m Pyright adapter already "
-	// 					 "initialized."
-	// 				  << std::endl;
-	// 		success = true;
-	// 	}
-	// 	break;
-
-	// case TYPESCRIPT:
-	// 	if (!typescriptAdapter->isInitialized())
-	// 	{
-	// 		success = typescriptAdapter->initialize(workspacePath);
-	// 		if (success)
-	// 		{
-	// 			std::cout << "\033[32mLSP Manager:\033[0m Initialized "
-	// 						 "typescript adapter for "
-	// 					  << workspacePath << std::endl;
-	// 		} else
-	// 		{
-	// 			std::cout
-	// 				<< "\033[33mLSP Manager:\033[0m TypeScript adapter initialization "
-	// 				   "failed - "
-	// 				   "LSP support will be disabled for TypeScript/JavaScript files"
-	// 				<< std::endl;
-	// 			// Don't treat this as a fatal error - just disable LSP for this language
-	// 			success = false;
-	// 		}
-	// 	} else
-	// 	{
-	// 		std::cout << "\033[32mLSP Manager:\033[0m Typescript adapter "
-	// 					 "already initialized."
-	// 				  << std::endl;
-	// 		success = true;
-	// 	}
-	// 	break;
-
-	// case GOADAPTER: // For Go
-	// 	if (!goAdapter->isInitialized())
-	// 	{
-	// 		success = goAdapter->initialize(workspacePath);
-	// 		if (success)
-	// 		{
-	// 			std::cout << "\033[32mLSP Manager:\033[0m Initialized Go adapter for "
-	// 					  << workspacePath << std::endl;
-	// 		} else
-	// 		{
-	// 			std::cout
-	// 				<< "\033[33mLSP Manager:\033[0m Go adapter initialization failed - "
-	// 				   "LSP support will be disabled for Go files"
-	// 				<< std::endl;
-	// 			// Don't treat this as a fatal error - just disable LSP for this language
-	// 			success = false;
-	// 		}
-	// 	} else
-	// 	{
-	// 		std::cout << "\033[32mLSP Manager:\033[0m Go adapter already initialized."
-	// 				  << std::endl;
-	// 		success = true;
-	// 	}
-	// 	break;
-		
-	case LUAU: // For Luau
-		if (!luauAdapter->isInitialized())
-		{
-			success = luauAdapter->initialize(workspacePath);
-			if (success)
-			{
-				std::cout << "\033[32mLSP Manager:\033[0m Initialized Luau adapter for "
-						<< workspacePath << std::endl;
-			}
-			else
-			{
-				std::cout << "\033[33mLSP Manager:\033[0m Luau adapter initialization failed - "
-							"LSP support will be disabled for Luau files"
-						<< std::endl;
-				success = false;
-			}
-		}
-		else
+	{
+		std::lock_guard<std::mutex> lock(serversMutex);
+		workspacePath = path;
+		while (workspacePath.size() > 1 &&
+			   (workspacePath.back() == '/' || workspacePath.back() == '\\'))
 		{
-			std::cout << "\033[32mLSP Manager:\033[0m Luau adapter already initialized."
-					<< std::endl;
-			success = true;
+			workspacePath.pop_back();
 		}
-		break;
-	
-	case NONE:
-	default:
-		std::cerr << "\033[31mLSP Manager:\033[0m Cannot initialize, no active "
-					 "adapter selected or "
-					 "unknown type. Active adapter type: "
-				  << activeAdapter << std::endl;
-		return false;
 	}
 
-	return success;
+	// Files opened from now on get servers rooted here; the selected one is
+	// started right away if it is not running
+	std::lock_guard<std::mutex> lock(serversMutex);
+	if (!activeServer)
+	{
+		return false;
+	}
+	if (!activeServer->connection && !activeServer->starting)
+	{
+		startServer(*activeServer);
+	}
+	return usable(activeServer);
 }
 
 bool LSPManager::isInitialized() const
 {
-	switch (activeAdapter)
-	{
-	// case CLANGD:
-	// 	return clangdAdapter && clangdAdapter->isInitialized();
-	// case PYRIGHT:
-	// 	return pyrightAdapter && pyrightAdapter->isInitialized();
-	// case TYPESCRIPT:
-	// 	return typescriptAdapter && typescriptAdapter->isInitialized();
-	// case GOADAPTER: // For Go
-	// 	return goAdapter && goAdapter->isInitialized();
-	case LUAU:
-		return luauAdapter && luauAdapter->isInitialized();
-	case NONE:
-	default:
-		return false;
-	}
+	std::lock_guard<std::mutex> lock(serversMutex);
+	return usable(activeServer);
 }
 
-bool LSPManager::selectAdapterForFile(const std::string &filePath)
+bool LSPManager::usable(const Server *server)
+{
+	return server && (server->starting ||
+					  (server->connection && server->connection->running()));
+}
+
+LSPManager::AdapterType LSPManager::adapterTypeFor(const std::string &filePath)
 {
 	size_t dot_pos = filePath.find_last_of(".");
 	if (dot_pos == std::string::npos)
 	{
-		// No extension, decide if you want to deactivate or keep current.
-		// Deactivating might be safer.
-		// activeAdapter = NONE;
-		// std::cout << "\033[33mLSP Manager:\033[0m No file extension for '" <<
-		// filePath << "'. No adapter selected." << std::endl;
-		return false; // Or return true if you want to allow no adapter for
-					  // extensionless files
+		return NONE;
 	}
 
 	std::string ext = filePath.substr(dot_pos + 1);
-	AdapterType newAdapter = NONE;
-
 	if (ext == "c" || ext == "cpp" || ext == "cc" || ext == "cxx" || ext == "h" ||
 		ext == "hpp")
 	{
-		newAdapter = CLANGD;
+		return CLANGD;
 	} else if (ext == "py")
 	{
-		newAdapter = PYRIGHT;
+		return PYRIGHT;
 	} else if (ext == "ts" || ext == "tsx" || ext == "js" || ext == "jsx")
 	{
-		newAdapter = TYPESCRIPT;
+		return TYPESCRIPT;
 	} else if (ext == "cs") // For C#
 	{
-		newAdapter = OMNISHARP;
+		return OMNISHARP;
 	} else if (ext == "go") // For Go
 	{
-		newAdapter = GOADAPTER;
+		return GOADAPTER;
 	} else if (ext == "lua" || ext == "luau")
 	{
-		newAdapter = LUAU;
+		return LUAU;
 	}
 	// Add more else if blocks for other languages/adapters
+	return NONE;
+}
 
-	if (newAdapter != NONE)
+std::unique_ptr<LSPAdapter> LSPManager::createAdapter(AdapterType type)
+{
+	switch (type)
 	{
-		if (activeAdapter != newAdapter)
+	case CLANGD:
+		return std::make_unique<LSPAdapterClangd>();
+	case PYRIGHT:
+		return std::make_unique<LSPAdapterPyright>();
+	case TYPESCRIPT:
+		return std::make_unique<LSPAdapterTypescript>();
+	case GOADAPTER:
+		return std::make_unique<LSPAdapterGo>();
+	case LUAU:
+		return std::make_unique<LSPAdapterLuau>();
+	case NONE:
+	default:
+		return nullptr;
+	}
+}
+
+std::string LSPManager::rootFor(const std::string &filePath) const
+{
+	size_t length = workspacePath.size();
+	if (length > 0 && filePath.size() > length &&
+		filePath.compare(0, length, workspacePath) == 0 &&
+		(filePath[length] == '/' || filePath[length] == '\\'))
+	{
+		return workspacePath;
+	}
+	// Files outside the workspace get a server for their own folder
+	size_t separator = filePath.find_last_of("/\\");
+	return separator == std::string::npos ? std::string() : filePath.substr(0, separator);
+}
+
+LSPManager::Server *LSPManager::findServer(const std::string &filePath) const
+{
+	AdapterType type = adapterTypeFor(filePath);
+	std::string root = rootFor(filePath);
+	for (const std::unique_ptr<Server> &server : servers)
+	{
+		if (server->type == type && server->root == root)
 		{
-			// Optional: If switching from an initialized adapter, you might want
-			// to shut it down. For simplicity, this example just switches. The
-			// old adapter's process might still run. Consider adding shutdown
-			// logic here if resource usage is a concern. e.g., if (isInitialized())
-			// { /* get current adapter and call its shutdown methods */ }
-			std::cout << "\033[35mLSP Manager:\033[0m Switching active adapter to: "
-					  << newAdapter << " for file: " << filePath << std::endl;
-			activeAdapter = newAdapter;
-		} else
+			return server.get();
+		}
+	}
+	return nullptr;
+}
+
+bool LSPManager::selectAdapterForFile(const std::string &filePath)
+{
+	AdapterType type = adapterTypeFor(filePath);
+	if (type == NONE)
+	{
+		return false;
+	}
+
+	std::lock_guard<std::mutex> lock(serversMutex);
+	Server *server = findServer(filePath);
+	if (!server)
+	{
+		servers.push_back(std::make_unique<Server>());
+		server = servers.back().get();
+		server->type = type;
+		server->root = rootFor(filePath);
+	}
+	activeServer = server;
+
+	// Started on first use; one that failed waits before it is tried again
+	bool retry_due = !server->failed ||
+					 std::chrono::steady_clock::now() - server->failedAt >= RETRY_DELAY;
+	if (!server->connection && !server->starting && retry_due)
+	{
+		startServer(*server);
+	}
+	return true;
+}
+
+void LSPManager::startServer(Server &server)
+{
+	server.adapter = createAdapter(server.type);
+	if (!server.adapter)
+	{
+		server.failed = true;
+		server.failedAt = std::chrono::steady_clock::now();
+		return;
+	}
+	server.starting = true;
+	{
+		std::lock_guard<std::mutex> lock(queueMutex);
+		jobs.push_back({&server, nullptr});
+	}
+	queueCondition.notify_one();
+}
+
+void LSPManager::initializeServer(Server &server)
+{
+	// The adapter is not replaced while the server is starting
+	LSPAdapter *adapter = server.adapter.get();
+	std::cout << "\033[35mLSP Manager:\033[0m Starting " << adapterName(server.type)
+			  << " for " << server.root << std::endl;
+	bool started = false;
+	try
+	{
+		started = adapter->initialize(server.root);
+	} catch (const std::exception &e)
+	{
+		std::cerr << "\033[31mLSP Manager:\033[0m Exception starting "
+				  << adapterName(server.type) << ": " << e.what() << std::endl;
+	}
+
+	std::lock_guard<std::mutex> lock(serversMutex);
+	server.starting = false;
+	std::vector<QueuedRequest> queued;
+	queued.swap(server.queued);
+	serverStarted.notify_all();
+	if (!started)
+	{
+		std::cout << "\033[33mLSP Manager:\033[0m " << adapterName(server.type)
+				  << " failed to start - LSP support is disabled for these files "
+					 "for now"
+				  << std::endl;
+		server.failed = true;
+		server.failedAt = std::chrono::steady_clock::now();
+		// Their didOpen went nowhere, so they are opened again on the retry
+		server.openDocuments.clear();
+		for (QueuedRequest &request : queued)
 		{
-			// It's the same adapter, no need to switch, just ensure it's
-			// "selected" This path is fine.
+			if (request.handler)
+			{
+				unanswered.push_back(std::move(request.handler));
+			}
 		}
-		return true;
+		return;
 	}
 
-	// If no specific adapter is found for the extension
-	std::cout << "\033[33mLSP Manager:\033[0m No specific adapter found for "
-				 "extension '"
-			  << ext << "'. Active adapter remains: " << activeAdapter << std::endl;
-	// activeAdapter = NONE; // Or keep the current one if that's desired behavior
-	return false; // No *new* adapter was selected for this extension
+	// Published under the lock after the queue is sent, so nothing the main
+	// thread sends next can overtake it
+	server.connection = std::make_unique<LSPConnection>(
+		[adapter]() { return adapter->readResponse(); },
+		[adapter](const std::string &body) { return adapter->sendRequest(body); });
+	for (QueuedRequest &request : queued)
+	{
+		if (request.method.empty())
+		{
+			server.connection->send(request.body);
+		} else if (!server.connection->request(request.method, request.body,
+											   request.handler))
+		{
+			unanswered.push_back(std::move(request.handler));
+		}
+	}
+	server.failed = false;
+	server.lastUsed = std::chrono::steady_clock::now();
+	std::cout << "\033[32mLSP Manager:\033[0m Initialized " << adapterName(server.type)
+			  << " for " << server.root << std::endl;
 }
 
-bool LSPManager::sendRequest(const std::string &request)
+void LSPManager::stopServer(Server &server)
 {
-	switch (activeAdapter)
-	{
-	// case CLANGD:
-	// 	return clangdAdapter && clangdAdapter->isInitialized()
-	// 			   ? clangdAdapter->sendRequest(request)
-	// 			   : false;
-	// case PYRIGHT:
-	// 	return pyrightAdapter && pyrightAdapter->isInitialized()
-	// 			   ? pyrightAdapter->sendRequest(request)
-	// 			   : false;
-	// case TYPESCRIPT:
-	// 	return typescriptAdapter && typescriptAdapter->isInitialized()
-	// 			   ? typescriptAdapter->sendRequest(request)
-	// 			   : false;
-	// case GOADAPTER: // For Go
-	// 	return goAdapter && goAdapter->isInitialized() ? goAdapter->sendRequest(request)
-	// 												   : false;
-	case LUAU:
-		return luauAdapter && luauAdapter->isInitialized()
-					? luauAdapter->sendRequest(request)
-					: false;
+	if (!server.connection)
+	{
+		return;
+	}
+	std::cout << "\033[35mLSP Manager:\033[0m Stopping " << adapterName(server.type)
+			  << " for " << server.root << std::endl;
+	// The reader blocks in a read until the server's pipe is closed
+	server.adapter->shutdown();
+	server.connection->stop();
+	// Handlers still waiting get their empty answer from processMessages.
+	// On exit they are dropped with the connection instead, as they reach
+	// into editor globals that may already be destroyed by then.
+}
 
-	case NONE:
-	default:
+void LSPManager::workerFunction()
+{
+	while (true)
+	{
+		Job job;
+		{
+			std::unique_lock<std::mutex> lock(queueMutex);
+			queueCondition.wait(lock, [this] { return !jobs.empty() || shouldStop; });
+			if (shouldStop)
+			{
+				return;
+			}
+			job = std::move(jobs.front());
+			jobs.pop_front();
+		}
+
+		if (job.start)
+		{
+			initializeServer(*job.start);
+		} else
+		{
+			stopServer(*job.stop);
+			// Its requests still waiting get their empty answer on the main
+			// thread, where handlers run
+			std::lock_guard<std::mutex> lock(serversMutex);
+			stoppedServers.push_back(std::move(job.stop));
+		}
+	}
+}
+
+bool LSPManager::sendRequest(const std::string &request)
+{
+	std::unique_lock<std::mutex> lock(serversMutex);
+	if (!usable(activeServer))
+	{
 		std::cerr << "\033[31mLSP Manager:\033[0m Cannot send request, no "
 					 "active adapter or unknown type."
 				  << std::endl;
 		return false;
 	}
+	activeServer->lastUsed = std::chrono::steady_clock::now();
+	if (activeServer->starting)
+	{
+		activeServer->queued.push_back({"", request, nullptr});
+		return true;
+	}
+	// Only the main thread removes servers, so the connection outlives the lock
+	LSPConnection *connection = activeServer->connection.get();
+	lock.unlock();
+	return connection->send(request);
 }
 
-std::string LSPManager::readResponse(int *contentLength)
+bool LSPManager::request(const std::string &method,
+						 const std::string &params,
+						 LSPConnection::Handler handler)
 {
-	if (contentLength)
-		*contentLength = -1; // Default for safety
-
-	switch (activeAdapter)
-	{
-	// case CLANGD:
-	// 	return clangdAdapter && clangdAdapter->isInitialized()
-	// 			   ? clangdAdapter->readResponse(contentLength)
-	// 			   : "";
-	// case PYRIGHT:
-	// 	return pyrightAdapter && pyrightAdapter->isInitialized()
-	// 			   ? pyrightAdapter->readResponse(contentLength)
-	// 			   : "";
-	// case TYPESCRIPT:
-	// 	return typescriptAdapter && typescriptAdapter->isInitialized()
-	// 			   ? typescriptAdapter->readResponse(contentLength)
-	// 			   : "";
-	// case GOADAPTER: // For Go
-	// 	return goAdapter && goAdapter->isInitialized()
-	// 			   ? goAdapter->readResponse(contentLength)
-	// 			   : "";
-	case LUAU:
-			return luauAdapter && luauAdapter->isInitialized()
-					? luauAdapter->readResponse(contentLength)
-					: "";
-	case NONE:
-	default:
-		std::cerr << "\033[31mLSP Manager:\033[0m Cannot read response, no "
-					 "active adapter or "
-					 "unknown type."
-				  << std::endl;
-		// if (contentLength) *contentLength = -1; // Already set at the start
-		return "";
+	std::unique_lock<std::mutex> lock(serversMutex);
+	if (!usable(activeServer))
+	{
+		return false;
 	}
+	activeServer->lastUsed = std::chrono::steady_clock::now();
+	if (activeServer->starting)
+	{
+		activeServer->queued.push_back({method, params, std::move(handler)});
+		return true;
+	}
+	LSPConnection *connection = activeServer->connection.get();
+	lock.unlock();
+	return connection->request(method, params, std::move(handler));
 }
 
-std::string LSPManager::getLanguageId(const std::string &filePath) const
+std::future<std::string> LSPManager::requestForFile(const std::string &filePath,
+													const std::string &method,
+													const std::string &params)
 {
-	// This method is typically called after selectAdapterForFile has set the
-	// activeAdapter based on the filePath. So, we can trust activeAdapter here.
-	switch (activeAdapter)
-	{
-	// case CLANGD:
-	// 	return clangdAdapter && clangdAdapter->isInitialized()
-	// 			   ? clangdAdapter->getLanguageId(filePath)
-	// 			   : "plaintext";
-	// case PYRIGHT:
-	// 	return pyrightAdapter && pyrightAdapter->isInitialized()
-	// 			   ? pyrightAdapter->getLanguageId(filePath)
-	// 			   : "plaintext";
-	// case TYPESCRIPT:
-	// 	return typescriptAdapter && typescriptAdapter->isInitialized()
-	// 			   ? typescriptAdapter->getLanguageId(filePath)
-	// 			   : "plaintext";
-	// case GOADAPTER: // For Go
-	// 	return goAdapter && goAdapter->isInitialized()
-	// 			   ? goAdapter->getLanguageId(filePath)
-	// 			   : "plaintext";
-    case LUAU:
-		return luauAdapter && luauAdapter->isInitialized()
-					? luauAdapter->getLanguageId(filePath)
-					: "plaintext";
-	case NONE:
-	default:
-		// If selectAdapterForFile failed (e.g. unknown extension), activeAdapter
-		// might be NONE or the previously active one. Returning "plaintext" is
-		// a safe default. However, the adapter itself should provide the ID, so
-		// this path should ideally not be hit if an adapter is truly active and
-		// selected. std::cout << "\033[33mLSP Manager:\033[0m getLanguageId called
-		// with no specific active adapter. File: " << filePath << std::endl;
-		return "plaintext";
+	std::unique_lock<std::mutex> lock(serversMutex);
+	Server *server = findServer(filePath);
+	if (!server || !server->connection)
+	{
+		std::promise<std::string> none;
+		none.set_value("");
+		return none.get_future();
 	}
+	server->lastUsed = std::chrono::steady_clock::now();
+	// Sent unlocked, as in request(): a server stopped meanwhile is only
+	// freed on the main thread, and its connection answers with ""
+	LSPConnection *connection = server->connection.get();
+	lock.unlock();
+	return connection->request(method, params);
 }
 
-bool LSPManager::hasWorkingAdapter() const
+void LSPManager::documentOpened(const std::string &filePath)
 {
-	switch (activeAdapter)
-	{
-	// case CLANGD:
-	// 	return clangdAdapter && clangdAdapter->isInitialized();
-	// case PYRIGHT:
-	// 	return pyrightAdapter && pyrightAdapter->isInitialized();
-	// case TYPESCRIPT:
-	// 	return typescriptAdapter && typescriptAdapter->isInitialized();
-	// case GOADAPTER:
-	// 	return goAdapter && goAdapter->isInitialized();
-	case LUAU:
-		return luauAdapter && luauAdapter->isInitialized();
-	case NONE:
-	default:
-		return false;
+	std::lock_guard<std::mutex> lock(serversMutex);
+	if (Server *server = findServer(filePath))
+	{
+		server->openDocuments.insert(filePath);
+		server->lastUsed = std::chrono::steady_clock::now();
+	}
+}
+
+void LSPManager::documentClosed(const std::string &filePath)
+{
+	std::lock_guard<std::mutex> lock(serversMutex);
+	if (Server *server = findServer(filePath))
+	{
+		server->openDocuments.erase(filePath);
+	}
+}
+
+bool LSPManager::isDocumentOpen(const std::string &filePath) const
+{
+	std::lock_guard<std::mutex> lock(serversMutex);
+	Server *server = findServer(filePath);
+	return server && (server->connection || server->starting) &&
+		   server->openDocuments.count(filePath) > 0;
+}
+
+void LSPManager::processMessages()
+{
+	std::vector<LSPConnection *> running;
+	std::vector<std::unique_ptr<Server>> stopped;
+	std::vector<LSPConnection::Handler> failed;
+	{
+		std::lock_guard<std::mutex> lock(serversMutex);
+		for (const std::unique_ptr<Server> &server : servers)
+		{
+			if (server->connection)
+			{
+				running.push_back(server->connection.get());
+			}
+		}
+		stopped.swap(stoppedServers);
+		failed.swap(unanswered);
+	}
+	// Requests that were queued for a server that did not start
+	for (LSPConnection::Handler &handler : failed)
+	{
+		handler("");
+	}
+	// Handlers may select files and start servers, which only adds to the list
+	for (LSPConnection *connection : running)
+	{
+		connection->dispatch([this, connection](const std::string &message) {
+			handleServerMessage(*connection, message);
+		});
+	}
+	// Stopped by the worker; requests still waiting get their empty answer
+	for (std::unique_ptr<Server> &server : stopped)
+	{
+		server->connection->dispatch([](const std::string &) {});
+	}
+	stopped.clear();
+
+	// Servers that exited are dropped too, so the next use starts them again
+	auto now = std::chrono::steady_clock::now();
+	{
+		std::lock_guard<std::mutex> lock(serversMutex);
+		for (auto server = servers.begin(); server != servers.end();)
+		{
+			LSPConnection *connection = (*server)->connection.get();
+			bool idle = (*server)->openDocuments.empty() &&
+						now - (*server)->lastUsed >= IDLE_TIMEOUT;
+			if (connection && (!connection->running() || idle))
+			{
+				if (activeServer == server->get())
+				{
+					activeServer = nullptr;
+				}
+				stopped.push_back(std::move(*server));
+				server = servers.erase(server);
+			} else
+			{
+				++server;
+			}
+		}
+	}
+	if (!stopped.empty())
+	{
+		{
+			std::lock_guard<std::mutex> lock(queueMutex);
+			for (std::unique_ptr<Server> &server : stopped)
+			{
+				jobs.push_back({nullptr, std::move(server)});
+			}
+		}
+		queueCondition.notify_one();
+	}
+}
+
+void LSPManager::handleServerMessage(LSPConnection &connection, const std::string &message)
+{
+	json j = json::parse(message, nullptr, false);
+	if (j.is_discarded() || !j.is_object())
+	{
+		return;
 	}
-}
\ No newline at end of file
+	std::string method = j.value("method", "");
+	if (j.contains("id"))
+	{
+		// Requests from the server wait for an answer; none of them needs
+		// more than an empty one from this client
+		connection.send(json{{"jsonrpc", "2.0"}, {"id", j["id"]}, {"result", nullptr}}
+							.dump());
+	}
+	if ((method == "window/logMessage" || method == "window/showMessage") &&
+		j.contains("params"))
+	{
+		std::cout << "\033[35mLSP Server:\033[0m "
+				  << j["params"].value("message", "") << std::endl;
+	}
+	// Other notifications, such as diagnostics, have no consumer yet
+}
+
+LSPConnection *LSPManager::activeConnection() const
+{
+	std::lock_guard<std::mutex> lock(serversMutex);
+	return activeServer && activeServer->connection && activeServer->connection->running()
+			   ? activeServer->connection.get()
+			   : nullptr;
+}
+
+std::string LSPManager::getLanguageId(const std::string &filePath) const
+{
+	// Called after selectAdapterForFile, so the selected server is the
+	// file's own
+	return activeServer && activeServer->adapter
+			   ? activeServer->adapter->getLanguageId(filePath)
+			   : "plaintext";
+}
+
+std::string LSPManager::getServerCapabilities() const
+{
+	return activeConnection() ? activeServer->adapter->getServerCapabilities() : "{}";
+}
+
+std::string LSPManager::getServerCapabilities(const std::string &filePath) const
+{
+	std::unique_lock<std::mutex> lock(serversMutex);
+	Server *server = nullptr;
+	serverStarted.wait(lock, [&] {
+		server = findServer(filePath);
+		return !server || !server->starting;
+	});
+	return server && server->connection ? server->adapter->getServerCapabilities()
+										: "{}";
+}
+
+bool LSPManager::hasWorkingAdapter() const { return isInitialized(); }
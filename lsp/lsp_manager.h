@@ -1,47 +1,79 @@
 #pragma once
-// #include "lsp_adapter_clangd.h"
-// #include "lsp_adapter_go.h" // Your new Go adapter
-// #include "lsp_adapter_pyright.h"
-// #include "lsp_adapter_typescript.h"
-#include "lsp_adapter_luau.h"
+#include "lsp_adapter.h"
+#include "lsp_connection.h"
 
+#include <atomic>
+#include <chrono>
+#include <condition_variable>
+#include <deque>
+#include <future>
 #include <memory>
+#include <mutex>
 #include <string>
+#include <thread>
+#include <unordered_set>
+#include <vector>
 
-// Forward declarations
-// class EditorLSP; // Not strictly needed in lsp_manager.h if not used directly
-
+// Runs one language server per language and workspace root, so files of
+// different languages each keep a warm server. Servers start the first
+// time a file of theirs is selected and are shut down once they have had
+// no open document and no traffic for IDLE_TIMEOUT. Starting, with its
+// initialize handshake, and stopping run on a worker thread so the UI never
+// waits on a server; requests made while one starts are sent once it is
+// ready.
 class LSPManager
 {
   public:
 	LSPManager();
 	~LSPManager();
 
-	// Adapter selection and initialization
+	// Sets the workspace root for files under path and starts the server
+	// of the selected file if it is not running yet
 	bool initialize(const std::string &workspacePath);
+	// True when the selected file's server is running or starting
 	bool isInitialized() const;
 
-	// Determine appropriate adapter for a file
+	// Selects the server of filePath's language and root for the calls that
+	// follow on the main thread, starting it on the worker if needed. False
+	// for files no server handles.
 	bool selectAdapterForFile(const std::string &filePath);
 
-	// Communication methods
+	// Communication methods, on the selected server, queued while it starts.
+	// Responses are read by the connection's reader thread; request() hands
+	// them to handler on the main thread, from processMessages().
 	bool sendRequest(const std::string &request);
-	std::string readResponse(int *contentLength = nullptr);
+	bool request(const std::string &method,
+				 const std::string &params,
+				 LSPConnection::Handler handler);
+	// For worker threads, which name the file instead of selecting it and
+	// wait for the response themselves. Answers "" unless the server is ready.
+	std::future<std::string> requestForFile(const std::string &filePath,
+											const std::string &method,
+											const std::string &params);
+
+	// The open documents of each server, which keep it from idling out and
+	// must be opened again when a server restarts
+	void documentOpened(const std::string &filePath);
+	void documentClosed(const std::string &filePath);
+	bool isDocumentOpen(const std::string &filePath) const;
+
+	// Runs the handlers of the responses that arrived, handles what the
+	// servers sent on their own and hands idle or exited servers to the
+	// worker to shut down. Called once per frame on the main thread.
+	void processMessages();
 
 	// Language-specific helpers
 	std::string getLanguageId(const std::string &filePath) const;
+	// What the selected server announced it supports, as JSON text; "{}"
+	// when there is no server. The overload may be called from any thread
+	// and waits for a server that is starting.
+	std::string getServerCapabilities() const;
+	std::string getServerCapabilities(const std::string &filePath) const;
 
-	// Check if the current adapter is working
+	// Check if the selected server is working
 	bool hasWorkingAdapter() const;
 
   private:
-	// // LSP adapter instances
-	// std::unique_ptr<LSPAdapterClangd> clangdAdapter;
-	// std::unique_ptr<LSPAdapterPyright> pyrightAdapter;
-	// std::unique_ptr<LSPAdapterTypescript> typescriptAdapter;
-	// std::unique_ptr<LSPAdapterGo> goAdapter; // For Go
-	std::unique_ptr<LSPAdapterLuau> luauAdapter; // For Luau
-
 	// Make sure the enum matches all your adapters
 	enum AdapterType {
 		NONE,
@@ -53,9 +85,78 @@ class LSPManager
 		LUAU       // For Luau
 	};
 
-	AdapterType activeAdapter;
+	// A main-thread request made while its server starts
+	struct QueuedRequest
+	{
+		std::string method; // empty for a message sent as is
+		std::string body;	// params, or the whole message
+		LSPConnection::Handler handler;
+	};
+
+	struct Server
+	{
+		AdapterType type = NONE;
+		std::string root;
+		// Fresh for each start, as a transport runs one process only. Set on
+		// the main thread while the server is not starting.
+		std::unique_ptr<LSPAdapter> adapter;
+		std::unique_ptr<LSPConnection> connection; // set by the worker once ready
+		bool starting = false;
+		std::vector<QueuedRequest> queued; // until the start ends
+		std::unordered_set<std::string> openDocuments;
+		std::chrono::steady_clock::time_point lastUsed;
+		// A server that failed to start is tried again after RETRY_DELAY
+		bool failed = false;
+		std::chrono::steady_clock::time_point failedAt;
+	};
+
+	static constexpr std::chrono::minutes IDLE_TIMEOUT{5};
+	static constexpr std::chrono::seconds RETRY_DELAY{30};
+
+	static AdapterType adapterTypeFor(const std::string &filePath);
+	static std::unique_ptr<LSPAdapter> createAdapter(AdapterType type);
+	// Workspace root a file's server runs in. Caller holds serversMutex.
+	std::string rootFor(const std::string &filePath) const;
+	// Caller holds serversMutex
+	Server *findServer(const std::string &filePath) const;
+	// Caller holds serversMutex. True for a server that is ready or starting.
+	static bool usable(const Server *server);
+	// Hands the server to the worker to start. Caller holds serversMutex.
+	void startServer(Server &server);
+	// Worker side of the two
+	void initializeServer(Server &server);
+	void stopServer(Server &server);
+	void workerFunction();
+	// Connection of the selected server, nullptr when it is not running
+	LSPConnection *activeConnection() const;
+	void handleServerMessage(LSPConnection &connection, const std::string &message);
+
+	// Guards the list and the fields of each server, for the worker threads
+	mutable std::mutex serversMutex;
+	// Signalled whenever a start ends, for getServerCapabilities(filePath)
+	mutable std::condition_variable serverStarted;
+	std::vector<std::unique_ptr<Server>> servers;
 	std::string workspacePath;
+	// Left for the main thread, under serversMutex: servers the worker
+	// stopped, whose last handlers still have to run, and handlers of
+	// queued requests that never reached a server
+	std::vector<std::unique_ptr<Server>> stoppedServers;
+	std::vector<LSPConnection::Handler> unanswered;
+
+	Server *activeServer = nullptr; // written on the main thread only
+
+	// One of start or stop per job
+	struct Job
+	{
+		Server *start = nullptr;
+		std::unique_ptr<Server> stop;
+	};
+	std::deque<Job> jobs;
+	std::mutex queueMutex;
+	std::condition_variable queueCondition;
+	std::atomic<bool> shouldStop{false};
+	std::thread workerThread;
 };
 
 // Global instance
-extern LSPManager gLSPManager;
\ No newline at end of file
+extern LSPManager gLSPManager;
@@ -0,0 +1,384 @@
+/*
+	File: lsp_semantic_tokens.cpp
+	Description: Requests textDocument/semanticTokens for the open document
+	and turns them into SemanticSpans drawn over the syntax colors.
+*/
+
+#include "lsp_semantic_tokens.h"
+#include "../editor/editor.h"
+#include "../lib/json.hpp"
+#include "lsp.h"
+#include "lsp_json_scan.h"
+#include "lsp_manager.h"
+#include "lsp_utils.h"
+
+#include <algorithm>
+#include <chrono>
+#include <future>
+#include <iostream>
+#include <string_view>
+
+using json = nlohmann::json;
+
+namespace {
+
+// One replacement in the token array of a delta
+struct TokensEdit
+{
+	uint32_t start;
+	uint32_t deleteCount;
+	std::vector<uint32_t> data;
+};
+
+// The result of a semantic tokens response, either full or a delta
+struct TokensResult
+{
+	std::string resultId;
+	bool hasData = false;
+	std::vector<uint32_t> data;
+	bool hasEdits = false;
+	std::vector<TokensEdit> edits;
+};
+
+// Reads the result of a response, false when it is not a successful one
+bool readTokensResult(std::string_view response, TokensResult &result)
+{
+	JsonScanner scanner(response);
+	auto readEdit = [&scanner](TokensEdit &edit) {
+		return scanner.readObject([&](std::string_view key) {
+			if (key == "start")
+			{
+				return scanner.readNumber(edit.start);
+			}
+			if (key == "deleteCount")
+			{
+				return scanner.readNumber(edit.deleteCount);
+			}
+			if (key == "data")
+			{
+				return scanner.readNumbers(edit.data);
+			}
+			return scanner.skipValue();
+		});
+	};
+	auto readResult = [&]() {
+		return scanner.readObject([&](std::string_view key) {
+			if (key == "resultId")
+			{
+				return scanner.readString(result.resultId);
+			}
+			if (key == "data")
+			{
+				result.hasData = true;
+				return scanner.readNumbers(result.data);
+			}
+			if (key == "edits")
+			{
+				result.hasEdits = true;
+				return scanner.readArray([&]() {
+					result.edits.push_back(TokensEdit{0, 0, {}});
+					return readEdit(result.edits.back());
+				});
+			}
+			return scanner.skipValue();
+		});
+	};
+
+	bool found = false;
+	bool ok = scanner.readObject([&](std::string_view key) {
+		if (key != "result")
+		{
+			return scanner.skipValue();
+		}
+		if (scanner.readNull())
+		{
+			return true;
+		}
+		found = true;
+		return readResult();
+	});
+	return ok && found;
+}
+
+// Applies the edits of a delta to the array it was made against, in one
+// pass. Edit starts refer to that array, so they are applied in order.
+bool applyEdits(std::vector<uint32_t> &data, std::vector<TokensEdit> &edits)
+{
+	std::sort(edits.begin(), edits.end(), [](const TokensEdit &a, const TokensEdit &b) {
+		return a.start < b.start;
+	});
+	std::vector<uint32_t> result;
+	result.reserve(data.size());
+	size_t copied = 0;
+	for (const TokensEdit &edit : edits)
+	{
+		if (edit.start < copied || edit.start + size_t(edit.deleteCount) > data.size())
+		{
+			return false;
+		}
+		result.insert(result.end(), data.begin() + copied, data.begin() + edit.start);
+		result.insert(result.end(), edit.data.begin(), edit.data.end());
+		copied = edit.start + size_t(edit.deleteCount);
+	}
+	result.insert(result.end(), data.begin() + copied, data.end());
+	data = std::move(result);
+	return true;
+}
+
+} // namespace
+
+LSPSemanticTokens::LSPSemanticTokens()
+{
+	workerThread = std::thread(&LSPSemanticTokens::workerFunction, this);
+}
+
+LSPSemanticTokens::~LSPSemanticTokens()
+{
+	shouldStop = true;
+	queueCondition.notify_one();
+	if (workerThread.joinable())
+	{
+		workerThread.join();
+	}
+}
+
+void LSPSemanticTokens::requestTokens(const std::string &filePath)
+{
+	if (editor_state.large_file)
+	{
+		return;
+	}
+	// Counted newlines let the worker find the token lines in the snapshot
+	editor_state.fileContent.lineCount();
+	{
+		std::lock_guard<std::mutex> lock(queueMutex);
+		pending = Request{filePath, editor_state.fileContent.snapshot()};
+	}
+	queueCondition.notify_one();
+}
+
+void LSPSemanticTokens::forgetFile(const std::string &filePath)
+{
+	std::lock_guard<std::mutex> lock(filesMutex);
+	files.erase(filePath);
+}
+
+void LSPSemanticTokens::workerFunction()
+{
+	while (!shouldStop)
+	{
+		Request request;
+		{
+			std::unique_lock<std::mutex> lock(queueMutex);
+			queueCondition.wait(lock, [this] { return pending || shouldStop; });
+			if (shouldStop)
+			{
+				break;
+			}
+			request = std::move(*pending);
+			pending.reset();
+		}
+
+		try
+		{
+			processRequest(request);
+		} catch (const std::exception &e)
+		{
+			std::cerr << "\033[31mLSP SemanticTokens:\033[0m " << e.what() << std::endl;
+		}
+	}
+}
+
+void LSPSemanticTokens::processRequest(const Request &request)
+{
+	// The worker names the file; selecting it is for the main thread
+	if (!updateLegend(gLSPManager.getServerCapabilities(request.filePath)))
+	{
+		return;
+	}
+
+	FileTokens known;
+	{
+		std::lock_guard<std::mutex> lock(filesMutex);
+		known = files[request.filePath];
+	}
+	bool delta = legend.delta && !known.resultId.empty();
+
+	std::string params =
+		R"({"textDocument":{"uri":")" + pathToFileUri(request.filePath) + R"("})";
+	if (delta)
+	{
+		params +=
+			R"(,"previousResultId":")" + EditorLSP::escapeJSON(known.resultId) + R"(")";
+	}
+	params += "}";
+	std::future<std::string> answer = gLSPManager.requestForFile(
+		request.filePath,
+		delta ? "textDocument/semanticTokens/full/delta" : "textDocument/semanticTokens/full",
+		params);
+
+	// The reader thread fills the future, nothing else waits on this worker
+	std::string response;
+	if (answer.wait_for(std::chrono::seconds(5)) == std::future_status::ready)
+	{
+		response = answer.get();
+	}
+
+	TokensResult result;
+	if (response.empty() || !readTokensResult(response, result))
+	{
+		// An unanswered delta leaves no base, the next request is a full one
+		forgetFile(request.filePath);
+		return;
+	}
+	if (result.hasData)
+	{
+		known.data = std::move(result.data);
+	} else if (!result.hasEdits || !applyEdits(known.data, result.edits))
+	{
+		forgetFile(request.filePath);
+		return;
+	}
+	known.resultId = std::move(result.resultId);
+
+	std::vector<SemanticSpans::Span> spans = decode(known.data, request.snapshot);
+	{
+		std::lock_guard<std::mutex> lock(filesMutex);
+		files[request.filePath] = std::move(known);
+	}
+	// Spans of a document no longer open are dropped by the next rebase
+	editor_state.semantic_spans.assign(
+		request.snapshot.documentId(), request.snapshot.version(), std::move(spans));
+}
+
+bool LSPSemanticTokens::updateLegend(const std::string &capabilities)
+{
+	if (capabilities == legend.source)
+	{
+		return legend.full;
+	}
+
+	legend = Legend();
+	legend.source = capabilities;
+	try
+	{
+		json caps = json::parse(capabilities);
+		legend.utf8 = caps.value("positionEncoding", "utf-16") == "utf-8";
+		if (!caps.contains("semanticTokensProvider"))
+		{
+			return false;
+		}
+		const json &provider = caps["semanticTokensProvider"];
+		const json full = provider.value("full", json(false));
+		legend.full = full.is_object() || (full.is_boolean() && full.get<bool>());
+		legend.delta = full.is_object() && full.value("delta", false);
+		for (const json &type : provider.at("legend").at("tokenTypes"))
+		{
+			legend.typeClasses.push_back(classForTokenType(type.get<std::string>()));
+		}
+	} catch (const json::exception &e)
+	{
+		std::cerr << "\033[31mLSP SemanticTokens:\033[0m Bad legend: " << e.what()
+				  << std::endl;
+		legend.full = false;
+	}
+	return legend.full;
+}
+
+std::vector<SemanticSpans::Span>
+LSPSemanticTokens::decode(const std::vector<uint32_t> &data,
+						  const TextSnapshot &snapshot) const
+{
+	std::vector<SemanticSpans::Span> spans;
+	size_t line = 0;
+	size_t column = 0;
+	// Text of the line the tokens are on, without its line break
+	size_t loaded_line = SIZE_MAX;
+	size_t line_start = 0;
+	std::string line_text;
+
+	for (size_t i = 0; i + 5 <= data.size(); i += 5)
+	{
+		// Each token is relative to the one before: line delta, start column
+		// (relative when on the same line), length, type and modifiers
+		if (data[i] != 0)
+		{
+			line += data[i];
+			column = data[i + 1];
+		} else
+		{
+			column += data[i + 1];
+		}
+		size_t type = data[i + 3];
+		if (type >= legend.typeClasses.size() || !legend.typeClasses[type])
+		{
+			continue;
+		}
+
+		if (line != loaded_line)
+		{
+			line_start = snapshot.lineStart(line);
+			if (line_start >= snapshot.size())
+			{
+				break;
+			}
+			line_text =
+				snapshot.substr(line_start, snapshot.lineStart(line + 1) - line_start);
+			while (!line_text.empty() &&
+				   (line_text.back() == '\n' || line_text.back() == '\r'))
+			{
+				line_text.pop_back();
+			}
+			loaded_line = line;
+		}
+
+		size_t end_column = column + data[i + 2];
+		size_t start = legend.utf8 ? std::min(column, line_text.size())
+								   : utf16ColumnToByte(line_text, column);
+		size_t end = legend.utf8 ? std::min(end_column, line_text.size())
+								 : utf16ColumnToByte(line_text, end_column);
+		start += line_start;
+		end += line_start;
+		if (end > start && (spans.empty() || spans.back().end <= start))
+		{
+			spans.push_back({start, end, *legend.typeClasses[type]});
+		}
+	}
+	return spans;
+}
+
+std::optional<HighlightClass> LSPSemanticTokens::classForTokenType(const std::string &type)
+{
+	static const std::unordered_map<std::string, HighlightClass> type_classes = {
+		{"namespace", HighlightClass::Type},
+		{"type", HighlightClass::Type},
+		{"class", HighlightClass::Type},
+		{"enum", HighlightClass::Type},
+		{"interface", HighlightClass::Type},
+		{"struct", HighlightClass::Type},
+		{"typeParameter", HighlightClass::Type},
+		{"parameter", HighlightClass::Variable},
+		{"variable", HighlightClass::Variable},
+		{"property", HighlightClass::Variable},
+		{"enumMember", HighlightClass::Variable},
+		{"event", HighlightClass::Variable},
+		{"function", HighlightClass::Function},
+		{"method", HighlightClass::Function},
+		{"macro", HighlightClass::Function},
+		{"decorator", HighlightClass::Function},
+		{"keyword", HighlightClass::Keyword},
+		{"modifier", HighlightClass::Keyword},
+		{"comment", HighlightClass::Comment},
+		{"string", HighlightClass::String},
+		{"regexp", HighlightClass::String},
+		{"number", HighlightClass::Number},
+		{"operator", HighlightClass::Operator}};
+
+	// Types the editor has no color for keep what the syntax gave them
+	auto found = type_classes.find(type);
+	if (found == type_classes.end())
+	{
+		return std::nullopt;
+	}
+	return found->second;
+}
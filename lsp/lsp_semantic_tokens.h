@@ -0,0 +1,86 @@
+/*
+	File: lsp_semantic_tokens.h
+	Description: Requests textDocument/semanticTokens for the open document
+	and turns them into SemanticSpans drawn over the syntax colors.
+
+	After the first full answer the server is asked for deltas against the
+	result it sent last, which are a few integers for a typical edit. Token
+	arrays are read straight from the message text instead of a JSON DOM, as
+	they hold five integers per token of the file.
+*/
+
+#pragma once
+#include "../editor/editor_buffer.h"
+#include "../editor/editor_semantic_spans.h"
+
+#include <atomic>
+#include <condition_variable>
+#include <cstdint>
+#include <mutex>
+#include <optional>
+#include <string>
+#include <thread>
+#include <unordered_map>
+#include <vector>
+
+class LSPSemanticTokens
+{
+  public:
+	LSPSemanticTokens();
+	~LSPSemanticTokens();
+
+	// Asks for the tokens of filePath as of the current text, a delta when
+	// the server sent tokens for it before. Only the newest request that has
+	// not started yet is kept.
+	void requestTokens(const std::string &filePath);
+
+	// Drops what is kept for filePath, e.g. when it is closed
+	void forgetFile(const std::string &filePath);
+
+  private:
+	struct Request
+	{
+		std::string filePath;
+		TextSnapshot snapshot;
+	};
+
+	// Tokens the server last sent for a file, the base of its next delta
+	struct FileTokens
+	{
+		std::string resultId;
+		std::vector<uint32_t> data;
+	};
+
+	// How the server encodes tokens, read from its capabilities
+	struct Legend
+	{
+		std::string source; // capabilities this was read from
+		bool full = false;
+		bool delta = false;
+		bool utf8 = false; // columns count bytes rather than UTF-16 units
+		// Class of each token type, nullopt to keep the syntax colors
+		std::vector<std::optional<HighlightClass>> typeClasses;
+	};
+
+	void workerFunction();
+	void processRequest(const Request &request);
+	// Rereads the legend when the file's server differs from the last one,
+	// false without tokens
+	bool updateLegend(const std::string &capabilities);
+	std::vector<SemanticSpans::Span> decode(const std::vector<uint32_t> &data,
+											const TextSnapshot &snapshot) const;
+	static std::optional<HighlightClass> classForTokenType(const std::string &type);
+
+	std::optional<Request> pending;
+	std::mutex queueMutex;
+	std::condition_variable queueCondition;
+	std::atomic<bool> shouldStop{false};
+	std::thread workerThread;
+
+	// Under filesMutex, as forgetFile() is called from the UI thread
+	std::unordered_map<std::string, FileTokens> files;
+	std::mutex filesMutex;
+
+	// Worker only
+	Legend legend;
+};
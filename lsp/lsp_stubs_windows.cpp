@@ -76,7 +76,7 @@ void EditorLSP::didChange(const std::string &filePath, int version) {
     // Stub - no action on Windows
 }
 
-std::string EditorLSP::escapeJSON(const std::string &s) const {
+std::string EditorLSP::escapeJSON(const std::string &s) {
     return s;
 }
 
@@ -88,6 +88,10 @@ void LSPAutocomplete::requestCompletion(const std::string &filePath, int line, i
     // Stub - no action on Windows
 }
 
+void LSPAutocomplete::processInput() {
+    // Stub - no action on Windows
+}
+
 void LSPAutocomplete::renderCompletions() {
     // Stub - no action on Windows
 }
@@ -1,5 +1,6 @@
 #include "lsp_symbol_info.h"
 #include "../editor/editor.h"
+#include "lsp_utils.h"
 #include <iostream>
 #include <sstream>
 
@@ -23,61 +24,29 @@ void LSPSymbolInfo::fetchSymbolInfo(const std::string &filePath)
 			  << "Line: " << lsp_line << " (" << current_line + 1 << "), "
 			  << "Char: " << lsp_char << " (abs pos: " << cursor_pos << ")\n";
 
-	if (!gLSPManager.isInitialized())
+	if (!gLSPManager.selectAdapterForFile(filePath) || !gLSPManager.isInitialized())
 	{
 		std::cout << "\033[31mLSP SymbolInfo:\033[0m LSP not initialized\n";
 		return;
 	}
 
-	static int requestId = 5000;
-	std::string request = std::string(R"({
-        "jsonrpc": "2.0",
-        "id": )" + std::to_string(requestId++) +
-									  R"(,
-        "method": "textDocument/hover",
-        "params": {
-            "textDocument": {
-                "uri": "file://)" + filePath +
-									  R"("
-            },
-            "position": {
-                "line": )" + std::to_string(lsp_line) +
-									  R"(,
-                "character": )" + std::to_string(lsp_char) +
-									  R"(
-            }
-        }
-    })");
-
-	std::cout << "\033[36mLSP SymbolInfo Request:\033[0m\n" << request << "\n";
-
-	if (!gLSPManager.sendRequest(request))
-	{
-		std::cout << "\033[31mLSP SymbolInfo:\033[0m Failed to send hover request\n";
-		return;
-	}
+	json params = {{"textDocument", {{"uri", pathToFileUri(filePath)}}},
+				   {"position", {{"line", lsp_line}, {"character", lsp_char}}}};
 
 	// Store display position
 	displayPosition = ImGui::GetMousePos();
 	displayPosition.x += 20;
 
-	// Response handling with timeout
-	const int MAX_ATTEMPTS = 15;
-	for (int attempt = 0; attempt < MAX_ATTEMPTS; attempt++)
+	bool sent = gLSPManager.request(
+		"textDocument/hover", params.dump(), [this](const std::string &response) {
+			if (!response.empty())
+			{
+				parseHoverResponse(response);
+			}
+		});
+	if (!sent)
 	{
-		int contentLength = 0;
-		std::string response = gLSPManager.readResponse(&contentLength);
-
-		if (!response.empty())
-		{
-			std::cout << "\033[36mLSP SymbolInfo Response:\033[0m\n" << response << "\n";
-		}
-
-		if (response.find("\"id\":" + std::to_string(requestId - 1)) != std::string::npos)
-		{
-			parseHoverResponse(response);
-			return;
-		}
+		std::cout << "\033[31mLSP SymbolInfo:\033[0m Failed to send hover request\n";
 	}
 }
 
@@ -198,7 +167,7 @@ void LSPSymbolInfo::renderSymbolInfo()
 		return;
 
 	// Calculate cursor position in screen space
-	int cursor_line = gEditor.getLineFromPos(editor_state.cursor_index);
+	size_t cursor_row = gEditorWrap.rowOfPosition(editor_state.cursor_index);
 	float cursor_x = gEditorCursor.getCursorXPosition(editor_state.text_pos,
 													  editor_state.fileContent,
 													  editor_state.cursor_index);
@@ -206,7 +175,7 @@ void LSPSymbolInfo::renderSymbolInfo()
 	// Get the actual screen position of the text cursor
 	ImVec2 cursor_screen_pos = editor_state.text_pos;
 	cursor_screen_pos.x = cursor_x;
-	cursor_screen_pos.y += cursor_line * editor_state.line_height;
+	cursor_screen_pos.y += cursor_row * editor_state.line_height;
 
 	// Set initial display position relative to cursor
 	displayPosition = cursor_screen_pos;
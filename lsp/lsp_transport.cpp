@@ -0,0 +1,561 @@
+/*
+	File: lsp_transport.cpp
+	Description: Child process and message framing for language servers.
+*/
+
+#include "lsp_transport.h"
+
+#include <algorithm>
+#include <chrono>
+#include <cstring>
+#include <iostream>
+
+#ifdef _WIN32
+#include <windows.h>
+#else
+#include <csignal>
+#include <fcntl.h>
+#include <poll.h>
+#include <sys/uio.h>
+#include <sys/wait.h>
+#include <unistd.h>
+#endif
+
+namespace {
+
+// Reads are made at least this large, so a big message takes few of them
+constexpr size_t MIN_READ = 64 * 1024;
+// A header this long without its blank line is not one
+constexpr size_t MAX_HEADER = 8 * 1024;
+
+int remainingMs(std::chrono::steady_clock::time_point deadline)
+{
+	auto left = std::chrono::duration_cast<std::chrono::milliseconds>(
+		deadline - std::chrono::steady_clock::now());
+	return int(std::max<long long>(0, left.count()));
+}
+
+} // namespace
+
+char *LSPFrameReader::writeSpace(size_t &len)
+{
+	if (buffer.size() - used < MIN_READ)
+	{
+		grow(used + MIN_READ);
+	}
+	size_t tail = (head + used) & (buffer.size() - 1);
+	// Up to the end of the storage or the first unread byte, whichever is
+	// first; the rest of the free space is written on the next call
+	len = tail >= head ? std::min(buffer.size() - tail, buffer.size() - used)
+					   : head - tail;
+	return buffer.data() + tail;
+}
+
+void LSPFrameReader::grow(size_t needed)
+{
+	size_t size = std::max<size_t>(buffer.size(), MIN_READ);
+	while (size < needed)
+	{
+		size *= 2;
+	}
+	std::vector<char> grown(size);
+	size_t first = std::min(used, buffer.size() - head);
+	if (used > 0)
+	{
+		std::memcpy(grown.data(), buffer.data() + head, first);
+		std::memcpy(grown.data() + first, buffer.data(), used - first);
+	}
+	buffer.swap(grown);
+	head = 0;
+}
+
+bool LSPFrameReader::parseHeader()
+{
+	for (; scanned < used; ++scanned)
+	{
+		if (at(scanned) != '\n')
+		{
+			continue;
+		}
+		size_t lineEnd = scanned;
+		if (lineEnd > lineStart && at(lineEnd - 1) == '\r')
+		{
+			--lineEnd;
+		}
+		if (lineEnd == lineStart)
+		{
+			// The blank line; the body follows it
+			size_t consumed = scanned + 1;
+			head = (head + consumed) & (buffer.size() - 1);
+			used -= consumed;
+			scanned = 0;
+			lineStart = 0;
+			malformed = contentLength < 0;
+			bodyLength = contentLength;
+			contentLength = -1;
+			return !malformed;
+		}
+
+		// Content-Length is the only header used; Content-Type is skipped
+		static const char name[] = "content-length:";
+		const size_t nameLength = sizeof(name) - 1;
+		bool matches = lineEnd - lineStart > nameLength;
+		for (size_t i = 0; matches && i < nameLength; ++i)
+		{
+			char c = at(lineStart + i);
+			matches = (c >= 'A' && c <= 'Z' ? char(c - 'A' + 'a') : c) == name[i];
+		}
+		if (matches)
+		{
+			long long value = 0;
+			bool digits = false;
+			for (size_t i = lineStart + nameLength; i < lineEnd; ++i)
+			{
+				char c = at(i);
+				if (c >= '0' && c <= '9' && value < (1LL << 40))
+				{
+					value = value * 10 + (c - '0');
+					digits = true;
+				} else if (c != ' ' && c != '\t')
+				{
+					digits = false;
+					break;
+				}
+			}
+			contentLength = digits ? value : -1;
+		}
+		lineStart = scanned + 1;
+	}
+	malformed = scanned > MAX_HEADER;
+	return false;
+}
+
+bool LSPFrameReader::next(std::string &body)
+{
+	if (malformed || (bodyLength < 0 && !parseHeader()))
+	{
+		return false;
+	}
+	size_t length = size_t(bodyLength);
+	if (used < length)
+	{
+		return false;
+	}
+
+	size_t first = std::min(length, buffer.size() - head);
+	body.assign(buffer.data() + head, first);
+	body.append(buffer.data(), length - first);
+	used -= length;
+	// An empty buffer starts over at the front, so reads stay contiguous
+	head = used == 0 ? 0 : (head + length) & (buffer.size() - 1);
+	bodyLength = -1;
+	return true;
+}
+
+std::string LSPTransport::receive(int timeoutMs)
+{
+	auto deadline =
+		std::chrono::steady_clock::now() + std::chrono::milliseconds(std::max(timeoutMs, 0));
+	std::string body;
+	while (!frames.next(body))
+	{
+		if (frames.error())
+		{
+			std::cerr << "\033[31mLSP Transport:\033[0m Malformed message header"
+					  << std::endl;
+			return "";
+		}
+		bool timedOut = false;
+		if (!fill(timeoutMs < 0 ? -1 : remainingMs(deadline), timedOut))
+		{
+			return "";
+		}
+	}
+	return body;
+}
+
+#ifdef _WIN32
+
+namespace {
+
+std::wstring widen(const std::string &text)
+{
+	if (text.empty())
+	{
+		return std::wstring();
+	}
+	int length = MultiByteToWideChar(CP_UTF8, 0, text.data(), int(text.size()), nullptr, 0);
+	std::wstring wide(size_t(length), L'\0');
+	MultiByteToWideChar(CP_UTF8, 0, text.data(), int(text.size()), wide.data(), length);
+	return wide;
+}
+
+} // namespace
+
+LSPTransport::~LSPTransport()
+{
+	stop(0);
+	for (HANDLE handle : {input, output, process})
+	{
+		if (handle)
+		{
+			CloseHandle(handle);
+		}
+	}
+}
+
+bool LSPTransport::start(const std::vector<std::string> &command)
+{
+	if (command.empty() || started)
+	{
+		return false;
+	}
+
+	SECURITY_ATTRIBUTES sa{sizeof(SECURITY_ATTRIBUTES), nullptr, TRUE};
+	HANDLE outRead = nullptr, outWrite = nullptr, inRead = nullptr, inWrite = nullptr;
+	if (!CreatePipe(&outRead, &outWrite, &sa, 0))
+	{
+		return false;
+	}
+	if (!CreatePipe(&inRead, &inWrite, &sa, 0))
+	{
+		CloseHandle(outRead);
+		CloseHandle(outWrite);
+		return false;
+	}
+	// Only the child's ends are inherited
+	SetHandleInformation(outRead, HANDLE_FLAG_INHERIT, 0);
+	SetHandleInformation(inWrite, HANDLE_FLAG_INHERIT, 0);
+
+	STARTUPINFOW si{};
+	si.cb = sizeof(si);
+	si.dwFlags = STARTF_USESTDHANDLES;
+	si.hStdInput = inRead;
+	si.hStdOutput = outWrite;
+	// Kept apart from stdout, where it would break the framing
+	si.hStdError = GetStdHandle(STD_ERROR_HANDLE);
+
+	std::wstring commandLine;
+	for (const std::string &arg : command)
+	{
+		commandLine += (commandLine.empty() ? L"\"" : L" \"") + widen(arg) + L"\"";
+	}
+
+	PROCESS_INFORMATION pi{};
+	BOOL created = CreateProcessW(nullptr,
+								  commandLine.data(),
+								  nullptr,
+								  nullptr,
+								  TRUE,
+								  CREATE_NO_WINDOW,
+								  nullptr,
+								  nullptr,
+								  &si,
+								  &pi);
+	CloseHandle(outWrite);
+	CloseHandle(inRead);
+	if (!created)
+	{
+		CloseHandle(outRead);
+		CloseHandle(inWrite);
+		return false;
+	}
+	CloseHandle(pi.hThread);
+	process = pi.hProcess;
+	input = inWrite;
+	output = outRead;
+	started = true;
+	return true;
+}
+
+bool LSPTransport::send(std::string_view body)
+{
+	// One write for header and body
+	std::string frame = "Content-Length: " + std::to_string(body.size()) + "\r\n\r\n";
+	frame.append(body);
+
+	std::lock_guard<std::mutex> lock(writeMutex);
+	if (!input)
+	{
+		return false;
+	}
+	size_t offset = 0;
+	while (offset < frame.size())
+	{
+		DWORD written = 0;
+		DWORD chunk = DWORD(std::min<size_t>(frame.size() - offset, 1 << 20));
+		if (!WriteFile(input, frame.data() + offset, chunk, &written, nullptr))
+		{
+			return false;
+		}
+		offset += written;
+	}
+	return true;
+}
+
+bool LSPTransport::fill(int timeoutMs, bool &timedOut)
+{
+	if (closed || endOfOutput)
+	{
+		return false;
+	}
+	// Anonymous pipes cannot be waited on, so a timed wait peeks
+	if (timeoutMs >= 0)
+	{
+		auto deadline =
+			std::chrono::steady_clock::now() + std::chrono::milliseconds(timeoutMs);
+		DWORD available = 0;
+		while (PeekNamedPipe(output, nullptr, 0, nullptr, &available, nullptr) &&
+			   available == 0)
+		{
+			if (std::chrono::steady_clock::now() >= deadline)
+			{
+				timedOut = true;
+				return false;
+			}
+			Sleep(5);
+		}
+	}
+
+	size_t len = 0;
+	char *space = frames.writeSpace(len);
+	DWORD read = 0;
+	// Returns with what the pipe holds, up to len, once there is anything
+	if (!ReadFile(output, space, DWORD(std::min<size_t>(len, 1 << 30)), &read, nullptr) ||
+		read == 0)
+	{
+		endOfOutput = true;
+		return false;
+	}
+	frames.commit(read);
+	return true;
+}
+
+void LSPTransport::stop(int graceMs)
+{
+	if (!started || closed.exchange(true))
+	{
+		return;
+	}
+	{
+		std::lock_guard<std::mutex> lock(writeMutex);
+		CloseHandle(input);
+		input = nullptr;
+	}
+	// Ending the process breaks the pipe a blocked ReadFile waits on
+	if (WaitForSingleObject(process, DWORD(graceMs)) != WAIT_OBJECT_0)
+	{
+		TerminateProcess(process, 1);
+		WaitForSingleObject(process, 1000);
+	}
+}
+
+#else
+
+LSPTransport::~LSPTransport()
+{
+	stop(0);
+	for (int fd : {input, output, wake[0], wake[1]})
+	{
+		if (fd >= 0)
+		{
+			close(fd);
+		}
+	}
+}
+
+bool LSPTransport::start(const std::vector<std::string> &command)
+{
+	if (command.empty() || started)
+	{
+		return false;
+	}
+
+	int toServer[2] = {-1, -1};
+	int fromServer[2] = {-1, -1};
+	if (pipe(toServer) < 0 || pipe(fromServer) < 0 || pipe(wake) < 0)
+	{
+		for (int fd : {toServer[0], toServer[1], fromServer[0], fromServer[1]})
+		{
+			if (fd >= 0)
+			{
+				close(fd);
+			}
+		}
+		return false;
+	}
+	for (int fd : {toServer[1], fromServer[0], wake[0], wake[1]})
+	{
+		fcntl(fd, F_SETFD, FD_CLOEXEC);
+	}
+	// Built before fork, the child only calls async-signal-safe functions
+	std::vector<char *> argv;
+	for (const std::string &arg : command)
+	{
+		argv.push_back(const_cast<char *>(arg.c_str()));
+	}
+	argv.push_back(nullptr);
+
+	pid = fork();
+	if (pid < 0)
+	{
+		for (int fd : {toServer[0], toServer[1], fromServer[0], fromServer[1]})
+		{
+			close(fd);
+		}
+		return false;
+	}
+	if (pid == 0)
+	{
+		dup2(toServer[0], STDIN_FILENO);
+		dup2(fromServer[1], STDOUT_FILENO);
+		close(toServer[0]);
+		close(toServer[1]);
+		close(fromServer[0]);
+		close(fromServer[1]);
+		execvp(argv[0], argv.data());
+		_exit(127);
+	}
+
+	close(toServer[0]);
+	close(fromServer[1]);
+	input = toServer[1];
+	output = fromServer[0];
+	fcntl(output, F_SETFL, fcntl(output, F_GETFL) | O_NONBLOCK);
+	fcntl(wake[0], F_SETFL, fcntl(wake[0], F_GETFL) | O_NONBLOCK);
+	started = true;
+	return true;
+}
+
+bool LSPTransport::send(std::string_view body)
+{
+	std::string header = "Content-Length: " + std::to_string(body.size()) + "\r\n\r\n";
+	iovec parts[2] = {{const_cast<char *>(header.data()), header.size()},
+					  {const_cast<char *>(body.data()), body.size()}};
+	iovec *part = parts;
+	int count = body.empty() ? 1 : 2;
+
+	std::lock_guard<std::mutex> lock(writeMutex);
+	if (input < 0)
+	{
+		return false;
+	}
+	// The pipe may take less than all of it; the rest follows
+	while (count > 0)
+	{
+		ssize_t written = writev(input, part, count);
+		if (written < 0)
+		{
+			if (errno == EINTR)
+			{
+				continue;
+			}
+			return false;
+		}
+		size_t left = size_t(written);
+		while (count > 0 && left >= part->iov_len)
+		{
+			left -= part->iov_len;
+			++part;
+			--count;
+		}
+		if (count > 0)
+		{
+			part->iov_base = static_cast<char *>(part->iov_base) + left;
+			part->iov_len -= left;
+		}
+	}
+	return true;
+}
+
+bool LSPTransport::fill(int timeoutMs, bool &timedOut)
+{
+	if (closed || endOfOutput)
+	{
+		return false;
+	}
+	pollfd fds[2] = {{output, POLLIN, 0}, {wake[0], POLLIN, 0}};
+	int ready = poll(fds, 2, timeoutMs);
+	if (ready < 0)
+	{
+		return errno == EINTR;
+	}
+	if (ready == 0)
+	{
+		timedOut = true;
+		return false;
+	}
+	if (fds[1].revents != 0)
+	{
+		return false; // stop()
+	}
+
+	// Drain what the pipe holds
+	for (;;)
+	{
+		size_t len = 0;
+		char *space = frames.writeSpace(len);
+		ssize_t n = read(output, space, len);
+		if (n > 0)
+		{
+			frames.commit(size_t(n));
+			if (size_t(n) < len)
+			{
+				return true;
+			}
+		} else if (n == 0)
+		{
+			// What arrived before the end may still hold messages
+			endOfOutput = true;
+			return true;
+		} else if (errno == EAGAIN || errno == EWOULDBLOCK)
+		{
+			return true;
+		} else if (errno != EINTR)
+		{
+			endOfOutput = true;
+			return true;
+		}
+	}
+}
+
+void LSPTransport::stop(int graceMs)
+{
+	if (!started || closed.exchange(true))
+	{
+		return;
+	}
+	{
+		std::lock_guard<std::mutex> lock(writeMutex);
+		close(input);
+		input = -1;
+	}
+	ssize_t woken = write(wake[1], "x", 1);
+	(void)woken;
+
+	// EOF on its input lets the server exit on its own first
+	auto waitFor = [this](int ms) {
+		auto deadline = std::chrono::steady_clock::now() + std::chrono::milliseconds(ms);
+		int status = 0;
+		while (waitpid(pid, &status, WNOHANG) == 0)
+		{
+			if (std::chrono::steady_clock::now() >= deadline)
+			{
+				return false;
+			}
+			usleep(5000);
+		}
+		return true;
+	};
+	if (!waitFor(graceMs))
+	{
+		kill(pid, SIGTERM);
+		if (!waitFor(500))
+		{
+			kill(pid, SIGKILL);
+			waitpid(pid, nullptr, 0);
+		}
+	}
+}
+
+#endif
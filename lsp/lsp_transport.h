@@ -0,0 +1,104 @@
+/*
+	File: lsp_transport.h
+	Description: Runs a language server as a child process and moves
+	Content-Length framed messages over its stdin and stdout.
+
+	Output is read in large chunks into a ring buffer that grows to fit the
+	largest message, and the header is parsed as the bytes arrive, so a
+	message costs one copy out of the buffer and no read is made per byte.
+	A message goes out as one gathered write of header and body.
+
+	On POSIX the process has to ignore SIGPIPE, as main() does: a write to
+	a server that exited then fails with EPIPE instead of ending the
+	editor. Pipes have no per-write MSG_NOSIGNAL, and an app embedding the
+	editor decides for itself.
+*/
+
+#pragma once
+#include <atomic>
+#include <cstddef>
+#include <mutex>
+#include <string>
+#include <string_view>
+#include <vector>
+
+#ifdef _WIN32
+typedef void *HANDLE;
+#else
+#include <sys/types.h>
+#endif
+
+// Splits a byte stream into message bodies
+class LSPFrameReader
+{
+  public:
+	// Space to read up to the next len bytes into, growing when it is short
+	char *writeSpace(size_t &len);
+	void commit(size_t written) { used += written; }
+
+	// Takes out the next complete body. False until one has arrived, or
+	// when the header is malformed, which error() tells apart.
+	bool next(std::string &body);
+	bool error() const { return malformed; }
+
+  private:
+	char at(size_t offset) const { return buffer[(head + offset) & (buffer.size() - 1)]; }
+	void grow(size_t needed);
+	// Reads header lines up to the blank line; true once it was found
+	bool parseHeader();
+
+	std::vector<char> buffer; // size is a power of two
+	size_t head = 0;
+	size_t used = 0;
+
+	size_t scanned = 0;			// header bytes already looked at
+	size_t lineStart = 0;		// of the header line being scanned
+	long long bodyLength = -1;	// -1 until the header ended
+	long long contentLength = -1;
+	bool malformed = false;
+};
+
+class LSPTransport
+{
+  public:
+	LSPTransport() = default;
+	~LSPTransport();
+	LSPTransport(const LSPTransport &) = delete;
+	LSPTransport &operator=(const LSPTransport &) = delete;
+
+	// Starts command[0] with the rest as arguments, searching PATH when it
+	// has no directory
+	bool start(const std::vector<std::string> &command);
+	bool running() const { return started && !closed; }
+
+	bool send(std::string_view body);
+	// Blocks until the next message body, at most timeoutMs when it is not
+	// negative. "" on timeout and once the server is gone or stop() ran.
+	std::string receive(int timeoutMs = -1);
+
+	// Closes the server's input and ends the process if it has not exited
+	// after graceMs. A receive() blocked in another thread returns.
+	void stop(int graceMs = 200);
+
+  private:
+	// Reads what the pipe has into the frame reader; false when it closed
+	// or the wait timed out, which timedOut tells apart
+	bool fill(int timeoutMs, bool &timedOut);
+
+	LSPFrameReader frames;
+	std::mutex writeMutex;
+	bool started = false;
+	bool endOfOutput = false; // reader thread only
+	std::atomic<bool> closed{false};
+
+#ifdef _WIN32
+	HANDLE process = nullptr;
+	HANDLE input = nullptr;	 // server's stdin
+	HANDLE output = nullptr; // server's stdout
+#else
+	pid_t pid = -1;
+	int input = -1;
+	int output = -1;
+	int wake[2] = {-1, -1}; // written by stop() to end a blocked receive()
+#endif
+};
@@ -1,5 +1,6 @@
 #pragma once
 #include <string>
+#include <string_view>
 #include <cctype>
 
 inline std::string pathToFileUri(std::string p) {
@@ -23,3 +24,34 @@ inline std::string pathToFileUri(std::string p) {
     }
     return out;
 }
+
+// Bytes of the UTF-8 sequence that starts with lead
+inline size_t utf8SequenceLength(unsigned char lead) {
+    if (lead < 0xC0) return 1; // ASCII, or a stray continuation byte
+    if (lead < 0xE0) return 2;
+    if (lead < 0xF0) return 3;
+    return 4;
+}
+
+// Byte offset in line of an LSP column, which counts UTF-16 code units
+// unless the server agreed to utf-8 positions. Clamped to the line.
+inline size_t utf16ColumnToByte(std::string_view line, size_t column) {
+    size_t byte = 0, units = 0;
+    while (byte < line.size() && units < column) {
+        size_t length = utf8SequenceLength(static_cast<unsigned char>(line[byte]));
+        units += length == 4 ? 2 : 1; // outside the BMP it takes a surrogate pair
+        byte += length;
+    }
+    return byte < line.size() ? byte : line.size();
+}
+
+// LSP column in UTF-16 code units of byte offset in line
+inline size_t byteToUtf16Column(std::string_view line, size_t byte) {
+    size_t units = 0;
+    for (size_t i = 0; i < byte && i < line.size();) {
+        size_t length = utf8SequenceLength(static_cast<unsigned char>(line[i]));
+        units += length == 4 ? 2 : 1;
+        i += length;
+    }
+    return units;
+}
@@ -3,8 +3,17 @@
 	Description: NEDitor main entry point
 */
 #include "ned.h"
+#ifndef _WIN32
+#include <csignal>
+#endif
 int main()
 {
+#ifndef _WIN32
+	// A language server that exits must not take the editor down with it,
+	// writing to its closed pipe fails with EPIPE instead
+	signal(SIGPIPE, SIG_IGN);
+#endif
+
 	Ned ned;
 	if (!ned.initialize())
 	{
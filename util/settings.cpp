@@ -572,6 +572,8 @@ void Settings::renderProfileSelector()
 					fontChanged = true;
 					settingsChanged = true;
 					gEditorHighlight.forceColorUpdate();
+					// A profile can switch highlighter mode as well
+					gEditorHighlight.highlightContent();
 				}
 			}
 			if (isSelected)
@@ -833,6 +835,16 @@ void Settings::renderToggleSettings()
 	ImGui::SameLine();
 	ImGui::TextDisabled("(Syntax Highlighting)");
 
+	bool wordWrap = getWordWrap();
+	if (ImGui::Checkbox("Word Wrap", &wordWrap))
+	{
+		settings["word_wrap"] = wordWrap;
+		settingsChanged = true;
+		saveSettings();
+	}
+	ImGui::SameLine();
+	ImGui::TextDisabled("(Wrap long lines at the editor edge)");
+
 	bool gitChangedLines = settings.value("git_changed_lines", true);
 	if (ImGui::Checkbox("Git Changed Lines", &gitChangedLines))
 	{
@@ -1366,9 +1378,11 @@ void Settings::switchToProfile(const std::string &profileName)
 	settingsChanged = true;
 	fontChanged = true;
 
-	// Force syntax color update for editor
+	// Force syntax color update for editor; a profile can switch highlighter
+	// mode as well, so rehighlight too
 	extern class EditorHighlight gEditorHighlight;
 	gEditorHighlight.forceColorUpdate();
+	gEditorHighlight.highlightContent();
 }
 
 std::string Settings::getCurrentProfileName() const
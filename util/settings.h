@@ -129,6 +129,14 @@ class Settings
 		}
 		return true; // Fallback
 	}
+	bool getWordWrap() const
+	{
+		if (settings.contains("word_wrap") && settings["word_wrap"].is_boolean())
+		{
+			return settings["word_wrap"].get<bool>();
+		}
+		return false; // Fallback
+	}
 	bool getTreesitterMode() const
 	{
 		if (settings.contains("treesitter") && settings["treesitter"].is_boolean())
@@ -384,6 +384,7 @@ void SettingsFileManager::loadSettings(json &settings, std::string &settingsPath
 		{"theme", "default"},
 		{"treesitter", true},
 		{"vignet_intensity", 0.25},
+		{"word_wrap", false},
 		{"mac_background_opacity", 0.5},
 		{"mac_blur_enabled", true},
 		{"fps_target", 120.0},
@@ -620,6 +621,7 @@ void SettingsFileManager::checkSettingsFile(const std::string &settingsPath,
 													"splitPos",
 													"rainbow",
 													"treesitter",
+													"word_wrap",
 													"shader_toggle",
 													"scanline_intensity",
 													"burnin_intensity",
@@ -746,6 +748,7 @@ void SettingsFileManager::applyDefaultSettings(json &settings)
 		{"theme", "default"},
 		{"treesitter", true},
 		{"vignet_intensity", 0.25},
+		{"word_wrap", false},
 		{"mac_background_opacity", 0.5},
 		{"mac_blur_enabled", true},
 		{"fps_target", 120.0},